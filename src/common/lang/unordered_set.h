@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 #include <unordered_set>
 
 using std::unordered_set;
+using std::unordered_multiset;
 
 template <class T>
 static bool is_subset(const unordered_set<T> &super_set, const unordered_set<T> &child_set)
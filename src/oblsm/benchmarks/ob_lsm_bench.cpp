@@ -1,2 +1,208 @@
-// TODO: add oblsm bench tool, reference leveldb db_bench
-int main() { return 0; }
\ No newline at end of file
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+// TODO: add more oblsm benchmarks, reference leveldb db_bench
+
+#include <cstdio>
+#include <cstring>
+
+#include "common/lang/chrono.h"
+#include "common/lang/filesystem.h"
+#include "common/lang/memory.h"
+#include "common/lang/string.h"
+#include "common/lang/vector.h"
+#include "oblsm/memtable/ob_memtable.h"
+#include "oblsm/ob_lsm_define.h"
+#include "oblsm/table/ob_sstable.h"
+#include "oblsm/table/ob_sstable_builder.h"
+#include "oblsm/util/ob_coding.h"
+#include "oblsm/util/ob_comparator.h"
+#include "oblsm/util/ob_lru_cache.h"
+
+using namespace oceanbase;
+
+namespace {
+
+struct BenchOptions
+{
+  int    num_tables     = 8;       // number of sstables a lookup has to go through
+  int    keys_per_table = 10000;   // keys in each sstable
+  int    lookups        = 100000;  // number of point lookups in each round
+  size_t bits_per_key   = 10;      // bloom filter bits per key
+  size_t cache_size     = 0;       // block cache size in bytes, 0 means no cache, every block is read from file
+  string db             = "oblsm_bench";
+};
+
+// The key ranges of all sstables overlap like sstables flushed to level 0.
+// Keys in sstables are even numbers, missing keys are odd numbers between them.
+string make_key(const BenchOptions &options, int table, int i, bool existing = true)
+{
+  const long n = 2L * (static_cast<long>(i) * options.num_tables + table) + (existing ? 0 : 1);
+  char       buf[32];
+  snprintf(buf, sizeof(buf), "key_%016ld", n);
+  return buf;
+}
+
+class ReadAmplificationBench
+{
+public:
+  ReadAmplificationBench(const BenchOptions &options, size_t bits_per_key)
+      : options_(options), bits_per_key_(bits_per_key)
+  {
+    if (options_.cache_size > 0) {
+      block_cache_.reset(new_lru_cache<uint64_t, shared_ptr<ObBlock>>(options_.cache_size, 4));
+    }
+  }
+
+  bool build()
+  {
+    const string dir = (filesystem::path(options_.db) / to_string(bits_per_key_)).string();
+    filesystem::remove_all(dir);
+    filesystem::create_directories(dir);
+
+    uint64_t seq = 0;
+    for (int t = 0; t < options_.num_tables; t++) {
+      shared_ptr<ObMemTable> mem_table = make_shared<ObMemTable>();
+      for (int i = 0; i < options_.keys_per_table; i++) {
+        const string key = make_key(options_, t, i);
+        mem_table->put(seq++, key, key);
+      }
+
+      ObSSTableBuilder builder(&comparator_, block_cache_.get(), bits_per_key_);
+      const string     file_name = (filesystem::path(dir) / (to_string(t) + SSTABLE_SUFFIX)).string();
+      if (builder.build(mem_table, file_name, t) != RC::SUCCESS) {
+        printf("failed to build sstable %s\n", file_name.c_str());
+        return false;
+      }
+      file_bytes_ += builder.file_size();
+      // newest first, like a get in ObLsm
+      sstables_.insert(sstables_.begin(), builder.get_built_table());
+    }
+    seq_ = seq;
+    return true;
+  }
+
+  /**
+   * @brief Looks up `options_.lookups` keys, every sstable is checked until the key is found.
+   * @param existing whether the keys exist in the oldest sstable or not at all.
+   */
+  void run(bool existing)
+  {
+    uint64_t blocks_before = block_reads();
+    int      found         = 0;
+    auto     begin         = chrono::steady_clock::now();
+    for (int i = 0; i < options_.lookups; i++) {
+      const int    index = i % options_.keys_per_table;
+      const string key   = make_key(options_, 0, index, existing);
+      string       lookup_key;
+      string       value;
+      put_lookup_key(&lookup_key, key, seq_);
+      for (const auto &sst : sstables_) {
+        RC rc = sst->get(lookup_key, &value);
+        if (rc != RC::NOTFOUND) {
+          found += rc == RC::SUCCESS ? 1 : 0;
+          break;
+        }
+      }
+    }
+    auto     end    = chrono::steady_clock::now();
+    uint64_t blocks = block_reads() - blocks_before;
+    double   us     = chrono::duration<double, std::micro>(end - begin).count();
+
+    printf("bits_per_key=%-3zu %-8s lookups=%d found=%d blocks/lookup=%.3f micros/op=%.3f sst_bytes=%zu\n",
+        bits_per_key_, existing ? "existing" : "missing", options_.lookups, found,
+        static_cast<double>(blocks) / options_.lookups, us / options_.lookups, file_bytes_);
+    if (block_cache_ != nullptr) {
+      const uint64_t hits   = block_cache_->hit_count() - cache_hits_;
+      const uint64_t misses = block_cache_->miss_count() - cache_misses_;
+      cache_hits_ += hits;
+      cache_misses_ += misses;
+      printf("    block cache: hits=%lu misses=%lu hit_rate=%.3f usage=%zu/%zu\n", hits, misses,
+          hits + misses == 0 ? 0.0 : static_cast<double>(hits) / (hits + misses), block_cache_->usage(),
+          block_cache_->capacity());
+    }
+  }
+
+private:
+  uint64_t block_reads() const
+  {
+    uint64_t count = 0;
+    for (const auto &sst : sstables_) {
+      count += sst->block_read_count();
+    }
+    return count;
+  }
+
+private:
+  const BenchOptions                                    &options_;
+  size_t                                                bits_per_key_ = 0;
+  ObDefaultComparator                                   comparator_;
+  unique_ptr<ObLRUCache<uint64_t, shared_ptr<ObBlock>>> block_cache_;
+  vector<shared_ptr<ObSSTable>>                         sstables_;
+  uint64_t                                              seq_          = 0;
+  size_t                                                file_bytes_   = 0;
+  uint64_t                                              cache_hits_   = 0;
+  uint64_t                                              cache_misses_ = 0;
+};
+
+void usage(const char *name)
+{
+  printf("usage: %s [--num_tables=N] [--keys_per_table=N] [--lookups=N] [--bits_per_key=N] [--cache_size=bytes] "
+         "[--db=path]\n",
+      name);
+}
+
+}  // namespace
+
+/**
+ * Read amplification of point lookups with and without bloom filters.
+ * Every round looks up keys which are in the oldest sstable or not in any sstable,
+ * and reports how many blocks were read from the files for each lookup.
+ * With --cache_size, the blocks are cached and the hit rate of the block cache is reported too.
+ */
+int main(int argc, char **argv)
+{
+  BenchOptions options;
+  for (int i = 1; i < argc; i++) {
+    int  n;
+    char path[4096];
+    if (sscanf(argv[i], "--num_tables=%d", &n) == 1) {
+      options.num_tables = n;
+    } else if (sscanf(argv[i], "--keys_per_table=%d", &n) == 1) {
+      options.keys_per_table = n;
+    } else if (sscanf(argv[i], "--lookups=%d", &n) == 1) {
+      options.lookups = n;
+    } else if (sscanf(argv[i], "--bits_per_key=%d", &n) == 1) {
+      options.bits_per_key = n;
+    } else if (sscanf(argv[i], "--cache_size=%d", &n) == 1) {
+      options.cache_size = n;
+    } else if (sscanf(argv[i], "--db=%4095s", path) == 1) {
+      options.db = path;
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if (options.num_tables <= 0 || options.keys_per_table <= 0 || options.lookups <= 0) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  for (size_t bits_per_key : {static_cast<size_t>(0), options.bits_per_key}) {
+    ReadAmplificationBench bench(options, bits_per_key);
+    if (!bench.build()) {
+      return 1;
+    }
+    bench.run(true /*existing*/);
+    bench.run(false /*existing*/);
+  }
+  filesystem::remove_all(options.db);
+  return 0;
+}
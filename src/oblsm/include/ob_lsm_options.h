@@ -40,6 +40,13 @@ struct ObLsmOptions
   // default compaction type
   CompactionType type = CompactionType::LEVELED;
 
+  // memory size of the block cache in bytes, shared by all sstables. 0 disables the cache.
+  size_t block_cache_size = 8 * 1024 * 1024;
+
+  // bits of the bloom filter for each key in a sstable, 0 disables the filter.
+  // 10 bits per key gives about 1% false positive rate.
+  size_t bloom_filter_bits_per_key = 10;
+
   // it is used to control whether the WAL is forced to be written to the disk every time a new key is written.
   bool force_sync_new_log = true;
 };
@@ -52,6 +52,27 @@ int ObMemTable::KeyComparator::operator()(const char *a, const char *b) const
   return comparator.compare(a_v, b_v);
 }
 
+RC ObMemTable::get(const string_view &lookup_key, string *value)
+{
+  // Versions of a key are ordered by sequence descendingly, so the seek stops at the
+  // newest version that isn't newer than the read sequence.
+  Table::Iterator iter(&table_);
+  iter.seek(lookup_key.data());
+  if (!iter.valid()) {
+    return RC::NOTFOUND;
+  }
+  string_view internal_key = get_length_prefixed_string(iter.key());
+  if (extract_user_key(internal_key) != extract_user_key_from_lookup_key(lookup_key)) {
+    return RC::NOTFOUND;
+  }
+  string_view found = get_length_prefixed_string(internal_key.data() + internal_key.size());
+  if (found.empty()) {
+    return RC::NOT_EXIST;
+  }
+  value->assign(found.data(), found.size());
+  return RC::SUCCESS;
+}
+
 ObLsmIterator *ObMemTable::new_iterator() { return new ObMemTableIterator(get_shared_ptr(), &table_); }
 
 string_view ObMemTableIterator::key() const { return get_length_prefixed_string(iter_.key()); }
@@ -61,6 +61,16 @@ public:
    */
   void put(uint64_t seq, const string_view &key, const string_view &value);
 
+  /**
+   * @brief Looks up the newest version of a user key that is visible at a sequence number.
+   *
+   * @param lookup_key The lookup key built by `put_lookup_key`, carrying the user key and the read sequence.
+   * @param value Set to the value if the key is found.
+   * @return RC::SUCCESS if the key is found, RC::NOT_EXIST if the newest visible version is a deletion,
+   *         RC::NOTFOUND if the memtable has no visible version of the key.
+   */
+  RC get(const string_view &lookup_key, string *value);
+
   /**
    * @brief Estimates the memory usage of the memtable.
    *
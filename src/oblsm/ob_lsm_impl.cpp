@@ -10,6 +10,7 @@ See the Mulan PSL v2 for more details. */
 
 #include "oblsm/ob_lsm_impl.h"
 
+#include "common/lang/algorithm.h"
 #include "common/log/log.h"
 #include "common/sys/rc.h"
 #include "oblsm/include/ob_lsm.h"
@@ -36,8 +37,9 @@ ObLsmImpl::ObLsmImpl(const ObLsmOptions &options, const string &path)
   }
 
   executor_.init("ObLsmBackground", 1, 1, 60 * 1000);
-  block_cache_ =
-      std::unique_ptr<ObLRUCache<uint64_t, shared_ptr<ObBlock>>>{new ObLRUCache<uint64_t, shared_ptr<ObBlock>>(1024)};
+  // blocks are charged by bytes, and the cache is split into 16 shards to reduce lock contention.
+  block_cache_ = std::unique_ptr<ObLRUCache<uint64_t, shared_ptr<ObBlock>>>{
+      new_lru_cache<uint64_t, shared_ptr<ObBlock>>(options_.block_cache_size, BLOCK_CACHE_SHARD_BITS)};
 }
 
 RC ObLsmImpl::recover()
@@ -279,7 +281,8 @@ vector<shared_ptr<ObSSTable>> ObLsmImpl::do_compaction(ObCompaction *picked) { r
 
 void ObLsmImpl::build_sstable(shared_ptr<ObMemTable> imem)
 {
-  unique_ptr<ObSSTableBuilder> tb = make_unique<ObSSTableBuilder>(&default_comparator_, block_cache_.get());
+  unique_ptr<ObSSTableBuilder> tb =
+      make_unique<ObSSTableBuilder>(&default_comparator_, block_cache_.get(), options_.bloom_filter_bits_per_key);
 
   uint64_t sstable_id = sstable_id_.fetch_add(1);
   tb->build(imem, get_sstable_path(sstable_id), sstable_id);
@@ -314,22 +317,56 @@ string ObLsmImpl::get_wal_path(uint64_t memtable_id)
 
 RC ObLsmImpl::get(const string_view &key, string *value)
 {
-  RC                 rc = RC::SUCCESS;
-  unique_lock<mutex> lock(mu_);
-  auto               iter = unique_ptr<ObLsmIterator>(new_iterator(ObLsmReadOptions{}));
-  iter->seek(key);
-  if (iter->valid() && iter->key() == key) {
-    if (iter->value().empty()) {
-      rc = RC::NOT_EXIST;
-    } else {
-      value->assign(iter->value());
-    }
-  } else {
+  // Only in-memory metadata is used under the lock, the tables are read after unlocking.
+  unique_lock<mutex>             lock(mu_);
+  const uint64_t                 seq = seq_.load();
+  shared_ptr<ObMemTable>         mem = mem_table_;
+  vector<shared_ptr<ObMemTable>> imms(imem_tables_.rbegin(), imem_tables_.rend());
+  vector<shared_ptr<ObSSTable>>  sstables;
+  pick_sstables_for_get(key, sstables);
+  lock.unlock();
+
+  string lookup_key;
+  put_lookup_key(&lookup_key, key, seq);
+
+  // stop at the first table that has a visible version (value or deletion) of the key
+  RC rc = mem->get(lookup_key, value);
+  for (size_t i = 0; rc == RC::NOTFOUND && i < imms.size(); i++) {
+    rc = imms[i]->get(lookup_key, value);
+  }
+  for (size_t i = 0; rc == RC::NOTFOUND && i < sstables.size(); i++) {
+    rc = sstables[i]->get(lookup_key, value);
+  }
+  if (rc == RC::NOTFOUND) {
     rc = RC::NOT_EXIST;
   }
   return rc;
 }
 
+void ObLsmImpl::pick_sstables_for_get(const string_view &key, vector<shared_ptr<ObSSTable>> &sstables) const
+{
+  for (size_t level = 0; level < sstables_->size(); level++) {
+    const vector<shared_ptr<ObSSTable>> &level_tables = sstables_->at(level);
+    if (options_.type == CompactionType::LEVELED && level == 0) {
+      // sstables in level 0 may overlap, the newest one is at the back.
+      for (auto iter = level_tables.rbegin(); iter != level_tables.rend(); ++iter) {
+        if ((*iter)->compare_key_range(key) == 0) {
+          sstables.emplace_back(*iter);
+        }
+      }
+      continue;
+    }
+
+    // sstables in the other levels (and in a run of tiered compaction) are sorted and don't overlap,
+    // at most one of them may contain the key.
+    auto iter = std::partition_point(level_tables.begin(), level_tables.end(),
+        [&key](const shared_ptr<ObSSTable> &sst) { return sst->compare_key_range(key) > 0; });
+    if (iter != level_tables.end() && (*iter)->compare_key_range(key) == 0) {
+      sstables.emplace_back(*iter);
+    }
+  }
+}
+
 ObLsmIterator *ObLsmImpl::new_iterator(ObLsmReadOptions options)
 {
   unique_lock<mutex>     lock(mu_);
@@ -372,6 +409,8 @@ void ObLsmImpl::dump_sstables()
     }
     cout << "level size " << level_size << endl;
   }
+  cout << "block cache: usage " << block_cache_->usage() << "/" << block_cache_->capacity() << ", hits "
+       << block_cache_->hit_count() << ", misses " << block_cache_->miss_count() << endl;
 }
 
 RC ObLsmImpl::recover_from_manifest_records(const std::vector<ObManifestCompaction> &records)
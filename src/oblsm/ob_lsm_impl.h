@@ -60,6 +60,8 @@ public:
 
   SSTablesPtr get_sstables() { return sstables_; }
 
+  const ObLRUCache<uint64_t, shared_ptr<ObBlock>> *block_cache() const { return block_cache_.get(); }
+
   RC recover();
   RC batch_put(const std::vector<pair<string, string>> &kvs) override;
 
@@ -142,6 +144,16 @@ private:
    */
   void build_sstable(shared_ptr<ObMemTable> imem);
 
+  /**
+   * @brief Picks the SSTables that may contain the key for a point lookup, in the order to search them.
+   *
+   * All overlapping SSTables of level 0 are picked newest first, and at most one SSTable is picked
+   * from each of the other levels by binary search on the key ranges. No block is read.
+   *
+   * @note The caller must hold `mu_`.
+   */
+  void pick_sstables_for_get(const string_view &key, vector<shared_ptr<ObSSTable>> &sstables) const;
+
   /**
    * @brief Retrieves the file path for a given SSTable.
    *
@@ -158,6 +170,8 @@ private:
    */
   string get_wal_path(uint64_t memtable_id);
 
+  static constexpr int BLOCK_CACHE_SHARD_BITS = 4;
+
   ObLsmOptions                      options_;
   string                            path_;
   mutex                             mu_;
@@ -42,9 +42,8 @@ public:
 
   void seek(const string_view &target) override
   {
-    put_numeric<uint64_t>(&lookup_key_, target.size() + SEQ_SIZE);
-    lookup_key_.append(target.data(), target.size());
-    put_numeric<uint64_t>(&lookup_key_, seq_);
+    lookup_key_.clear();
+    put_lookup_key(&lookup_key_, target, seq_);
     iter_->seek(string_view(lookup_key_.data(), lookup_key_.size()));
     if (iter_->valid()) {
       find_next_user_entry(false, &saved_key_);
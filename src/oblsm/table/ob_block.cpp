@@ -16,7 +16,28 @@ namespace oceanbase {
 
 RC ObBlock::decode(const string &data)
 {
-  return RC::UNIMPLEMENTED;
+  // entries | offset size(n) | offset 1 .. offset n | offset start
+  if (data.size() < 2 * sizeof(uint32_t)) {
+    return RC::INVALID_ARGUMENT;
+  }
+  const uint32_t data_size = get_numeric<uint32_t>(data.data() + data.size() - sizeof(uint32_t));
+  if (data_size > data.size() - 2 * sizeof(uint32_t)) {
+    return RC::INVALID_ARGUMENT;
+  }
+  const char    *p     = data.data() + data_size;
+  const uint32_t count = get_numeric<uint32_t>(p);
+  if (data_size + (count + 2) * sizeof(uint32_t) != data.size()) {
+    return RC::INVALID_ARGUMENT;
+  }
+
+  offsets_.clear();
+  offsets_.reserve(count);
+  p += sizeof(uint32_t);
+  for (uint32_t i = 0; i < count; i++, p += sizeof(uint32_t)) {
+    offsets_.push_back(get_numeric<uint32_t>(p));
+  }
+  data_.assign(data.data(), data_size);
+  return RC::SUCCESS;
 }
 
 string_view ObBlock::get_entry(uint32_t offset) const
@@ -70,13 +91,22 @@ RC BlockMeta::decode(const string &data)
 
 void BlockIterator::seek(const string_view &lookup_key)
 {
-   index_ = 0;
-   while(valid()) {
+  // binary search the first entry whose user key is not less than the target
+  const string_view target = extract_user_key_from_lookup_key(lookup_key);
+  uint32_t          left   = 0;
+  uint32_t          right  = count_;
+  while (left < right) {
+    index_ = left + (right - left) / 2;
     parse_entry();
-    if (comparator_->compare(extract_user_key(key_), extract_user_key_from_lookup_key(lookup_key)) >= 0) {
-      break;
+    if (comparator_->compare(extract_user_key(key_), target) < 0) {
+      left = index_ + 1;
+    } else {
+      right = index_;
     }
-    index_++;
-   }
+  }
+  index_ = left;
+  if (valid()) {
+    parse_entry();
+  }
 }
 }  // namespace oceanbase
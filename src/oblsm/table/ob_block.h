@@ -60,6 +60,14 @@ public:
 
   int size() const { return offsets_.size(); }
 
+  /**
+   * @brief Approximate memory usage of the decoded block, used as its charge in the block cache.
+   */
+  size_t appro_memory_usage() const
+  {
+    return sizeof(ObBlock) + data_.capacity() + offsets_.capacity() * sizeof(uint32_t);
+  }
+
   /**
    * @brief Decodes serialized block data.
    *
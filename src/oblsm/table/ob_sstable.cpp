@@ -11,24 +11,153 @@ See the Mulan PSL v2 for more details. */
 #include "oblsm/table/ob_sstable.h"
 #include "oblsm/util/ob_coding.h"
 #include "common/log/log.h"
+#include "common/lang/algorithm.h"
 #include "common/lang/filesystem.h"
 namespace oceanbase {
 
+static constexpr uint32_t SSTABLE_FOOTER_SIZE = 3 * sizeof(uint32_t);
+
 void ObSSTable::init()
 {
-  // your code here
+  file_reader_ = ObFileReader::create_file_reader(file_name_);
+  if (file_reader_ == nullptr) {
+    LOG_WARN("failed to open sstable %s", file_name_.c_str());
+    return;
+  }
+
+  const uint32_t file_size = file_reader_->file_size();
+  if (file_size < SSTABLE_FOOTER_SIZE + sizeof(uint32_t)) {
+    LOG_WARN("sstable %s is too small, size=%u", file_name_.c_str(), file_size);
+    return;
+  }
+  const string   footer        = file_reader_->read_pos(file_size - SSTABLE_FOOTER_SIZE, SSTABLE_FOOTER_SIZE);
+  const uint32_t filter_offset = get_numeric<uint32_t>(footer.data());
+  const uint32_t filter_size   = get_numeric<uint32_t>(footer.data() + sizeof(uint32_t));
+  const uint32_t meta_offset   = get_numeric<uint32_t>(footer.data() + 2 * sizeof(uint32_t));
+  if (meta_offset > file_size - SSTABLE_FOOTER_SIZE || filter_offset + filter_size != meta_offset) {
+    LOG_WARN("invalid sstable footer. sstable=%s, filter offset=%u, filter size=%u, meta offset=%u",
+             file_name_.c_str(), filter_offset, filter_size, meta_offset);
+    return;
+  }
+
+  const string metas    = file_reader_->read_pos(meta_offset, file_size - SSTABLE_FOOTER_SIZE - meta_offset);
+  const char  *meta_ptr = metas.data();
+  uint32_t     meta_num = get_numeric<uint32_t>(meta_ptr);
+  meta_ptr += sizeof(uint32_t);
+  block_metas_.clear();
+  block_metas_.reserve(meta_num);
+  for (uint32_t i = 0; i < meta_num; i++) {
+    uint32_t meta_size = get_numeric<uint32_t>(meta_ptr);
+    meta_ptr += sizeof(uint32_t);
+    BlockMeta block_meta;
+    block_meta.decode(string(meta_ptr, meta_size));
+    block_metas_.emplace_back(std::move(block_meta));
+    meta_ptr += meta_size;
+  }
+
+  if (filter_size > 0) {
+    filter_ = make_unique<ObBloomfilter>();
+    RC rc   = filter_->decode(file_reader_->read_pos(filter_offset, filter_size));
+    if (OB_FAIL(rc)) {
+      // Without the filter every lookup has to read the blocks, it's slower but still correct.
+      LOG_WARN("failed to decode bloom filter of sstable %s, rc=%s", file_name_.c_str(), strrc(rc));
+      filter_.reset();
+    }
+  }
 }
 
 shared_ptr<ObBlock> ObSSTable::read_block_with_cache(uint32_t block_idx) const
 {
-  // your code here
-  return nullptr;
+  if (block_cache_ == nullptr) {
+    return read_block(block_idx);
+  }
+
+  const uint64_t      cache_key = (static_cast<uint64_t>(sst_id_) << 32) | block_idx;
+  shared_ptr<ObBlock> block;
+  if (block_cache_->get(cache_key, block)) {
+    return block;
+  }
+  block = read_block(block_idx);
+  if (block != nullptr) {
+    block_cache_->put(cache_key, block, block->appro_memory_usage());
+  }
+  return block;
 }
 
 shared_ptr<ObBlock> ObSSTable::read_block(uint32_t block_idx) const
 {
-  // your code here
-  return nullptr;
+  if (file_reader_ == nullptr || block_idx >= block_metas_.size()) {
+    return nullptr;
+  }
+
+  const BlockMeta    &block_meta = block_metas_[block_idx];
+  shared_ptr<ObBlock> block      = make_shared<ObBlock>(comparator_);
+  block_read_count_.fetch_add(1, std::memory_order_relaxed);
+  RC rc = block->decode(file_reader_->read_pos(block_meta.offset_, block_meta.size_));
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to decode block. sstable=%s, block=%u, rc=%s", file_name_.c_str(), block_idx, strrc(rc));
+    return nullptr;
+  }
+  return block;
+}
+
+uint32_t ObSSTable::find_block(const string_view &user_key) const
+{
+  auto iter = std::lower_bound(
+      block_metas_.begin(), block_metas_.end(), user_key, [this](const BlockMeta &meta, const string_view &key) {
+        return comparator_->compare(extract_user_key(meta.last_key_), key) < 0;
+      });
+  return static_cast<uint32_t>(iter - block_metas_.begin());
+}
+
+int ObSSTable::compare_key_range(const string_view &user_key) const
+{
+  if (block_metas_.empty()) {
+    return 1;
+  }
+  if (comparator_->compare(user_key, extract_user_key(block_metas_.front().first_key_)) < 0) {
+    return -1;
+  }
+  if (comparator_->compare(user_key, extract_user_key(block_metas_.back().last_key_)) > 0) {
+    return 1;
+  }
+  return 0;
+}
+
+RC ObSSTable::get(const string_view &lookup_key, string *value) const
+{
+  const string_view user_key = extract_user_key_from_lookup_key(lookup_key);
+  const uint64_t    seq      = extract_sequence(lookup_key);
+  if (compare_key_range(user_key) != 0 || !may_contain(user_key)) {
+    return RC::NOTFOUND;
+  }
+
+  // Versions of a key are ordered by sequence descendingly. They may continue in the next
+  // block if all the versions in this block are newer than the read sequence.
+  for (uint32_t block_idx = find_block(user_key); block_idx < block_metas_.size(); block_idx++) {
+    if (comparator_->compare(extract_user_key(block_metas_[block_idx].first_key_), user_key) > 0) {
+      break;
+    }
+    shared_ptr<ObBlock> block = read_block_with_cache(block_idx);
+    if (block == nullptr) {
+      return RC::IOERR_READ;
+    }
+    unique_ptr<ObLsmIterator> iter(block->new_iterator());
+    for (iter->seek(lookup_key); iter->valid(); iter->next()) {
+      const string_view internal_key = iter->key();
+      if (comparator_->compare(extract_user_key(internal_key), user_key) != 0) {
+        return RC::NOTFOUND;
+      }
+      if (extract_sequence(internal_key) <= seq) {
+        if (iter->value().empty()) {
+          return RC::NOT_EXIST;
+        }
+        value->assign(iter->value().data(), iter->value().size());
+        return RC::SUCCESS;
+      }
+    }
+  }
+  return RC::NOTFOUND;
 }
 
 void ObSSTable::remove() { filesystem::remove(file_name_); }
@@ -38,21 +167,33 @@ ObLsmIterator *ObSSTable::new_iterator() { return new TableIterator(get_shared_p
 void TableIterator::read_block_with_cache()
 {
   block_ = sst_->read_block_with_cache(curr_block_idx_);
-  block_iterator_.reset(block_->new_iterator());
+  block_iterator_.reset(block_ == nullptr ? nullptr : block_->new_iterator());
 }
 
 void TableIterator::seek_to_first()
 {
   curr_block_idx_ = 0;
+  if (block_cnt_ == 0) {
+    block_iterator_ = nullptr;
+    return;
+  }
   read_block_with_cache();
-  block_iterator_->seek_to_first();
+  if (block_iterator_ != nullptr) {
+    block_iterator_->seek_to_first();
+  }
 }
 
 void TableIterator::seek_to_last()
 {
+  if (block_cnt_ == 0) {
+    block_iterator_ = nullptr;
+    return;
+  }
   curr_block_idx_ = block_cnt_ - 1;
   read_block_with_cache();
-  block_iterator_->seek_to_last();
+  if (block_iterator_ != nullptr) {
+    block_iterator_->seek_to_last();
+  }
 }
 
 void TableIterator::next()
@@ -62,26 +203,23 @@ void TableIterator::next()
   } else if (curr_block_idx_ < block_cnt_ - 1) {
     curr_block_idx_++;
     read_block_with_cache();
-    block_iterator_->seek_to_first();
+    if (block_iterator_ != nullptr) {
+      block_iterator_->seek_to_first();
+    }
   }
 }
 
 void TableIterator::seek(const string_view &lookup_key)
 {
-  curr_block_idx_ = 0;
-  // TODO: use binary search
-  for (; curr_block_idx_ < block_cnt_; curr_block_idx_++) {
-    const auto &block_meta = sst_->block_meta(curr_block_idx_);
-    if (sst_->comparator()->compare(extract_user_key(block_meta.last_key_), extract_user_key_from_lookup_key(lookup_key)) >= 0) {
-      break;
-    }
-  }
+  curr_block_idx_ = sst_->find_block(extract_user_key_from_lookup_key(lookup_key));
   if (curr_block_idx_ == block_cnt_) {
     block_iterator_ = nullptr;
     return;
   }
   read_block_with_cache();
-  block_iterator_->seek(lookup_key);
+  if (block_iterator_ != nullptr) {
+    block_iterator_->seek(lookup_key);
+  }
 };
 
 }  // namespace oceanbase
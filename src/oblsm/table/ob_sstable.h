@@ -11,9 +11,11 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 
 #include "oblsm/util/ob_file_reader.h"
+#include "common/lang/atomic.h"
 #include "common/lang/memory.h"
 #include "common/sys/rc.h"
 #include "oblsm/table/ob_block.h"
+#include "oblsm/util/ob_bloomfilter.h"
 #include "oblsm/util/ob_comparator.h"
 #include "oblsm/util/ob_lru_cache.h"
 
@@ -28,20 +30,28 @@ namespace oceanbase {
 //    ├─────────────────┤   │
 //    │    block n      │◄┐ │
 //    ├─────────────────┤ │ │
-// ┌─►│  meta size(n)   │ │ │
+// ┌─►│  bloom filter   │ │ │
 // │  ├─────────────────┤ │ │
-// │  │block meta 1 size│ │ │
-// │  ├─────────────────┤ │ │
-// │  │  block meta 1   ┼─┼─┘
-// │  ├─────────────────┤ │
-// │  │      ..         │ │
-// │  ├─────────────────┤ │
-// │  │block meta n size│ │
-// │  ├─────────────────┤ │
-// │  │  block meta n   ┼─┘
-// │  ├─────────────────┤
-// └──┼                 │
+// │┌►│  meta size(n)   │ │ │
+// ││ ├─────────────────┤ │ │
+// ││ │block meta 1 size│ │ │
+// ││ ├─────────────────┤ │ │
+// ││ │  block meta 1   ┼─┼─┘
+// ││ ├─────────────────┤ │
+// ││ │      ..         │ │
+// ││ ├─────────────────┤ │
+// ││ │block meta n size│ │
+// ││ ├─────────────────┤ │
+// ││ │  block meta n   ┼─┘
+// ││ ├─────────────────┤
+// └┼─┤  filter offset  │
+//  │ ├─────────────────┤
+//  │ │  filter size    │
+//  │ ├─────────────────┤
+//  └─┤  meta offset    │
 //    └─────────────────┘
+//
+// The bloom filter contains all user keys of the sstable, its size is 0 if the sstable was built without a filter.
 
 /**
  * @class ObSSTable
@@ -126,16 +136,60 @@ public:
 
   const ObComparator *comparator() const { return comparator_; }
 
+  /**
+   * @brief Checks whether the SSTable may contain the user key.
+   *
+   * Consults the bloom filter of the SSTable, so no block is read.
+   *
+   * @return false if the key is definitely not in the SSTable. Always true if the SSTable has no filter.
+   */
+  bool may_contain(const string_view &user_key) const { return filter_ == nullptr || filter_->contains(user_key); }
+
+  bool has_filter() const { return filter_ != nullptr; }
+
+  /**
+   * @brief Looks up the newest version of a user key that is visible at a sequence number.
+   *
+   * Consults the bloom filter first, then reads only the block(s) whose key range covers the key.
+   *
+   * @param lookup_key The lookup key built by `put_lookup_key`, carrying the user key and the read sequence.
+   * @param value Set to the value if the key is found.
+   * @return RC::SUCCESS if the key is found, RC::NOT_EXIST if the newest visible version is a deletion,
+   *         RC::NOTFOUND if the SSTable has no visible version of the key, or an IO error.
+   */
+  RC get(const string_view &lookup_key, string *value) const;
+
+  /**
+   * @brief Finds the first block whose last key is not less than the user key, by binary search.
+   * @return The block index, or `block_count()` if the user key is greater than all keys.
+   */
+  uint32_t find_block(const string_view &user_key) const;
+
+  /**
+   * @brief Compares the user key with the key range of the SSTable without reading any block.
+   * @return negative if the key is less than the first key, positive if it is greater than the last key
+   *         (or the SSTable is empty), 0 if the key is in the range.
+   */
+  int compare_key_range(const string_view &user_key) const;
+
+  /**
+   * @brief Number of blocks read from the file (not from the block cache) since the SSTable was opened.
+   */
+  uint64_t block_read_count() const { return block_read_count_.load(std::memory_order_relaxed); }
+
   void   remove();
   string first_key() const { return block_metas_.empty() ? "" : block_metas_[0].first_key_; }
   string last_key() const { return block_metas_.empty() ? "" : block_metas_.back().last_key_; }
 
 private:
-  uint32_t                 sst_id_;
-  string                   file_name_;
-  const ObComparator      *comparator_ = nullptr;
-  unique_ptr<ObFileReader> file_reader_;
-  vector<BlockMeta>        block_metas_;
+  uint32_t                  sst_id_;
+  string                    file_name_;
+  const ObComparator       *comparator_ = nullptr;
+  unique_ptr<ObFileReader>  file_reader_;
+  vector<BlockMeta>         block_metas_;
+  unique_ptr<ObBloomfilter> filter_;
+
+  mutable atomic<uint64_t> block_read_count_{0};
 
   ObLRUCache<uint64_t, shared_ptr<ObBlock>> *block_cache_;
 };
@@ -10,13 +10,59 @@ See the Mulan PSL v2 for more details. */
 
 #include "oblsm/table/ob_sstable_builder.h"
 #include "oblsm/util/ob_coding.h"
+#include "common/log/log.h"
 
 namespace oceanbase {
 
 // TODO: refactor build with mem_table/iterator logic.
 RC ObSSTableBuilder::build(shared_ptr<ObMemTable> mem_table, const std::string &file_name, uint32_t sst_id)
 {
-  return RC::UNIMPLEMENTED;
+  reset();
+  sst_id_      = sst_id;
+  file_writer_ = ObFileWriter::create_file_writer(file_name, false);
+  if (file_writer_ == nullptr) {
+    LOG_WARN("failed to create sstable file %s", file_name.c_str());
+    return RC::IOERR_OPEN;
+  }
+
+  unique_ptr<ObLsmIterator> iter(mem_table->new_iterator());
+
+  // The memtable doesn't record its entry count, count them first to size the filter.
+  unique_ptr<ObBloomfilter> filter;
+  if (bloom_filter_bits_per_key_ > 0) {
+    size_t key_count = 0;
+    for (iter->seek_to_first(); iter->valid(); iter->next()) {
+      key_count++;
+    }
+    filter = ObBloomfilter::create(key_count, bloom_filter_bits_per_key_);
+  }
+
+  RC rc = RC::SUCCESS;
+  for (iter->seek_to_first(); iter->valid(); iter->next()) {
+    string_view key   = iter->key();
+    string_view value = iter->value();
+    if (curr_blk_first_key_.empty()) {
+      curr_blk_first_key_.assign(key.data(), key.size());
+    }
+    rc = block_builder_.add(key, value);
+    if (rc == RC::FULL) {
+      finish_build_block();
+      curr_blk_first_key_.assign(key.data(), key.size());
+      rc = block_builder_.add(key, value);
+    }
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to add kv pair to block, sstable=%s, rc=%s", file_name.c_str(), strrc(rc));
+      return rc;
+    }
+    if (filter != nullptr) {
+      filter->insert(extract_user_key(key));
+    }
+  }
+  if (!curr_blk_first_key_.empty()) {
+    finish_build_block();
+  }
+
+  return finish_build_table(filter.get());
 }
 
 void ObSSTableBuilder::finish_build_block()
@@ -28,6 +74,45 @@ void ObSSTableBuilder::finish_build_block()
   // TODO: block aligned to BLOCK_SIZE
   curr_offset_ += block_contents.size();
   block_builder_.reset();
+  curr_blk_first_key_.clear();
+}
+
+RC ObSSTableBuilder::finish_build_table(const ObBloomfilter *filter)
+{
+  string tail;
+
+  // filter block
+  const uint32_t filter_offset = curr_offset_;
+  if (filter != nullptr) {
+    filter->encode(&tail);
+  }
+  const uint32_t filter_size = tail.size();
+
+  // block metas
+  const uint32_t meta_offset = filter_offset + filter_size;
+  put_numeric<uint32_t>(&tail, block_metas_.size());
+  for (const BlockMeta &block_meta : block_metas_) {
+    string meta = block_meta.encode();
+    put_numeric<uint32_t>(&tail, meta.size());
+    tail.append(meta);
+  }
+
+  // footer
+  put_numeric<uint32_t>(&tail, filter_offset);
+  put_numeric<uint32_t>(&tail, filter_size);
+  put_numeric<uint32_t>(&tail, meta_offset);
+
+  RC rc = file_writer_->write(tail);
+  if (OB_SUCC(rc)) {
+    rc = file_writer_->flush();
+  }
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to write sstable %s, rc=%s", file_writer_->file_name().c_str(), strrc(rc));
+    return rc;
+  }
+  curr_offset_ += tail.size();
+  file_size_ = curr_offset_;
+  return rc;
 }
 
 shared_ptr<ObSSTable> ObSSTableBuilder::get_built_table()
@@ -17,6 +17,7 @@ See the Mulan PSL v2 for more details. */
 #include "oblsm/util/ob_file_writer.h"
 #include "oblsm/table/ob_block.h"
 #include "oblsm/table/ob_sstable.h"
+#include "oblsm/util/ob_bloomfilter.h"
 #include "oblsm/util/ob_lru_cache.h"
 
 namespace oceanbase {
@@ -27,8 +28,12 @@ namespace oceanbase {
 class ObSSTableBuilder
 {
 public:
-  ObSSTableBuilder(const ObComparator *comparator, ObLRUCache<uint64_t, shared_ptr<ObBlock>> *block_cache)
-      : comparator_(comparator), block_cache_(block_cache)
+  /**
+   * @param bloom_filter_bits_per_key Bits of the sstable's bloom filter for each key, 0 means no filter.
+   */
+  ObSSTableBuilder(const ObComparator *comparator, ObLRUCache<uint64_t, shared_ptr<ObBlock>> *block_cache,
+      size_t bloom_filter_bits_per_key = ObBloomfilter::DEFAULT_BITS_PER_KEY)
+      : comparator_(comparator), bloom_filter_bits_per_key_(bloom_filter_bits_per_key), block_cache_(block_cache)
   {}
   ~ObSSTableBuilder() = default;
 
@@ -36,7 +41,8 @@ public:
    * @brief Builds an SSTable from the provided in-memory table and stores it in a file.
    *
    * This function takes an `ObMemTable` as input, partitions the data into blocks,
-   * serializes the blocks, and writes them into an SSTable file.
+   * serializes the blocks, and writes them into an SSTable file. The user keys are
+   * also added to a bloom filter, which is written after the blocks.
    *
    * @param mem_table A shared pointer to the `ObMemTable` containing the data to be written into the SSTable.
    * @param file_name The name of the file where the constructed SSTable will be stored.
@@ -52,8 +58,10 @@ public:
 
 private:
   void finish_build_block();
+  RC   finish_build_table(const ObBloomfilter *filter);
 
   const ObComparator      *comparator_ = nullptr;
+  size_t                   bloom_filter_bits_per_key_ = 0;
   ObBlockBuilder           block_builder_;
   string                   curr_blk_first_key_;
   unique_ptr<ObFileWriter> file_writer_;
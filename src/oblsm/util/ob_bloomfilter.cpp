@@ -9,5 +9,132 @@ MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
 #include "oblsm/util/ob_bloomfilter.h"
+#include "common/lang/algorithm.h"
+#include "oblsm/util/ob_coding.h"
 
-namespace oceanbase {}  // namespace oceanbase
+namespace oceanbase {
+
+// MurmurHash64A, the filter is persisted in sstables so the hash must not depend on the platform library.
+static uint64_t bloom_hash(const string_view &object)
+{
+  const uint64_t m     = 0xc6a4a7935bd1e995ULL;
+  const int      r     = 47;
+  const char    *data  = object.data();
+  const char    *limit = data + (object.size() & ~static_cast<size_t>(7));
+  uint64_t       h     = 0x9747b28cULL ^ (object.size() * m);
+
+  for (; data != limit; data += 8) {
+    uint64_t k = get_numeric<uint64_t>(data);
+    k *= m;
+    k ^= k >> r;
+    k *= m;
+    h ^= k;
+    h *= m;
+  }
+
+  switch (object.size() & 7) {
+    case 7: h ^= static_cast<uint64_t>(static_cast<uint8_t>(data[6])) << 48; [[fallthrough]];
+    case 6: h ^= static_cast<uint64_t>(static_cast<uint8_t>(data[5])) << 40; [[fallthrough]];
+    case 5: h ^= static_cast<uint64_t>(static_cast<uint8_t>(data[4])) << 32; [[fallthrough]];
+    case 4: h ^= static_cast<uint64_t>(static_cast<uint8_t>(data[3])) << 24; [[fallthrough]];
+    case 3: h ^= static_cast<uint64_t>(static_cast<uint8_t>(data[2])) << 16; [[fallthrough]];
+    case 2: h ^= static_cast<uint64_t>(static_cast<uint8_t>(data[1])) << 8; [[fallthrough]];
+    case 1: h ^= static_cast<uint64_t>(static_cast<uint8_t>(data[0])); h *= m;
+  }
+
+  h ^= h >> r;
+  h *= m;
+  h ^= h >> r;
+  return h;
+}
+
+ObBloomfilter::ObBloomfilter(size_t hash_func_count, size_t totoal_bits)
+{
+  reset(max<size_t>(hash_func_count, 1), max<size_t>((totoal_bits + 63) / 64, 1));
+}
+
+unique_ptr<ObBloomfilter> ObBloomfilter::create(size_t key_count, size_t bits_per_key)
+{
+  // bits_per_key * ln(2), at least one and at most 30 probes.
+  size_t hash_func_count = min<size_t>(max<size_t>(bits_per_key * 69 / 100, 1), 30);
+  return make_unique<ObBloomfilter>(hash_func_count, max<size_t>(key_count * bits_per_key, 64));
+}
+
+void ObBloomfilter::reset(size_t hash_func_count, size_t word_count)
+{
+  hash_func_count_ = hash_func_count;
+  word_count_      = word_count;
+  words_.reset(new atomic<uint64_t>[word_count]());
+  object_count_.store(0, std::memory_order_relaxed);
+}
+
+void ObBloomfilter::insert(const string_view &object)
+{
+  const size_t   bits  = total_bits();
+  uint64_t       h     = bloom_hash(object);
+  const uint64_t delta = (h >> 33) | (h << 31);
+  for (size_t i = 0; i < hash_func_count_; i++) {
+    const size_t bit = h % bits;
+    words_[bit / 64].fetch_or(1ULL << (bit % 64), std::memory_order_relaxed);
+    h += delta;
+  }
+  object_count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool ObBloomfilter::contains(const string_view &object) const
+{
+  const size_t   bits  = total_bits();
+  uint64_t       h     = bloom_hash(object);
+  const uint64_t delta = (h >> 33) | (h << 31);
+  for (size_t i = 0; i < hash_func_count_; i++) {
+    const size_t bit = h % bits;
+    if ((words_[bit / 64].load(std::memory_order_relaxed) & (1ULL << (bit % 64))) == 0) {
+      return false;
+    }
+    h += delta;
+  }
+  return true;
+}
+
+void ObBloomfilter::clear()
+{
+  for (size_t i = 0; i < word_count_; i++) {
+    words_[i].store(0, std::memory_order_relaxed);
+  }
+  object_count_.store(0, std::memory_order_relaxed);
+}
+
+void ObBloomfilter::encode(string *dst) const
+{
+  put_numeric<uint32_t>(dst, hash_func_count_);
+  put_numeric<uint32_t>(dst, word_count_);
+  put_numeric<uint64_t>(dst, object_count());
+  for (size_t i = 0; i < word_count_; i++) {
+    put_numeric<uint64_t>(dst, words_[i].load(std::memory_order_relaxed));
+  }
+}
+
+RC ObBloomfilter::decode(const string_view &data)
+{
+  const size_t header_size = 2 * sizeof(uint32_t) + sizeof(uint64_t);
+  if (data.size() < header_size) {
+    return RC::INVALID_ARGUMENT;
+  }
+  const char *p               = data.data();
+  uint32_t    hash_func_count = get_numeric<uint32_t>(p);
+  uint32_t    word_count      = get_numeric<uint32_t>(p + sizeof(uint32_t));
+  uint64_t    object_count    = get_numeric<uint64_t>(p + 2 * sizeof(uint32_t));
+  if (hash_func_count == 0 || word_count == 0 || data.size() != header_size + word_count * sizeof(uint64_t)) {
+    return RC::INVALID_ARGUMENT;
+  }
+
+  reset(hash_func_count, word_count);
+  p += header_size;
+  for (size_t i = 0; i < word_count_; i++, p += sizeof(uint64_t)) {
+    words_[i].store(get_numeric<uint64_t>(p), std::memory_order_relaxed);
+  }
+  object_count_.store(object_count, std::memory_order_relaxed);
+  return RC::SUCCESS;
+}
+
+}  // namespace oceanbase
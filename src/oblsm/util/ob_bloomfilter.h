@@ -10,37 +10,61 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include "common/lang/atomic.h"
+#include "common/lang/memory.h"
 #include "common/lang/string.h"
+#include "common/lang/string_view.h"
+#include "common/sys/rc.h"
+
 namespace oceanbase {
 
 /**
  * @class ObBloomfilter
  * @brief A simple Bloom filter implementation(Need to support concurrency).
+ *
+ * The bits are stored in 64-bit atomic words, so `insert` and `contains` can be called from
+ * multiple threads without any lock. The `hash_func_count` probe positions of an object are
+ * derived from a single 64-bit hash by double hashing. The hash function is fixed, so a filter
+ * encoded into a file can be decoded and queried by another process.
  */
 class ObBloomfilter
 {
 public:
+  /**
+   * @brief Default number of filter bits for each key, about 1% false positive rate.
+   */
+  static constexpr size_t DEFAULT_BITS_PER_KEY = 10;
+
   /**
    * @brief Constructs a Bloom filter with specified parameters.
    *
    * @param hash_func_count Number of hash functions to use. Default is 4.
-   * @param totoal_bits Total number of bits in the Bloom filter. Default is 65536.
+   * @param totoal_bits Total number of bits in the Bloom filter, rounded up to a multiple of 64.
+   *                    Default is 65536.
    */
-  ObBloomfilter(size_t hash_func_count = 4, size_t totoal_bits = 65536) {}
+  ObBloomfilter(size_t hash_func_count = 4, size_t totoal_bits = 65536);
+
+  /**
+   * @brief Creates a Bloom filter sized for `key_count` keys with `bits_per_key` bits each.
+   * @details The number of hash functions is `bits_per_key * ln(2)`, which minimizes the
+   * false positive rate for that size.
+   */
+  static unique_ptr<ObBloomfilter> create(size_t key_count, size_t bits_per_key);
 
   /**
    * @brief Inserts an object into the Bloom filter.
    * @details This method computes hash values for the given object and sets corresponding bits in the filter.
    * @param object The object to be inserted.
    */
-  void insert(const string &object) {}
+  void insert(const string_view &object);
 
   /**
    * @brief Clears all entries in the Bloom filter.
    *
-   * @details Resets the filter, removing all previously inserted objects.
+   * @details Resets the filter, removing all previously inserted objects. Objects inserted
+   * concurrently with `clear` may or may not be kept.
    */
-  void clear() {}
+  void clear();
 
   /**
    * @brief Checks if an object is possibly in the Bloom filter.
@@ -48,12 +72,12 @@ public:
    * @param object The object to be checked.
    * @return true if the object might be in the filter, false if definitely not.
    */
-  bool contains(const string &object) const { return false; }
+  bool contains(const string_view &object) const;
 
   /**
    * @brief Returns the count of objects inserted into the Bloom filter.
    */
-  size_t object_count() const { return 0; }
+  size_t object_count() const { return object_count_.load(std::memory_order_relaxed); }
 
   /**
    * @brief Checks if the Bloom filter is empty.
@@ -61,7 +85,28 @@ public:
    */
   bool empty() const { return 0 == object_count(); }
 
+  size_t hash_func_count() const { return hash_func_count_; }
+  size_t total_bits() const { return word_count_ * 64; }
+
+  /**
+   * @brief Appends the serialized filter to `dst`.
+   * @details Format: hash_func_count(uint32), word_count(uint32), object_count(uint64), words(uint64 * word_count).
+   */
+  void encode(string *dst) const;
+
+  /**
+   * @brief Replaces the content of this filter with the serialized filter in `data`.
+   */
+  RC decode(const string_view &data);
+
+private:
+  void reset(size_t hash_func_count, size_t word_count);
+
 private:
+  size_t                         hash_func_count_ = 0;
+  size_t                         word_count_      = 0;
+  unique_ptr<atomic<uint64_t>[]> words_;
+  atomic<size_t>                 object_count_{0};
 };
 
 }  // namespace oceanbase
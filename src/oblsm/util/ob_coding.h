@@ -109,6 +109,20 @@ inline string_view extract_user_key_from_lookup_key(const string_view &lookup_ke
   return string_view(lookup_key.data() + LOOKUP_KEY_PREFIX_SIZE, user_key_size_from_lookup_key(lookup_key));
 }
 
+/**
+ * @brief Appends a lookup key for the user key at the sequence number to `dst`.
+ *
+ * A lookup key is the length of the internal key, followed by the internal key
+ * (the user key and the sequence number). It is the format of the keys in the
+ * memtable, and the target of `seek` on internal iterators.
+ */
+inline void put_lookup_key(string *dst, const string_view &user_key, uint64_t seq)
+{
+  put_numeric<uint64_t>(dst, user_key.size() + SEQ_SIZE);
+  dst->append(user_key.data(), user_key.size());
+  put_numeric<uint64_t>(dst, seq);
+}
+
 inline string_view extract_internal_key(const string_view &lookup_key)
 {
   return string_view(lookup_key.data() + LOOKUP_KEY_PREFIX_SIZE, lookup_key.size() - LOOKUP_KEY_PREFIX_SIZE);
@@ -13,6 +13,12 @@ See the Mulan PSL v2 for more details. */
 #include <stdint.h>
 #include <cstddef>
 
+#include "common/lang/functional.h"
+#include "common/lang/list.h"
+#include "common/lang/memory.h"
+#include "common/lang/mutex.h"
+#include "common/lang/unordered_map.h"
+
 namespace oceanbase {
 
 /**
@@ -23,6 +29,13 @@ namespace oceanbase {
  * entries when the cache exceeds its capacity. It supports thread-safe operations for
  * inserting, retrieving, and checking the existence of cache entries.
  *
+ * Every entry is charged against the capacity, by default 1 so the capacity is the number of
+ * entries. A block cache charges the bytes of each block, so its capacity is a memory size.
+ *
+ * The cache can be split into `2^shard_bits` shards by the hash of the keys. Each shard has its
+ * own lock, LRU list and `capacity / shard count` of the capacity, so threads accessing different
+ * shards don't contend with each other. The LRU order is kept per shard.
+ *
  * @tparam KeyType The type of keys used to identify cache entries.
  * @tparam ValueType The type of values stored in the cache.
  */
@@ -33,9 +46,18 @@ public:
   /**
    * @brief Constructs an `ObLRUCache` with a specified capacity.
    *
-   * @param capacity The maximum number of elements the cache can hold.
+   * @param capacity The maximum total charge of the elements the cache can hold.
+   * @param shard_bits The cache is split into `2^shard_bits` shards.
    */
-  ObLRUCache(size_t capacity) : capacity_(capacity) {}
+  ObLRUCache(size_t capacity, int shard_bits = 0)
+      : capacity_(capacity), shard_bits_(shard_bits), shards_(new Shard[static_cast<size_t>(1) << shard_bits])
+  {
+    const size_t shard_num      = shard_count();
+    const size_t shard_capacity = (capacity + shard_num - 1) / shard_num;
+    for (size_t i = 0; i < shard_num; i++) {
+      shards_[i].capacity = shard_capacity;
+    }
+  }
 
   /**
    * @brief Retrieves a value from the cache using the specified key.
@@ -48,7 +70,20 @@ public:
    * @param value A reference to store the value associated with the key.
    * @return `true` if the key is found and the value is retrieved; `false` otherwise.
    */
-  bool get(const KeyType &key, ValueType &value) { return false; }
+  bool get(const KeyType &key, ValueType &value)
+  {
+    Shard            &shard = shard_of(key);
+    lock_guard<mutex> guard(shard.lock);
+    auto              iter = shard.table.find(key);
+    if (iter == shard.table.end()) {
+      shard.misses++;
+      return false;
+    }
+    shard.lru.splice(shard.lru.begin(), shard.lru, iter->second);
+    value = iter->second->value;
+    shard.hits++;
+    return true;
+  }
 
   /**
    * @brief Inserts a key-value pair into the cache.
@@ -56,25 +91,117 @@ public:
    * If the key already exists in the cache, its value is updated, and the key-value pair
    * is moved to the front of the LRU list. If the cache exceeds its capacity after insertion,
    * the least recently used entry is evicted.
+   * An entry whose charge exceeds the capacity of its shard is not cached.
    *
    * @param key The key to insert into the cache.
    * @param value The value to associate with the specified key.
+   * @param charge The charge of the entry against the capacity.
    */
-  void put(const KeyType &key, const ValueType &value) {}
+  void put(const KeyType &key, const ValueType &value, size_t charge = 1)
+  {
+    Shard            &shard = shard_of(key);
+    lock_guard<mutex> guard(shard.lock);
+    auto              iter = shard.table.find(key);
+    if (iter != shard.table.end()) {
+      shard.usage -= iter->second->charge;
+      shard.lru.erase(iter->second);
+      shard.table.erase(iter);
+    }
+    if (charge > shard.capacity) {
+      return;
+    }
+
+    shard.lru.push_front(Entry{key, value, charge});
+    shard.table.emplace(key, shard.lru.begin());
+    shard.usage += charge;
+    while (shard.usage > shard.capacity) {
+      Entry &victim = shard.lru.back();
+      shard.usage -= victim.charge;
+      shard.table.erase(victim.key);
+      shard.lru.pop_back();
+    }
+  }
 
   /**
    * @brief Checks whether the specified key exists in the cache.
    *
+   * Neither the LRU order nor the hit/miss statistics are changed.
+   *
    * @param key The key to check in the cache.
    * @return `true` if the key exists; `false` otherwise.
    */
-  bool contains(const KeyType &key) const { return false; }
+  bool contains(const KeyType &key) const
+  {
+    const Shard      &shard = shard_of(key);
+    lock_guard<mutex> guard(shard.lock);
+    return shard.table.count(key) > 0;
+  }
+
+  size_t capacity() const { return capacity_; }
+  size_t shard_count() const { return static_cast<size_t>(1) << shard_bits_; }
+
+  /**
+   * @brief Total charge of the entries in the cache.
+   */
+  size_t usage() const { return sum([](const Shard &shard) { return shard.usage; }); }
+
+  /**
+   * @brief Number of `get` calls that found / didn't find the key.
+   */
+  uint64_t hit_count() const { return sum([](const Shard &shard) { return shard.hits; }); }
+  uint64_t miss_count() const { return sum([](const Shard &shard) { return shard.misses; }); }
+
+private:
+  struct Entry
+  {
+    KeyType   key;
+    ValueType value;
+    size_t    charge;
+  };
+
+  struct alignas(64) Shard
+  {
+    mutable mutex                                          lock;
+    list<Entry>                                            lru;  ///< the most recently used entry is at the front
+    unordered_map<KeyType, typename list<Entry>::iterator> table;
+    size_t                                                 capacity = 0;
+    size_t                                                 usage    = 0;
+    uint64_t                                               hits     = 0;
+    uint64_t                                               misses   = 0;
+  };
+
+  size_t shard_index(const KeyType &key) const
+  {
+    if (shard_bits_ == 0) {
+      return 0;
+    }
+    // std::hash of integers is the identity, mix the bits before taking the highest ones.
+    const uint64_t h = static_cast<uint64_t>(hash<KeyType>()(key)) * 0x9e3779b97f4a7c15ULL;
+    return static_cast<size_t>(h >> (64 - shard_bits_));
+  }
+
+  Shard       &shard_of(const KeyType &key) { return shards_[shard_index(key)]; }
+  const Shard &shard_of(const KeyType &key) const { return shards_[shard_index(key)]; }
+
+  template <typename Getter>
+  uint64_t sum(Getter getter) const
+  {
+    uint64_t total = 0;
+    for (size_t i = 0; i < shard_count(); i++) {
+      lock_guard<mutex> guard(shards_[i].lock);
+      total += getter(shards_[i]);
+    }
+    return total;
+  }
 
 private:
   /**
-   * @brief The maximum number of elements the cache can hold.
+   * @brief The maximum total charge of the elements the cache can hold.
    */
   size_t capacity_;
+
+  int                 shard_bits_ = 0;
+  unique_ptr<Shard[]> shards_;
 };
 
 /**
@@ -85,13 +212,14 @@ private:
  *
  * @tparam Key The type of keys used to identify cache entries.
  * @tparam Value The type of values stored in the cache.
- * @param capacity The maximum number of elements the cache can hold.
+ * @param capacity The maximum total charge of the elements the cache can hold.
+ * @param shard_bits The cache is split into `2^shard_bits` shards.
  * @return A pointer to the newly created `ObLRUCache` instance.
  */
 template <typename Key, typename Value>
-ObLRUCache<Key, Value> *new_lru_cache(uint32_t capacity)
+ObLRUCache<Key, Value> *new_lru_cache(size_t capacity, int shard_bits = 0)
 {
-  return nullptr;
+  return new ObLRUCache<Key, Value>(capacity, shard_bits);
 }
 
 }  // namespace oceanbase
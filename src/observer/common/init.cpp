@@ -28,6 +28,10 @@ See the Mulan PSL v2 for more details. */
 #include "sql/plan_cache/plan_cache_stage.h"
 #include "storage/buffer/disk_buffer_pool.h"
 #include "storage/default/default_handler.h"
+#include "storage/index/adaptive_hash_index.h"
+#include "storage/record/lob_handler.h"
+#include "storage/trx/mvcc_lock_manager.h"
+#include "storage/trx/mvcc_vacuum.h"
 #include "storage/trx/trx.h"
 
 using namespace common;
@@ -134,8 +138,54 @@ int prepare_init_seda()
   return 0;
 }
 
+/**
+ * @brief 读取存储相关的配置，需要在打开数据库之前设置
+ */
+static void init_storage_config(Ini &properties)
+{
+  const string storage_section = "STORAGE";
+
+  int lob_inline_threshold = 0;
+  if (str_to_val(properties.get("LOB_INLINE_THRESHOLD", "", storage_section), lob_inline_threshold)) {
+    LobFileHandler::set_inline_threshold(lob_inline_threshold);
+    LOG_INFO("lob inline threshold=%d", LobFileHandler::inline_threshold());
+  }
+
+  int64_t lob_cache_size = 0;
+  if (str_to_val(properties.get("LOB_CACHE_SIZE", "", storage_section), lob_cache_size)) {
+    LobFileHandler::set_default_cache_capacity(lob_cache_size);
+    LOG_INFO("lob cache size=%ld", static_cast<long>(lob_cache_size));
+  }
+
+  int vacuum_interval_ms = 0;
+  if (str_to_val(properties.get("VACUUM_INTERVAL_MS", "", storage_section), vacuum_interval_ms)) {
+    MvccVacuum::set_default_interval_ms(vacuum_interval_ms);
+    LOG_INFO("vacuum interval=%dms", MvccVacuum::default_interval_ms());
+  }
+
+  int vacuum_pages_per_second = 0;
+  if (str_to_val(properties.get("VACUUM_PAGES_PER_SECOND", "", storage_section), vacuum_pages_per_second)) {
+    MvccVacuum::set_default_pages_per_second(vacuum_pages_per_second);
+    LOG_INFO("vacuum pages per second=%d", MvccVacuum::default_pages_per_second());
+  }
+
+  int adaptive_hash_index = 0;
+  if (str_to_val(properties.get("ADAPTIVE_HASH_INDEX", "", storage_section), adaptive_hash_index)) {
+    AdaptiveHashIndex::set_default_enabled(adaptive_hash_index != 0);
+    LOG_INFO("adaptive hash index=%d", AdaptiveHashIndex::default_enabled());
+  }
+
+  int lock_wait_timeout_ms = 0;
+  if (str_to_val(properties.get("LOCK_WAIT_TIMEOUT_MS", "", storage_section), lock_wait_timeout_ms)) {
+    MvccLockManager::set_default_wait_timeout_ms(lock_wait_timeout_ms);
+    LOG_INFO("row lock wait timeout=%dms", MvccLockManager::default_wait_timeout_ms());
+  }
+}
+
 int init_global_objects(ProcessParam *process_param, Ini &properties)
 {
+  init_storage_config(properties);
+
   GCTX.handler_ = new DefaultHandler();
 
   int ret = 0;
@@ -42,13 +42,15 @@ enum class ReadWriteMode
 
 /**
  * @brief 存储格式，仅支持 Heap 存储引擎设置。
- * @details 当前仅支持行存格式（ROW_FORMAT）以及 PAX 存储格式(PAX_FORMAT)。
+ * @details 当前支持定长的行存格式（ROW_FORMAT）、PAX 存储格式(PAX_FORMAT)，
+ * 以及使用槽位目录组织变长记录的行存格式(SLOTTED_FORMAT)。
  */
 enum class StorageFormat
 {
   UNKNOWN_FORMAT = 0,
   ROW_FORMAT,
-  PAX_FORMAT
+  PAX_FORMAT,
+  SLOTTED_FORMAT
 };
 
 /**
@@ -70,9 +70,21 @@ Trx *Session::current_trx()
   当前把事务与数据库绑定到了一起。这样虽然不合理，但是处理起来也简单。
   我们在测试过程中，也不需要多个数据库之间做关联。
   */
+  const bool read_only = read_only_statement_ && !trx_multi_operation_mode_;
+  if (trx_ != nullptr && trx_->read_only() && !read_only) {
+    // 之前的只读语句没有执行完就失败了，留下了只读事务
+    destroy_trx();
+  }
+
   if (trx_ == nullptr) {
-    trx_ = db_->trx_kit().create_trx(db_->log_handler());
+    if (read_only) {
+      trx_ = db_->trx_kit().create_read_only_trx(db_->log_handler());
+    } else {
+      trx_ = db_->trx_kit().create_trx(db_->log_handler());
+    }
   }
+  trx_->set_synchronous_commit(synchronous_commit_);
+  trx_->set_autocommit(!trx_multi_operation_mode_);
   return trx_;
 }
 
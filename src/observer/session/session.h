@@ -63,10 +63,15 @@ public:
 
   /**
    * @brief 当前会话关联的事务
-   *
+   * @details 自动提交模式下执行只读语句时，创建只读事务
    */
   Trx *current_trx();
 
+  /**
+   * @brief 设置当前正在执行的语句是否只读
+   */
+  void set_read_only_statement(bool read_only) { read_only_statement_ = read_only; }
+
   void destroy_trx();
 
   /**
@@ -88,6 +93,12 @@ public:
   void set_use_cascade(bool use_cascade) { use_cascade_ = use_cascade; }
   bool use_cascade() const { return use_cascade_; }
 
+  void set_synchronous_commit(bool synchronous_commit) { synchronous_commit_ = synchronous_commit; }
+  bool synchronous_commit() const { return synchronous_commit_; }
+
+  void set_parallel_workers(int parallel_workers) { parallel_workers_ = parallel_workers; }
+  int  parallel_workers() const { return parallel_workers_; }
+
   void          set_execution_mode(const ExecutionMode mode) { execution_mode_ = mode; }
   ExecutionMode get_execution_mode() const { return execution_mode_; }
 
@@ -113,11 +124,16 @@ private:
   SessionEvent *current_request_ = nullptr;  ///< 当前正在处理的请求
 
   bool trx_multi_operation_mode_ = false;  ///< 当前事务的模式，是否多语句模式. 单语句模式自动提交
+  bool read_only_statement_      = false;  ///< 当前执行的语句是否只读，比如查询
 
   bool sql_debug_   = false;  ///< 是否输出SQL调试信息
   bool hash_join_   = false;  ///< 是否使用hash join
   bool use_cascade_ = false;  ///< 是否使用 cascade 优化器
 
+  bool synchronous_commit_ = true;  ///< 提交事务时是否等待日志落地
+
+  int parallel_workers_ = 1;  ///< 只读的表扫描使用几个线程，大于1时生成并行扫描
+
   // 是否使用了 `chunk_iterator` 模式。 只有在设置了 `chunk_iterator`
   // 并且可以生成相关物理执行计划时才会使用 `chunk_iterator` 模式。
   bool used_chunk_mode_ = false;
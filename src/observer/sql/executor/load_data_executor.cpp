@@ -33,16 +33,20 @@ RC LoadDataExecutor::execute(SQLStageEvent *sql_event)
   return rc;
 }
 
+/// 导入数据时，每攒够这么多行就批量插入一次，这样可以批量更新索引
+static const int LOAD_DATA_BATCH_SIZE = 1024;
+
 /**
- * 从文件中导入数据时使用。尝试向表中插入解析后的一行数据。
+ * 从文件中导入数据时使用。将解析后的一行数据转换成表中的一条记录。
  * @param table  要导入的表
  * @param file_values 从文件中读取到的一行数据，使用分隔符拆分后的几个字段值
- * @param record_values Table::insert_record使用的参数，为了防止频繁的申请内存
+ * @param record_values Table::make_record使用的参数，为了防止频繁的申请内存
+ * @param[out] record 转换后的记录
  * @param errmsg 如果出现错误，通过这个参数返回错误信息
  * @return 成功返回RC::SUCCESS
  */
-RC insert_record_from_file(
-    Table *table, vector<string> &file_values, vector<Value> &record_values, stringstream &errmsg)
+RC make_record_from_file(
+    Table *table, vector<string> &file_values, vector<Value> &record_values, Record &record, stringstream &errmsg)
 {
 
   const int field_num     = record_values.size();
@@ -70,18 +74,14 @@ RC insert_record_from_file(
   }
 
   if (RC::SUCCESS == rc) {
-    Record record;
     rc = table->make_record(field_num, record_values.data(), record);
     if (rc != RC::SUCCESS) {
       errmsg << "insert failed.";
-    } else if (RC::SUCCESS != (rc = table->insert_record(record))) {
-      errmsg << "insert failed.";
     }
   }
   return rc;
 }
 
-
 // TODO: pax format and row format
 void LoadDataExecutor::load_data(Table *table, const char *file_name, char terminated, char enclosed, SqlResult *sql_result)
 {
@@ -109,6 +109,21 @@ void LoadDataExecutor::load_data(Table *table, const char *file_name, char termi
   int                      line_num        = 0;
   int                      insertion_count = 0;
   RC                       rc              = RC::SUCCESS;
+
+  vector<Record> records;
+  int            batch_begin_line = 0;
+  // 批量插入攒下来的记录，任何一条失败，这一批都不会插入
+  auto flush_records = [&]() {
+    RC flush_rc = table->insert_records(records);
+    if (flush_rc != RC::SUCCESS) {
+      result_string << "Line:" << batch_begin_line << "-" << line_num << " insert records failed. error:"
+                    << strrc(flush_rc) << endl;
+    } else {
+      insertion_count += static_cast<int>(records.size());
+    }
+    records.clear();
+    return flush_rc;
+  };
   while (!fs.eof() && RC::SUCCESS == rc) {
     getline(fs, line);
     line_num++;
@@ -120,13 +135,21 @@ void LoadDataExecutor::load_data(Table *table, const char *file_name, char termi
     common::split_string(line, delim, file_values);
     stringstream errmsg;
 
-    if (table->table_meta().storage_format() == StorageFormat::ROW_FORMAT) {
-      rc = insert_record_from_file(table, file_values, record_values, errmsg);
+    if (table->table_meta().storage_format() == StorageFormat::ROW_FORMAT ||
+        table->table_meta().storage_format() == StorageFormat::SLOTTED_FORMAT) {
+      Record record;
+      rc = make_record_from_file(table, file_values, record_values, record, errmsg);
       if (rc != RC::SUCCESS) {
         result_string << "Line:" << line_num << " insert record failed:" << errmsg.str() << ". error:" << strrc(rc)
                       << endl;
       } else {
-        insertion_count++;
+        if (records.empty()) {
+          batch_begin_line = line_num;
+        }
+        records.push_back(std::move(record));
+        if (static_cast<int>(records.size()) >= LOAD_DATA_BATCH_SIZE) {
+          rc = flush_records();
+        }
       }
     } else if (table->table_meta().storage_format() == StorageFormat::PAX_FORMAT) {
       // your code here
@@ -137,6 +160,9 @@ void LoadDataExecutor::load_data(Table *table, const char *file_name, char termi
       result_string << "Unsupported storage format: " << strrc(rc) << endl;
     }
   }
+  if (RC::SUCCESS == rc && !records.empty()) {
+    rc = flush_records();
+  }
   fs.close();
 
   struct timespec end_time;
@@ -50,6 +50,21 @@ RC SetVariableExecutor::execute(SQLStageEvent *sql_event)
           session->set_use_cascade(bool_value);
           LOG_TRACE("set use_cascade to %d", bool_value);
         }
+      } else if (strcasecmp(var_name, "synchronous_commit") == 0) {
+        bool bool_value = false;
+        rc              = var_value_to_boolean(var_value, bool_value);
+        if (rc == RC::SUCCESS) {
+          session->set_synchronous_commit(bool_value);
+          LOG_TRACE("set synchronous_commit to %d", bool_value);
+        }
+      } else if (strcasecmp(var_name, "parallel_workers") == 0) {
+        if (var_value.attr_type() == AttrType::INTS && var_value.get_int() >= 1 &&
+            var_value.get_int() <= MAX_PARALLEL_WORKERS) {
+          session->set_parallel_workers(var_value.get_int());
+          LOG_TRACE("set parallel_workers to %d", var_value.get_int());
+        } else {
+          rc = RC::VARIABLE_NOT_VALID;
+        }
       } else {
       rc = RC::VARIABLE_NOT_EXISTS;
     }
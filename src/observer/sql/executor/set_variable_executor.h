@@ -26,6 +26,9 @@ See the Mulan PSL v2 for more details. */
  */
 class SetVariableExecutor
 {
+public:
+  static constexpr int MAX_PARALLEL_WORKERS = 64;  ///< parallel_workers 的最大值
+
 public:
   SetVariableExecutor()          = default;
   virtual ~SetVariableExecutor() = default;
@@ -0,0 +1,58 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/sys/rc.h"
+#include "event/session_event.h"
+#include "event/sql_event.h"
+#include "session/session.h"
+#include "sql/executor/sql_result.h"
+#include "sql/operator/string_list_physical_operator.h"
+#include "storage/db/db.h"
+#include "storage/trx/mvcc_vacuum.h"
+
+/**
+ * @brief 查看 MVCC 后台清理进度的执行器
+ * @ingroup Executor
+ * @details 每个统计项输出一行。不使用 MVCC 的数据库没有清理线程，返回空的结果
+ */
+class ShowStatusExecutor
+{
+public:
+  ShowStatusExecutor()          = default;
+  virtual ~ShowStatusExecutor() = default;
+
+  RC execute(SQLStageEvent *sql_event)
+  {
+    SqlResult    *sql_result    = sql_event->session_event()->sql_result();
+    SessionEvent *session_event = sql_event->session_event();
+
+    Db *db = session_event->session()->get_current_db();
+
+    TupleSchema tuple_schema;
+    tuple_schema.append_cell(TupleCellSpec("", "Variable_name", "Variable_name"));
+    tuple_schema.append_cell(TupleCellSpec("", "Value", "Value"));
+    sql_result->set_tuple_schema(tuple_schema);
+
+    auto oper = new StringListPhysicalOperator;
+    if (db->vacuum() != nullptr) {
+      const MvccVacuumStats stats = db->vacuum()->stats();
+      oper->append({"passes", std::to_string(stats.passes)});
+      oper->append({"pages_scanned", std::to_string(stats.pages_scanned)});
+      oper->append({"records_removed", std::to_string(stats.records_removed)});
+      oper->append({"undo_purged", std::to_string(stats.undo_purged)});
+      oper->append({"watermark", std::to_string(stats.watermark)});
+    }
+
+    sql_result->set_operator(unique_ptr<PhysicalOperator>(oper));
+    return RC::SUCCESS;
+  }
+};
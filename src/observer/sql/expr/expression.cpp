@@ -44,7 +44,13 @@ RC FieldExpr::get_column(Chunk& chunk, Column& column)
     column.reference(chunk.column(pos_));
   }
   else {
-    column.reference(chunk.column(field().meta()->field_id()));
+    // 表扫描可能只读取了部分列，需要按照字段ID查找
+    const int index = chunk.column_index(field().meta()->field_id());
+    if (index < 0) {
+      LOG_WARN("field is not in the chunk. field=%s", field_name());
+      return RC::NOTFOUND;
+    }
+    column.reference(chunk.column(index));
   }
   return RC::SUCCESS;
 }
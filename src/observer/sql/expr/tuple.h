@@ -235,15 +235,21 @@ public:
         return RC::SUCCESS;
       }
 
+      string text;
+      if (ref->is_inline()) {
+        text.assign(ref->inline_data(), min(ref->length, field_meta->len() - static_cast<int>(sizeof(LobRef))));
+        cell.set_type(AttrType::TEXTS);
+        cell.set_data(text.data(), static_cast<int>(text.size()));
+        return RC::SUCCESS;
+      }
+
       const Table *table = table_;
       if (table == nullptr || table->lob_handler() == nullptr) {
         LOG_WARN("lob handler is null when reading TEXT field");
         return RC::INTERNAL;
       }
 
-      string text;
-      text.resize(ref->length);
-      RC rc = table->lob_handler()->get_data(ref->offset, ref->length, text.data());
+      RC rc = table->lob_handler()->read_field(this->record_->data() + field_meta->offset(), field_meta->len(), text);
       if (OB_FAIL(rc)) {
         LOG_WARN("failed to read lob data. rc=%s", strrc(rc));
         return rc;
@@ -51,6 +51,10 @@ RC DeletePhysicalOperator::open(Trx *trx)
   // 记录的有效性由事务来保证，如果事务不保证删除的有效性，那说明此事务类型不支持并发控制，比如VacuousTrx
   for (Record &record : records_) {
     rc = trx_->delete_record(table_, record);
+    if (rc == RC::LOCKED_CONCURRENCY_CONFLICT && trx_->autocommit()) {
+      // 读到的版本已经被其它事务修改并提交，自动提交的语句在最新的版本上重新执行
+      rc = delete_latest_version(record.rid());
+    }
     if (rc != RC::SUCCESS) {
       LOG_WARN("failed to delete record: %s", strrc(rc));
       return rc;
@@ -60,6 +64,34 @@ RC DeletePhysicalOperator::open(Trx *trx)
   return RC::SUCCESS;
 }
 
+RC DeletePhysicalOperator::delete_latest_version(const RID &rid)
+{
+  Record latest_record;
+  RC     rc = trx_->read_latest_version(table_, rid, latest_record);
+  if (rc == RC::RECORD_NOT_EXIST) {
+    return RC::SUCCESS;
+  }
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  if (recheck_predicate_ != nullptr) {
+    RowTuple tuple;
+    tuple.set_schema(table_, table_->table_meta().field_metas());
+    tuple.set_record(&latest_record);
+    Value value;
+    rc = recheck_predicate_->get_value(tuple, value);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to recheck predicate on latest version. rid=%s, rc=%s", rid.to_string().c_str(), strrc(rc));
+      return rc;
+    }
+    if (!value.get_boolean()) {
+      return RC::SUCCESS;
+    }
+  }
+  return trx_->delete_record(table_, latest_record);
+}
+
 RC DeletePhysicalOperator::next()
 {
   return RC::RECORD_EOF;
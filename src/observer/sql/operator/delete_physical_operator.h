@@ -14,6 +14,7 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include "sql/expr/expression.h"
 #include "sql/operator/physical_operator.h"
 
 class Trx;
@@ -40,8 +41,20 @@ public:
 
   Tuple *current_tuple() override { return nullptr; }
 
+  /**
+   * @brief 设置语句的过滤条件，在记录最新提交的版本上重新检查时使用
+   */
+  void set_recheck_predicate(unique_ptr<Expression> predicate) { recheck_predicate_ = std::move(predicate); }
+
+private:
+  /**
+   * @brief 自动提交的语句读到的版本已经被其它事务修改，在最新提交的版本上重新检查条件并删除
+   */
+  RC delete_latest_version(const RID &rid);
+
 private:
-  Table         *table_ = nullptr;
-  Trx           *trx_   = nullptr;
-  vector<Record> records_;
+  Table                 *table_ = nullptr;
+  Trx                   *trx_   = nullptr;
+  vector<Record>         records_;
+  unique_ptr<Expression> recheck_predicate_;
 };
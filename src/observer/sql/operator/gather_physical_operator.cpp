@@ -0,0 +1,229 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "sql/operator/gather_physical_operator.h"
+#include "common/log/log.h"
+#include "sql/expr/composite_tuple.h"
+#include "sql/operator/table_scan_physical_operator.h"
+#include "sql/operator/table_scan_vec_physical_operator.h"
+#include "storage/table/table.h"
+
+using namespace std;
+
+GatherPhysicalOperator::~GatherPhysicalOperator() { stop_workers(); }
+
+string GatherPhysicalOperator::param() const { return "workers=" + to_string(children_.size()); }
+
+RC GatherPhysicalOperator::open(Trx *trx)
+{
+  if (children_.empty()) {
+    LOG_WARN("gather operator has no child");
+    return RC::INTERNAL;
+  }
+
+  shared_ptr<PageMorselQueue> morsels;
+  RC                          rc = table_->create_morsel_queue(morsels);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to create morsel queue. table=%s, rc=%s", table_->name(), strrc(rc));
+    return rc;
+  }
+
+  for (size_t i = 0; i < children_.size(); i++) {
+    PhysicalOperator *child = children_[i].get();
+    if (vectorized_) {
+      ASSERT(child->type() == PhysicalOperatorType::TABLE_SCAN_VEC, "gather child should be a vectorized table scan");
+      static_cast<TableScanVecPhysicalOperator *>(child)->set_morsel_queue(morsels);
+    } else {
+      ASSERT(child->type() == PhysicalOperatorType::TABLE_SCAN, "gather child should be a table scan");
+      static_cast<TableScanPhysicalOperator *>(child)->set_morsel_queue(morsels);
+    }
+
+    rc = child->open(trx);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to open child operator of gather. rc=%s", strrc(rc));
+      for (size_t j = 0; j < i; j++) {
+        children_[j]->close();
+      }
+      return rc;
+    }
+  }
+
+  batches_.clear();
+  current_batch_.reset();
+  current_index_   = 0;
+  stopped_         = false;
+  worker_rc_       = RC::SUCCESS;
+  running_workers_ = static_cast<int>(children_.size());
+  max_batches_     = children_.size() * QUEUE_BATCHES;
+  for (unique_ptr<PhysicalOperator> &child : children_) {
+    workers_.emplace_back(&GatherPhysicalOperator::worker_run, this, child.get());
+  }
+  return RC::SUCCESS;
+}
+
+RC GatherPhysicalOperator::next()
+{
+  while (current_batch_ == nullptr || current_index_ >= current_batch_->tuples.size()) {
+    RC rc = pop();
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+
+  current_index_++;
+  return RC::SUCCESS;
+}
+
+RC GatherPhysicalOperator::next(Chunk &chunk)
+{
+  RC rc = pop();
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+  return chunk.reference(*current_batch_->chunk);
+}
+
+RC GatherPhysicalOperator::close()
+{
+  // 子算子由各自的工作线程关闭
+  stop_workers();
+  batches_.clear();
+  current_batch_.reset();
+  return RC::SUCCESS;
+}
+
+Tuple *GatherPhysicalOperator::current_tuple()
+{
+  if (current_batch_ == nullptr || current_index_ == 0) {
+    return nullptr;
+  }
+  return &current_batch_->tuples[current_index_ - 1];
+}
+
+RC GatherPhysicalOperator::tuple_schema(TupleSchema &schema) const
+{
+  if (children_.empty()) {
+    return RC::INTERNAL;
+  }
+  return children_.front()->tuple_schema(schema);
+}
+
+void GatherPhysicalOperator::worker_run(PhysicalOperator *child)
+{
+  RC rc = vectorized_ ? produce_chunks(child) : produce_tuples(child);
+  // 扫描器持有的页面锁是在工作线程中加的，也要在工作线程中释放
+  child->close();
+
+  lock_guard<mutex> guard(lock_);
+  if (rc != RC::RECORD_EOF && OB_FAIL(rc)) {
+    LOG_WARN("gather worker failed. rc=%s", strrc(rc));
+    if (OB_SUCC(worker_rc_)) {
+      worker_rc_ = rc;
+    }
+  }
+  running_workers_--;
+  not_empty_.notify_all();
+}
+
+RC GatherPhysicalOperator::produce_tuples(PhysicalOperator *child)
+{
+  RC   rc    = RC::SUCCESS;
+  auto batch = make_unique<Batch>();
+  while (OB_SUCC(rc = child->next())) {
+    Tuple *tuple = child->current_tuple();
+    if (nullptr == tuple) {
+      LOG_WARN("failed to get current tuple from child operator");
+      return RC::INTERNAL;
+    }
+
+    batch->tuples.emplace_back();
+    rc = ValueListTuple::make(*tuple, batch->tuples.back());
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to copy tuple. rc=%s", strrc(rc));
+      return rc;
+    }
+
+    if (batch->tuples.size() >= static_cast<size_t>(TUPLE_BATCH_SIZE)) {
+      if (!push(std::move(batch))) {
+        return RC::SUCCESS;
+      }
+      batch = make_unique<Batch>();
+    }
+  }
+
+  if (rc == RC::RECORD_EOF && !batch->tuples.empty()) {
+    push(std::move(batch));
+  }
+  return rc;
+}
+
+RC GatherPhysicalOperator::produce_chunks(PhysicalOperator *child)
+{
+  RC    rc = RC::SUCCESS;
+  Chunk chunk;
+  while (OB_SUCC(rc = child->next(chunk))) {
+    if (chunk.rows() == 0) {
+      continue;
+    }
+
+    // 子算子返回的 chunk 引用的是扫描算子内部的数据，下一次调用 next 时会被覆盖
+    auto batch   = make_unique<Batch>();
+    batch->chunk = make_unique<Chunk>(chunk);
+    if (!push(std::move(batch))) {
+      return RC::SUCCESS;
+    }
+  }
+  return rc;
+}
+
+bool GatherPhysicalOperator::push(unique_ptr<Batch> batch)
+{
+  unique_lock<mutex> guard(lock_);
+  not_full_.wait(guard, [this] { return stopped_ || batches_.size() < max_batches_; });
+  if (stopped_) {
+    return false;
+  }
+
+  batches_.push_back(std::move(batch));
+  not_empty_.notify_one();
+  return true;
+}
+
+RC GatherPhysicalOperator::pop()
+{
+  unique_lock<mutex> guard(lock_);
+  not_empty_.wait(guard, [this] { return !batches_.empty() || running_workers_ == 0 || OB_FAIL(worker_rc_); });
+  if (OB_FAIL(worker_rc_)) {
+    return worker_rc_;
+  }
+  if (batches_.empty()) {
+    return RC::RECORD_EOF;
+  }
+
+  current_batch_ = std::move(batches_.front());
+  current_index_ = 0;
+  batches_.pop_front();
+  not_full_.notify_one();
+  return RC::SUCCESS;
+}
+
+void GatherPhysicalOperator::stop_workers()
+{
+  {
+    lock_guard<mutex> guard(lock_);
+    stopped_ = true;
+  }
+  not_full_.notify_all();
+
+  for (thread &worker : workers_) {
+    worker.join();
+  }
+  workers_.clear();
+}
@@ -0,0 +1,94 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/condition_variable.h"
+#include "common/lang/deque.h"
+#include "common/lang/mutex.h"
+#include "common/lang/thread.h"
+#include "sql/expr/tuple.h"
+#include "sql/operator/physical_operator.h"
+#include "storage/common/chunk.h"
+
+class Table;
+
+/**
+ * @brief 并行扫描的汇总算子
+ * @ingroup PhysicalOperator
+ * @details 每个子算子是同一张表的扫描算子(TABLE_SCAN 或者 TABLE_SCAN_VEC)，打开时为它们创建同一个页面片段队列，
+ * 每个子算子在自己的线程中领取片段并执行扫描和过滤，结束时也在这个线程中关闭，MVCC 的可见性仍然在扫描器中逐条记录判断。
+ * 工作线程把结果复制成 ValueListTuple 或者 Chunk 放到队列中，由调用 next 的线程依次取出，
+ * 上层的聚合、投影等算子不需要知道下面是并行执行的。返回结果的顺序是不确定的。
+ * 工作线程中没有设置当前会话，所以过滤条件中不能有子查询。
+ */
+class GatherPhysicalOperator : public PhysicalOperator
+{
+public:
+  GatherPhysicalOperator(Table *table, bool vectorized) : table_(table), vectorized_(vectorized) {}
+
+  virtual ~GatherPhysicalOperator();
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::GATHER; }
+
+  string param() const override;
+
+  RC open(Trx *trx) override;
+  RC next() override;
+  RC next(Chunk &chunk) override;
+  RC close() override;
+
+  Tuple *current_tuple() override;
+
+  RC tuple_schema(TupleSchema &schema) const override;
+
+private:
+  /**
+   * @brief 工作线程放到队列中的一批结果
+   * @details 行模式下是若干个复制出来的 tuple，向量化模式下是一个复制出来的 chunk
+   */
+  struct Batch
+  {
+    vector<ValueListTuple> tuples;
+    unique_ptr<Chunk>      chunk;
+  };
+
+  void worker_run(PhysicalOperator *child);
+  RC   produce_tuples(PhysicalOperator *child);
+  RC   produce_chunks(PhysicalOperator *child);
+
+  /// @brief 把一批结果放到队列中，队列满时等待。算子关闭时返回 false
+  bool push(unique_ptr<Batch> batch);
+  /// @brief 取出下一批结果，所有的工作线程都结束并且队列为空时返回 RECORD_EOF
+  RC   pop();
+
+  void stop_workers();
+
+private:
+  static constexpr int TUPLE_BATCH_SIZE = 64;  ///< 行模式下每一批结果包含的 tuple 个数
+  static constexpr int QUEUE_BATCHES    = 4;   ///< 每个工作线程最多可以积压的批数
+
+  Table *table_      = nullptr;
+  bool   vectorized_ = false;
+
+  vector<thread> workers_;
+  size_t         max_batches_ = 0;  ///< 队列中最多积压的批数
+
+  mutex                     lock_;
+  condition_variable        not_empty_;
+  condition_variable        not_full_;
+  deque<unique_ptr<Batch>>  batches_;
+  int                       running_workers_ = 0;
+  bool                      stopped_         = false;
+  RC                        worker_rc_       = RC::SUCCESS;  ///< 第一个失败的工作线程的错误码
+
+  unique_ptr<Batch> current_batch_;
+  size_t            current_index_ = 0;
+};
@@ -0,0 +1,127 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "sql/operator/index_only_scan_physical_operator.h"
+#include "storage/index/index.h"
+#include "storage/table/table.h"
+
+IndexOnlyScanPhysicalOperator::IndexOnlyScanPhysicalOperator(Table *table, Index *index, const Value *left_value,
+    bool left_inclusive, const Value *right_value, bool right_inclusive)
+    : table_(table), index_(index), left_inclusive_(left_inclusive), right_inclusive_(right_inclusive)
+{
+  if (left_value) {
+    left_value_ = *left_value;
+  }
+  if (right_value) {
+    right_value_ = *right_value;
+  }
+}
+
+RC IndexOnlyScanPhysicalOperator::open(Trx *trx)
+{
+  if (nullptr == table_ || nullptr == index_) {
+    return RC::INTERNAL;
+  }
+
+  field_meta_ = table_->table_meta().field(index_->index_meta().field());
+  if (nullptr == field_meta_) {
+    LOG_WARN("no such field in table. table=%s, field=%s", table_->name(), index_->index_meta().field());
+    return RC::SCHEMA_FIELD_NOT_EXIST;
+  }
+
+  RC rc = current_record_.new_record(table_->table_meta().record_size());
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to allocate record buffer. rc=%s", strrc(rc));
+    return rc;
+  }
+  memset(current_record_.data(), 0, current_record_.len());
+
+  IndexScanner *index_scanner = index_->create_scanner(left_value_.data(),
+      left_value_.length(),
+      left_inclusive_,
+      right_value_.data(),
+      right_value_.length(),
+      right_inclusive_);
+  if (nullptr == index_scanner) {
+    LOG_WARN("failed to create index scanner");
+    return RC::INTERNAL;
+  }
+  index_scanner_ = index_scanner;
+
+  key_fields_ = {*field_meta_};
+  tuple_.set_schema(table_, &key_fields_);
+  tuple_.set_record(&current_record_);
+  return RC::SUCCESS;
+}
+
+RC IndexOnlyScanPhysicalOperator::next()
+{
+  RID  rid;
+  RC   rc            = RC::SUCCESS;
+  bool filter_result = false;
+
+  char *key = current_record_.data() + field_meta_->offset();
+  while (RC::SUCCESS == (rc = index_scanner_->next_entry_with_key(&rid, key))) {
+    current_record_.set_rid(rid);
+
+    rc = filter(tuple_, filter_result);
+    if (OB_FAIL(rc)) {
+      LOG_TRACE("failed to filter index entry. rc=%s", strrc(rc));
+      return rc;
+    }
+
+    if (filter_result) {
+      return RC::SUCCESS;
+    }
+  }
+
+  return rc;
+}
+
+RC IndexOnlyScanPhysicalOperator::close()
+{
+  if (index_scanner_ != nullptr) {
+    index_scanner_->destroy();
+    index_scanner_ = nullptr;
+  }
+  return RC::SUCCESS;
+}
+
+Tuple *IndexOnlyScanPhysicalOperator::current_tuple() { return &tuple_; }
+
+void IndexOnlyScanPhysicalOperator::set_predicates(vector<unique_ptr<Expression>> &&exprs)
+{
+  predicates_ = std::move(exprs);
+}
+
+RC IndexOnlyScanPhysicalOperator::filter(RowTuple &tuple, bool &result)
+{
+  RC    rc = RC::SUCCESS;
+  Value value;
+  for (unique_ptr<Expression> &expr : predicates_) {
+    rc = expr->get_value(tuple, value);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+
+    if (!value.get_boolean()) {
+      result = false;
+      return rc;
+    }
+  }
+
+  result = true;
+  return rc;
+}
+
+string IndexOnlyScanPhysicalOperator::param() const
+{
+  return string(index_->index_meta().name()) + " ON " + table_->name();
+}
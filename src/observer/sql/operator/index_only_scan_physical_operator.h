@@ -0,0 +1,63 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "sql/expr/tuple.h"
+#include "sql/operator/physical_operator.h"
+#include "storage/record/record_manager.h"
+
+/**
+ * @brief 索引覆盖扫描物理算子
+ * @ingroup PhysicalOperator
+ * @details 查询只用到了索引字段时，直接使用B+树叶子节点中的键值构造tuple，不再回表读取记录。
+ * 索引中没有事务可见性信息，所以只能在不需要检查记录可见性的事务模型下使用。
+ */
+class IndexOnlyScanPhysicalOperator : public PhysicalOperator
+{
+public:
+  IndexOnlyScanPhysicalOperator(Table *table, Index *index, const Value *left_value, bool left_inclusive,
+      const Value *right_value, bool right_inclusive);
+
+  virtual ~IndexOnlyScanPhysicalOperator() = default;
+
+  PhysicalOperatorType type() const override { return PhysicalOperatorType::INDEX_ONLY_SCAN; }
+
+  string param() const override;
+
+  RC open(Trx *trx) override;
+  RC next() override;
+  RC close() override;
+
+  Tuple *current_tuple() override;
+
+  void set_predicates(vector<unique_ptr<Expression>> &&exprs);
+
+private:
+  RC filter(RowTuple &tuple, bool &result);
+
+private:
+  Table           *table_         = nullptr;
+  Index           *index_         = nullptr;
+  const FieldMeta *field_meta_    = nullptr;
+  IndexScanner    *index_scanner_ = nullptr;
+
+  /// 按照表的记录格式存放键值，其它字段都是空的，这样可以直接复用 RowTuple
+  Record            current_record_;
+  vector<FieldMeta> key_fields_;
+  RowTuple          tuple_;
+
+  Value left_value_;
+  Value right_value_;
+  bool  left_inclusive_  = false;
+  bool  right_inclusive_ = false;
+
+  vector<unique_ptr<Expression>> predicates_;
+};
@@ -51,6 +51,10 @@ RC IndexScanPhysicalOperator::open(Trx *trx)
     return RC::INTERNAL;
   }
   index_scanner_ = index_scanner;
+  rids_.clear();
+  keys_.clear();
+  rid_index_ = 0;
+  with_key_  = index_->support_index_only_scan();
 
   tuple_.set_schema(table_, table_->table_meta().field_metas());
 
@@ -61,12 +65,25 @@ RC IndexScanPhysicalOperator::open(Trx *trx)
 RC IndexScanPhysicalOperator::next()
 {
   // TODO: 需要适配 lsm-tree 引擎
-  RID rid;
-  RC  rc = RC::SUCCESS;
+  RC rc = RC::SUCCESS;
 
   bool filter_result = false;
-  while (RC::SUCCESS == (rc = index_scanner_->next_entry(&rid))) {
-    rc = table_->get_record(rid, current_record_);
+  while (true) {
+    if (rid_index_ >= rids_.size()) {
+      rid_index_ = 0;
+      if (with_key_) {
+        rc = index_scanner_->next_entries_with_key(rids_, keys_, index_->field_meta().len(), RID_BATCH_SIZE);
+      } else {
+        rc = index_scanner_->next_entries(rids_, RID_BATCH_SIZE);
+      }
+      if (OB_FAIL(rc)) {
+        break;
+      }
+    }
+
+    const size_t entry_index = rid_index_++;
+    const RID   &rid         = rids_[entry_index];
+    rc                       = table_->get_record(rid, current_record_);
     if (OB_FAIL(rc)) {
       LOG_TRACE("failed to get record. rid=%s, rc=%s", rid.to_string().c_str(), strrc(rc));
       return rc;
@@ -74,6 +91,21 @@ RC IndexScanPhysicalOperator::next()
 
     LOG_TRACE("got a record. rid=%s", rid.to_string().c_str());
 
+    // 先找到当前事务可见的版本，键值和过滤条件都要在这个版本上判断
+    RC visit_rc = trx_->visit_record(table_, current_record_, mode_);
+    if (visit_rc == RC::RECORD_INVISIBLE) {
+      LOG_TRACE("record invisible");
+      continue;
+    }
+    if (visit_rc != RC::SUCCESS && visit_rc != RC::LOCKED_CONCURRENCY_CONFLICT) {
+      return visit_rc;
+    }
+
+    if (!match_entry(current_record_, entry_index)) {
+      LOG_TRACE("index entry does not match the visible version. rid=%s", rid.to_string().c_str());
+      continue;
+    }
+
     tuple_.set_record(&current_record_);
     rc = filter(tuple_, filter_result);
     if (OB_FAIL(rc)) {
@@ -86,13 +118,7 @@ RC IndexScanPhysicalOperator::next()
       continue;
     }
 
-    rc = trx_->visit_record(table_, current_record_, mode_);
-    if (rc == RC::RECORD_INVISIBLE) {
-      LOG_TRACE("record invisible");
-      continue;
-    } else {
-      return rc;
-    }
+    return visit_rc;
   }
 
   return rc;
@@ -196,6 +222,30 @@ void IndexScanPhysicalOperator::update_composite_tuple()
   composite_tuple_->add_tuple(std::move(inner_tuple_copy));
 }
 
+bool IndexScanPhysicalOperator::match_entry(const Record &record, size_t entry_index) const
+{
+  const FieldMeta &field = index_->field_meta();
+  if (with_key_) {
+    return index_->key_equals(record.data(), keys_.data() + entry_index * field.len());
+  }
+
+  // 索引不能返回键值时，检查可见版本的键值是否在扫描范围内
+  Value key(field.type(), const_cast<char *>(record.data() + field.offset()), field.len());
+  if (left_value_.attr_type() != AttrType::UNDEFINED) {
+    const int cmp = key.compare(left_value_);
+    if (cmp < 0 || (cmp == 0 && !left_inclusive_)) {
+      return false;
+    }
+  }
+  if (right_value_.attr_type() != AttrType::UNDEFINED) {
+    const int cmp = key.compare(right_value_);
+    if (cmp > 0 || (cmp == 0 && !right_inclusive_)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 RC IndexScanPhysicalOperator::filter(RowTuple &tuple, bool &result)
 {
   RC    rc = RC::SUCCESS;
@@ -26,6 +26,10 @@ class CompositeTuple;
  */
 class IndexScanPhysicalOperator : public PhysicalOperator
 {
+public:
+  /// 每次从索引中批量获取的记录位置个数
+  static constexpr int RID_BATCH_SIZE = 64;
+
 public:
   IndexScanPhysicalOperator(Table *table, Index *index, ReadWriteMode mode, const Value *left_value,
       bool left_inclusive, const Value *right_value, bool right_inclusive);
@@ -50,6 +54,8 @@ public:
 private:
   // 与TableScanPhysicalOperator代码相同，可以优化
   RC filter(RowTuple &tuple, bool &result);
+  /// @brief 可见版本的索引字段是否与索引项一致。索引中保留了旧版本的键值，同一条记录可能有多个索引项
+  bool match_entry(const Record &record, size_t entry_index) const;
   /// @brief 更新 composite_tuple_，使其包含外部查询和当前 tuple 的所有字段
   void update_composite_tuple();
 
@@ -60,6 +66,11 @@ private:
   ReadWriteMode mode_          = ReadWriteMode::READ_WRITE;
   IndexScanner *index_scanner_ = nullptr;
 
+  vector<RID>  rids_;             ///< 从索引中批量获取的记录位置
+  vector<char> keys_;             ///< 与 rids_ 对应的索引键值，索引不能返回键值时为空
+  size_t       rid_index_ = 0;    ///< 下一个要访问的记录位置在 rids_ 中的下标
+  bool         with_key_  = false;  ///< 是否从索引中同时获取键值
+
   Record   current_record_;
   RowTuple tuple_;
 
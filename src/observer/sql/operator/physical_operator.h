@@ -37,6 +37,7 @@ enum class PhysicalOperatorType
   TABLE_SCAN,
   TABLE_SCAN_VEC,
   INDEX_SCAN,
+  INDEX_ONLY_SCAN,  ///< 索引覆盖扫描，不回表
   NESTED_LOOP_JOIN,
   HASH_JOIN,
   EXPLAIN,
@@ -55,6 +56,7 @@ enum class PhysicalOperatorType
   AGGREGATE_VEC,
   EXPR_VEC,
   ORDER_BY,    ///< 排序
+  GATHER,      ///< 汇总并行扫描的结果
 };
 
 /**
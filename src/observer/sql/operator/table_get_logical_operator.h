@@ -57,10 +57,22 @@ public:
   void set_predicates(vector<unique_ptr<Expression>> &&exprs);
   auto predicates() -> vector<unique_ptr<Expression>> & { return predicates_; }
 
+  /**
+   * @brief 设置整个查询中引用到的本表字段
+   * @details 生成物理计划时，可以据此判断能否使用索引覆盖扫描，或者只读取部分列
+   */
+  void set_referenced_fields(vector<const FieldMeta *> &&fields);
+  /// 是否知道引用了哪些字段。不知道时(比如有子查询)，需要认为所有字段都会被用到
+  bool referenced_fields_known() const { return referenced_fields_known_; }
+  auto referenced_fields() const -> const vector<const FieldMeta *> & { return referenced_fields_; }
+
 private:
   Table        *table_ = nullptr;
   ReadWriteMode mode_  = ReadWriteMode::READ_WRITE;
 
+  bool                      referenced_fields_known_ = false;
+  vector<const FieldMeta *> referenced_fields_;
+
   // 与当前表相关的过滤操作，可以尝试在遍历数据时执行
   // 这里的表达式都是比较简单的比较运算，并且左右两边都是取字段表达式或值表达式
   // 不包含复杂的表达式运算，比如加减乘除、或者conjunction expression
@@ -14,6 +14,7 @@ See the Mulan PSL v2 for more details. */
 
 #include "sql/operator/table_scan_physical_operator.h"
 #include "event/sql_debug.h"
+#include "sql/expr/expression.h"
 #include "storage/table/table.h"
 #include "sql/expr/composite_tuple.h"
 #include "sql/expr/tuple.h"
@@ -22,8 +23,19 @@ using namespace std;
 
 RC TableScanPhysicalOperator::open(Trx *trx)
 {
-  RC rc = table_->get_record_scanner(record_scanner_, trx, mode_);
+  RC rc = RC::SUCCESS;
+  if (morsels_ != nullptr) {
+    rc = table_->get_parallel_record_scanner(record_scanner_, trx, mode_, morsels_);
+  } else {
+    rc = table_->get_record_scanner(record_scanner_, trx, mode_);
+  }
   if (rc == RC::SUCCESS) {
+    // 过滤条件直接在页面上的记录中计算，被过滤掉的记录不需要复制
+    record_scanner_->set_zero_copy(true);
+    scanner_filter_ = false;
+    if (!compiled_filter_.empty()) {
+      scanner_filter_ = OB_SUCC(record_scanner_->set_condition_filter(&compiled_filter_));
+    }
     tuple_.set_schema(table_, table_->table_meta().field_metas());
   }
   trx_ = trx;
@@ -35,10 +47,14 @@ RC TableScanPhysicalOperator::next()
   RC rc = RC::SUCCESS;
 
   bool filter_result = false;
-  while (OB_SUCC(rc = record_scanner_->next(current_record_))) {
-    LOG_TRACE("got a record. rid=%s", current_record_.rid().to_string().c_str());
-    
-    tuple_.set_record(&current_record_);
+  while (OB_SUCC(rc = record_scanner_->next(scan_record_))) {
+    LOG_TRACE("got a record. rid=%s", scan_record_.rid().to_string().c_str());
+
+    if (!scanner_filter_ && !compiled_filter_.empty() && !compiled_filter_.filter(scan_record_)) {
+      continue;
+    }
+
+    tuple_.set_record(&scan_record_);
     rc = filter(tuple_, filter_result);
     if (rc != RC::SUCCESS) {
       LOG_TRACE("record filtered failed=%s", strrc(rc));
@@ -52,6 +68,17 @@ RC TableScanPhysicalOperator::next()
       sql_debug("a tuple is filtered: %s", tuple_.to_string().c_str());
     }
   }
+
+  if (OB_SUCC(rc)) {
+    // 只读时上层算子在下一次调用 next 之前就会用完当前的记录，可以直接引用页面上的数据。
+    // 删除和更新会先收集所有的记录再修改，这时扫描器已经离开了记录所在的页面，需要复制出来
+    if (mode_ == ReadWriteMode::READ_WRITE) {
+      rc = current_record_.copy_data(scan_record_.data(), scan_record_.len());
+      current_record_.set_rid(scan_record_.rid());
+    } else {
+      current_record_.refer(scan_record_);
+    }
+  }
   return rc;
 }
 
@@ -86,7 +113,86 @@ string TableScanPhysicalOperator::param() const { return table_->name(); }
 
 void TableScanPhysicalOperator::set_predicates(vector<unique_ptr<Expression>> &&exprs)
 {
-  predicates_ = std::move(exprs);
+  predicates_.clear();
+  for (unique_ptr<Expression> &expr : exprs) {
+    if (!compile_predicate(expr.get())) {
+      predicates_.emplace_back(std::move(expr));
+    }
+  }
+}
+
+bool TableScanPhysicalOperator::compile_predicate(Expression *expr)
+{
+  vector<tuple<const FieldMeta *, CompOp, Value>> comparisons;
+  if (!collect_compiled_predicates(expr, comparisons)) {
+    return false;
+  }
+
+  for (auto &[field_meta, comp, value] : comparisons) {
+    RC rc = compiled_filter_.add(*field_meta, comp, value);
+    ASSERT(OB_SUCC(rc), "comparison should be supported. rc=%s", strrc(rc));
+  }
+  return true;
+}
+
+bool TableScanPhysicalOperator::collect_compiled_predicates(
+    Expression *expr, vector<tuple<const FieldMeta *, CompOp, Value>> &comparisons) const
+{
+  if (expr->type() == ExprType::CONJUNCTION) {
+    auto conjunction_expr = static_cast<ConjunctionExpr *>(expr);
+    if (conjunction_expr->conjunction_type() != ConjunctionExpr::Type::AND || conjunction_expr->children().empty()) {
+      return false;
+    }
+    for (unique_ptr<Expression> &child : conjunction_expr->children()) {
+      if (!collect_compiled_predicates(child.get(), comparisons)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  if (expr->type() != ExprType::COMPARISON) {
+    return false;
+  }
+
+  auto                    comparison_expr = static_cast<ComparisonExpr *>(expr);
+  CompOp                  comp            = comparison_expr->comp();
+  unique_ptr<Expression> &left            = comparison_expr->left();
+  unique_ptr<Expression> &right           = comparison_expr->right();
+
+  const FieldExpr *field_expr = nullptr;
+  const ValueExpr *value_expr = nullptr;
+  if (left->type() == ExprType::FIELD && right->type() == ExprType::VALUE) {
+    field_expr = static_cast<const FieldExpr *>(left.get());
+    value_expr = static_cast<const ValueExpr *>(right.get());
+  } else if (left->type() == ExprType::VALUE && right->type() == ExprType::FIELD) {
+    // `value op field` 转换成 `field op' value`
+    field_expr = static_cast<const FieldExpr *>(right.get());
+    value_expr = static_cast<const ValueExpr *>(left.get());
+    switch (comp) {
+      case LESS_THAN: comp = GREAT_THAN; break;
+      case LESS_EQUAL: comp = GREAT_EQUAL; break;
+      case GREAT_THAN: comp = LESS_THAN; break;
+      case GREAT_EQUAL: comp = LESS_EQUAL; break;
+      default: break;
+    }
+  } else {
+    return false;
+  }
+
+  // 相关子查询中引用的外部表字段不能在这里计算
+  const Field &field = field_expr->field();
+  if (field.table() != table_ || field.meta() == nullptr) {
+    return false;
+  }
+
+  const Value &value = value_expr->get_value();
+  if (!CompiledConditionFilter::support(*field.meta(), comp, value)) {
+    return false;
+  }
+
+  comparisons.emplace_back(field.meta(), comp, value);
+  return true;
 }
 
 void TableScanPhysicalOperator::set_outer_tuple(const Tuple *outer_tuple)
@@ -14,9 +14,11 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include "common/lang/tuple.h"
 #include "common/sys/rc.h"
 #include "sql/operator/physical_operator.h"
 #include "storage/record/record_manager.h"
+#include "storage/common/condition_filter.h"
 #include "storage/record/record_scanner.h"
 #include "common/types.h"
 
@@ -73,7 +75,23 @@ public:
   /// @brief 设置外部查询的 tuple（用于相关子查询）
   void set_outer_tuple(const Tuple *outer_tuple);
 
+  /**
+   * @brief 并行扫描时设置页面片段队列
+   * @details 每个工作线程创建一个算子，使用同一个队列，每个算子只返回自己领取到的页面上的记录。
+   * 会话设置了 parallel_workers 时，GatherPhysicalOperator 在打开子算子之前设置队列
+   */
+  void set_morsel_queue(shared_ptr<PageMorselQueue> morsels) { morsels_ = std::move(morsels); }
+
 private:
+  /**
+   * @brief 把 `字段 op 常量` 以及它们的 AND 编译成存储层的过滤条件
+   * @details 整个表达式都可以编译时才编译，并返回 true，这个表达式就不需要在 tuple 上计算了
+   */
+  bool compile_predicate(Expression *expr);
+  /// @brief 收集可以编译的比较，有任何一个子表达式不能编译时返回 false
+  bool collect_compiled_predicates(
+      Expression *expr, vector<tuple<const FieldMeta *, CompOp, Value>> &comparisons) const;
+
   RC filter(RowTuple &tuple, bool &result);
   /// @brief 更新 composite_tuple_，使其包含外部查询和当前 tuple 的所有字段
   void update_composite_tuple();
@@ -83,9 +101,13 @@ private:
   Trx                           *trx_   = nullptr;
   ReadWriteMode                  mode_  = ReadWriteMode::READ_WRITE;
   RecordScanner                 *record_scanner_;
-  Record                         current_record_;
+  shared_ptr<PageMorselQueue>    morsels_;
+  Record                         scan_record_;     ///< 扫描器返回的记录，直接引用页面上的数据
+  Record                         current_record_;  ///< 通过过滤条件的记录
   RowTuple                       tuple_;
   vector<unique_ptr<Expression>> predicates_;  // TODO chang predicate to table tuple filter
+  CompiledConditionFilter        compiled_filter_;  ///< 从 predicates_ 中编译出来的过滤条件，在原始记录上计算
+  bool                           scanner_filter_ = false;  ///< 扫描器是否已经使用 compiled_filter_ 过滤了记录
   const Tuple                    *outer_tuple_ = nullptr;  ///< 外部查询的 tuple（用于相关子查询）
   unique_ptr<CompositeTuple>     composite_tuple_;  ///< 组合外部查询和当前 tuple 的 CompositeTuple
 };
@@ -16,18 +16,36 @@ using namespace std;
 
 RC TableScanVecPhysicalOperator::open(Trx *trx)
 {
-  RC rc = table_->get_chunk_scanner(chunk_scanner_, trx, mode_);
+  RC rc = RC::SUCCESS;
+  if (morsels_ != nullptr) {
+    rc = table_->get_parallel_chunk_scanner(chunk_scanner_, trx, mode_, morsels_);
+  } else {
+    rc = table_->get_chunk_scanner(chunk_scanner_, trx, mode_);
+  }
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to get chunk scanner", strrc(rc));
     return rc;
   }
-  // TODO: don't need to fetch all columns from record manager
-  for (int i = 0; i < table_->table_meta().field_num(); ++i) {
-    all_columns_.add_column(
-        make_unique<Column>(*table_->table_meta().field(i)), table_->table_meta().field(i)->field_id());
-    filterd_columns_.add_column(
-        make_unique<Column>(*table_->table_meta().field(i)), table_->table_meta().field(i)->field_id());
+
+  const TableMeta &table_meta = table_->table_meta();
+  if (column_ids_.empty()) {
+    for (int i = 0; i < table_meta.field_num(); ++i) {
+      column_ids_.push_back(table_meta.field(i)->field_id());
+    }
+  }
+
+  for (int column_id : column_ids_) {
+    const int index = table_meta.field_index(column_id);
+    if (index < 0) {
+      LOG_WARN("invalid column id. table=%s, column_id=%d", table_->name(), column_id);
+      return RC::INVALID_ARGUMENT;
+    }
+    const FieldMeta *field_meta = table_meta.field(index);
+    all_columns_.add_column(make_unique<Column>(*field_meta), field_meta->field_id());
+    filterd_columns_.add_column(make_unique<Column>(*field_meta), field_meta->field_id());
   }
+
+  chunk_scanner_.set_zone_predicates(make_zone_predicates());
   return rc;
 }
 
@@ -47,15 +65,26 @@ RC TableScanVecPhysicalOperator::next(Chunk &chunk)
         LOG_TRACE("filtered failed=%s", strrc(rc));
         return rc;
       }
-      // TODO: if all setted, it doesn't need to set one by one
-      for (int i = 0; i < all_columns_.rows(); i++) {
-        if (select_[i] == 0) {
+      // 连续选中的行一次性复制
+      const int rows = all_columns_.rows();
+      for (int start = 0; start < rows;) {
+        if (select_[start] == 0) {
+          start++;
           continue;
         }
+        int end = start + 1;
+        while (end < rows && select_[end] != 0) {
+          end++;
+        }
         for (int j = 0; j < all_columns_.column_num(); j++) {
-          filterd_columns_.column(j).append_value(
-              all_columns_.column(filterd_columns_.column_ids(j)).get_value(i));
+          Column &column = all_columns_.column(j);
+          rc = filterd_columns_.column(j).append(column.data() + start * column.attr_len(), end - start);
+          if (OB_FAIL(rc)) {
+            LOG_WARN("failed to append filtered rows. rc=%s", strrc(rc));
+            return rc;
+          }
         }
+        start = end;
       }
       chunk.reference(filterd_columns_);
     }
@@ -72,6 +101,43 @@ void TableScanVecPhysicalOperator::set_predicates(vector<unique_ptr<Expression>>
   predicates_ = std::move(exprs);
 }
 
+vector<ZonePredicate> TableScanVecPhysicalOperator::make_zone_predicates() const
+{
+  vector<ZonePredicate> zone_predicates;
+  for (const unique_ptr<Expression> &expr : predicates_) {
+    if (expr->type() != ExprType::COMPARISON) {
+      continue;
+    }
+
+    auto      *cmp_expr = static_cast<ComparisonExpr *>(expr.get());
+    Expression *left     = cmp_expr->left().get();
+    Expression *right    = cmp_expr->right().get();
+    CompOp      comp     = cmp_expr->comp();
+    if (left->type() == ExprType::VALUE && right->type() == ExprType::FIELD) {
+      // 常量在左边时交换位置
+      swap(left, right);
+      switch (comp) {
+        case LESS_THAN: comp = GREAT_THAN; break;
+        case LESS_EQUAL: comp = GREAT_EQUAL; break;
+        case GREAT_THAN: comp = LESS_THAN; break;
+        case GREAT_EQUAL: comp = LESS_EQUAL; break;
+        default: break;
+      }
+    }
+    if (left->type() != ExprType::FIELD || right->type() != ExprType::VALUE) {
+      continue;
+    }
+
+    ZonePredicate zone_predicate;
+    // zone map 按照页面上列的下标记录，有事务字段时与 field_id 不同
+    zone_predicate.col_id = table_->table_meta().field_index(static_cast<FieldExpr *>(left)->field().meta()->field_id());
+    zone_predicate.comp   = comp;
+    zone_predicate.value  = static_cast<ValueExpr *>(right)->get_value();
+    zone_predicates.push_back(std::move(zone_predicate));
+  }
+  return zone_predicates;
+}
+
 RC TableScanVecPhysicalOperator::filter(Chunk &chunk)
 {
   RC rc = RC::SUCCESS;
@@ -38,15 +38,36 @@ public:
 
   void set_predicates(vector<unique_ptr<Expression>> &&exprs);
 
+  /**
+   * @brief 指定需要读取的列
+   * @details 使用字段的 field_id，事务字段的 field_id 是负数。只会从存储中读取这些列，
+   * 其它的列不会出现在返回的 chunk 中。为空时读取所有的列
+   */
+  void set_column_ids(vector<int> &&column_ids) { column_ids_ = std::move(column_ids); }
+
+  /**
+   * @brief 并行扫描时设置页面片段队列
+   * @details 每个工作线程创建一个算子，使用同一个队列，每个算子只返回自己领取到的页面上的记录。
+   * 会话设置了 parallel_workers 时，GatherPhysicalOperator 在打开子算子之前设置队列
+   */
+  void set_morsel_queue(shared_ptr<PageMorselQueue> morsels) { morsels_ = std::move(morsels); }
+
 private:
   RC filter(Chunk &chunk);
 
+  /**
+   * @brief 从下推的过滤条件中找出 `字段 op 常量` 形式的比较，用于根据 zone map 跳过页面
+   */
+  vector<ZonePredicate> make_zone_predicates() const;
+
 private:
   Table                         *table_ = nullptr;
   ReadWriteMode                  mode_  = ReadWriteMode::READ_WRITE;
   ChunkFileScanner               chunk_scanner_;
+  shared_ptr<PageMorselQueue>    morsels_;
   Chunk                          all_columns_;
   Chunk                          filterd_columns_;
+  vector<int>                    column_ids_;
   vector<uint8_t>                select_;
   vector<unique_ptr<Expression>> predicates_;
 };
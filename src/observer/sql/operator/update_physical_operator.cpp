@@ -61,6 +61,10 @@ RC UpdatePhysicalOperator::open(Trx *trx)
     }
     // 通过事务更新记录：将表中的old_rec替换为new_rec
     rc = trx_->update_record(table_, old_rec, new_rec);
+    if (rc == RC::LOCKED_CONCURRENCY_CONFLICT && trx_->autocommit()) {
+      // 读到的版本已经被其它事务修改并提交，自动提交的语句在最新的版本上重新执行
+      rc = update_latest_version(old_rec.rid());
+    }
     if (OB_FAIL(rc)) {
       LOG_WARN("failed to update record by transaction. rc=%s", strrc(rc));
       return rc;
@@ -111,25 +115,18 @@ RC UpdatePhysicalOperator::build_updated_record(const Record &old_record, Record
     }
 
     string text = real_value.get_string();
-    int64_t offset = 0;
     int64_t length = static_cast<int64_t>(text.size());
     // TEXT 最多保留 4096 字节，多余部分截断
     static const int64_t MAX_TEXT_LENGTH = 4096;
     if (length > MAX_TEXT_LENGTH) {
       length = MAX_TEXT_LENGTH;
     }
-    RC rc = table_->lob_handler()->insert_data(offset, length, text.c_str());
+    RC rc = table_->lob_handler()->write_field(
+        text.c_str(), length, new_record.data() + field_meta_->offset(), field_meta_->len());
     if (OB_FAIL(rc)) {
-      LOG_WARN("failed to insert lob data for update. field=%s rc=%s", field_meta_->name(), strrc(rc));
+      LOG_WARN("failed to write lob data for update. field=%s rc=%s", field_meta_->name(), strrc(rc));
       return rc;
     }
-
-    LobRef ref;
-    ref.offset   = offset;
-    ref.length   = static_cast<int32_t>(length);
-    ref.reserved = 0;
-
-    memcpy(new_record.data() + field_meta_->offset(), &ref, sizeof(ref));
     return RC::SUCCESS;
   }
 
@@ -148,6 +145,44 @@ RC UpdatePhysicalOperator::build_updated_record(const Record &old_record, Record
 }
 
 
+RC UpdatePhysicalOperator::update_latest_version(const RID &rid)
+{
+  Record latest_rec;
+  RC     rc = trx_->read_latest_version(table_, rid, latest_rec);
+  if (rc == RC::RECORD_NOT_EXIST) {
+    // 已经被其它事务删除，跳过这条记录
+    return RC::SUCCESS;
+  }
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  // 最新的版本可能已经不满足条件了
+  if (recheck_predicate_ != nullptr) {
+    RowTuple tuple;
+    tuple.set_schema(table_, table_->table_meta().field_metas());
+    tuple.set_record(&latest_rec);
+    Value value;
+    rc = recheck_predicate_->get_value(tuple, value);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to recheck predicate on latest version. rid=%s, rc=%s", rid.to_string().c_str(), strrc(rc));
+      return rc;
+    }
+    if (!value.get_boolean()) {
+      return RC::SUCCESS;
+    }
+  }
+
+  Record new_rec;
+  rc = build_updated_record(latest_rec, new_rec);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to build updated record. rc=%s", strrc(rc));
+    return rc;
+  }
+  return trx_->update_record(table_, latest_rec, new_rec);
+}
+
+
 /**
  * @brief 读取下一条记录（UPDATE算子是批量执行的，此处直接返回EOF表示无更多记录）
  * @return RC 固定返回RECORD_EOF
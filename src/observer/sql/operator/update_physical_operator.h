@@ -1,5 +1,6 @@
 #pragma once
 
+#include "sql/expr/expression.h"
 #include "sql/operator/physical_operator.h"
 #include "storage/field/field.h"
 #include "common/value.h"
@@ -20,13 +21,24 @@ public:
 
   Tuple *current_tuple() override { return nullptr; }
 
+  /**
+   * @brief 设置语句的过滤条件，在记录最新提交的版本上重新检查时使用
+   */
+  void set_recheck_predicate(unique_ptr<Expression> predicate) { recheck_predicate_ = std::move(predicate); }
+
 private:
   RC build_updated_record(const Record &old_record, Record &new_record);
 
+  /**
+   * @brief 自动提交的语句读到的版本已经被其它事务修改，在最新提交的版本上重新检查条件并更新
+   */
+  RC update_latest_version(const RID &rid);
+
 private:
   Table             *table_      = nullptr;
   const FieldMeta   *field_meta_ = nullptr;
   Value              value_;
   Trx               *trx_        = nullptr;
   vector<Record>     records_;
+  unique_ptr<Expression> recheck_predicate_;
 };
\ No newline at end of file
@@ -14,6 +14,8 @@ See the Mulan PSL v2 for more details. */
 
 #include "sql/optimizer/logical_plan_generator.h"
 
+#include "common/lang/algorithm.h"
+#include "common/lang/unordered_map.h"
 #include "common/log/log.h"
 
 #include "sql/operator/calc_logical_operator.h"
@@ -210,6 +212,8 @@ RC LogicalPlanGenerator::create_plan(SelectStmt *select_stmt, unique_ptr<Logical
 
   last_oper = &project_oper;
 
+  bind_referenced_fields(**last_oper);
+
   logical_operator = std::move(*last_oper);
   return RC::SUCCESS;
 }
@@ -480,3 +484,96 @@ RC LogicalPlanGenerator::create_order_by_plan(SelectStmt *select_stmt, unique_pt
   logical_operator = std::move(order_by_oper);
   return RC::SUCCESS;
 }
+
+void LogicalPlanGenerator::bind_referenced_fields(LogicalOperator &root)
+{
+  vector<TableGetLogicalOperator *> table_gets;
+  vector<const FieldExpr *>         field_exprs;
+  bool                              known = true;
+
+  function<RC(unique_ptr<Expression> &)> field_collector = [&](unique_ptr<Expression> &expr) -> RC {
+    switch (expr->type()) {
+      case ExprType::FIELD: {
+        field_exprs.push_back(static_cast<const FieldExpr *>(expr.get()));
+        return RC::SUCCESS;
+      }
+      // 子查询中引用了哪些外部字段是不知道的
+      case ExprType::SUBQUERY:
+      case ExprType::UNBOUND_FIELD:
+      case ExprType::UNBOUND_AGGREGATION:
+      case ExprType::UNBOUND_SUBQUERY: {
+        known = false;
+        return RC::SUCCESS;
+      }
+      default: {
+        return ExpressionIterator::iterate_child_expr(*expr, field_collector);
+      }
+    }
+  };
+
+  function<void(LogicalOperator &)> oper_visitor = [&](LogicalOperator &oper) {
+    for (unique_ptr<Expression> &expr : oper.expressions()) {
+      field_collector(expr);
+    }
+
+    switch (oper.type()) {
+      case LogicalOperatorType::TABLE_GET: {
+        auto &table_get = static_cast<TableGetLogicalOperator &>(oper);
+        table_gets.push_back(&table_get);
+        for (unique_ptr<Expression> &expr : table_get.predicates()) {
+          field_collector(expr);
+        }
+      } break;
+      case LogicalOperatorType::GROUP_BY: {
+        // 聚合表达式都是投影表达式的一部分，这里只需要关注分组表达式
+        for (unique_ptr<Expression> &expr : static_cast<GroupByLogicalOperator &>(oper).group_by_expressions()) {
+          field_collector(expr);
+        }
+      } break;
+      case LogicalOperatorType::ORDER_BY: {
+        for (auto &expr_pair : static_cast<OrderByLogicalOperator &>(oper).order_by_expressions()) {
+          field_collector(expr_pair.first);
+        }
+      } break;
+      case LogicalOperatorType::JOIN: {
+        for (unique_ptr<Expression> &expr : static_cast<JoinLogicalOperator &>(oper).get_join_predicates()) {
+          field_collector(expr);
+        }
+      } break;
+      default: break;
+    }
+
+    for (unique_ptr<LogicalOperator> &child : oper.children()) {
+      oper_visitor(*child);
+    }
+  };
+
+  oper_visitor(root);
+  if (!known) {
+    return;
+  }
+
+  unordered_map<const Table *, vector<const FieldMeta *>> table_fields;
+  for (TableGetLogicalOperator *table_get : table_gets) {
+    table_fields[table_get->table()];
+  }
+
+  for (const FieldExpr *field_expr : field_exprs) {
+    auto iter = table_fields.find(field_expr->field().table());
+    if (iter == table_fields.end()) {
+      // 引用了外部查询中的表，是相关子查询
+      return;
+    }
+
+    vector<const FieldMeta *> &fields = iter->second;
+    const FieldMeta           *meta   = field_expr->field().meta();
+    if (find(fields.begin(), fields.end(), meta) == fields.end()) {
+      fields.push_back(meta);
+    }
+  }
+
+  for (TableGetLogicalOperator *table_get : table_gets) {
+    vector<const FieldMeta *> fields = table_fields[table_get->table()];
+    table_get->set_referenced_fields(std::move(fields));
+  }
+}
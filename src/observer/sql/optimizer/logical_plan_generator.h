@@ -48,5 +48,10 @@ private:
   RC create_group_by_plan(SelectStmt *select_stmt, unique_ptr<LogicalOperator> &logical_operator);
   RC create_order_by_plan(SelectStmt *select_stmt, unique_ptr<LogicalOperator> &logical_operator);
 
+  /**
+   * @brief 收集查询计划中每张表被引用的字段，记录到对应的表扫描算子上
+   */
+  void bind_referenced_fields(LogicalOperator &root);
+
   int implicit_cast_cost(AttrType from, AttrType to);
 };
@@ -12,8 +12,10 @@ See the Mulan PSL v2 for more details. */
 // Created by Wangyunlai on 2022/12/14.
 //
 
+#include "common/lang/algorithm.h"
 #include "common/log/log.h"
 #include "sql/expr/expression.h"
+#include "sql/expr/expression_iterator.h"
 #include "session/session.h"
 #include "sql/operator/aggregate_vec_physical_operator.h"
 #include "sql/operator/calc_logical_operator.h"
@@ -24,9 +26,11 @@ See the Mulan PSL v2 for more details. */
 #include "sql/operator/update_physical_operator.h"
 #include "sql/operator/explain_logical_operator.h"
 #include "sql/operator/explain_physical_operator.h"
+#include "sql/operator/gather_physical_operator.h"
 #include "sql/operator/expr_vec_physical_operator.h"
 #include "sql/operator/group_by_vec_physical_operator.h"
 #include "sql/operator/hash_join_physical_operator.h"
+#include "sql/operator/index_only_scan_physical_operator.h"
 #include "sql/operator/index_scan_physical_operator.h"
 #include "sql/operator/insert_logical_operator.h"
 #include "sql/operator/insert_physical_operator.h"
@@ -47,6 +51,9 @@ See the Mulan PSL v2 for more details. */
 #include "sql/operator/order_by_physical_operator.h"
 #include "sql/operator/table_scan_vec_physical_operator.h"
 #include "sql/optimizer/physical_plan_generator.h"
+#include "storage/db/db.h"
+#include "storage/index/index.h"
+#include "storage/trx/trx.h"
 
 using namespace std;
 
@@ -132,6 +139,65 @@ RC PhysicalPlanGenerator::create_vec(LogicalOperator &logical_operator, unique_p
   return rc;
 }
 
+/**
+ * @brief 复制 UPDATE/DELETE 子计划中的过滤条件
+ * @details 自动提交的语句修改记录时，记录可能已经被其它事务修改，需要在最新提交的版本上重新检查条件。
+ * 条件可能已经下推到了 TableGet 中，要在创建子算子之前复制
+ */
+static unique_ptr<Expression> copy_filter(LogicalOperator &oper)
+{
+  vector<unique_ptr<Expression>> predicates;
+  vector<LogicalOperator *>      opers{&oper};
+  while (!opers.empty()) {
+    LogicalOperator *current = opers.back();
+    opers.pop_back();
+    if (current->type() == LogicalOperatorType::TABLE_GET) {
+      for (const unique_ptr<Expression> &expr : static_cast<TableGetLogicalOperator *>(current)->predicates()) {
+        predicates.push_back(expr->copy());
+      }
+    } else if (current->type() == LogicalOperatorType::PREDICATE) {
+      for (const unique_ptr<Expression> &expr : current->expressions()) {
+        predicates.push_back(expr->copy());
+      }
+    }
+    for (unique_ptr<LogicalOperator> &child : current->children()) {
+      opers.push_back(child.get());
+    }
+  }
+
+  if (predicates.empty()) {
+    return nullptr;
+  }
+  return make_unique<ConjunctionExpr>(ConjunctionExpr::Type::AND, predicates);
+}
+
+/**
+ * @brief 为字段上的比较条件选择一个索引
+ * @details 等值查询优先使用哈希索引，其它比较只能使用B+树索引
+ */
+static Index *choose_index(Table *table, const char *field_name, CompOp comp)
+{
+  const TableMeta &table_meta = table->table_meta();
+  const IndexMeta *chosen     = nullptr;
+  for (int i = 0; i < table_meta.index_num(); i++) {
+    const IndexMeta *index_meta = table_meta.index(i);
+    if (0 != strcmp(index_meta->field(), field_name)) {
+      continue;
+    }
+
+    if (index_meta->type() == IndexType::HASH) {
+      if (comp == EQUAL_TO) {
+        chosen = index_meta;
+        break;
+      }
+    } else if (chosen == nullptr) {
+      chosen = index_meta;
+    }
+  }
+
+  return chosen == nullptr ? nullptr : table->find_index(chosen->name());
+}
+
 RC PhysicalPlanGenerator::create_plan(TableGetLogicalOperator &table_get_oper, unique_ptr<PhysicalOperator> &oper, Session* session)
 {
   vector<unique_ptr<Expression>> &predicates = table_get_oper.predicates();
@@ -171,14 +237,24 @@ RC PhysicalPlanGenerator::create_plan(TableGetLogicalOperator &table_get_oper, u
       }
 
       const Field &field = field_expr->field();
-      index              = table->find_index_by_field(field.field_name());
+      index              = choose_index(table, field.field_name(), comparison_expr->comp());
       if (nullptr != index) {
         break;
       }
     }
   }
 
-  if (index != nullptr) {
+  if (index != nullptr && can_use_index_only_scan(table_get_oper, index, session)) {
+    ASSERT(value_expr != nullptr, "got an index but value expr is null ?");
+
+    const Value &value           = value_expr->get_value();
+    auto        *index_scan_oper = new IndexOnlyScanPhysicalOperator(
+        table, index, &value, true /*left_inclusive*/, &value, true /*right_inclusive*/);
+
+    index_scan_oper->set_predicates(std::move(predicates));
+    oper = unique_ptr<PhysicalOperator>(index_scan_oper);
+    LOG_TRACE("use index only scan");
+  } else if (index != nullptr) {
     ASSERT(value_expr != nullptr, "got an index but value expr is null ?");
 
     const Value               &value           = value_expr->get_value();
@@ -193,6 +269,20 @@ RC PhysicalPlanGenerator::create_plan(TableGetLogicalOperator &table_get_oper, u
     index_scan_oper->set_predicates(std::move(predicates));
     oper = unique_ptr<PhysicalOperator>(index_scan_oper);
     LOG_TRACE("use index scan");
+  } else if (int workers = parallel_scan_workers(table_get_oper, session); workers > 1) {
+    // 每个工作线程一个扫描算子，各自持有一份过滤条件
+    auto gather_oper = make_unique<GatherPhysicalOperator>(table, false /*vectorized*/);
+    for (int i = 0; i < workers; i++) {
+      vector<unique_ptr<Expression>> worker_predicates;
+      for (const unique_ptr<Expression> &expr : predicates) {
+        worker_predicates.push_back(expr->copy());
+      }
+      auto table_scan_oper = make_unique<TableScanPhysicalOperator>(table, table_get_oper.read_write_mode());
+      table_scan_oper->set_predicates(std::move(worker_predicates));
+      gather_oper->add_child(std::move(table_scan_oper));
+    }
+    oper = std::move(gather_oper);
+    LOG_TRACE("use parallel table scan. workers=%d", workers);
   } else {
     auto table_scan_oper = new TableScanPhysicalOperator(table, table_get_oper.read_write_mode());
     table_scan_oper->set_predicates(std::move(predicates));
@@ -203,6 +293,54 @@ RC PhysicalPlanGenerator::create_plan(TableGetLogicalOperator &table_get_oper, u
   return RC::SUCCESS;
 }
 
+bool PhysicalPlanGenerator::can_use_index_only_scan(
+    TableGetLogicalOperator &table_get_oper, Index *index, Session *session)
+{
+  if (table_get_oper.read_write_mode() != ReadWriteMode::READ_ONLY || !index->support_index_only_scan()) {
+    return false;
+  }
+
+  if (!table_get_oper.referenced_fields_known()) {
+    return false;
+  }
+
+  // 索引中没有记录的事务可见性信息，MVCC 需要回表检查每条记录
+  // 只看事务管理器的类型，不能调用 current_trx，否则会在生成计划时创建事务
+  if (nullptr == session || nullptr == session->get_current_db() ||
+      session->get_current_db()->trx_kit().type() != TrxKit::Type::VACUOUS) {
+    return false;
+  }
+
+  for (const FieldMeta *field_meta : table_get_oper.referenced_fields()) {
+    if (0 != strcmp(field_meta->name(), index->index_meta().field())) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int PhysicalPlanGenerator::parallel_scan_workers(TableGetLogicalOperator &table_get_oper, Session *session)
+{
+  if (nullptr == session || session->parallel_workers() <= 1 ||
+      table_get_oper.read_write_mode() != ReadWriteMode::READ_ONLY) {
+    return 1;
+  }
+
+  // 子查询要使用当前会话执行，工作线程中没有会话
+  bool                                   has_subquery = false;
+  function<RC(unique_ptr<Expression> &)> subquery_finder = [&](unique_ptr<Expression> &expr) -> RC {
+    if (expr->type() == ExprType::SUBQUERY || expr->type() == ExprType::UNBOUND_SUBQUERY) {
+      has_subquery = true;
+      return RC::SUCCESS;
+    }
+    return ExpressionIterator::iterate_child_expr(*expr, subquery_finder);
+  };
+  for (unique_ptr<Expression> &expr : table_get_oper.predicates()) {
+    subquery_finder(expr);
+  }
+  return has_subquery ? 1 : session->parallel_workers();
+}
+
 RC PhysicalPlanGenerator::create_plan(PredicateLogicalOperator &pred_oper, unique_ptr<PhysicalOperator> &oper, Session* session)
 {
   vector<unique_ptr<LogicalOperator>> &children_opers = pred_oper.children();
@@ -269,9 +407,11 @@ RC PhysicalPlanGenerator::create_plan(DeleteLogicalOperator &delete_oper, unique
 
   unique_ptr<PhysicalOperator> child_physical_oper;
 
-  RC rc = RC::SUCCESS;
+  RC                     rc = RC::SUCCESS;
+  unique_ptr<Expression> recheck_predicate;
   if (!child_opers.empty()) {
     LogicalOperator *child_oper = child_opers.front().get();
+    recheck_predicate           = copy_filter(*child_oper);
 
     rc = create(*child_oper, child_physical_oper, session);
     if (rc != RC::SUCCESS) {
@@ -280,7 +420,9 @@ RC PhysicalPlanGenerator::create_plan(DeleteLogicalOperator &delete_oper, unique
     }
   }
 
-  oper = unique_ptr<PhysicalOperator>(new DeletePhysicalOperator(delete_oper.table()));
+  auto delete_phy_oper = new DeletePhysicalOperator(delete_oper.table());
+  delete_phy_oper->set_recheck_predicate(std::move(recheck_predicate));
+  oper = unique_ptr<PhysicalOperator>(delete_phy_oper);
 
   if (child_physical_oper) {
     oper->add_child(std::move(child_physical_oper));
@@ -294,9 +436,11 @@ RC PhysicalPlanGenerator::create_plan(UpdateLogicalOperator &update_oper, unique
 
   unique_ptr<PhysicalOperator> child_physical_oper;
 
-  RC rc = RC::SUCCESS;
+  RC                     rc = RC::SUCCESS;
+  unique_ptr<Expression> recheck_predicate;
   if (!child_opers.empty()) {
     LogicalOperator *child_oper = child_opers.front().get();
+    recheck_predicate           = copy_filter(*child_oper);
 
     rc = create(*child_oper, child_physical_oper, session);
     if (rc != RC::SUCCESS) {
@@ -312,8 +456,9 @@ RC PhysicalPlanGenerator::create_plan(UpdateLogicalOperator &update_oper, unique
     return RC::SCHEMA_FIELD_NOT_EXIST;
   }
 
-  oper = unique_ptr<PhysicalOperator>(
-      new UpdatePhysicalOperator(table, field_meta, update_oper.value()));
+  auto update_phy_oper = new UpdatePhysicalOperator(table, field_meta, update_oper.value());
+  update_phy_oper->set_recheck_predicate(std::move(recheck_predicate));
+  oper = unique_ptr<PhysicalOperator>(update_phy_oper);
 
   if (child_physical_oper) {
     oper->add_child(std::move(child_physical_oper));
@@ -448,8 +593,40 @@ RC PhysicalPlanGenerator::create_vec_plan(TableGetLogicalOperator &table_get_ope
 {
   vector<unique_ptr<Expression>> &predicates = table_get_oper.predicates();
   Table *table = table_get_oper.table();
+
+  // 只读取查询中用到的列。一列都没有用到时(比如 count(*))，也需要读取一列来得到行数
+  vector<int> column_ids;
+  if (table_get_oper.referenced_fields_known()) {
+    for (const FieldMeta *field_meta : table_get_oper.referenced_fields()) {
+      column_ids.push_back(field_meta->field_id());
+    }
+    if (column_ids.empty()) {
+      const TableMeta &table_meta = table->table_meta();
+      column_ids.push_back(table_meta.field(table_meta.sys_field_num())->field_id());
+    }
+    sort(column_ids.begin(), column_ids.end());
+  }
+
+  if (int workers = parallel_scan_workers(table_get_oper, session); workers > 1) {
+    auto gather_oper = make_unique<GatherPhysicalOperator>(table, true /*vectorized*/);
+    for (int i = 0; i < workers; i++) {
+      vector<unique_ptr<Expression>> worker_predicates;
+      for (const unique_ptr<Expression> &expr : predicates) {
+        worker_predicates.push_back(expr->copy());
+      }
+      auto table_scan_oper = make_unique<TableScanVecPhysicalOperator>(table, table_get_oper.read_write_mode());
+      table_scan_oper->set_predicates(std::move(worker_predicates));
+      table_scan_oper->set_column_ids(vector<int>(column_ids));
+      gather_oper->add_child(std::move(table_scan_oper));
+    }
+    oper = std::move(gather_oper);
+    LOG_TRACE("use parallel vectorized table scan. workers=%d", workers);
+    return RC::SUCCESS;
+  }
+
   TableScanVecPhysicalOperator *table_scan_oper = new TableScanVecPhysicalOperator(table, table_get_oper.read_write_mode());
   table_scan_oper->set_predicates(std::move(predicates));
+  table_scan_oper->set_column_ids(std::move(column_ids));
   oper = unique_ptr<PhysicalOperator>(table_scan_oper);
   LOG_TRACE("use vectorized table scan");
 
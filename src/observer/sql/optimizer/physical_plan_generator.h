@@ -19,6 +19,7 @@ See the Mulan PSL v2 for more details. */
 #include "sql/operator/physical_operator.h"
 
 class Session;
+class Index;
 class TableGetLogicalOperator;
 class PredicateLogicalOperator;
 class ProjectLogicalOperator;
@@ -65,4 +66,16 @@ private:
 
   // TODO: remove this and add CBO rules
   bool can_use_hash_join(JoinLogicalOperator &logical_oper);
+
+  /**
+   * @brief 判断是否可以只扫描索引，不回表读取记录
+   * @details 查询中引用到的字段都在索引中，并且不需要通过记录检查事务可见性
+   */
+  bool can_use_index_only_scan(TableGetLogicalOperator &logical_oper, Index *index, Session *session);
+
+  /**
+   * @brief 表扫描使用几个线程
+   * @details 会话设置了 parallel_workers，扫描是只读的，并且过滤条件中没有子查询时才并行扫描，否则返回1
+   */
+  int parallel_scan_workers(TableGetLogicalOperator &logical_oper, Session *session);
 };
@@ -28,6 +28,16 @@ class Expression;
 
 // 前向声明
 struct SelectSqlNode;
+/**
+ * @brief 查看模块的运行状态，比如 SHOW VACUUM
+ * @ingroup SQLParser
+ * @details 模块名按照标识符解析，不需要增加关键字
+ */
+struct ShowStatusSqlNode
+{
+  string name;  ///< 模块名
+};
+
 class ParsedSqlNode;
 class ParsedSqlNode;
 
@@ -210,10 +220,11 @@ struct AnalyzeTableSqlNode
  */
 struct CreateIndexSqlNode
 {
-  string index_name;      ///< Index name
-  string relation_name;   ///< Relation name
-  string attribute_name;  ///< Attribute name
-  bool   Unique;          ///< 是否是唯一索引
+  string index_name;        ///< Index name
+  string relation_name;     ///< Relation name
+  string attribute_name;    ///< Attribute name
+  bool   Unique;            ///< 是否是唯一索引
+  string index_method;      ///< USING 后面的索引类型(btree 或 hash)，没有指定时为空
 };
 
 /**
@@ -305,6 +316,7 @@ enum SqlCommandFlag
   SCF_DROP_INDEX,
   SCF_SYNC,
   SCF_SHOW_TABLES,
+  SCF_SHOW_STATUS,  ///< 查看模块的运行状态
   SCF_DESC_TABLE,
   SCF_BEGIN,  ///< 事务开始语句，可以在这里扩展只读事务
   SCF_COMMIT,
@@ -339,6 +351,7 @@ public:
   LoadDataSqlNode     load_data;
   ExplainSqlNode      explain;
   SetVariableSqlNode  set_variable;
+  ShowStatusSqlNode   show_status;
   vector<unique_ptr<ParsedSqlNode>> subquery_nodes;  ///< 保存子查询的 ParsedSqlNode，确保在使用期间不被释放
 
 public:
@@ -33,7 +33,10 @@ RC ResolveStage::handle_request(SQLStageEvent *sql_event)
   SessionEvent *session_event = sql_event->session_event();
   SqlResult    *sql_result    = session_event->sql_result();
 
-  Db *db = session_event->session()->get_current_db();
+  Session *session = session_event->session();
+  session->set_read_only_statement(false);
+
+  Db *db = session->get_current_db();
   if (nullptr == db) {
     LOG_ERROR("cannot find current db");
     rc = RC::SCHEMA_DB_NOT_EXIST;
@@ -53,6 +56,7 @@ RC ResolveStage::handle_request(SQLStageEvent *sql_event)
   }
 
   sql_event->set_stmt(stmt);
+  session->set_read_only_statement(stmt != nullptr && stmt->type() == StmtType::SELECT);
 
   return rc;
 }
@@ -198,6 +198,7 @@ UnboundAggregateExpr *create_aggregate_expression(const char *aggregate_name,
 %type <condition_list>      where
 %type <condition_list>      condition_list
 %type <cstring>             storage_format
+%type <cstring>             index_using
 %type <key_list>            primary_key
 %type <key_list>            attr_list
 %type <relation_list>       join_rela
@@ -221,6 +222,7 @@ UnboundAggregateExpr *create_aggregate_expression(const char *aggregate_name,
 %type <sql_node>            drop_table_stmt
 %type <sql_node>            analyze_table_stmt
 %type <sql_node>            show_tables_stmt
+%type <sql_node>            show_status_stmt
 %type <sql_node>            desc_table_stmt
 %type <sql_node>            create_index_stmt
 %type <sql_node>            drop_index_stmt
@@ -259,6 +261,7 @@ command_wrapper:
   | drop_table_stmt
   | analyze_table_stmt
   | show_tables_stmt
+  | show_status_stmt
   | desc_table_stmt
   | create_index_stmt
   | drop_index_stmt
@@ -327,6 +330,13 @@ show_tables_stmt:
     }
     ;
 
+show_status_stmt:
+    SHOW ID {
+      $$ = new ParsedSqlNode(SCF_SHOW_STATUS);
+      $$->show_status.name = $2;
+    }
+    ;
+
 desc_table_stmt:
     DESC ID  {
       $$ = new ParsedSqlNode(SCF_DESC_TABLE);
@@ -335,7 +345,7 @@ desc_table_stmt:
     ;
 
 create_index_stmt:    /*create index 语句的语法解析树*/
-    CREATE INDEX ID ON ID LBRACE ID RBRACE
+    CREATE INDEX ID ON ID LBRACE ID RBRACE index_using
     {
       $$ = new ParsedSqlNode(SCF_CREATE_INDEX);
       CreateIndexSqlNode &create_index = $$->create_index;
@@ -343,8 +353,11 @@ create_index_stmt:    /*create index 语句的语法解析树*/
       create_index.relation_name = $5;
       create_index.attribute_name = $7;
       create_index.Unique = false;
+      if ($9 != nullptr) {
+        create_index.index_method = $9;
+      }
     }
-    | CREATE UNIQUE INDEX ID ON ID LBRACE ID RBRACE
+    | CREATE UNIQUE INDEX ID ON ID LBRACE ID RBRACE index_using
     {
       $$ = new ParsedSqlNode(SCF_CREATE_INDEX);
       CreateIndexSqlNode &create_index = $$->create_index;
@@ -352,6 +365,25 @@ create_index_stmt:    /*create index 语句的语法解析树*/
       create_index.relation_name = $6;
       create_index.attribute_name = $8;
       create_index.Unique = true;
+      if ($10 != nullptr) {
+        create_index.index_method = $10;
+      }
+    }
+    ;
+
+/* USING 和索引类型都按照标识符解析，不增加关键字，表名和字段名仍然可以叫 using 或者 hash */
+index_using:
+    /* empty */
+    {
+      $$ = nullptr;
+    }
+    | ID ID
+    {
+      if (0 != strcasecmp($1, "using")) {
+        yyerror(&@$, sql_string, sql_result, scanner, "expect USING before the index method");
+        YYERROR;
+      }
+      $$ = $2;
     }
     ;
 
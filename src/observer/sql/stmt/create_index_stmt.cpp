@@ -53,6 +53,14 @@ RC CreateIndexStmt::create(Db *db, const CreateIndexSqlNode &create_index, Stmt
     return RC::SCHEMA_INDEX_NAME_REPEAT;
   }
 
-  stmt = new CreateIndexStmt(table, field_meta, create_index.index_name, create_index.Unique);
+  IndexType     index_type = IndexType::BPLUS_TREE;
+  const string &method     = create_index.index_method;
+  if (0 == strcasecmp(method.c_str(), "hash")) {
+    index_type = IndexType::HASH;
+  } else if (!method.empty() && 0 != strcasecmp(method.c_str(), "btree")) {
+    LOG_WARN("unsupported index method. index name=%s, method=%s", create_index.index_name.c_str(), method.c_str());
+    return RC::INVALID_ARGUMENT;
+  }
+  stmt = new CreateIndexStmt(table, field_meta, create_index.index_name, create_index.Unique, index_type);
   return RC::SUCCESS;
 }
@@ -15,6 +15,7 @@ See the Mulan PSL v2 for more details. */
 #pragma once
 
 #include "sql/stmt/stmt.h"
+#include "storage/index/index_meta.h"
 
 struct CreateIndexSqlNode;
 class Table;
@@ -27,8 +28,9 @@ class FieldMeta;
 class CreateIndexStmt : public Stmt
 {
 public:
-  CreateIndexStmt(Table *table, const FieldMeta *field_meta, const string &index_name, bool Unique)
-      : table_(table), field_meta_(field_meta), index_name_(index_name), Unique_(Unique)
+  CreateIndexStmt(
+      Table *table, const FieldMeta *field_meta, const string &index_name, bool Unique, IndexType index_type)
+      : table_(table), field_meta_(field_meta), index_name_(index_name), Unique_(Unique), index_type_(index_type)
   {}
 
   virtual ~CreateIndexStmt() = default;
@@ -39,6 +41,7 @@ public:
   const FieldMeta *field_meta() const { return field_meta_; }
   const string    &index_name() const { return index_name_; }
   bool             unique_type() const { return Unique_; }
+  IndexType        index_type() const { return index_type_; }
 
 public:
   static RC create(Db *db, const CreateIndexSqlNode &create_index, Stmt *&stmt);
@@ -48,4 +51,5 @@ private:
   const FieldMeta *field_meta_ = nullptr;
   string           index_name_;
   bool             Unique_      = false;
+  IndexType        index_type_  = IndexType::BPLUS_TREE;
 };
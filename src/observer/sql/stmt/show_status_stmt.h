@@ -0,0 +1,42 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/string.h"
+#include "common/log/log.h"
+#include "sql/parser/parse_defs.h"
+#include "sql/stmt/stmt.h"
+
+class Db;
+
+/**
+ * @brief 查看模块运行状态的语句
+ * @ingroup Statement
+ * @details 当前只支持 SHOW VACUUM，查看 MVCC 后台清理的进度
+ */
+class ShowStatusStmt : public Stmt
+{
+public:
+  ShowStatusStmt()          = default;
+  virtual ~ShowStatusStmt() = default;
+
+  StmtType type() const override { return StmtType::SHOW_STATUS; }
+
+  static RC create(Db *db, const ShowStatusSqlNode &show_status, Stmt *&stmt)
+  {
+    if (0 != strcasecmp(show_status.name.c_str(), "vacuum")) {
+      LOG_WARN("unsupported show command. name=%s", show_status.name.c_str());
+      return RC::UNIMPLEMENTED;
+    }
+    stmt = new ShowStatusStmt();
+    return RC::SUCCESS;
+  }
+};
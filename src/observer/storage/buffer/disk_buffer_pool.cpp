@@ -12,7 +12,10 @@ See the Mulan PSL v2 for more details. */
 // Created by Meiyi & Longda on 2021/4/13.
 //
 #include <errno.h>
+#include <fcntl.h>
 #include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 #include "common/io/io.h"
 #include "common/lang/mutex.h"
@@ -109,6 +112,16 @@ Frame *BPFrameManager::get(int buffer_pool_id, PageNum page_num)
   return get_internal(frame_id);
 }
 
+bool BPFrameManager::contains(int buffer_pool_id, PageNum page_num)
+{
+  FrameId frame_id(buffer_pool_id, page_num);
+
+  lock_guard<mutex> lock_guard(lock_);
+
+  Frame *frame = nullptr;
+  return frames_.get(frame_id, frame);
+}
+
 Frame *BPFrameManager::get_internal(const FrameId &frame_id)
 {
   Frame *frame = nullptr;
@@ -186,7 +199,7 @@ list<Frame *> BPFrameManager::find_list(int buffer_pool_id)
 ////////////////////////////////////////////////////////////////////////////////
 BufferPoolIterator::BufferPoolIterator() {}
 BufferPoolIterator::~BufferPoolIterator() {}
-RC BufferPoolIterator::init(DiskBufferPool &bp, PageNum start_page /* = 0 */)
+RC BufferPoolIterator::init(DiskBufferPool &bp, PageNum start_page /* = 0 */, PageNum end_page /* = -1 */)
 {
   bitmap_.init(bp.file_header_->bitmap, bp.file_header_->page_count);
   if (start_page <= 0) {
@@ -194,14 +207,22 @@ RC BufferPoolIterator::init(DiskBufferPool &bp, PageNum start_page /* = 0 */)
   } else {
     current_page_num_ = start_page - 1;
   }
+  end_page_num_ = end_page;
   return RC::SUCCESS;
 }
 
-bool BufferPoolIterator::has_next() { return bitmap_.next_setted_bit(current_page_num_ + 1) != -1; }
+bool BufferPoolIterator::has_next()
+{
+  PageNum next_page = bitmap_.next_setted_bit(current_page_num_ + 1);
+  return next_page != -1 && (end_page_num_ < 0 || next_page < end_page_num_);
+}
 
 PageNum BufferPoolIterator::next()
 {
   PageNum next_page = bitmap_.next_setted_bit(current_page_num_ + 1);
+  if (next_page != -1 && end_page_num_ >= 0 && next_page >= end_page_num_) {
+    next_page = -1;
+  }
   if (next_page != -1) {
     current_page_num_ = next_page;
   }
@@ -348,6 +369,27 @@ RC DiskBufferPool::get_this_page(PageNum page_num, Frame **frame)
   return RC::SUCCESS;
 }
 
+RC DiskBufferPool::prefetch_page(PageNum page_num)
+{
+  if (page_num < 0 || page_num >= file_header_->page_count) {
+    return RC::INVALID_ARGUMENT;
+  }
+
+  if (frame_manager_.contains(id(), page_num)) {
+    return RC::SUCCESS;
+  }
+
+#ifdef POSIX_FADV_WILLNEED
+  int64_t offset = ((int64_t)page_num) * BP_PAGE_SIZE;
+  int     ret    = posix_fadvise(file_desc_, offset, BP_PAGE_SIZE, POSIX_FADV_WILLNEED);
+  if (ret != 0) {
+    LOG_WARN("failed to prefetch page %s:%d, ret=%d:%s", file_name_.c_str(), page_num, ret, strerror(ret));
+    return RC::IOERR_READ;
+  }
+#endif
+  return RC::SUCCESS;
+}
+
 RC DiskBufferPool::allocate_page(Frame **frame)
 {
   RC rc = RC::SUCCESS;
@@ -651,8 +693,18 @@ RC DiskBufferPool::redo_allocate_page(LSN lsn, PageNum page_num)
   file_header_->page_count++;
   hdr_frame_->set_lsn(lsn);
   hdr_frame_->mark_dirty();
-  
-  // TODO 应该检查文件是否足够大，包含了当前新分配的页面
+
+  // 新分配的页面可能还没有写到磁盘上，扩展文件，保证后续回放时可以读取这个页面
+  // 扩展出来的页面内容都是0，LSN也是0，所有相关的日志都会重做
+  struct stat file_stat;
+  const off_t file_size = static_cast<off_t>(page_num + 1) * BP_PAGE_SIZE;
+  if (fstat(file_desc_, &file_stat) == 0 && file_stat.st_size < file_size) {
+    if (ftruncate(file_desc_, file_size) != 0) {
+      LOG_ERROR("Failed to extend file while redo allocate page. file=%s, page_num=%d, error=%s",
+                file_name_.c_str(), page_num, strerror(errno));
+      return RC::IOERR_WRITE;
+    }
+  }
 
   Bitmap bitmap(file_header_->bitmap, file_header_->page_count);
   bitmap.set_bit(page_num);
@@ -102,6 +102,12 @@ public:
    */
   Frame *get(int buffer_pool_id, PageNum page_num);
 
+  /**
+   * @brief 判断指定的页面是否已经在内存中
+   * @details 与 get 不同，不会 pin 页面
+   */
+  bool contains(int buffer_pool_id, PageNum page_num);
+
   /**
    * @brief 列出所有指定文件的页面
    *
@@ -170,7 +176,11 @@ public:
   BufferPoolIterator();
   ~BufferPoolIterator();
 
-  RC      init(DiskBufferPool &bp, PageNum start_page = 0);
+  /**
+   * @brief 初始化
+   * @param end_page 只遍历 end_page 之前的页面，小于0时遍历到文件结束
+   */
+  RC      init(DiskBufferPool &bp, PageNum start_page = 0, PageNum end_page = -1);
   bool    has_next();
   PageNum next();
   RC      reset();
@@ -178,6 +188,7 @@ public:
 private:
   common::Bitmap bitmap_;
   PageNum        current_page_num_ = -1;
+  PageNum        end_page_num_     = -1;
 };
 
 /**
@@ -208,6 +219,14 @@ public:
    */
   RC get_this_page(PageNum page_num, Frame **frame);
 
+  /**
+   * @brief 预读指定的页面
+   * @details 页面不在缓冲区时，通知操作系统异步地把页面读到页缓存中，不会等待IO完成，
+   * 也不会占用缓冲区的页帧。之后再通过 get_this_page 访问时就不需要等待磁盘IO。
+   * 预读只是一个提示，失败不影响正确性。
+   */
+  RC prefetch_page(PageNum page_num);
+
   /**
    * @brief 在指定文件中分配一个新的页面，并将其放入缓冲区，返回页面句柄指针。
    * @details 分配页面时，如果文件中有空闲页，就直接分配一个空闲页；
@@ -274,6 +293,11 @@ public:
 
   const char *filename() const { return file_name_.c_str(); }
 
+  /**
+   * @brief 文件中的页面个数，包括文件头页面和已经释放的页面
+   */
+  int32_t page_count() const { return file_header_->page_count; }
+
 protected:
   RC allocate_frame(PageNum page_num, Frame **buf);
 
@@ -16,6 +16,16 @@ void Chunk::add_column(unique_ptr<Column> col, int col_id)
   column_ids_.push_back(col_id);
 }
 
+int Chunk::column_index(int col_id) const
+{
+  for (size_t i = 0; i < column_ids_.size(); ++i) {
+    if (column_ids_[i] == col_id) {
+      return static_cast<int>(i);
+    }
+  }
+  return -1;
+}
+
 RC Chunk::reference(Chunk &chunk)
 {
   reset();
@@ -63,6 +63,13 @@ public:
     return column_ids_[i];
   }
 
+  /**
+   * @brief 查找指定 col_id 的列在 Chunk 中的下标
+   * @details Chunk 中可能只包含表的部分列，此时列的下标与 col_id 不一致
+   * @return 没有找到时返回 -1
+   */
+  int column_index(int col_id) const;
+
   void add_column(unique_ptr<Column> col, int col_id);
 
   RC reference(Chunk &chunk);
@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include "condition_filter.h"
+#include "common/lang/comparator.h"
 #include "common/log/log.h"
 #include "common/value.h"
 #include "storage/record/record_manager.h"
@@ -211,3 +212,123 @@ bool CompositeConditionFilter::filter(const Record &rec) const
   }
   return true;
 }
+
+////////////////////////////////////////////////////////////////////////////////
+static bool is_numeric(AttrType type) { return type == AttrType::INTS || type == AttrType::FLOATS; }
+
+bool CompiledConditionFilter::support(const FieldMeta &field, CompOp comp, const Value &value)
+{
+  if (comp < EQUAL_TO || comp > GREAT_THAN) {
+    return false;
+  }
+
+  const AttrType field_type = field.type();
+  const AttrType value_type = value.attr_type();
+  switch (field_type) {
+    case AttrType::INTS:
+    case AttrType::FLOATS: return is_numeric(value_type);
+    case AttrType::DATES:
+    case AttrType::CHARS: return value_type == field_type;
+    default: return false;
+  }
+}
+
+RC CompiledConditionFilter::add(const FieldMeta &field, CompOp comp, const Value &value)
+{
+  if (!support(field, comp, value)) {
+    return RC::UNSUPPORTED;
+  }
+
+  FieldComparison comparison;
+  comparison.comp     = comp;
+  comparison.offset   = field.offset();
+  comparison.len      = field.len();
+  comparison.nullable = field.nullable();
+  switch (field.type()) {
+    case AttrType::INTS: {
+      if (value.attr_type() == AttrType::FLOATS) {
+        comparison.type        = CompareType::INT_AS_FLOAT;
+        comparison.float_value = value.get_float();
+      } else {
+        comparison.type      = CompareType::INT;
+        comparison.int_value = value.get_int();
+      }
+    } break;
+    case AttrType::DATES: {
+      comparison.type      = CompareType::INT;
+      comparison.int_value = value.get_int();
+    } break;
+    case AttrType::FLOATS: {
+      comparison.type        = CompareType::FLOAT;
+      comparison.float_value = value.get_float();
+    } break;
+    default: {
+      comparison.type         = CompareType::CHARS;
+      comparison.string_value = value.get_string();
+    } break;
+  }
+
+  comparisons_.push_back(std::move(comparison));
+  return RC::SUCCESS;
+}
+
+bool CompiledConditionFilter::match(const FieldComparison &comparison, const char *field_data)
+{
+  if (comparison.nullable) {
+    // 与 RowTuple 一致，可以为 NULL 的字段全部是0时就是 NULL
+    bool is_null = true;
+    for (int i = 0; i < comparison.len && is_null; i++) {
+      is_null = field_data[i] == 0;
+    }
+    if (is_null) {
+      return false;
+    }
+  }
+
+  int cmp_result = 0;
+  switch (comparison.type) {
+    case CompareType::INT: {
+      int value = 0;
+      memcpy(&value, field_data, sizeof(value));
+      cmp_result = (value > comparison.int_value) - (value < comparison.int_value);
+    } break;
+    case CompareType::INT_AS_FLOAT: {
+      int value = 0;
+      memcpy(&value, field_data, sizeof(value));
+      float float_value = static_cast<float>(value);
+      cmp_result        = compare_float(&float_value, const_cast<float *>(&comparison.float_value));
+    } break;
+    case CompareType::FLOAT: {
+      float value = 0;
+      memcpy(&value, field_data, sizeof(value));
+      cmp_result = compare_float(&value, const_cast<float *>(&comparison.float_value));
+    } break;
+    case CompareType::CHARS: {
+      cmp_result = compare_string(const_cast<char *>(field_data),
+          static_cast<int>(strnlen(field_data, comparison.len)),
+          const_cast<char *>(comparison.string_value.data()),
+          static_cast<int>(comparison.string_value.size()));
+    } break;
+  }
+
+  switch (comparison.comp) {
+    case EQUAL_TO: return cmp_result == 0;
+    case LESS_EQUAL: return cmp_result <= 0;
+    case NOT_EQUAL: return cmp_result != 0;
+    case LESS_THAN: return cmp_result < 0;
+    case GREAT_EQUAL: return cmp_result >= 0;
+    case GREAT_THAN: return cmp_result > 0;
+    default: return false;
+  }
+}
+
+bool CompiledConditionFilter::filter(const Record &rec) const
+{
+  const char *data = rec.data();
+  for (const FieldComparison &comparison : comparisons_) {
+    if (!match(comparison, data + comparison.offset)) {
+      return false;
+    }
+  }
+  return true;
+}
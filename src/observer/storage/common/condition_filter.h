@@ -14,10 +14,13 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include "common/lang/string.h"
+#include "common/lang/vector.h"
 #include "sql/parser/parse.h"
 
 class Record;
 class Table;
+class FieldMeta;
 
 struct ConDesc
 {
@@ -88,3 +91,61 @@ private:
   int                     filter_num_   = 0;
   bool                    memory_owner_ = false;  // filters_的内存是否由自己来控制
 };
+
+/**
+ * @brief 编译好的过滤条件，直接在记录的原始数据上计算
+ * @details 只支持 `字段 op 常量` 形式的比较，多个比较之间是 AND 的关系。
+ * 根据 FieldMeta 中的偏移量和类型直接解释记录中的字节，不需要为每条记录构造 Value 和 Tuple，
+ * 扫描器可以在复制记录之前先过滤掉不满足条件的记录。有事务时，要在检查可见性之后过滤，
+ * 因为事务可能会把页面上的记录换成快照中的旧版本。
+ * 比较的语义与 ComparisonExpr 一致：可以为 NULL 的字段全部是0时当做 NULL，与 NULL 比较的结果都是 false。
+ */
+class CompiledConditionFilter : public ConditionFilter
+{
+public:
+  CompiledConditionFilter()          = default;
+  virtual ~CompiledConditionFilter() = default;
+
+  /**
+   * @brief 是否支持编译这个比较
+   * @details 字段与常量的类型相同，或者都是数字类型，并且比较符是 =、<>、<、<=、>、>= 之一
+   */
+  static bool support(const FieldMeta &field, CompOp comp, const Value &value);
+
+  /**
+   * @brief 增加一个比较条件 `field comp value`
+   * @return 不支持时返回 UNSUPPORTED，调用者需要自己计算这个条件
+   */
+  RC add(const FieldMeta &field, CompOp comp, const Value &value);
+
+  bool empty() const { return comparisons_.empty(); }
+  int  size() const { return static_cast<int>(comparisons_.size()); }
+
+  bool filter(const Record &rec) const override;
+
+private:
+  enum class CompareType
+  {
+    INT,           ///< 整数或日期字段与相同类型的常量比较
+    INT_AS_FLOAT,  ///< 整数字段与浮点数常量比较
+    FLOAT,         ///< 浮点数字段与数字常量比较
+    CHARS,         ///< 字符串字段与字符串常量比较
+  };
+
+  struct FieldComparison
+  {
+    CompareType type        = CompareType::INT;
+    CompOp      comp        = NO_OP;
+    int         offset      = 0;
+    int         len         = 0;
+    bool        nullable    = false;
+    int         int_value   = 0;
+    float       float_value = 0;
+    string      string_value;
+  };
+
+  static bool match(const FieldComparison &comparison, const char *field_data);
+
+private:
+  vector<FieldComparison> comparisons_;
+};
@@ -38,4 +38,9 @@ string table_index_file(const char *base_dir, const char *table_name, const char
 string table_lob_file(const char *base_dir, const char *table_name)
 {
   return filesystem::path(base_dir) / (string(table_name) + TABLE_LOB_SUFFIX);
+}
+
+string table_fsm_file(const char *base_dir, const char *table_name)
+{
+  return filesystem::path(base_dir) / (string(table_name) + TABLE_FSM_SUFFIX);
 }
\ No newline at end of file
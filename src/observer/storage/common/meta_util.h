@@ -21,9 +21,11 @@ static constexpr const char *TABLE_META_FILE_PATTERN = ".*\\.table$";
 static constexpr const char *TABLE_DATA_SUFFIX       = ".data";
 static constexpr const char *TABLE_INDEX_SUFFIX      = ".index";
 static constexpr const char *TABLE_LOB_SUFFIX        = ".lob";
+static constexpr const char *TABLE_FSM_SUFFIX        = ".fsm";
 
 string db_meta_file(const char *base_dir, const char *db_name);
 string table_meta_file(const char *base_dir, const char *table_name);
 string table_data_file(const char *base_dir, const char *table_name);
 string table_index_file(const char *base_dir, const char *table_name, const char *index_name);
 string table_lob_file(const char *base_dir, const char *table_name);
+string table_fsm_file(const char *base_dir, const char *table_name);
@@ -25,13 +25,20 @@ See the Mulan PSL v2 for more details. */
 #include "storage/table/table.h"
 #include "storage/table/table_meta.h"
 #include "storage/trx/trx.h"
+#include "storage/trx/mvcc_trx.h"
+#include "storage/trx/mvcc_vacuum.h"
 #include "storage/clog/disk_log_handler.h"
 #include "storage/clog/integrated_log_replayer.h"
 
 using namespace common;
 
+Db::Db() = default;
+
 Db::~Db()
 {
+  // 清理线程会访问表，需要先停止
+  vacuum_.reset();
+
   for (auto &iter : opened_tables_) {
     delete iter.second;
   }
@@ -147,12 +154,29 @@ RC Db::init(const char *name, const char *dbpath, const char *trx_kit_name, cons
     return rc;
   }
 
+  // 恢复完成以后再开始清理已经删除的记录
+  auto *mvcc_trx_kit = dynamic_cast<MvccTrxKit *>(trx_kit_.get());
+  if (mvcc_trx_kit != nullptr) {
+    vacuum_ = make_unique<MvccVacuum>(*this, *mvcc_trx_kit);
+    rc      = vacuum_->start();
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to start vacuum. dbpath=%s, rc=%s", dbpath, strrc(rc));
+      return rc;
+    }
+  }
+
   return rc;
 }
 
 RC Db::create_table(const char *table_name, span<const AttrInfoSqlNode> attributes, const vector<string>& primary_keys, const StorageFormat storage_format)
 {
   RC rc = RC::SUCCESS;
+
+  unique_lock<common::Mutex> vacuum_guard;
+  if (vacuum_) {
+    vacuum_guard = unique_lock<common::Mutex>(vacuum_->table_lock());
+  }
+
   // check table_name
   if (opened_tables_.count(table_name) != 0) {
     LOG_WARN("%s has been opened before.", table_name);
@@ -184,6 +208,11 @@ RC Db::drop_table(const char *table_name)
     LOG_ERROR("drop table fail: table name is empty!");
     return RC::EMPTY;
   }
+  unique_lock<common::Mutex> vacuum_guard;
+  if (vacuum_) {
+    vacuum_guard = unique_lock<common::Mutex>(vacuum_->table_lock());
+  }
+
   Table *table = find_table(table_name);
   if (table != nullptr) {
     std::string table_file_path = table_meta_file(path_.c_str(), table_name);
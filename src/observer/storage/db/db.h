@@ -30,6 +30,7 @@ class Table;
 class LogHandler;
 class BufferPoolManager;
 class TrxKit;
+class MvccVacuum;
 
 /**
  * @brief 一个DB实例负责管理一批表
@@ -45,7 +46,7 @@ class TrxKit;
 class Db
 {
 public:
-  Db() = default;
+  Db();
   ~Db();
 
   /**
@@ -106,6 +107,9 @@ public:
   /// @brief 获取当前数据库的事务管理器
   TrxKit &trx_kit();
 
+  /// @brief 获取MVCC的后台清理，不是MVCC事务时返回空
+  MvccVacuum *vacuum() { return vacuum_.get(); }
+
   string path() const { return path_; }
 
   oceanbase::ObLsm *lsm() { return lsm_; }
@@ -146,6 +150,7 @@ private:
   unique_ptr<BufferPoolManager>  buffer_pool_manager_;  ///< 当前数据库的buffer pool管理器
   unique_ptr<LogHandler>         log_handler_;          ///< 当前数据库的日志处理器
   unique_ptr<TrxKit>             trx_kit_;              ///< 当前数据库的事务管理器
+  unique_ptr<MvccVacuum>         vacuum_;               ///< 清理已经删除的记录，只有MVCC事务需要
   oceanbase::ObLsm              *lsm_;                  ///< 当前数据库的 LSM-Tree 存储引擎
 
   /// 给每个table都分配一个ID，用来记录日志。这里假设所有的DDL都不会并发操作，所以相关的数据都不上锁
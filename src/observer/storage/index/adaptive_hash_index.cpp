@@ -0,0 +1,239 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/index/adaptive_hash_index.h"
+#include "common/log/log.h"
+#include "common/lang/algorithm.h"
+
+static atomic<bool> default_enabled_{true};
+
+void AdaptiveHashIndex::set_default_enabled(bool enabled) { default_enabled_ = enabled; }
+bool AdaptiveHashIndex::default_enabled() { return default_enabled_; }
+
+AdaptiveHashIndex::AdaptiveHashIndex() : enabled_(default_enabled_.load()) { init(AttrType::UNDEFINED, 0); }
+
+void AdaptiveHashIndex::init(AttrType attr_type, int attr_length, int capacity)
+{
+  attr_type_   = attr_type;
+  attr_length_ = attr_length;
+  capacity     = max(capacity, 1);
+
+  const int shard_num      = std::clamp(capacity / MIN_SHARD_SIZE, 1, MAX_SHARDS);
+  const int shard_capacity = (capacity + shard_num - 1) / shard_num;
+  shards_.clear();
+  for (int i = 0; i < shard_num; i++) {
+    shards_.emplace_back(make_unique<Shard>());
+    shards_.back()->capacity = shard_capacity;
+  }
+}
+
+void AdaptiveHashIndex::set_enabled(bool enabled)
+{
+  enabled_ = enabled;
+  if (!enabled) {
+    clear();
+  }
+}
+
+void AdaptiveHashIndex::clear()
+{
+  for (auto &shard : shards_) {
+    lock_guard guard(shard->lock);
+    shard->entries.clear();
+    shard->entry_lru.clear();
+    shard->counters.clear();
+    shard->counter_lru.clear();
+    shard->version++;
+    shard->update_active();
+  }
+}
+
+int AdaptiveHashIndex::size()
+{
+  int size = 0;
+  for (auto &shard : shards_) {
+    lock_guard guard(shard->lock);
+    size += static_cast<int>(shard->entries.size());
+  }
+  return size;
+}
+
+string AdaptiveHashIndex::normalize_key(const char *user_key, int key_len) const
+{
+  string key(attr_length_, '\0');
+  memcpy(key.data(), user_key, std::min(key_len, attr_length_));
+
+  switch (attr_type_) {
+    case AttrType::CHARS: {
+      const size_t end = key.find('\0');
+      if (end != string::npos) {
+        fill(key.begin() + end, key.end(), '\0');
+      }
+    } break;
+    case AttrType::FLOATS: {
+      float value = 0;
+      memcpy(&value, key.data(), sizeof(value));
+      if (value == 0) {
+        value = 0;
+        memcpy(key.data(), &value, sizeof(value));
+      }
+    } break;
+    default: break;
+  }
+  return key;
+}
+
+bool AdaptiveHashIndex::lookup(
+    const char *user_key, int key_len, const TreeLookup &tree_lookup, RC &rc, vector<RID> &rids)
+{
+  if (!enabled_) {
+    return false;
+  }
+
+  string   key     = normalize_key(user_key, key_len);
+  Shard   &shard   = shard_of(key);
+  uint64_t version = 0;
+  {
+    lock_guard guard(shard.lock);
+    auto entry_iter = shard.entries.find(key);
+    if (entry_iter != shard.entries.end()) {
+      shard.entry_lru.splice(shard.entry_lru.begin(), shard.entry_lru, entry_iter->second.lru_iter);
+      rids = entry_iter->second.rids;
+      hit_count_++;
+      rc = RC::SUCCESS;
+      return true;
+    }
+
+    miss_count_++;
+
+    auto counter_iter = shard.counters.find(key);
+    if (counter_iter == shard.counters.end()) {
+      shard.counter_lru.push_front(key);
+      counter_iter = shard.counters.emplace(key, Counter{0, shard.counter_lru.begin()}).first;
+      if (static_cast<int>(shard.counters.size()) > shard.capacity) {
+        shard.counters.erase(shard.counter_lru.back());
+        shard.counter_lru.pop_back();
+      }
+    } else {
+      shard.counter_lru.splice(shard.counter_lru.begin(), shard.counter_lru, counter_iter->second.lru_iter);
+    }
+
+    if (++counter_iter->second.count < HOT_THRESHOLD) {
+      return false;
+    }
+    version = shard.version;
+    // 查询B+树期间的修改需要增加版本号，invalidate 不能跳过加锁
+    shard.pending++;
+    shard.update_active();
+  }
+
+  // 热点键值，查询B+树并缓存。查询B+树时不持有锁
+  list<RID> tree_rids;
+  rc = tree_lookup(tree_rids);
+  if (OB_SUCC(rc)) {
+    rids.assign(tree_rids.begin(), tree_rids.end());
+  } else {
+    LOG_WARN("failed to lookup b+ tree for adaptive hash index. rc=%s", strrc(rc));
+  }
+
+  lock_guard guard(shard.lock);
+  shard.pending--;
+  shard.update_active();
+  if (OB_FAIL(rc) || static_cast<int>(rids.size()) > MAX_RIDS_PER_KEY) {
+    return true;
+  }
+
+  if (version != shard.version || !enabled_) {
+    // 查询期间有修改，结果可能已经过期
+    return true;
+  }
+
+  auto counter_iter = shard.counters.find(key);
+  if (counter_iter != shard.counters.end()) {
+    shard.counter_lru.erase(counter_iter->second.lru_iter);
+    shard.counters.erase(counter_iter);
+  }
+
+  if (shard.entries.find(key) == shard.entries.end()) {
+    shard.entry_lru.push_front(key);
+    shard.entries.emplace(key, Entry{rids, shard.entry_lru.begin()});
+    if (static_cast<int>(shard.entries.size()) > shard.capacity) {
+      shard.entries.erase(shard.entry_lru.back());
+      shard.entry_lru.pop_back();
+    }
+    shard.update_active();
+  }
+  return true;
+}
+
+void AdaptiveHashIndex::invalidate(const char *user_key, int key_len)
+{
+  if (!enabled_) {
+    return;
+  }
+
+  string key   = normalize_key(user_key, key_len);
+  Shard &shard = shard_of(key);
+  if (shard.active.load() == 0) {
+    // 没有缓存的键值，也没有正在查询B+树的热点键值。之后开始的查询一定能看到B+树的修改
+    return;
+  }
+
+  lock_guard guard(shard.lock);
+  auto       iter = shard.entries.find(key);
+  if (iter != shard.entries.end()) {
+    shard.entry_lru.erase(iter->second.lru_iter);
+    shard.entries.erase(iter);
+    shard.update_active();
+  }
+  shard.version++;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+AdaptiveHashIndexScanner::AdaptiveHashIndexScanner(vector<RID> &&rids, string &&key)
+    : rids_(std::move(rids)), key_(std::move(key))
+{}
+
+RC AdaptiveHashIndexScanner::next_entry(RID *rid)
+{
+  if (pos_ >= rids_.size()) {
+    return RC::RECORD_EOF;
+  }
+  *rid = rids_[pos_++];
+  return RC::SUCCESS;
+}
+
+RC AdaptiveHashIndexScanner::next_entry_with_key(RID *rid, char *key)
+{
+  RC rc = next_entry(rid);
+  if (OB_SUCC(rc)) {
+    memcpy(key, key_.data(), key_.size());
+  }
+  return rc;
+}
+
+RC AdaptiveHashIndexScanner::next_entries(vector<RID> &rids, int max_count)
+{
+  rids.clear();
+  if (pos_ >= rids_.size()) {
+    return RC::RECORD_EOF;
+  }
+
+  const size_t end = std::min(rids_.size(), pos_ + static_cast<size_t>(max_count));
+  rids.assign(rids_.begin() + pos_, rids_.begin() + end);
+  pos_ = end;
+  return RC::SUCCESS;
+}
+
+RC AdaptiveHashIndexScanner::destroy()
+{
+  delete this;
+  return RC::SUCCESS;
+}
@@ -0,0 +1,164 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/atomic.h"
+#include "common/lang/functional.h"
+#include "common/lang/list.h"
+#include "common/lang/memory.h"
+#include "common/lang/mutex.h"
+#include "common/lang/string.h"
+#include "common/lang/unordered_map.h"
+#include "common/lang/vector.h"
+#include "common/type/attr_type.h"
+#include "storage/index/index.h"
+#include "storage/record/record.h"
+
+/**
+ * @brief 自适应哈希索引
+ * @ingroup Index
+ * @details 建立在B+树索引之上的内存哈希表，用于加速热点键值的等值查询。
+ * 记录每个键值被等值查询的次数，达到 HOT_THRESHOLD 以后，把B+树查询到的RID缓存起来，
+ * 后续的查询直接返回，不再从根节点向下查找。
+ * 缓存的是RID而不是叶子节点中的位置，B+树节点的分裂与合并不会让缓存失效；
+ * 键值对应的索引项发生变化(插入或删除)时，由 invalidate 删除缓存。
+ * 缓存的键值个数和每个键值缓存的RID个数都有上限，超过键值个数上限时淘汰最久没有访问的键值。
+ * 可以随时关闭，关闭时清空所有缓存。新建的索引是否开启由配置项 ADAPTIVE_HASH_INDEX 决定。
+ *
+ * 缓存按照键值的哈希值分成多个分片，每个分片有自己的锁、LRU链表和容量，不同分片上的访问互不影响。
+ * 分片上没有缓存的键值，也没有正在进行的B+树查询时，invalidate 不需要加锁。
+ */
+class AdaptiveHashIndex
+{
+public:
+  /// 从B+树中查找一个键值对应的所有RID
+  using TreeLookup = function<RC(list<RID> &)>;
+
+  static constexpr int DEFAULT_CAPACITY = 4096;  ///< 默认最多缓存的键值个数
+  static constexpr int HOT_THRESHOLD    = 3;     ///< 访问多少次以后认为是热点键值
+  static constexpr int MAX_RIDS_PER_KEY = 64;    ///< 一个键值最多缓存多少个RID，太多时不缓存
+  static constexpr int MAX_SHARDS       = 16;    ///< 最多分成多少个分片
+  static constexpr int MIN_SHARD_SIZE   = 64;    ///< 每个分片至少缓存多少个键值，容量太小时少分几片
+
+  /// 新建的自适应哈希索引是否开启，默认开启
+  static void set_default_enabled(bool enabled);
+  static bool default_enabled();
+
+public:
+  AdaptiveHashIndex();
+  ~AdaptiveHashIndex() = default;
+
+  /**
+   * @brief 初始化
+   * @details 需要在使用之前调用，不能和其它操作并发
+   * @param capacity 最多缓存多少个键值。统计访问次数的键值个数也使用这个上限
+   */
+  void init(AttrType attr_type, int attr_length, int capacity = DEFAULT_CAPACITY);
+
+  void set_enabled(bool enabled);
+  bool enabled() const { return enabled_; }
+
+  /**
+   * @brief 等值查询
+   * @details 命中缓存时直接返回。没有命中时记录访问次数，成为热点键值以后调用 tree_lookup 查询B+树并缓存结果。
+   * @param key_len user_key的长度，比属性长度短时(比如字符串)会在后面补0
+   * @param[out] rids 查询到的RID
+   * @return true 表示 rids 中是查询结果；false 表示没有查询，调用者需要自己从B+树中查找
+   */
+  bool lookup(const char *user_key, int key_len, const TreeLookup &tree_lookup, RC &rc, vector<RID> &rids);
+
+  /**
+   * @brief 键值对应的索引项发生了变化，删除缓存
+   * @details 需要在B+树修改完成以后调用，保证并发的查询不会把修改前的数据放到缓存中
+   */
+  void invalidate(const char *user_key, int key_len);
+
+  /// 清空所有缓存和访问统计
+  void clear();
+
+  int      size();
+  int      shard_count() const { return static_cast<int>(shards_.size()); }
+  uint64_t hit_count() const { return hit_count_.load(); }
+  uint64_t miss_count() const { return miss_count_.load(); }
+
+  /**
+   * @brief 把键值转换成统一的格式，长度为 attr_length
+   * @details 字符串后面补0，浮点数的-0转成0，保证相等的键值字节完全相同
+   */
+  string normalize_key(const char *user_key, int key_len) const;
+
+private:
+  struct Entry
+  {
+    vector<RID>            rids;
+    list<string>::iterator lru_iter;
+  };
+
+  struct Counter
+  {
+    int                    count = 0;
+    list<string>::iterator lru_iter;
+  };
+
+  struct Shard
+  {
+    mutex                          lock;
+    unordered_map<string, Entry>   entries;   ///< 已经缓存的热点键值
+    list<string>                   entry_lru;
+    unordered_map<string, Counter> counters;  ///< 还没有缓存的键值的访问次数
+    list<string>                   counter_lru;
+    int                            capacity = 0;
+
+    /// 每次 invalidate 都会增加。查询B+树前后版本号不同时，查询结果可能已经过期，不能放入缓存
+    uint64_t version = 0;
+    int      pending = 0;  ///< 正在查询B+树的个数
+
+    /// entries.size() + pending，在锁内修改。为0时 invalidate 不需要加锁
+    atomic<int> active{0};
+
+    void update_active() { active.store(static_cast<int>(entries.size()) + pending); }
+  };
+
+  Shard &shard_of(const string &key) { return *shards_[hash<string>()(key) % shards_.size()]; }
+
+private:
+  AttrType attr_type_   = AttrType::UNDEFINED;
+  int      attr_length_ = 0;
+
+  atomic<bool> enabled_{true};
+
+  vector<unique_ptr<Shard>> shards_;
+
+  atomic<uint64_t> hit_count_{0};
+  atomic<uint64_t> miss_count_{0};
+};
+
+/**
+ * @brief 从自适应哈希索引中返回结果的扫描器
+ * @ingroup Index
+ * @details 只用于等值查询，所有的RID对应同一个键值
+ */
+class AdaptiveHashIndexScanner : public IndexScanner
+{
+public:
+  AdaptiveHashIndexScanner(vector<RID> &&rids, string &&key);
+  ~AdaptiveHashIndexScanner() noexcept override = default;
+
+  RC next_entry(RID *rid) override;
+  RC next_entry_with_key(RID *rid, char *key) override;
+  RC next_entries(vector<RID> &rids, int max_count) override;
+  RC destroy() override;
+
+private:
+  vector<RID> rids_;
+  size_t      pos_ = 0;
+  string      key_;
+};
@@ -14,6 +14,7 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include "storage/index/bplus_tree.h"
+#include "common/lang/algorithm.h"
 #include "common/lang/lower_bound.h"
 #include "common/log/log.h"
 #include "common/global_context.h"
@@ -248,6 +249,21 @@ RC LeafIndexNodeHandler::insert(int index, const char *key, const char *value)
   return RC::SUCCESS;
 }
 
+RC LeafIndexNodeHandler::insert_batch(span<const int> indexes, span<const char> items)
+{
+  RC rc = mtr_.logger().leaf_batch_insert_items(*this, indexes, items);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to log batch insert items. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  const int item_size = this->item_size();
+  for (size_t i = 0; i < indexes.size(); i++) {
+    recover_insert_items(indexes[i], items.data() + i * item_size, 1);
+  }
+  return RC::SUCCESS;
+}
+
 RC LeafIndexNodeHandler::remove(int index)
 {
   assert(index >= 0 && index < size());
@@ -1543,6 +1559,146 @@ RC BplusTreeHandler::insert_entry(const char *user_key, const RID *rid)
   return RC::SUCCESS;
 }
 
+RC BplusTreeHandler::insert_entries(const vector<const char *> &user_keys, const vector<RID> &rids)
+{
+  if (user_keys.size() != rids.size()) {
+    LOG_WARN("Invalid arguments, user keys size %zu, rids size %zu", user_keys.size(), rids.size());
+    return RC::INVALID_ARGUMENT;
+  }
+
+  const int    attr_length = file_header_.attr_length;
+  const int    key_length  = file_header_.key_length;
+  const size_t count       = user_keys.size();
+
+  vector<char> keys(count * key_length);
+  vector<int>  order(count);
+  for (size_t i = 0; i < count; i++) {
+    if (user_keys[i] == nullptr) {
+      LOG_WARN("Invalid arguments, key is empty. index=%zu", i);
+      return RC::INVALID_ARGUMENT;
+    }
+    char *key = keys.data() + i * key_length;
+    memcpy(key, user_keys[i], attr_length);
+    memcpy(key + attr_length, &rids[i], sizeof(RID));
+    order[i] = static_cast<int>(i);
+  }
+
+  sort(order.begin(), order.end(), [this, &keys, key_length](int left, int right) {
+    return key_comparator_(keys.data() + left * key_length, keys.data() + right * key_length) < 0;
+  });
+
+  RC     rc  = RC::SUCCESS;
+  size_t pos = 0;
+  while (pos < count) {
+    rc = insert_sorted_entries_into_leaf(keys.data(), order, pos);
+    if (OB_FAIL(rc)) {
+      LOG_TRACE("Failed to insert entries into leaf. inserted=%zu, total=%zu, rc=%s", pos, count, strrc(rc));
+      return rc;
+    }
+  }
+
+  LOG_TRACE("insert entries success. count=%zu", count);
+  return RC::SUCCESS;
+}
+
+RC BplusTreeHandler::insert_sorted_entries_into_leaf(const char *keys, const vector<int> &order, size_t &pos)
+{
+  const int key_length = file_header_.key_length;
+
+  auto key_at = [keys, &order, key_length](size_t index) { return keys + order[index] * key_length; };
+  auto rid_at = [this, &key_at](size_t index) {
+    return reinterpret_cast<const RID *>(key_at(index) + file_header_.attr_length);
+  };
+
+  RC rc = RC::SUCCESS;
+
+  BplusTreeMiniTransaction mtr(*this, &rc);
+
+  if (is_empty()) {
+    root_lock_.lock();
+    if (is_empty()) {
+      rc = create_new_tree(mtr, key_at(pos), rid_at(pos));
+      root_lock_.unlock();
+      if (OB_SUCC(rc)) {
+        pos++;
+      }
+      return rc;
+    }
+    root_lock_.unlock();
+  }
+
+  Frame *frame = nullptr;
+
+  rc = find_leaf(mtr, BplusTreeOperationType::INSERT, key_at(pos), frame);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("Failed to find leaf %s. rc=%d:%s", rid_at(pos)->to_string().c_str(), rc, strrc(rc));
+    return rc;
+  }
+
+  LeafIndexNodeHandler leaf_node(mtr, file_header_, frame);
+
+  // 第一个键值按照普通的流程插入。如果叶子节点已经满了，查找叶子节点时没有释放父节点的锁，可以直接分裂
+  const bool need_split = leaf_node.size() >= leaf_node.max_size();
+  rc                    = insert_entry_into_leaf_node(mtr, frame, key_at(pos), rid_at(pos));
+  if (OB_FAIL(rc)) {
+    LOG_TRACE("Failed to insert into leaf of index, rid:%s. rc=%s", rid_at(pos)->to_string().c_str(), strrc(rc));
+    return rc;
+  }
+  pos++;
+
+  if (need_split) {
+    // 分裂以后叶子节点的范围变了，剩下的键值重新查找叶子节点
+    return rc;
+  }
+
+  // 后面的键值只要不超过叶子节点中最大的键值，就一定在当前叶子节点的范围内。最右边的叶子节点没有上界
+  // 同一个叶子节点上的键值一起插入，只记录一条日志。键值是有序的，前面插入的键值都在后面键值的插入位置之前，
+  // 所以插入位置就是在原来的节点中查找到的位置加上已经插入的个数
+  const bool   right_most = (leaf_node.next_page() == BP_INVALID_PAGE_NUM);
+  const char  *last_key   = leaf_node.key_at(leaf_node.size() - 1);
+  vector<int>  batch_indexes;
+  vector<char> batch_items;
+  size_t       batch_pos = pos;
+  for (; batch_pos < order.size(); batch_pos++) {
+    const char *key = key_at(batch_pos);
+    if (!right_most && key_comparator_(key, last_key) > 0) {
+      break;
+    }
+
+    // 查找叶子节点时，如果叶子节点是安全的，就已经释放了父节点的锁，不能在这里分裂
+    if (leaf_node.size() + static_cast<int>(batch_indexes.size()) >= leaf_node.max_size()) {
+      break;
+    }
+
+    bool exists          = false;
+    int  insert_position = leaf_node.lookup(key_comparator_, key, &exists);
+    if (exists || (batch_pos > pos && key_comparator_(key, key_at(batch_pos - 1)) == 0)) {
+      // 当前叶子节点上插入的键值由 mini transaction 回滚，之前叶子节点上插入的键值由调用者删除
+      LOG_TRACE("entry exists");
+      rc = RC::RECORD_DUPLICATE_KEY;
+      return rc;
+    }
+
+    batch_indexes.push_back(insert_position + static_cast<int>(batch_indexes.size()));
+    const char *rid = reinterpret_cast<const char *>(rid_at(batch_pos));
+    batch_items.insert(batch_items.end(), key, key + leaf_node.key_size());
+    batch_items.insert(batch_items.end(), rid, rid + leaf_node.value_size());
+  }
+
+  if (batch_indexes.empty()) {
+    return rc;
+  }
+
+  rc = leaf_node.insert_batch(batch_indexes, batch_items);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to insert entries into leaf node. count=%zu, rc=%s", batch_indexes.size(), strrc(rc));
+    return rc;
+  }
+  frame->mark_dirty();
+  pos = batch_pos;
+  return rc;
+}
+
 RC BplusTreeHandler::get_entry(const char *user_key, int key_len, list<RID> &rids)
 {
   BplusTreeScanner scanner(*this);
@@ -1837,6 +1993,8 @@ RC BplusTreeScanner::open(const char *left_user_key, int left_len, bool left_inc
 
   inited_        = true;
   first_emitted_ = false;
+  sibling_pages_.clear();
+  prefetched_pages_.clear();
 
   LatchMemo &latch_memo = mtr_.latch_memo();
 
@@ -1852,7 +2010,11 @@ RC BplusTreeScanner::open(const char *left_user_key, int left_len, bool left_inc
   }
 
   if (nullptr == left_user_key) {
-    rc = tree_handler_.left_most_page(mtr_, current_frame_);
+    auto child_page_getter = [this](InternalIndexNodeHandler &internal_node) {
+      collect_sibling_leaves(internal_node, 0);
+      return internal_node.value_at(0);
+    };
+    rc = tree_handler_.find_leaf_internal(mtr_, BplusTreeOperationType::READ, child_page_getter, current_frame_);
     if (OB_FAIL(rc)) {
       if (rc == RC::EMPTY) {
         current_frame_ = nullptr;
@@ -1894,7 +2056,12 @@ RC BplusTreeScanner::open(const char *left_user_key, int left_len, bool left_inc
       fixed_left_key = nullptr;
     }
 
-    rc = tree_handler_.find_leaf(mtr_, BplusTreeOperationType::READ, left_key, current_frame_);
+    auto child_page_getter = [this, left_key](InternalIndexNodeHandler &internal_node) {
+      int index = internal_node.lookup(tree_handler_.key_comparator_, left_key);
+      collect_sibling_leaves(internal_node, index);
+      return internal_node.value_at(index);
+    };
+    rc = tree_handler_.find_leaf_internal(mtr_, BplusTreeOperationType::READ, child_page_getter, current_frame_);
     if (rc == RC::EMPTY) {
       rc             = RC::SUCCESS;
       current_frame_ = nullptr;
@@ -1961,13 +2128,83 @@ RC BplusTreeScanner::open(const char *left_user_key, int left_len, bool left_inc
     current_frame_ = nullptr;
   }
 
+  if (current_frame_ != nullptr && prefetch_depth_ > 0) {
+    // 父节点中记录的兄弟节点就是后面的叶子节点，不需要等待访问到再去读取
+    for (size_t i = 1; i < sibling_pages_.size(); i++) {
+      (void)tree_handler_.buffer_pool().prefetch_page(sibling_pages_[i]);
+    }
+    prefetched_pages_.assign(sibling_pages_.begin(), sibling_pages_.end());
+    prefetch_next_leaves();
+  }
+
   return RC::SUCCESS;
 }
 
-void BplusTreeScanner::fetch_item(RID &rid)
+void BplusTreeScanner::collect_sibling_leaves(InternalIndexNodeHandler &internal_node, int index)
+{
+  sibling_pages_.clear();
+  for (int i = index; i < internal_node.size() && i <= index + prefetch_depth_; i++) {
+    sibling_pages_.push_back(internal_node.value_at(i));
+  }
+}
+
+void BplusTreeScanner::prefetch_next_leaves()
+{
+  if (prefetch_depth_ <= 0 || nullptr == current_frame_) {
+    return;
+  }
+
+  // 丢掉已经访问到的页面。如果当前页面不在预读队列中，说明叶子链表发生了变化，重新开始预读
+  const PageNum current_page = current_frame_->page_num();
+  auto          iter         = find(prefetched_pages_.begin(), prefetched_pages_.end(), current_page);
+  if (iter == prefetched_pages_.end()) {
+    prefetched_pages_.clear();
+  } else {
+    prefetched_pages_.erase(prefetched_pages_.begin(), iter + 1);
+  }
+
+  // 父节点中记录的兄弟节点用完以后，只能通过叶子链表知道后面的叶子节点
+  PageNum tail_page = prefetched_pages_.empty() ? current_page : prefetched_pages_.back();
+  while (static_cast<int>(prefetched_pages_.size()) < prefetch_depth_) {
+    const PageNum next_page_num = next_leaf_of(tail_page);
+    if (BP_INVALID_PAGE_NUM == next_page_num) {
+      break;
+    }
+    (void)tree_handler_.buffer_pool().prefetch_page(next_page_num);
+    prefetched_pages_.push_back(next_page_num);
+    tail_page = next_page_num;
+  }
+}
+
+PageNum BplusTreeScanner::next_leaf_of(PageNum page_num)
+{
+  if (page_num == current_frame_->page_num()) {
+    LeafIndexNodeHandler node(mtr_, tree_handler_.file_header_, current_frame_);
+    return node.next_page();
+  }
+
+  LatchMemo &latch_memo = mtr_.latch_memo();
+  const int  memo_point = latch_memo.memo_point();
+
+  Frame  *frame         = nullptr;
+  PageNum next_page_num = BP_INVALID_PAGE_NUM;
+  if (OB_SUCC(latch_memo.get_page(page_num, frame)) && latch_memo.try_slatch(frame)) {
+    IndexNodeHandler node(mtr_, tree_handler_.file_header_, frame);
+    if (node.is_leaf()) {
+      next_page_num = LeafIndexNodeHandler(mtr_, tree_handler_.file_header_, frame).next_page();
+    }
+  }
+  latch_memo.release_from(memo_point);
+  return next_page_num;
+}
+
+void BplusTreeScanner::fetch_item(RID &rid, char *user_key)
 {
   LeafIndexNodeHandler node(mtr_, tree_handler_.file_header_, current_frame_);
   memcpy(&rid, node.value_at(iter_index_), sizeof(rid));
+  if (user_key != nullptr) {
+    memcpy(user_key, node.key_at(iter_index_), tree_handler_.file_header_.attr_length);
+  }
 }
 
 bool BplusTreeScanner::touch_end()
@@ -1983,14 +2220,16 @@ bool BplusTreeScanner::touch_end()
   return compare_result > 0;
 }
 
-RC BplusTreeScanner::next_entry(RID &rid)
+RC BplusTreeScanner::next_entry(RID &rid) { return next_entry(rid, nullptr); }
+
+RC BplusTreeScanner::next_entry(RID &rid, char *user_key)
 {
   if (nullptr == current_frame_) {
     return RC::RECORD_EOF;
   }
 
   if (!first_emitted_) {
-    fetch_item(rid);
+    fetch_item(rid, user_key);
     first_emitted_ = true;
     return RC::SUCCESS;
   }
@@ -2000,15 +2239,74 @@ RC BplusTreeScanner::next_entry(RID &rid)
   LeafIndexNodeHandler node(mtr_, tree_handler_.file_header_, current_frame_);
   if (iter_index_ < node.size()) {
     if (touch_end()) {
+      current_frame_ = nullptr;
       return RC::RECORD_EOF;
     }
 
-    fetch_item(rid);
+    fetch_item(rid, user_key);
     return RC::SUCCESS;
   }
 
-  RC      rc            = RC::SUCCESS;
-  PageNum next_page_num = node.next_page();
+  RC rc = move_to_next_leaf();
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+  return next_entry(rid, user_key);
+}
+
+RC BplusTreeScanner::next_entries(vector<RID> &rids, vector<char> *user_keys, int max_count)
+{
+  rids.clear();
+  if (user_keys != nullptr) {
+    user_keys->clear();
+  }
+
+  if (nullptr == current_frame_) {
+    return RC::RECORD_EOF;
+  }
+
+  int start_index = first_emitted_ ? iter_index_ + 1 : iter_index_;
+  while (start_index >= LeafIndexNodeHandler(mtr_, tree_handler_.file_header_, current_frame_).size()) {
+    iter_index_ = start_index;
+    RC rc       = move_to_next_leaf();
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    start_index = 0;
+  }
+  first_emitted_ = true;
+
+  LeafIndexNodeHandler node(mtr_, tree_handler_.file_header_, current_frame_);
+  const int            attr_length = tree_handler_.file_header_.attr_length;
+  const int            end_index   = min(node.size(), start_index + max_count);
+  rids.reserve(end_index - start_index);
+  if (user_keys != nullptr) {
+    user_keys->reserve(static_cast<size_t>(attr_length) * (end_index - start_index));
+  }
+
+  for (iter_index_ = start_index; iter_index_ < end_index; iter_index_++) {
+    if (touch_end()) {
+      current_frame_ = nullptr;
+      break;
+    }
+
+    RID rid;
+    memcpy(&rid, node.value_at(iter_index_), sizeof(rid));
+    rids.push_back(rid);
+    if (user_keys != nullptr) {
+      const char *user_key = node.key_at(iter_index_);
+      user_keys->insert(user_keys->end(), user_key, user_key + attr_length);
+    }
+  }
+  iter_index_--;  // 指向最后返回的元素，下一次从它后面开始
+
+  return rids.empty() ? RC::RECORD_EOF : RC::SUCCESS;
+}
+
+RC BplusTreeScanner::move_to_next_leaf()
+{
+  LeafIndexNodeHandler node(mtr_, tree_handler_.file_header_, current_frame_);
+  const PageNum        next_page_num = node.next_page();
   if (BP_INVALID_PAGE_NUM == next_page_num) {
     return RC::RECORD_EOF;
   }
@@ -2016,7 +2314,8 @@ RC BplusTreeScanner::next_entry(RID &rid)
   LatchMemo &latch_memo = mtr_.latch_memo();
 
   const int memo_point = latch_memo.memo_point();
-  rc                   = latch_memo.get_page(next_page_num, current_frame_);
+  Frame    *next_frame = nullptr;
+  RC        rc         = latch_memo.get_page(next_page_num, next_frame);
   if (OB_FAIL(rc)) {
     LOG_WARN("failed to get next page. page num=%d, rc=%s", next_page_num, strrc(rc));
     return rc;
@@ -2027,14 +2326,18 @@ RC BplusTreeScanner::next_entry(RID &rid)
    * 因为这里访问页面的方式顺序与插入、删除的顺序不一样
    * 如果加锁失败，就由上层做重试
    */
-  bool locked = latch_memo.try_slatch(current_frame_);
+  bool locked = latch_memo.try_slatch(next_frame);
   if (!locked) {
+    latch_memo.release_from(memo_point);
     return RC::LOCKED_NEED_WAIT;
   }
 
   latch_memo.release_to(memo_point);
-  iter_index_ = -1;  // `next` will add 1
-  return next_entry(rid);
+  current_frame_ = next_frame;
+  iter_index_    = -1;  // `next` will add 1
+
+  prefetch_next_leaves();
+  return RC::SUCCESS;
 }
 
 RC BplusTreeScanner::close()
@@ -20,9 +20,11 @@ See the Mulan PSL v2 for more details. */
 #include <string.h>
 
 #include "common/lang/comparator.h"
+#include "common/lang/deque.h"
 #include "common/lang/memory.h"
 #include "common/lang/sstream.h"
 #include "common/lang/functional.h"
+#include "common/lang/vector.h"
 #include "common/log/log.h"
 #include "sql/parser/parse_defs.h"
 #include "storage/buffer/disk_buffer_pool.h"
@@ -352,6 +354,12 @@ public:
   int lookup(const KeyComparator &comparator, const char *key, bool *found = nullptr) const;
 
   RC  insert(int index, const char *key, const char *value);
+  /**
+   * @brief 插入一批元素，只记录一条日志
+   * @param indexes 依次插入每个元素时的位置
+   * @param items 依次插入的元素，每个元素包含键值和RID
+   */
+  RC  insert_batch(span<const int> indexes, span<const char> items);
   RC  remove(int index);
   int remove(const char *key, const KeyComparator &comparator);
   RC  move_half_to(LeafIndexNodeHandler &other);
@@ -486,6 +494,16 @@ public:
    */
   RC insert_entry(const char *user_key, const RID *rid);
 
+  /**
+   * @brief 批量插入索引项
+   * @details 先将所有的（user_key，rid）排序，再按照顺序插入。落在同一个叶子节点上的一批键值，
+   * 只需要查找一次叶子节点，在同一个 mini transaction 中完成插入，叶子节点满了才会分裂。
+   * 如果中途失败，已经插入的部分索引项不会回滚，由调用方负责清理。
+   * @param user_keys 要插入的属性值，内存大小与attr_length一致
+   * @param rids 与 user_keys 一一对应的记录标识
+   */
+  RC insert_entries(const vector<const char *> &user_keys, const vector<RID> &rids);
+
   /**
    * @brief 从IndexHandle句柄对应的索引中删除一个值为（user_key，rid）的索引项
    * @return RECORD_INVALID_KEY 指定值不存在
@@ -617,6 +635,14 @@ protected:
    */
   RC insert_entry_into_leaf_node(BplusTreeMiniTransaction &mtr, Frame *frame, const char *pkey, const RID *rid);
 
+  /**
+   * @brief 将排好序的一批键值中，落在同一个叶子节点上的连续一段插入进去
+   * @param keys 所有的键值(包含RID)，每个键值的长度是 key_length
+   * @param order 键值排序后的顺序
+   * @param[in,out] pos 从 order 的哪个位置开始插入，返回时指向下一个还没有插入的位置
+   */
+  RC insert_sorted_entries_into_leaf(const char *keys, const vector<int> &order, size_t &pos);
+
   /**
    * @brief 创建一个新的B+树
    */
@@ -661,6 +687,10 @@ private:
  */
 class BplusTreeScanner
 {
+public:
+  /// 默认预读的叶子节点个数
+  static constexpr int DEFAULT_PREFETCH_DEPTH = 4;
+
 public:
   BplusTreeScanner(BplusTreeHandler &tree_handler);
   ~BplusTreeScanner();
@@ -683,12 +713,37 @@ public:
    *
    * @param rid 当前默认所有值都是RID类型。对B+树来说并不是一个好的抽象
    * @return RC RECORD_EOF 表示遍历完成
-   * TODO 需要增加返回 key 的接口
    * @warning 不要在遍历时删除数据。删除数据会导致遍历器失效。
    * 当前默认的走索引删除的逻辑就是这样做的，所以删除逻辑有BUG。
    */
   RC next_entry(RID &rid);
 
+  /**
+   * @brief 获取下一条记录，同时返回索引中存放的键值
+   * @details 索引覆盖扫描时使用，不需要再回表读取记录
+   * @param rid 记录的位置
+   * @param[out] user_key 用户键值，内存大小至少为 attr_length，为空时不返回键值
+   */
+  RC next_entry(RID &rid, char *user_key);
+
+  /**
+   * @brief 批量获取记录，每次只处理一个叶子节点
+   * @details 在当前叶子节点的读锁下把剩下的满足条件的元素一次复制出来，最多 max_count 个，
+   * 当前叶子节点取完以后下一次调用才移动到下一个叶子节点。
+   * @param[out] rids 返回的记录位置，会先清空
+   * @param[out] user_keys 不为空时依次返回每条记录的键值，每个键值占 attr_length 个字节
+   * @param max_count 最多返回多少条记录
+   * @return RC RECORD_EOF 表示遍历完成
+   */
+  RC next_entries(vector<RID> &rids, vector<char> *user_keys, int max_count);
+
+  /**
+   * @brief 设置预读叶子节点的个数
+   * @details 扫描时始终保持当前叶子节点后面有 depth 个叶子节点已经发起预读，设置为0表示不预读。
+   * 需要在 open 之前设置。
+   */
+  void set_prefetch_depth(int depth) { prefetch_depth_ = depth; }
+
   /**
    * @brief 关闭当前扫描器
    * @details 可以不调用，在析构函数时会自动执行
@@ -701,13 +756,40 @@ private:
    */
   RC fix_user_key(const char *user_key, int key_len, bool want_greater, char **fixed_key, bool *should_inclusive);
 
-  void fetch_item(RID &rid);
+  void fetch_item(RID &rid, char *user_key);
 
   /**
    * @brief 判断是否到了扫描的结束位置
    */
   bool touch_end();
 
+  /**
+   * @brief 当前叶子节点访问完了，移动到下一个叶子节点
+   * @return RC RECORD_EOF 没有下一个叶子节点，LOCKED_NEED_WAIT 下一个叶子节点正在被修改，由上层重试
+   */
+  RC move_to_next_leaf();
+
+  /**
+   * @brief 记录叶子节点后面的兄弟节点，用于预读
+   * @details 在查找叶子节点的过程中调用，最后一次调用时的参数就是叶子节点的父节点
+   * @param internal_node 内部节点
+   * @param index 接下来要访问的子节点在内部节点中的位置
+   */
+  void collect_sibling_leaves(InternalIndexNodeHandler &internal_node, int index);
+
+  /**
+   * @brief 进入一个新的叶子节点后，预读后面的叶子节点
+   * @details 预读队列中的叶子节点少于 prefetch_depth_ 个时，沿着叶子链表从队列的最后一个节点继续向后补齐
+   */
+  void prefetch_next_leaves();
+
+  /**
+   * @brief 读取预读队列中最后一个叶子节点的下一个叶子节点
+   * @details 与扫描移动到下一个叶子节点的方向相同，只尝试加读锁，拿不到锁时返回 BP_INVALID_PAGE_NUM，
+   * 等进入下一个叶子节点时再补齐
+   */
+  PageNum next_leaf_of(PageNum page_num);
+
 private:
   bool                     inited_ = false;
   BplusTreeHandler        &tree_handler_;
@@ -720,4 +802,8 @@ private:
   common::MemPoolItem::item_unique_ptr right_key_;
   int                                  iter_index_    = -1;
   bool                                 first_emitted_ = false;
+
+  int            prefetch_depth_ = DEFAULT_PREFETCH_DEPTH;
+  vector<PageNum> sibling_pages_;     ///< 查找叶子节点时记录的兄弟节点，第一个是叶子节点本身
+  deque<PageNum>  prefetched_pages_;  ///< 已经发起预读但还没有访问到的叶子节点，按照叶子链表的顺序排列
 };
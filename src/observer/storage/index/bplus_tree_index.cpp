@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include "storage/index/bplus_tree_index.h"
+#include "common/lang/algorithm.h"
 #include "common/log/log.h"
 #include "storage/table/table.h"
 #include "storage/db/db.h"
@@ -37,6 +38,8 @@ RC BplusTreeIndex::create(Table *table, const char *file_name, const IndexMeta &
     return rc;
   }
 
+  adaptive_hash_index_.init(field_meta.type(), field_meta.len());
+
   inited_ = true;
   table_  = table;
   LOG_INFO("Successfully create index, file_name:%s, index:%s, field:%s",
@@ -62,6 +65,8 @@ RC BplusTreeIndex::open(Table *table, const char *file_name, const IndexMeta &in
     return rc;
   }
 
+  adaptive_hash_index_.init(field_meta.type(), field_meta.len());
+
   inited_ = true;
   table_  = table;
   LOG_INFO("Successfully open index, file_name:%s, index:%s, field:%s",
@@ -74,6 +79,7 @@ RC BplusTreeIndex::close()
   if (inited_) {
     LOG_INFO("Begin to close index, index:%s, field:%s", index_meta_.name(), index_meta_.field());
     index_handler_.close();
+    adaptive_hash_index_.clear();
     inited_ = false;
   }
   LOG_INFO("Successfully close index.");
@@ -91,23 +97,69 @@ RC BplusTreeIndex::insert_entry(const char *record, const RID *rid)
                rc, strrc(rc));
       return rc;
     }
-    if (!existing_rids.empty()) {
+    // 记录以前的版本使用过这个键值时，它的索引项还没有清理，检查其它记录以后直接复用
+    const bool has_own_entry = find(existing_rids.begin(), existing_rids.end(), *rid) != existing_rids.end();
+    existing_rids.remove(*rid);
+    if (!existing_rids.empty() && key_in_use(table_, record + field_meta_.offset(), existing_rids)) {
       LOG_WARN("Duplicate key when insert entry to unique index. index:%s, field:%s, key value at offset %d",
                index_meta_.name(), index_meta_.field(), field_meta_.offset());
       return RC::RECORD_DUPLICATE_KEY;
     }
+    if (has_own_entry) {
+      return RC::SUCCESS;
+    }
+  }
+  RC rc = index_handler_.insert_entry(record + field_meta_.offset(), rid);
+  adaptive_hash_index_.invalidate(record + field_meta_.offset(), field_meta_.len());
+  return rc;
+}
+
+RC BplusTreeIndex::insert_entries(const vector<const char *> &records, const vector<RID> &rids)
+{
+  // 唯一索引需要逐条检查是否有重复的键值
+  if (index_meta_.unique_type()) {
+    return Index::insert_entries(records, rids);
+  }
+
+  vector<const char *> user_keys;
+  user_keys.reserve(records.size());
+  for (const char *record : records) {
+    user_keys.push_back(record + field_meta_.offset());
+  }
+  RC rc = index_handler_.insert_entries(user_keys, rids);
+  for (const char *user_key : user_keys) {
+    adaptive_hash_index_.invalidate(user_key, field_meta_.len());
   }
-  return index_handler_.insert_entry(record + field_meta_.offset(), rid);
+  return rc;
 }
 
 RC BplusTreeIndex::delete_entry(const char *record, const RID *rid)
 {
-  return index_handler_.delete_entry(record + field_meta_.offset(), rid);
+  RC rc = index_handler_.delete_entry(record + field_meta_.offset(), rid);
+  adaptive_hash_index_.invalidate(record + field_meta_.offset(), field_meta_.len());
+  return rc;
 }
 
 IndexScanner *BplusTreeIndex::create_scanner(
     const char *left_key, int left_len, bool left_inclusive, const char *right_key, int right_len, bool right_inclusive)
 {
+  const bool point_lookup = left_key != nullptr && right_key != nullptr && left_inclusive && right_inclusive &&
+                            left_len == right_len && memcmp(left_key, right_key, left_len) == 0;
+  if (point_lookup) {
+    RC          rc = RC::SUCCESS;
+    vector<RID> rids;
+    auto        tree_lookup = [this, left_key, left_len](list<RID> &tree_rids) {
+      return index_handler_.get_entry(left_key, left_len, tree_rids);
+    };
+    if (adaptive_hash_index_.lookup(left_key, left_len, tree_lookup, rc, rids)) {
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to lookup adaptive hash index. rc=%s", strrc(rc));
+        return nullptr;
+      }
+      return new AdaptiveHashIndexScanner(std::move(rids), adaptive_hash_index_.normalize_key(left_key, left_len));
+    }
+  }
+
   BplusTreeIndexScanner *index_scanner = new BplusTreeIndexScanner(index_handler_);
   RC rc = index_scanner->open(left_key, left_len, left_inclusive, right_key, right_len, right_inclusive);
   if (rc != RC::SUCCESS) {
@@ -133,6 +185,18 @@ RC BplusTreeIndexScanner::open(
 
 RC BplusTreeIndexScanner::next_entry(RID *rid) { return tree_scanner_.next_entry(*rid); }
 
+RC BplusTreeIndexScanner::next_entry_with_key(RID *rid, char *key) { return tree_scanner_.next_entry(*rid, key); }
+
+RC BplusTreeIndexScanner::next_entries(vector<RID> &rids, int max_count)
+{
+  return tree_scanner_.next_entries(rids, nullptr, max_count);
+}
+
+RC BplusTreeIndexScanner::next_entries_with_key(vector<RID> &rids, vector<char> &keys, int key_len, int max_count)
+{
+  return tree_scanner_.next_entries(rids, &keys, max_count);
+}
+
 RC BplusTreeIndexScanner::destroy()
 {
   delete this;
@@ -14,12 +14,14 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include "storage/index/adaptive_hash_index.h"
 #include "storage/index/bplus_tree.h"
 #include "storage/index/index.h"
 
 /**
  * @brief B+树索引
  * @ingroup Index
+ * @details 等值查询会经过自适应哈希索引(AdaptiveHashIndex)，热点键值可以不用从根节点查找
  */
 class BplusTreeIndex : public Index
 {
@@ -32,6 +34,7 @@ public:
   RC close();
 
   RC insert_entry(const char *record, const RID *rid) override;
+  RC insert_entries(const vector<const char *> &records, const vector<RID> &rids) override;
   RC delete_entry(const char *record, const RID *rid) override;
 
   /**
@@ -42,10 +45,19 @@ public:
 
   RC sync() override;
 
+  bool support_index_only_scan() const override { return true; }
+
+  /**
+   * @brief 打开或关闭自适应哈希索引，默认打开
+   */
+  void               set_adaptive_hash_enabled(bool enabled) { adaptive_hash_index_.set_enabled(enabled); }
+  AdaptiveHashIndex &adaptive_hash_index() { return adaptive_hash_index_; }
+
 private:
-  bool             inited_ = false;
-  Table           *table_  = nullptr;
-  BplusTreeHandler index_handler_;
+  bool              inited_ = false;
+  Table            *table_  = nullptr;
+  BplusTreeHandler  index_handler_;
+  AdaptiveHashIndex adaptive_hash_index_;
 };
 
 /**
@@ -59,6 +71,9 @@ public:
   ~BplusTreeIndexScanner() noexcept override;
 
   RC next_entry(RID *rid) override;
+  RC next_entry_with_key(RID *rid, char *key) override;
+  RC next_entries(vector<RID> &rids, int max_count) override;
+  RC next_entries_with_key(vector<RID> &rids, vector<char> &keys, int key_len, int max_count) override;
   RC destroy() override;
 
   RC open(const char *left_key, int left_len, bool left_inclusive, const char *right_key, int right_len,
@@ -62,6 +62,11 @@ RC BplusTreeLogger::node_remove_items(IndexNodeHandler &node_handler, int index,
       node_handler.frame(), LogOperation::Type::NODE_REMOVE, index, items, item_num));
 }
 
+RC BplusTreeLogger::leaf_batch_insert_items(IndexNodeHandler &node_handler, span<const int> indexes, span<const char> items)
+{
+  return append_log_entry(make_unique<LeafBatchInsertLogEntryHandler>(node_handler.frame(), indexes, items));
+}
+
 RC BplusTreeLogger::leaf_set_next_page(IndexNodeHandler &node_handler, PageNum page_num, PageNum old_page_num)
 {
   return append_log_entry(make_unique<LeafSetNextPageLogEntryHandler>(node_handler.frame(), page_num, old_page_num));
@@ -99,6 +99,14 @@ public:
    */
   RC node_remove_items(IndexNodeHandler &node_handler, int index, span<const char> items, int item_num);
 
+  /**
+   * @brief 在叶子节点中依次插入一批元素，只记录一条日志
+   * @param node_handler 页面处理器
+   * @param indexes 依次插入每个元素时的位置
+   * @param items 插入的元素
+   */
+  RC leaf_batch_insert_items(IndexNodeHandler &node_handler, span<const int> indexes, span<const char> items);
+
   /**
    * @brief 初始化一个空的叶子节点
    */
@@ -34,6 +34,7 @@ string LogOperation::to_string() const
     case Type::INTERNAL_UPDATE_KEY: ss << "INTERNAL_UPDATE_KEY"; break;
     case Type::NODE_INSERT: ss << "NODE_INSERT"; break;
     case Type::NODE_REMOVE: ss << "NODE_REMOVE"; break;
+    case Type::LEAF_BATCH_INSERT: ss << "LEAF_BATCH_INSERT"; break;
     default: ss << "INVALID"; break;
   }
   return ss.str();
@@ -172,6 +173,10 @@ RC LogEntryHandler::from_buffer(
       rc = NormalOperationLogEntryHandler::deserialize(frame, operation, buffer, handler);
     } break;
 
+    case LogOperation::Type::LEAF_BATCH_INSERT: {
+      rc = LeafBatchInsertLogEntryHandler::deserialize(frame, buffer, handler);
+    } break;
+
     default: {
       LOG_ERROR("unknown log operation. operation=%d:%s", operation.index(), operation.to_string().c_str());
       return RC::INTERNAL;
@@ -354,6 +359,89 @@ RC NormalOperationLogEntryHandler::redo(BplusTreeMiniTransaction &mtr, BplusTree
   }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// LeafBatchInsertLogEntryHandler
+LeafBatchInsertLogEntryHandler::LeafBatchInsertLogEntryHandler(
+    Frame *frame, span<const int> indexes, span<const char> items)
+    : NodeLogEntryHandler(LogOperation::Type::LEAF_BATCH_INSERT, frame),
+      indexes_(indexes.begin(), indexes.end()),
+      items_(items.begin(), items.end())
+{}
+
+RC LeafBatchInsertLogEntryHandler::serialize_body(Serializer &buffer) const
+{
+  int32_t item_num   = static_cast<int32_t>(indexes_.size());
+  int32_t item_bytes = static_cast<int32_t>(items_.size());
+  if (buffer.write_int32(item_num) < 0) {
+    return RC::INTERNAL;
+  }
+  for (int index : indexes_) {
+    if (buffer.write_int32(index) < 0) {
+      return RC::INTERNAL;
+    }
+  }
+  if (buffer.write_int32(item_bytes) < 0 || buffer.write(items_) < 0) {
+    return RC::INTERNAL;
+  }
+  return RC::SUCCESS;
+}
+
+string LeafBatchInsertLogEntryHandler::to_string() const
+{
+  stringstream ss;
+  ss << LogEntryHandler::to_string() << ", item_num=" << indexes_.size();
+  return ss.str();
+}
+
+RC LeafBatchInsertLogEntryHandler::deserialize(Frame *frame, Deserializer &buffer, unique_ptr<LogEntryHandler> &handler)
+{
+  int32_t item_num = -1;
+  if (buffer.read_int32(item_num) < 0 || item_num < 0) {
+    return RC::INTERNAL;
+  }
+
+  vector<int> indexes(item_num);
+  for (int32_t i = 0; i < item_num; i++) {
+    if (buffer.read_int32(indexes[i]) < 0) {
+      return RC::INTERNAL;
+    }
+  }
+
+  int32_t item_bytes = -1;
+  if (buffer.read_int32(item_bytes) < 0 || item_bytes < 0) {
+    return RC::INTERNAL;
+  }
+  vector<char> items(item_bytes);
+  if (buffer.read(items) < 0) {
+    return RC::INTERNAL;
+  }
+
+  handler = make_unique<LeafBatchInsertLogEntryHandler>(frame, indexes, items);
+  return RC::SUCCESS;
+}
+
+RC LeafBatchInsertLogEntryHandler::rollback(BplusTreeMiniTransaction &mtr, BplusTreeHandler &tree_handler)
+{
+  if (nullptr == frame()) {
+    return RC::INTERNAL;
+  }
+  LeafIndexNodeHandler leaf_node(mtr, tree_handler.file_header(), frame());
+  for (auto iter = indexes_.rbegin(); iter != indexes_.rend(); ++iter) {
+    leaf_node.recover_remove_items(*iter, 1);
+  }
+  return RC::SUCCESS;
+}
+
+RC LeafBatchInsertLogEntryHandler::redo(BplusTreeMiniTransaction &mtr, BplusTreeHandler &tree_handler)
+{
+  LeafIndexNodeHandler leaf_node(mtr, tree_handler.file_header(), frame());
+  const int            item_size = leaf_node.item_size();
+  for (size_t i = 0; i < indexes_.size(); i++) {
+    leaf_node.recover_insert_items(indexes_[i], items_.data() + i * item_size, 1);
+  }
+  return RC::SUCCESS;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // LeafInitEmptyLogEntryHandler
 LeafInitEmptyLogEntryHandler::LeafInitEmptyLogEntryHandler(Frame *frame)
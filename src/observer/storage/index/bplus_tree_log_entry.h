@@ -50,6 +50,7 @@ public:
     INTERNAL_UPDATE_KEY,       /// 更新内部节点的key
     NODE_INSERT,               /// 在节点中间(也可能是末尾)插入一些元素
     NODE_REMOVE,               /// 在节点中间(也可能是末尾)删除一些元素
+    LEAF_BATCH_INSERT,         /// 在叶子节点中依次插入一批元素
 
     MAX_TYPE,
   };
@@ -256,6 +257,36 @@ private:
   vector<char> items_;
 };
 
+/**
+ * @brief 在叶子节点中依次插入一批元素
+ * @ingroup CLog
+ * @details 批量插入索引时，同一个叶子节点上的键值只记录一条日志。
+ * 每个元素都记录插入时的位置，重做时按顺序插入，回滚时按相反的顺序删除
+ */
+class LeafBatchInsertLogEntryHandler : public NodeLogEntryHandler
+{
+public:
+  LeafBatchInsertLogEntryHandler(Frame *frame, span<const int> indexes, span<const char> items);
+  virtual ~LeafBatchInsertLogEntryHandler() = default;
+
+  RC serialize_body(common::Serializer &buffer) const override;
+  RC rollback(BplusTreeMiniTransaction &mtr, BplusTreeHandler &tree_handler) override;
+  RC redo(BplusTreeMiniTransaction &mtr, BplusTreeHandler &tree_handler) override;
+
+  string to_string() const override;
+
+  static RC deserialize(Frame *frame, common::Deserializer &buffer, unique_ptr<LogEntryHandler> &handler);
+
+  int         item_num() const { return static_cast<int>(indexes_.size()); }
+  const int  *indexes() const { return indexes_.data(); }
+  const char *items() const { return items_.data(); }
+  int32_t     item_bytes() const { return static_cast<int32_t>(items_.size()); }
+
+private:
+  vector<int>  indexes_;
+  vector<char> items_;
+};
+
 /**
  * @brief 叶子节点初始化日志处理类
  * @ingroup CLog
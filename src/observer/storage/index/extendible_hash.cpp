@@ -0,0 +1,576 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/index/extendible_hash.h"
+#include <stddef.h>
+
+#include "common/log/log.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/defer.h"
+#include "common/lang/sstream.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "storage/buffer/frame.h"
+#include "storage/index/extendible_hash_log.h"
+
+using namespace common;
+
+/// 哈希索引的头页面，第0页是缓冲池自己的头页面
+static constexpr PageNum HASH_HEADER_PAGE = 1;
+
+static constexpr int DIRECTORY_OFFSET = static_cast<int>(sizeof(ExtendibleHashFileHeader));
+static constexpr int BUCKET_HEADER_SIZE = static_cast<int>(sizeof(ExtendibleHashBucketHeader));
+
+static_assert(DIRECTORY_OFFSET + static_cast<int>(sizeof(PageNum)) * (1 << ExtendibleHashHandler::MAX_GLOBAL_DEPTH) <=
+                  BP_PAGE_DATA_SIZE,
+    "directory of extendible hash is too large");
+
+string ExtendibleHashFileHeader::to_string() const
+{
+  stringstream ss;
+  ss << "attr_length:" << attr_length << ", key_length:" << key_length << ", attr_type:" << attr_type_to_string(attr_type)
+     << ", bucket_capacity:" << bucket_capacity << ", global_depth:" << global_depth;
+  return ss.str();
+}
+
+static ExtendibleHashFileHeader *file_header_of(Frame *frame)
+{
+  return reinterpret_cast<ExtendibleHashFileHeader *>(frame->data());
+}
+
+static ExtendibleHashBucketHeader *bucket_header_of(Frame *frame)
+{
+  return reinterpret_cast<ExtendibleHashBucketHeader *>(frame->data());
+}
+
+static int directory_offset(int index) { return DIRECTORY_OFFSET + index * static_cast<int>(sizeof(PageNum)); }
+
+////////////////////////////////////////////////////////////////////////////////
+// class ExtendibleHashHandler
+RC ExtendibleHashHandler::create(LogHandler &log_handler, BufferPoolManager &bpm, const char *file_name,
+    AttrType attr_type, int attr_length, int bucket_capacity /* = -1 */)
+{
+  RC rc = bpm.create_file(file_name);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("Failed to create file. file name=%s, rc=%d:%s", file_name, rc, strrc(rc));
+    return rc;
+  }
+  LOG_INFO("Successfully create hash index file:%s", file_name);
+
+  DiskBufferPool *bp = nullptr;
+
+  rc = bpm.open_file(log_handler, file_name, bp);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("Failed to open file. file name=%s, rc=%d:%s", file_name, rc, strrc(rc));
+    return rc;
+  }
+
+  rc = this->create(log_handler, *bp, attr_type, attr_length, bucket_capacity);
+  if (OB_FAIL(rc)) {
+    bpm.close_file(file_name);
+    return rc;
+  }
+
+  LOG_INFO("Successfully create hash index file %s.", file_name);
+  return rc;
+}
+
+RC ExtendibleHashHandler::create(
+    LogHandler &log_handler, DiskBufferPool &buffer_pool, AttrType attr_type, int attr_length, int bucket_capacity)
+{
+  const int key_length   = attr_length + static_cast<int>(sizeof(RID));
+  const int max_capacity = (BP_PAGE_DATA_SIZE - BUCKET_HEADER_SIZE) / key_length;
+  if (bucket_capacity < 0 || bucket_capacity > max_capacity) {
+    bucket_capacity = max_capacity;
+  }
+  if (bucket_capacity < 1) {
+    LOG_WARN("attr length is too large for hash index. attr_length=%d", attr_length);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  Frame *header_frame = nullptr;
+  RC     rc           = buffer_pool.allocate_page(&header_frame);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to allocate header page for hash index. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  if (header_frame->page_num() != HASH_HEADER_PAGE) {
+    LOG_WARN("header page num should be %d but got %d. is it a new file", HASH_HEADER_PAGE, header_frame->page_num());
+    buffer_pool.unpin_page(header_frame);
+    return RC::INTERNAL;
+  }
+
+  Frame *bucket_frame = nullptr;
+  rc                  = buffer_pool.allocate_page(&bucket_frame);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to allocate first bucket page for hash index. rc=%s", strrc(rc));
+    buffer_pool.unpin_page(header_frame);
+    return rc;
+  }
+
+  ExtendibleHashBucketHeader *bucket_header = bucket_header_of(bucket_frame);
+  bucket_header->local_depth                = 0;
+  bucket_header->size                       = 0;
+  bucket_header->overflow_page              = BP_INVALID_PAGE_NUM;
+  bucket_frame->mark_dirty();
+
+  ExtendibleHashFileHeader *file_header = file_header_of(header_frame);
+  file_header->attr_length              = attr_length;
+  file_header->key_length               = key_length;
+  file_header->attr_type                = attr_type;
+  file_header->bucket_capacity          = bucket_capacity;
+  file_header->global_depth             = 0;
+  file_header->directory[0]             = bucket_frame->page_num();
+  header_frame->mark_dirty();
+  LOG_INFO("init hash index header. %s", file_header->to_string().c_str());
+
+  buffer_pool.unpin_page(bucket_frame);
+  buffer_pool.unpin_page(header_frame);
+
+  log_handler_      = &log_handler;
+  disk_buffer_pool_ = &buffer_pool;
+  attr_type_        = attr_type;
+  attr_length_      = attr_length;
+  key_length_       = key_length;
+  bucket_capacity_  = bucket_capacity;
+
+  /*
+  与B+树相同，创建时的页面修改不记录日志，而是直接刷到磁盘。
+  恢复时要求索引文件已经是一个完整的哈希表，后续的修改都可以通过物理日志重做。
+  */
+  rc = this->sync();
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to sync hash index. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  LOG_INFO("Successfully create hash index");
+  return RC::SUCCESS;
+}
+
+RC ExtendibleHashHandler::open(LogHandler &log_handler, BufferPoolManager &bpm, const char *file_name)
+{
+  if (disk_buffer_pool_ != nullptr) {
+    LOG_WARN("%s has been opened before index.open.", file_name);
+    return RC::RECORD_OPENNED;
+  }
+
+  DiskBufferPool *disk_buffer_pool = nullptr;
+
+  RC rc = bpm.open_file(log_handler, file_name, disk_buffer_pool);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("Failed to open file name=%s, rc=%d:%s", file_name, rc, strrc(rc));
+    return rc;
+  }
+
+  rc = this->open(log_handler, *disk_buffer_pool);
+  if (OB_SUCC(rc)) {
+    LOG_INFO("open hash index success. filename=%s", file_name);
+  }
+  return rc;
+}
+
+RC ExtendibleHashHandler::open(LogHandler &log_handler, DiskBufferPool &buffer_pool)
+{
+  if (disk_buffer_pool_ != nullptr) {
+    LOG_WARN("hash index has been opened before index.open.");
+    return RC::RECORD_OPENNED;
+  }
+
+  Frame *frame = nullptr;
+  RC     rc    = buffer_pool.get_this_page(HASH_HEADER_PAGE, &frame);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("Failed to get header page, rc=%d:%s", rc, strrc(rc));
+    return rc;
+  }
+
+  const ExtendibleHashFileHeader *file_header = file_header_of(frame);
+  attr_type_                                  = file_header->attr_type;
+  attr_length_                                = file_header->attr_length;
+  key_length_                                 = file_header->key_length;
+  bucket_capacity_                            = file_header->bucket_capacity;
+  buffer_pool.unpin_page(frame);
+
+  log_handler_      = &log_handler;
+  disk_buffer_pool_ = &buffer_pool;
+  return RC::SUCCESS;
+}
+
+RC ExtendibleHashHandler::close()
+{
+  if (disk_buffer_pool_ != nullptr) {
+    disk_buffer_pool_->close_file();
+  }
+
+  disk_buffer_pool_ = nullptr;
+  return RC::SUCCESS;
+}
+
+RC ExtendibleHashHandler::sync() { return disk_buffer_pool_->flush_all_pages(); }
+
+int ExtendibleHashHandler::global_depth()
+{
+  lock_.lock_shared();
+  DEFER(lock_.unlock_shared());
+
+  ExtendibleHashMiniTransaction mtr(*disk_buffer_pool_, *log_handler_);
+
+  Frame *header_frame = nullptr;
+  if (OB_FAIL(mtr.get_page(HASH_HEADER_PAGE, header_frame))) {
+    return -1;
+  }
+  return file_header_of(header_frame)->global_depth;
+}
+
+void ExtendibleHashHandler::normalize_key(const char *user_key, int key_len, char *key) const
+{
+  memset(key, 0, attr_length_);
+  memcpy(key, user_key, std::min(key_len, attr_length_));
+
+  switch (attr_type_) {
+    case AttrType::CHARS: {
+      const char *end = static_cast<const char *>(memchr(key, 0, attr_length_));
+      if (end != nullptr) {
+        memset(key + (end - key), 0, attr_length_ - (end - key));
+      }
+    } break;
+    case AttrType::FLOATS: {
+      float value = 0;
+      memcpy(&value, key, sizeof(value));
+      if (value == 0) {
+        value = 0;
+        memcpy(key, &value, sizeof(value));
+      }
+    } break;
+    default: break;
+  }
+}
+
+uint32_t ExtendibleHashHandler::hash(const char *key) const
+{
+  // FNV-1a
+  uint32_t hash_value = 2166136261U;
+  for (int i = 0; i < attr_length_; i++) {
+    hash_value ^= static_cast<uint8_t>(key[i]);
+    hash_value *= 16777619U;
+  }
+  return hash_value;
+}
+
+char *ExtendibleHashHandler::entry_at(Frame *frame, int index) const
+{
+  return frame->data() + BUCKET_HEADER_SIZE + index * key_length_;
+}
+
+RC ExtendibleHashHandler::find_bucket(
+    ExtendibleHashMiniTransaction &mtr, uint32_t hash_value, Frame *&header_frame, Frame *&bucket_frame)
+{
+  RC rc = mtr.get_page(HASH_HEADER_PAGE, header_frame);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  const ExtendibleHashFileHeader *file_header = file_header_of(header_frame);
+  const uint32_t                  mask        = (1U << file_header->global_depth) - 1;
+  return mtr.get_page(file_header->directory[hash_value & mask], bucket_frame);
+}
+
+RC ExtendibleHashHandler::insert_entry(const char *user_key, const RID *rid, bool unique /* = false */)
+{
+  lock_.lock();
+  DEFER(lock_.unlock());
+
+  vector<char> entry(key_length_);
+  normalize_key(user_key, attr_length_, entry.data());
+  memcpy(entry.data() + attr_length_, rid, sizeof(RID));
+  const uint32_t hash_value = hash(entry.data());
+
+  ExtendibleHashMiniTransaction mtr(*disk_buffer_pool_, *log_handler_);
+
+  RC rc = RC::SUCCESS;
+  while (true) {
+    Frame *header_frame = nullptr;
+    Frame *bucket_frame = nullptr;
+    rc                  = find_bucket(mtr, hash_value, header_frame, bucket_frame);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to find bucket. rc=%s", strrc(rc));
+      return rc;
+    }
+
+    // 遍历整个桶，检查重复的键值，同时找一个有空闲位置的页面
+    Frame *free_frame     = nullptr;
+    Frame *last_frame     = nullptr;
+    bool   all_same_hash  = true;
+    for (Frame *frame = bucket_frame; frame != nullptr;) {
+      const ExtendibleHashBucketHeader *bucket_header = bucket_header_of(frame);
+      for (int i = 0; i < bucket_header->size; i++) {
+        const char *item = entry_at(frame, i);
+        if (memcmp(item, entry.data(), attr_length_) == 0) {
+          if (unique || *entry_rid(item) == *rid) {
+            return RC::RECORD_DUPLICATE_KEY;
+          }
+        } else if (all_same_hash && hash(item) != hash_value) {
+          all_same_hash = false;
+        }
+      }
+
+      if (free_frame == nullptr && bucket_header->size < bucket_capacity_) {
+        free_frame = frame;
+      }
+
+      last_frame = frame;
+      if (bucket_header->overflow_page == BP_INVALID_PAGE_NUM) {
+        frame = nullptr;
+      } else if (OB_FAIL(rc = mtr.get_page(bucket_header->overflow_page, frame))) {
+        LOG_WARN("failed to get overflow page. rc=%s", strrc(rc));
+        return rc;
+      }
+    }
+
+    if (free_frame != nullptr) {
+      const int size = bucket_header_of(free_frame)->size;
+      mtr.write(free_frame, BUCKET_HEADER_SIZE + size * key_length_, entry.data(), key_length_);
+      const int new_size = size + 1;
+      mtr.write(free_frame, offsetof(ExtendibleHashBucketHeader, size), &new_size, sizeof(new_size));
+      break;
+    }
+
+    // 桶满了，能分裂就分裂，分裂后重新查找。所有的项哈希值都相同时分裂也没有用
+    if (bucket_header_of(bucket_frame)->local_depth < MAX_GLOBAL_DEPTH && !all_same_hash) {
+      rc = split_bucket(mtr, header_frame, bucket_frame);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to split bucket. rc=%s", strrc(rc));
+        return rc;
+      }
+      continue;
+    }
+
+    Frame *overflow_frame = nullptr;
+    rc                    = mtr.allocate_page(overflow_frame);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to allocate overflow page. rc=%s", strrc(rc));
+      return rc;
+    }
+
+    ExtendibleHashBucketHeader overflow_header;
+    overflow_header.local_depth   = bucket_header_of(bucket_frame)->local_depth;
+    overflow_header.size          = 1;
+    overflow_header.overflow_page = BP_INVALID_PAGE_NUM;
+    mtr.write(overflow_frame, 0, &overflow_header, BUCKET_HEADER_SIZE);
+    mtr.write(overflow_frame, BUCKET_HEADER_SIZE, entry.data(), key_length_);
+
+    const PageNum overflow_page = overflow_frame->page_num();
+    mtr.write(last_frame, offsetof(ExtendibleHashBucketHeader, overflow_page), &overflow_page, sizeof(overflow_page));
+    break;
+  }
+
+  return mtr.commit();
+}
+
+RC ExtendibleHashHandler::split_bucket(ExtendibleHashMiniTransaction &mtr, Frame *header_frame, Frame *bucket_frame)
+{
+  const ExtendibleHashFileHeader *file_header = file_header_of(header_frame);
+  const int                       local_depth = bucket_header_of(bucket_frame)->local_depth;
+  int                             global_depth = file_header->global_depth;
+
+  if (local_depth == global_depth) {
+    if (global_depth >= MAX_GLOBAL_DEPTH) {
+      LOG_WARN("directory of hash index is full. global_depth=%d", global_depth);
+      return RC::INTERNAL;
+    }
+
+    // 目录扩大一倍，新的一半与原来的一半指向相同的桶
+    const int old_size = 1 << global_depth;
+    mtr.write(header_frame, directory_offset(old_size), file_header->directory, old_size * sizeof(PageNum));
+    global_depth++;
+    mtr.write(header_frame, offsetof(ExtendibleHashFileHeader, global_depth), &global_depth, sizeof(global_depth));
+  }
+
+  // 收集桶中所有的项，按照哈希值的第 local_depth 位分成两部分
+  vector<char> stay_entries;
+  vector<char> move_entries;
+  RC           rc = RC::SUCCESS;
+  for (Frame *frame = bucket_frame; frame != nullptr;) {
+    const ExtendibleHashBucketHeader *bucket_header = bucket_header_of(frame);
+    for (int i = 0; i < bucket_header->size; i++) {
+      const char   *item    = entry_at(frame, i);
+      vector<char> &entries = ((hash(item) >> local_depth) & 1) ? move_entries : stay_entries;
+      entries.insert(entries.end(), item, item + key_length_);
+    }
+
+    if (bucket_header->overflow_page == BP_INVALID_PAGE_NUM) {
+      frame = nullptr;
+    } else if (OB_FAIL(rc = mtr.get_page(bucket_header->overflow_page, frame))) {
+      LOG_WARN("failed to get overflow page. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+
+  Frame *new_frame = nullptr;
+  rc               = mtr.allocate_page(new_frame);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to allocate bucket page. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  ExtendibleHashBucketHeader new_header;
+  new_header.local_depth   = local_depth + 1;
+  new_header.size          = 0;
+  new_header.overflow_page = BP_INVALID_PAGE_NUM;
+  mtr.write(new_frame, 0, &new_header, BUCKET_HEADER_SIZE);
+
+  rc = write_bucket(mtr, bucket_frame, local_depth + 1, stay_entries);
+  if (OB_SUCC(rc)) {
+    rc = write_bucket(mtr, new_frame, local_depth + 1, move_entries);
+  }
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  // 原来指向这个桶的目录项中，第 local_depth 位是1的改为指向新桶
+  const PageNum bucket_page = bucket_frame->page_num();
+  const PageNum new_page    = new_frame->page_num();
+  for (int i = 0; i < (1 << global_depth); i++) {
+    if (file_header->directory[i] == bucket_page && ((i >> local_depth) & 1)) {
+      mtr.write(header_frame, directory_offset(i), &new_page, sizeof(new_page));
+    }
+  }
+
+  LOG_TRACE("split hash bucket. page=%d, new page=%d, local depth=%d, global depth=%d",
+            bucket_page, new_page, local_depth + 1, global_depth);
+  return RC::SUCCESS;
+}
+
+RC ExtendibleHashHandler::write_bucket(
+    ExtendibleHashMiniTransaction &mtr, Frame *bucket_frame, int local_depth, const vector<char> &entries)
+{
+  const int entry_num = static_cast<int>(entries.size()) / key_length_;
+
+  RC     rc    = RC::SUCCESS;
+  int    pos   = 0;
+  Frame *frame = bucket_frame;
+  while (frame != nullptr) {
+    ExtendibleHashBucketHeader header = *bucket_header_of(frame);
+
+    header.local_depth = local_depth;
+    header.size        = std::min(bucket_capacity_, entry_num - pos);
+    if (header.size > 0) {
+      mtr.write(frame, BUCKET_HEADER_SIZE, entries.data() + pos * key_length_, header.size * key_length_);
+    }
+    pos += header.size;
+
+    Frame *next_frame = nullptr;
+    if (header.overflow_page != BP_INVALID_PAGE_NUM) {
+      // 剩余的溢出页即使没有数据也保留在链表中，后面插入时可以直接使用
+      rc = mtr.get_page(header.overflow_page, next_frame);
+    } else if (pos < entry_num) {
+      rc = mtr.allocate_page(next_frame);
+      if (OB_SUCC(rc)) {
+        ExtendibleHashBucketHeader next_header;
+        next_header.local_depth   = local_depth;
+        next_header.size          = 0;
+        next_header.overflow_page = BP_INVALID_PAGE_NUM;
+        mtr.write(next_frame, 0, &next_header, BUCKET_HEADER_SIZE);
+        header.overflow_page = next_frame->page_num();
+      }
+    }
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get overflow page of hash bucket. rc=%s", strrc(rc));
+      return rc;
+    }
+
+    mtr.write(frame, 0, &header, BUCKET_HEADER_SIZE);
+    frame = next_frame;
+  }
+  return rc;
+}
+
+RC ExtendibleHashHandler::delete_entry(const char *user_key, const RID *rid)
+{
+  lock_.lock();
+  DEFER(lock_.unlock());
+
+  vector<char> key(attr_length_);
+  normalize_key(user_key, attr_length_, key.data());
+
+  ExtendibleHashMiniTransaction mtr(*disk_buffer_pool_, *log_handler_);
+
+  Frame *header_frame = nullptr;
+  Frame *frame        = nullptr;
+  RC     rc           = find_bucket(mtr, hash(key.data()), header_frame, frame);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to find bucket. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  while (frame != nullptr) {
+    const ExtendibleHashBucketHeader *bucket_header = bucket_header_of(frame);
+    for (int i = 0; i < bucket_header->size; i++) {
+      const char *item = entry_at(frame, i);
+      if (memcmp(item, key.data(), attr_length_) != 0 || !(*entry_rid(item) == *rid)) {
+        continue;
+      }
+
+      // 桶中的项是无序的，用最后一项覆盖要删除的项即可
+      const int last = bucket_header->size - 1;
+      if (i != last) {
+        mtr.write(frame, BUCKET_HEADER_SIZE + i * key_length_, entry_at(frame, last), key_length_);
+      }
+      mtr.write(frame, offsetof(ExtendibleHashBucketHeader, size), &last, sizeof(last));
+      return mtr.commit();
+    }
+
+    if (bucket_header->overflow_page == BP_INVALID_PAGE_NUM) {
+      frame = nullptr;
+    } else if (OB_FAIL(rc = mtr.get_page(bucket_header->overflow_page, frame))) {
+      LOG_WARN("failed to get overflow page. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+
+  return RC::RECORD_NOT_EXIST;
+}
+
+RC ExtendibleHashHandler::get_entry(const char *user_key, int key_len, list<RID> &rids)
+{
+  lock_.lock_shared();
+  DEFER(lock_.unlock_shared());
+
+  vector<char> key(attr_length_);
+  normalize_key(user_key, key_len, key.data());
+
+  ExtendibleHashMiniTransaction mtr(*disk_buffer_pool_, *log_handler_);
+
+  Frame *header_frame = nullptr;
+  Frame *frame        = nullptr;
+  RC     rc           = find_bucket(mtr, hash(key.data()), header_frame, frame);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to find bucket. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  while (frame != nullptr) {
+    const ExtendibleHashBucketHeader *bucket_header = bucket_header_of(frame);
+    for (int i = 0; i < bucket_header->size; i++) {
+      const char *item = entry_at(frame, i);
+      if (memcmp(item, key.data(), attr_length_) == 0) {
+        rids.push_back(*entry_rid(item));
+      }
+    }
+
+    if (bucket_header->overflow_page == BP_INVALID_PAGE_NUM) {
+      frame = nullptr;
+    } else if (OB_FAIL(rc = mtr.get_page(bucket_header->overflow_page, frame))) {
+      LOG_WARN("failed to get overflow page. rc=%s", strrc(rc));
+      return rc;
+    }
+  }
+  return RC::SUCCESS;
+}
@@ -0,0 +1,170 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/list.h"
+#include "common/lang/mutex.h"
+#include "common/lang/string.h"
+#include "common/lang/vector.h"
+#include "common/types.h"
+#include "common/type/attr_type.h"
+#include "storage/record/record.h"
+
+class Frame;
+class LogHandler;
+class DiskBufferPool;
+class BufferPoolManager;
+class ExtendibleHashMiniTransaction;
+
+/**
+ * @brief 可扩展哈希
+ * @defgroup ExtendibleHash
+ * @details 可扩展哈希由一个目录和若干个桶组成。目录保存在索引文件的第一个页面，每一项指向一个桶页面。
+ * 根据键值哈希值的低 global_depth 位找到目录项，再找到桶。桶满了以后分裂成两个，
+ * 如果桶的 local_depth 已经等于 global_depth，就先把目录扩大一倍。
+ * 目录的大小受页面大小限制，达到最大深度以后，或者桶中所有元素的哈希值都相同时，
+ * 不再分裂，而是在桶后面挂溢出页。删除元素时不会合并桶。
+ */
+
+/**
+ * @brief 哈希索引文件的头页面
+ * @ingroup ExtendibleHash
+ * @details 目录紧跟在头部后面，共 1 << global_depth 项
+ */
+struct ExtendibleHashFileHeader
+{
+  int32_t  attr_length;      ///< 键值的长度
+  int32_t  key_length;       ///< 桶中每一项的长度，即 attr_length + sizeof(RID)
+  AttrType attr_type;        ///< 键值的类型
+  int32_t  bucket_capacity;  ///< 每个桶页面最多存放多少项
+  int32_t  global_depth;     ///< 目录的深度
+  PageNum  directory[0];     ///< 目录，每一项是一个桶的页面编号
+
+  string to_string() const;
+};
+
+/**
+ * @brief 桶页面的头部
+ * @ingroup ExtendibleHash
+ * @details 头部后面紧跟着 size 个 (key, rid) 项。溢出页与桶页面的格式相同，溢出页的 local_depth 没有意义
+ */
+struct ExtendibleHashBucketHeader
+{
+  int32_t local_depth;    ///< 桶的深度，哈希值的低 local_depth 位相同的键值都在这个桶中
+  int32_t size;           ///< 当前页面中有多少项
+  PageNum overflow_page;  ///< 下一个溢出页，没有时为 BP_INVALID_PAGE_NUM
+};
+
+/**
+ * @brief 可扩展哈希的实现
+ * @ingroup ExtendibleHash
+ * @details 只支持等值查询。所有的修改都通过 ExtendibleHashMiniTransaction 记录物理日志，
+ * 一次操作是一条日志。这里使用一个读写锁保护整个哈希表，查询可以并发，修改是串行的。
+ */
+class ExtendibleHashHandler
+{
+public:
+  ExtendibleHashHandler()  = default;
+  ~ExtendibleHashHandler() = default;
+
+  /**
+   * @brief 创建一个哈希表
+   * @param log_handler 记录日志
+   * @param bpm 缓冲池管理器
+   * @param file_name 文件名
+   * @param attr_type 属性类型
+   * @param attr_length 属性长度
+   * @param bucket_capacity 每个桶最多存放多少项，小于0时按照页面大小计算，主要用于测试
+   */
+  RC create(LogHandler &log_handler, BufferPoolManager &bpm, const char *file_name, AttrType attr_type,
+      int attr_length, int bucket_capacity = -1);
+  RC create(LogHandler &log_handler, DiskBufferPool &buffer_pool, AttrType attr_type, int attr_length,
+      int bucket_capacity = -1);
+
+  /**
+   * @brief 打开一个哈希表
+   */
+  RC open(LogHandler &log_handler, BufferPoolManager &bpm, const char *file_name);
+  RC open(LogHandler &log_handler, DiskBufferPool &buffer_pool);
+
+  RC close();
+
+  /**
+   * @brief 插入一个 (user_key, rid) 项
+   * @param unique 是否检查键值唯一
+   * @return RECORD_DUPLICATE_KEY 相同的项已经存在，或者要求唯一时键值已经存在
+   * @note 这里假设user_key的内存大小与attr_length 一致
+   */
+  RC insert_entry(const char *user_key, const RID *rid, bool unique = false);
+
+  /**
+   * @brief 删除一个 (user_key, rid) 项
+   * @return RECORD_NOT_EXIST 指定的项不存在
+   */
+  RC delete_entry(const char *user_key, const RID *rid);
+
+  /**
+   * @brief 查找键值对应的所有记录
+   * @param key_len user_key的长度，比属性长度短时(比如字符串)会在后面补0
+   */
+  RC get_entry(const char *user_key, int key_len, list<RID> &rids);
+
+  RC sync();
+
+public:
+  static constexpr int MAX_GLOBAL_DEPTH = 10;
+
+  int             attr_length() const { return attr_length_; }
+  AttrType        attr_type() const { return attr_type_; }
+  int             bucket_capacity() const { return bucket_capacity_; }
+  DiskBufferPool &buffer_pool() const { return *disk_buffer_pool_; }
+
+  /**
+   * @brief 当前目录的深度
+   */
+  int global_depth();
+
+private:
+  /**
+   * @brief 把键值转换成统一的格式
+   * @details 字符串后面补0，浮点数的-0转成0，保证相等的键值字节完全相同，哈希值也相同
+   */
+  void     normalize_key(const char *user_key, int key_len, char *key) const;
+  uint32_t hash(const char *key) const;
+
+  char       *entry_at(Frame *frame, int index) const;
+  const RID  *entry_rid(const char *entry) const { return reinterpret_cast<const RID *>(entry + attr_length_); }
+
+  RC find_bucket(ExtendibleHashMiniTransaction &mtr, uint32_t hash_value, Frame *&header_frame, Frame *&bucket_frame);
+
+  /**
+   * @brief 分裂桶
+   * @details 把桶(包括溢出页)中的项按照哈希值的第 local_depth 位分到两个桶中，必要时扩大目录
+   */
+  RC split_bucket(ExtendibleHashMiniTransaction &mtr, Frame *header_frame, Frame *bucket_frame);
+
+  /**
+   * @brief 把若干个项写入到一个桶中，空间不够时使用或者分配溢出页
+   */
+  RC write_bucket(ExtendibleHashMiniTransaction &mtr, Frame *bucket_frame, int local_depth, const vector<char> &entries);
+
+private:
+  LogHandler     *log_handler_      = nullptr;
+  DiskBufferPool *disk_buffer_pool_ = nullptr;
+
+  // 以下是不会变化的元数据，从头页面中复制出来。目录深度等会变化的数据每次都从页面中读取
+  AttrType attr_type_       = AttrType::UNDEFINED;
+  int      attr_length_     = 0;
+  int      key_length_      = 0;
+  int      bucket_capacity_ = 0;
+
+  common::SharedMutex lock_;
+};
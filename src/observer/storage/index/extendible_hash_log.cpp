@@ -0,0 +1,228 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/index/extendible_hash_log.h"
+#include "common/log/log.h"
+#include "common/lang/defer.h"
+#include "common/lang/sstream.h"
+#include "common/lang/algorithm.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "storage/buffer/frame.h"
+#include "storage/clog/log_entry.h"
+#include "storage/clog/log_handler.h"
+
+using namespace common;
+
+const int32_t ExtendibleHashLogHeader::SIZE = sizeof(ExtendibleHashLogHeader);
+const int32_t ExtendibleHashLogRegion::SIZE = sizeof(ExtendibleHashLogRegion);
+
+string ExtendibleHashLogHeader::to_string() const
+{
+  stringstream ss;
+  ss << "buffer_pool_id:" << buffer_pool_id << ", region_num:" << region_num;
+  return ss.str();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// class ExtendibleHashMiniTransaction
+ExtendibleHashMiniTransaction::ExtendibleHashMiniTransaction(DiskBufferPool &buffer_pool, LogHandler &log_handler)
+    : buffer_pool_(buffer_pool), log_handler_(log_handler)
+{
+  log_payload_.resize(ExtendibleHashLogHeader::SIZE);
+}
+
+ExtendibleHashMiniTransaction::~ExtendibleHashMiniTransaction()
+{
+  if (!committed_) {
+    rollback();
+  }
+
+  for (Frame *frame : frames_) {
+    buffer_pool_.unpin_page(frame);
+  }
+  for (PageNum page_num : allocated_pages_) {
+    buffer_pool_.dispose_page(page_num);
+  }
+}
+
+RC ExtendibleHashMiniTransaction::get_page(PageNum page_num, Frame *&frame)
+{
+  // 同一个页面只pin一次
+  auto iter = find_if(frames_.begin(), frames_.end(), [page_num](Frame *f) { return f->page_num() == page_num; });
+  if (iter != frames_.end()) {
+    frame = *iter;
+    return RC::SUCCESS;
+  }
+
+  RC rc = buffer_pool_.get_this_page(page_num, &frame);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to get page. page_num=%d, rc=%s", page_num, strrc(rc));
+    return rc;
+  }
+
+  frames_.push_back(frame);
+  return rc;
+}
+
+RC ExtendibleHashMiniTransaction::allocate_page(Frame *&frame)
+{
+  RC rc = buffer_pool_.allocate_page(&frame);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to allocate page. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  frames_.push_back(frame);
+  allocated_pages_.push_back(frame->page_num());
+  return rc;
+}
+
+void ExtendibleHashMiniTransaction::write(Frame *frame, int offset, const void *data, int length)
+{
+  ASSERT(offset >= 0 && length >= 0 && offset + length <= BP_PAGE_DATA_SIZE,
+         "invalid region. offset=%d, length=%d", offset, length);
+
+  char *dest = frame->data() + offset;
+
+  UndoRegion undo;
+  undo.frame  = frame;
+  undo.offset = offset;
+  undo.data.assign(dest, dest + length);
+  undo_regions_.push_back(std::move(undo));
+
+  memmove(dest, data, length);
+
+  const size_t pos = log_payload_.size();
+  log_payload_.resize(pos + ExtendibleHashLogRegion::SIZE + length);
+  auto region       = reinterpret_cast<ExtendibleHashLogRegion *>(log_payload_.data() + pos);
+  region->page_num  = frame->page_num();
+  region->offset    = offset;
+  region->length    = length;
+  memcpy(region->data, dest, length);
+  region_num_++;
+
+  if (find(dirty_frames_.begin(), dirty_frames_.end(), frame) == dirty_frames_.end()) {
+    dirty_frames_.push_back(frame);
+  }
+}
+
+RC ExtendibleHashMiniTransaction::commit()
+{
+  committed_ = true;
+  allocated_pages_.clear();
+
+  if (region_num_ == 0) {
+    return RC::SUCCESS;
+  }
+
+  auto header            = reinterpret_cast<ExtendibleHashLogHeader *>(log_payload_.data());
+  header->buffer_pool_id = buffer_pool_.id();
+  header->region_num     = region_num_;
+
+  LSN lsn = 0;
+  RC  rc  = log_handler_.append(lsn, LogModule::Id::HASH_INDEX, std::move(log_payload_));
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to append hash index log. rc=%s", strrc(rc));
+    // 内存中的修改已经无法撤销，与其它模块一样，这里仅记录错误
+  }
+
+  for (Frame *frame : dirty_frames_) {
+    frame->set_lsn(lsn);
+    frame->mark_dirty();
+  }
+  return rc;
+}
+
+void ExtendibleHashMiniTransaction::rollback()
+{
+  for (auto iter = undo_regions_.rbegin(); iter != undo_regions_.rend(); ++iter) {
+    memcpy(iter->frame->data() + iter->offset, iter->data.data(), iter->data.size());
+  }
+  undo_regions_.clear();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// class ExtendibleHashLogReplayer
+ExtendibleHashLogReplayer::ExtendibleHashLogReplayer(BufferPoolManager &bpm) : bpm_(bpm) {}
+
+RC ExtendibleHashLogReplayer::replay(const LogEntry &entry)
+{
+  LOG_TRACE("replaying hash index log: %s", entry.to_string().c_str());
+
+  if (entry.module().id() != LogModule::Id::HASH_INDEX) {
+    return RC::INVALID_ARGUMENT;
+  }
+
+  if (entry.payload_size() < ExtendibleHashLogHeader::SIZE) {
+    LOG_WARN("invalid log entry. payload size: %d is less than hash index log header size %d",
+             entry.payload_size(), ExtendibleHashLogHeader::SIZE);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  auto log_header = reinterpret_cast<const ExtendibleHashLogHeader *>(entry.data());
+
+  DiskBufferPool *buffer_pool = nullptr;
+  RC              rc          = bpm_.get_buffer_pool(log_header->buffer_pool_id, buffer_pool);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("fail to get buffer pool. buffer pool id=%d, rc=%s", log_header->buffer_pool_id, strrc(rc));
+    return rc;
+  }
+
+  vector<Frame *> frames;
+  DEFER(for (Frame *frame : frames) { buffer_pool->unpin_page(frame); });
+
+  const char *pos = entry.data() + ExtendibleHashLogHeader::SIZE;
+  const char *end = entry.data() + entry.payload_size();
+  for (int32_t i = 0; i < log_header->region_num; i++) {
+    if (end - pos < ExtendibleHashLogRegion::SIZE) {
+      LOG_WARN("invalid hash index log entry. entry=%s", entry.to_string().c_str());
+      return RC::INVALID_ARGUMENT;
+    }
+
+    auto region = reinterpret_cast<const ExtendibleHashLogRegion *>(pos);
+    if (region->offset < 0 || region->length < 0 || region->offset + region->length > BP_PAGE_DATA_SIZE ||
+        end - pos < ExtendibleHashLogRegion::SIZE + region->length) {
+      LOG_WARN("invalid hash index log region. page_num=%d, offset=%d, length=%d",
+               region->page_num, region->offset, region->length);
+      return RC::INVALID_ARGUMENT;
+    }
+    pos += ExtendibleHashLogRegion::SIZE + region->length;
+
+    Frame *frame = nullptr;
+    auto   iter  = find_if(frames.begin(), frames.end(),
+                           [region](Frame *f) { return f->page_num() == region->page_num; });
+    if (iter != frames.end()) {
+      frame = *iter;
+    } else {
+      rc = buffer_pool->get_this_page(region->page_num, &frame);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("fail to get this page. page num=%d, rc=%s", region->page_num, strrc(rc));
+        return rc;
+      }
+      frames.push_back(frame);
+    }
+
+    if (frame->lsn() >= entry.lsn()) {
+      LOG_TRACE("no need to redo hash index region. page_num=%d, frame lsn=%ld, log lsn=%ld",
+                region->page_num, frame->lsn(), entry.lsn());
+      continue;
+    }
+
+    memcpy(frame->data() + region->offset, region->data, region->length);
+  }
+
+  for (Frame *frame : frames) {
+    if (frame->lsn() < entry.lsn()) {
+      frame->set_lsn(entry.lsn());
+      frame->mark_dirty();
+    }
+  }
+  return RC::SUCCESS;
+}
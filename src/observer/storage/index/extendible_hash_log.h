@@ -0,0 +1,130 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/types.h"
+#include "common/sys/rc.h"
+#include "common/lang/string.h"
+#include "common/lang/vector.h"
+#include "storage/clog/log_replayer.h"
+
+class Frame;
+class LogHandler;
+class DiskBufferPool;
+class BufferPoolManager;
+
+/**
+ * @brief 哈希索引日志的头部
+ * @ingroup CLog
+ * @details 一条日志对应哈希索引上的一次完整操作，比如插入一个元素，或者分裂一个桶。
+ * 日志头后面跟着 region_num 个 ExtendibleHashLogRegion。
+ */
+struct ExtendibleHashLogHeader
+{
+  int32_t buffer_pool_id;
+  int32_t region_num;
+
+  string to_string() const;
+
+  static const int32_t SIZE;
+};
+
+/**
+ * @brief 哈希索引日志中的一段页面修改
+ * @ingroup CLog
+ * @details 记录页面上从 offset 开始的 length 个字节修改后的内容，重做时直接覆盖即可
+ */
+struct ExtendibleHashLogRegion
+{
+  PageNum page_num;
+  int32_t offset;  ///< 相对于页面数据(Frame::data)的偏移
+  int32_t length;
+  char    data[0];
+
+  static const int32_t SIZE;
+};
+
+/**
+ * @brief 哈希索引上的一次操作
+ * @ingroup Index
+ * @details 哈希索引所有的页面修改都通过这个类进行，修改内存数据的同时记录下修改的内容。
+ * 操作结束时调用 commit，将所有的修改作为一条日志写入，保证一次操作的修改要么都重做，要么都不重做。
+ * 同时负责管理访问过的页面，结束时统一 unpin。
+ * 哈希索引在索引级别加锁，所以这里不需要对页面加锁。
+ */
+class ExtendibleHashMiniTransaction final
+{
+public:
+  ExtendibleHashMiniTransaction(DiskBufferPool &buffer_pool, LogHandler &log_handler);
+  ~ExtendibleHashMiniTransaction();
+
+  RC get_page(PageNum page_num, Frame *&frame);
+  RC allocate_page(Frame *&frame);
+
+  /**
+   * @brief 修改页面数据，并记录日志
+   * @param frame 要修改的页面，必须是通过当前对象获取的
+   * @param offset 相对于页面数据的偏移
+   * @param data 修改后的数据
+   * @param length 数据长度
+   */
+  void write(Frame *frame, int offset, const void *data, int length);
+
+  /**
+   * @brief 提交修改
+   * @details 把所有的修改作为一条日志写入，并设置修改过的页面的LSN。
+   * 没有提交就销毁时，会撤销所有的页面修改，并释放新分配的页面
+   */
+  RC commit();
+
+private:
+  void rollback();
+
+private:
+  /**
+   * @brief 页面修改前的数据，用于操作失败时撤销
+   */
+  struct UndoRegion
+  {
+    Frame       *frame  = nullptr;
+    int          offset = 0;
+    vector<char> data;
+  };
+
+private:
+  DiskBufferPool &buffer_pool_;
+  LogHandler     &log_handler_;
+
+  vector<Frame *>     frames_;           ///< 访问过的页面，析构时unpin
+  vector<Frame *>     dirty_frames_;     ///< 修改过的页面
+  vector<PageNum>    allocated_pages_;  ///< 新分配的页面，没有提交时需要释放
+  vector<UndoRegion> undo_regions_;
+  vector<char>       log_payload_;
+  int32_t            region_num_ = 0;
+  bool               committed_  = false;
+};
+
+/**
+ * @brief 哈希索引的日志回放器
+ * @ingroup CLog
+ */
+class ExtendibleHashLogReplayer final : public LogReplayer
+{
+public:
+  ExtendibleHashLogReplayer(BufferPoolManager &bpm);
+  virtual ~ExtendibleHashLogReplayer() = default;
+
+  //! @copydoc LogReplayer::replay
+  RC replay(const LogEntry &entry) override;
+
+private:
+  BufferPoolManager &bpm_;
+};
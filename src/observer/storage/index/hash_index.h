@@ -0,0 +1,69 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/list.h"
+#include "storage/index/extendible_hash.h"
+#include "storage/index/index.h"
+
+/**
+ * @brief 哈希索引
+ * @ingroup Index
+ * @details 基于可扩展哈希实现，只能用于等值查询
+ */
+class HashIndex : public Index
+{
+public:
+  HashIndex() = default;
+  virtual ~HashIndex() noexcept;
+
+  RC create(Table *table, const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta) override;
+  RC open(Table *table, const char *file_name, const IndexMeta &index_meta, const FieldMeta &field_meta) override;
+  RC close();
+
+  RC insert_entry(const char *record, const RID *rid) override;
+  RC delete_entry(const char *record, const RID *rid) override;
+
+  /**
+   * @brief 创建扫描器
+   * @details 只支持左右边界相同并且都包含边界的扫描，即等值查询，否则返回空
+   */
+  IndexScanner *create_scanner(const char *left_key, int left_len, bool left_inclusive, const char *right_key,
+      int right_len, bool right_inclusive) override;
+
+  RC sync() override;
+
+private:
+  bool                  inited_ = false;
+  Table                *table_  = nullptr;
+  ExtendibleHashHandler index_handler_;
+};
+
+/**
+ * @brief 哈希索引扫描器
+ * @ingroup Index
+ * @details 打开时就找到所有满足条件的记录
+ */
+class HashIndexScanner : public IndexScanner
+{
+public:
+  HashIndexScanner(ExtendibleHashHandler &hash_handler);
+  ~HashIndexScanner() noexcept override = default;
+
+  RC open(const char *key, int key_len);
+
+  RC next_entry(RID *rid) override;
+  RC destroy() override;
+
+private:
+  ExtendibleHashHandler &hash_handler_;
+  list<RID>              rids_;
+};
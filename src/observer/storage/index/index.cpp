@@ -13,6 +13,10 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include "storage/index/index.h"
+#include "common/lang/algorithm.h"
+#include "common/value.h"
+#include "storage/db/db.h"
+#include "storage/trx/trx.h"
 
 RC Index::init(const IndexMeta &index_meta, const FieldMeta &field_meta)
 {
@@ -20,3 +24,87 @@ RC Index::init(const IndexMeta &index_meta, const FieldMeta &field_meta)
   field_meta_ = field_meta;
   return RC::SUCCESS;
 }
+
+bool Index::key_equals(const char *record, const char *key) const
+{
+  // 按照字段类型比较，比如字符串只比较结束符之前的部分
+  Value record_key(field_meta_.type(), const_cast<char *>(record + field_meta_.offset()), field_meta_.len());
+  Value other_key(field_meta_.type(), const_cast<char *>(key), field_meta_.len());
+  return record_key.compare(other_key) == 0;
+}
+
+bool Index::has_entry(const char *record, const RID &rid)
+{
+  const char   *key     = record + field_meta_.offset();
+  IndexScanner *scanner = create_scanner(key, field_meta_.len(), true, key, field_meta_.len(), true);
+  if (scanner == nullptr) {
+    return false;
+  }
+
+  bool found = false;
+  RID  entry_rid;
+  while (!found && OB_SUCC(scanner->next_entry(&entry_rid))) {
+    found = (entry_rid == rid);
+  }
+  scanner->destroy();
+  return found;
+}
+
+bool Index::key_in_use(Table *table, const char *key, const list<RID> &rids) const
+{
+  TrxKit &trx_kit = table->db()->trx_kit();
+  return any_of(rids.begin(), rids.end(), [this, table, key, &trx_kit](const RID &rid) {
+    return trx_kit.index_key_in_use(table, *this, rid, key);
+  });
+}
+
+RC Index::insert_entries(const vector<const char *> &records, const vector<RID> &rids)
+{
+  RC rc = RC::SUCCESS;
+  for (size_t i = 0; i < records.size() && OB_SUCC(rc); i++) {
+    rc = insert_entry(records[i], &rids[i]);
+  }
+  return rc;
+}
+
+RC IndexScanner::next_entries(vector<RID> &rids, int max_count)
+{
+  rids.clear();
+
+  RC  rc = RC::SUCCESS;
+  RID rid;
+  while (static_cast<int>(rids.size()) < max_count) {
+    rc = next_entry(&rid);
+    if (OB_FAIL(rc)) {
+      break;
+    }
+    rids.push_back(rid);
+  }
+
+  // 拿到了部分数据时先返回成功，错误由下一次调用返回
+  if (!rids.empty()) {
+    return RC::SUCCESS;
+  }
+  return rc;
+}
+
+RC IndexScanner::next_entries_with_key(vector<RID> &rids, vector<char> &keys, int key_len, int max_count)
+{
+  rids.clear();
+  keys.resize(static_cast<size_t>(key_len) * max_count);
+
+  RC  rc = RC::SUCCESS;
+  RID rid;
+  while (static_cast<int>(rids.size()) < max_count) {
+    rc = next_entry_with_key(&rid, keys.data() + rids.size() * key_len);
+    if (OB_FAIL(rc)) {
+      break;
+    }
+    rids.push_back(rid);
+  }
+
+  if (!rids.empty()) {
+    return RC::SUCCESS;
+  }
+  return rc;
+}
@@ -17,6 +17,8 @@ See the Mulan PSL v2 for more details. */
 #include <stddef.h>
 #include <vector>
 
+#include "common/lang/list.h"
+#include "common/lang/vector.h"
 #include "common/sys/rc.h"
 #include "storage/field/field_meta.h"
 #include "storage/index/index_meta.h"
@@ -51,9 +53,34 @@ public:
 
   virtual bool is_vector_index() { return false; }
 
+  /**
+   * @brief 是否可以直接从索引中返回键值
+   * @details 支持的话，查询只涉及索引字段时可以不回表，即索引覆盖扫描
+   */
+  virtual bool support_index_only_scan() const { return false; }
+
   const IndexMeta &index_meta() const { return index_meta_; }
+  const FieldMeta &field_meta() const { return field_meta_; }
   bool unique() const { return index_meta_.unique_type(); }
 
+  /**
+   * @brief 记录在索引字段上的键值是否与 key 相同
+   * @param record 完整的记录数据
+   * @param key 索引字段的数据，比如另一条记录中索引字段的数据，或者索引中保存的键值
+   */
+  bool key_equals(const char *record, const char *key) const;
+
+  /**
+   * @brief 索引中是否存在记录 record 在位置 rid 上的索引项
+   */
+  bool has_entry(const char *record, const RID &rid);
+
+  /**
+   * @brief 唯一索引中键值为 key 的索引项 rids 是否还有记录在使用这个键值
+   * @details 更新索引字段以后，旧版本的索引项保留到旧版本清理时，检查重复键值时要跳过这些索引项
+   */
+  bool key_in_use(Table *table, const char *key, const list<RID> &rids) const;
+
   /**
    * @brief 插入一条数据
    *
@@ -62,6 +89,14 @@ public:
    */
   virtual RC insert_entry(const char *record, const RID *rid) = 0;
 
+  /**
+   * @brief 批量插入数据
+   * @details 默认逐条插入。中途失败时已经插入的数据不会回滚，由调用方负责清理
+   * @param records 插入的记录
+   * @param rids 与 records 一一对应的记录位置
+   */
+  virtual RC insert_entries(const vector<const char *> &records, const vector<RID> &rids);
+
   /**
    * @brief 删除一条数据
    *
@@ -113,4 +148,25 @@ public:
    */
   virtual RC next_entry(RID *rid) = 0;
   virtual RC destroy()            = 0;
+
+  /**
+   * @brief 遍历元素数据，同时返回索引中的键值
+   * @param[out] key 键值，内存大小至少是索引字段的长度
+   * @details 仅在 Index::support_index_only_scan 返回 true 时可用
+   */
+  virtual RC next_entry_with_key(RID *rid, char *key) { return RC::UNSUPPORTED; }
+
+  /**
+   * @brief 批量遍历元素数据
+   * @details 一次最多返回 max_count 个元素，会先清空 rids。
+   * 拿到了部分数据时返回成功，没有更多的元素时返回RECORD_EOF
+   */
+  virtual RC next_entries(vector<RID> &rids, int max_count);
+
+  /**
+   * @brief 批量遍历元素数据，同时返回索引中的键值
+   * @param[out] keys 依次保存每个元素的键值，每个键值占 key_len 个字节
+   * @details 与 next_entries 相同，仅在 Index::support_index_only_scan 返回 true 时可用
+   */
+  virtual RC next_entries_with_key(vector<RID> &rids, vector<char> &keys, int key_len, int max_count);
 };
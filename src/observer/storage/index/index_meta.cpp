@@ -22,8 +22,18 @@ See the Mulan PSL v2 for more details. */
 const static Json::StaticString FIELD_NAME("name");
 const static Json::StaticString FIELD_FIELD_NAME("field_name");
 const static Json::StaticString FIELD_UNIQUE("unique");
+const static Json::StaticString FIELD_TYPE("type");
 
-RC IndexMeta::init(const char *name, const FieldMeta &field, bool Unique)
+static const char *index_type_name(IndexType type)
+{
+  switch (type) {
+    case IndexType::BPLUS_TREE: return "btree";
+    case IndexType::HASH: return "hash";
+    default: return "unknown";
+  }
+}
+
+RC IndexMeta::init(const char *name, const FieldMeta &field, bool Unique, IndexType type)
 {
   if (common::is_blank(name)) {
     LOG_ERROR("Failed to init index, name is empty.");
@@ -33,6 +43,7 @@ RC IndexMeta::init(const char *name, const FieldMeta &field, bool Unique)
   name_  = name;
   field_ = field.name();
   Unique_ = Unique;
+  type_   = type;
   return RC::SUCCESS;
 }
 
@@ -41,6 +52,7 @@ void IndexMeta::to_json(Json::Value &json_value) const
   json_value[FIELD_NAME]       = name_;
   json_value[FIELD_FIELD_NAME] = field_;
   json_value[FIELD_UNIQUE] = Unique_;
+  json_value[FIELD_TYPE]   = index_type_name(type_);
 }
 
 RC IndexMeta::from_json(const TableMeta &table, const Json::Value &json_value, IndexMeta &index)
@@ -64,11 +76,26 @@ RC IndexMeta::from_json(const TableMeta &table, const Json::Value &json_value, I
     return RC::SCHEMA_FIELD_MISSING;
   }
 
-  return index.init(name_value.asCString(), *field, json_value[FIELD_UNIQUE].asBool());
+  // 旧版本的元数据中没有索引类型，都是B+树索引
+  IndexType          type       = IndexType::BPLUS_TREE;
+  const Json::Value &type_value = json_value[FIELD_TYPE];
+  if (type_value.isString()) {
+    if (0 == strcmp(type_value.asCString(), index_type_name(IndexType::HASH))) {
+      type = IndexType::HASH;
+    } else if (0 != strcmp(type_value.asCString(), index_type_name(IndexType::BPLUS_TREE))) {
+      LOG_ERROR("Deserialize index [%s]: unknown index type: %s", name_value.asCString(), type_value.asCString());
+      return RC::INTERNAL;
+    }
+  }
+
+  return index.init(name_value.asCString(), *field, json_value[FIELD_UNIQUE].asBool(), type);
 }
 
 const char *IndexMeta::name() const { return name_.c_str(); }
 
 const char *IndexMeta::field() const { return field_.c_str(); }
 
-void IndexMeta::desc(ostream &os) const { os << "index name=" << name_ << ", field=" << field_ << ", unique=" << Unique_; }
\ No newline at end of file
+void IndexMeta::desc(ostream &os) const
+{
+  os << "index name=" << name_ << ", field=" << field_ << ", unique=" << Unique_ << ", type=" << index_type_name(type_);
+}
\ No newline at end of file
@@ -24,22 +24,32 @@ namespace Json {
 class Value;
 }  // namespace Json
 
+/**
+ * @brief 索引的类型
+ * @ingroup Index
+ */
+enum class IndexType
+{
+  BPLUS_TREE,  ///< B+树索引，支持范围查询
+  HASH,        ///< 可扩展哈希索引，仅支持等值查询
+};
+
 /**
  * @brief 描述一个索引
  * @ingroup Index
- * @details 一个索引包含了表的哪些字段，索引的名称等。
- * 如果以后实现了多种类型的索引，还需要记录索引的类型，对应类型的一些元数据等
+ * @details 一个索引包含了表的哪些字段，索引的名称、类型等。
  */
 class IndexMeta
 {
 public:
   IndexMeta() = default;
 
-  RC init(const char *name, const FieldMeta &field, bool Unique); 
+  RC init(const char *name, const FieldMeta &field, bool Unique, IndexType type = IndexType::BPLUS_TREE);
 
 public:
   const char *name() const;
   const char *field() const;
+  IndexType   type() const { return type_; }
 
   void desc(ostream &os) const;
   bool unique_type() const { return Unique_; }
@@ -51,5 +61,6 @@ public:
 protected:
   string name_;   // index's name
   string field_;  // field's name
-  bool   Unique_ = false;
+  bool      Unique_ = false;
+  IndexType type_   = IndexType::BPLUS_TREE;
 };
@@ -158,3 +158,15 @@ void LatchMemo::release_to(int point)
   }
   items_.erase(items_.begin(), iter);
 }
+
+void LatchMemo::release_from(int point)
+{
+  ASSERT(point >= 0 && point <= static_cast<int>(items_.size()), 
+         "invalid memo point. point=%d, items size=%d",
+         point, static_cast<int>(items_.size()));
+
+  while (static_cast<int>(items_.size()) > point) {
+    release_item(items_.back());
+    items_.pop_back();
+  }
+}
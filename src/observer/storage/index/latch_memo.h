@@ -78,6 +78,9 @@ public:
 
   void release_to(int point);
 
+  /// @brief 释放 point 之后加入的锁和页面，point 之前的保留
+  void release_from(int point);
+
   int memo_point() const { return static_cast<int>(items_.size()); }
 
 private:
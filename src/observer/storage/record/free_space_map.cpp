@@ -0,0 +1,220 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/record/free_space_map.h"
+#include "common/lang/algorithm.h"
+#include "common/log/log.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "storage/buffer/frame.h"
+
+RC FreeSpaceMap::init(DiskBufferPool *buffer_pool, Fork fork)
+{
+  buffer_pool_  = buffer_pool;
+  fork_         = fork;
+  search_start_ = 1;
+  memory_pages_.clear();
+  return RC::SUCCESS;
+}
+
+void FreeSpaceMap::close()
+{
+  buffer_pool_  = nullptr;
+  search_start_ = 1;
+  memory_pages_.clear();
+}
+
+uint8_t FreeSpaceMap::level_of(int free_space, int total_space)
+{
+  if (free_space <= 0 || total_space <= 0) {
+    return FULL;
+  }
+  const int level = MIN_FREE_LEVEL + static_cast<int>(
+      static_cast<int64_t>(free_space) * (MAX_LEVEL - MIN_FREE_LEVEL) / total_space);
+  return static_cast<uint8_t>(min(level, static_cast<int>(MAX_LEVEL)));
+}
+
+uint8_t FreeSpaceMap::get_level(const char *data, int index)
+{
+  const uint8_t byte = static_cast<uint8_t>(data[index / 2]);
+  return (index % 2 == 0) ? (byte & 0x0F) : (byte >> 4);
+}
+
+void FreeSpaceMap::set_level(char *data, int index, uint8_t level)
+{
+  uint8_t byte = static_cast<uint8_t>(data[index / 2]);
+  if (index % 2 == 0) {
+    byte = (byte & 0xF0) | (level & 0x0F);
+  } else {
+    byte = (byte & 0x0F) | static_cast<uint8_t>(level << 4);
+  }
+  data[index / 2] = static_cast<char>(byte);
+}
+
+RC FreeSpaceMap::get_page(int fsm_page_index, bool create, char *&data, Frame *&frame)
+{
+  data  = nullptr;
+  frame = nullptr;
+
+  if (buffer_pool_ == nullptr) {
+    if (fsm_page_index >= static_cast<int>(memory_pages_.size())) {
+      if (!create) {
+        return RC::SUCCESS;
+      }
+      memory_pages_.resize(fsm_page_index + 1, string(BP_PAGE_DATA_SIZE, '\0'));
+    }
+    data = memory_pages_[fsm_page_index].data();
+    return RC::SUCCESS;
+  }
+
+  // 映射页面从1开始依次分配，不会释放。各个映射的页面交替存放
+  const PageNum page_num = fsm_page_index * FORK_NUM + static_cast<int>(fork_) + 1;
+  RC            rc       = RC::SUCCESS;
+  while (buffer_pool_->page_count() <= page_num) {
+    if (!create) {
+      return RC::SUCCESS;
+    }
+
+    Frame *new_frame = nullptr;
+    rc               = buffer_pool_->allocate_page(&new_frame);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to allocate free space map page. file=%s, rc=%s", buffer_pool_->filename(), strrc(rc));
+      return rc;
+    }
+    buffer_pool_->unpin_page(new_frame);
+  }
+
+  rc = buffer_pool_->get_this_page(page_num, &frame);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to get free space map page. file=%s, page_num=%d, rc=%s",
+             buffer_pool_->filename(), page_num, strrc(rc));
+    return rc;
+  }
+  data = frame->data();
+  return RC::SUCCESS;
+}
+
+void FreeSpaceMap::release(Frame *frame)
+{
+  if (frame != nullptr) {
+    buffer_pool_->unpin_page(frame);
+  }
+}
+
+RC FreeSpaceMap::update(PageNum page_num, uint8_t level)
+{
+  if (page_num <= 0) {
+    return RC::INVALID_ARGUMENT;
+  }
+
+  char  *data  = nullptr;
+  Frame *frame = nullptr;
+  RC     rc    = get_page(page_num / PAGES_PER_FSM_PAGE, level != UNKNOWN /*create*/, data, frame);
+  if (OB_FAIL(rc) || data == nullptr) {
+    return rc;
+  }
+
+  const int index = page_num % PAGES_PER_FSM_PAGE;
+  if (get_level(data, index) != level) {
+    if (frame != nullptr) {
+      frame->write_latch();
+    }
+    set_level(data, index, level);
+    if (frame != nullptr) {
+      frame->mark_dirty();
+      frame->write_unlatch();
+    }
+  }
+  release(frame);
+
+  if (level != FULL && page_num < search_start_) {
+    search_start_ = page_num;
+  }
+  return RC::SUCCESS;
+}
+
+RC FreeSpaceMap::get(PageNum page_num, uint8_t &level)
+{
+  level        = UNKNOWN;
+  char  *data  = nullptr;
+  Frame *frame = nullptr;
+  RC     rc    = get_page(page_num / PAGES_PER_FSM_PAGE, false /*create*/, data, frame);
+  if (OB_FAIL(rc) || data == nullptr) {
+    return rc;
+  }
+
+  level = get_level(data, page_num % PAGES_PER_FSM_PAGE);
+  release(frame);
+  return RC::SUCCESS;
+}
+
+RC FreeSpaceMap::find(PageNum page_limit, uint8_t min_level, PageNum &page_num)
+{
+  // 只有连续的满页面才能推进 search_start_，中间遇到空闲不够的页面以后就不再推进
+  bool    advance = true;
+  PageNum current = max(search_start_, 1);
+  while (current < page_limit) {
+    char  *data  = nullptr;
+    Frame *frame = nullptr;
+    RC     rc    = get_page(current / PAGES_PER_FSM_PAGE, false /*create*/, data, frame);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+    if (data == nullptr) {
+      // 后面的页面都没有记录过，溢出页面的映射中不会有候选页面
+      if (fork_ == Fork::OVERFLOW_PAGES) {
+        return RC::RECORD_EOF;
+      }
+      page_num = current;
+      return RC::SUCCESS;
+    }
+
+    if (frame != nullptr) {
+      frame->read_latch();
+    }
+
+    const PageNum end   = min(page_limit, (current / PAGES_PER_FSM_PAGE + 1) * PAGES_PER_FSM_PAGE);
+    bool          found = false;
+    for (; current < end; current++) {
+      const int index = current % PAGES_PER_FSM_PAGE;
+      // 一个字节中的两个页面都满了时可以一起跳过
+      if (index % 2 == 0 && current + 1 < end && is_full(get_level(data, index)) && is_full(get_level(data, index + 1))) {
+        current++;
+        if (advance) {
+          search_start_ = current + 1;
+        }
+        continue;
+      }
+
+      const uint8_t level = get_level(data, index);
+      if (is_full(level)) {
+        if (advance) {
+          search_start_ = current + 1;
+        }
+        continue;
+      }
+      if (level == UNKNOWN || level >= min_level) {
+        found = true;
+        break;
+      }
+      advance = false;
+    }
+
+    if (frame != nullptr) {
+      frame->read_unlatch();
+    }
+    release(frame);
+
+    if (found) {
+      page_num = current;
+      return RC::SUCCESS;
+    }
+  }
+  return RC::RECORD_EOF;
+}
@@ -0,0 +1,115 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/string.h"
+#include "common/lang/vector.h"
+#include "common/sys/rc.h"
+#include "common/types.h"
+#include "storage/buffer/page.h"
+
+class DiskBufferPool;
+class Frame;
+
+/**
+ * @brief 记录文件的空闲空间映射(free space map)
+ * @ingroup RecordManager
+ * @details 每个数据页面使用4个比特记录页面的空闲程度，插入记录时直接找到有空闲空间的页面，
+ * 打开表时不需要遍历所有的数据页面。
+ * 空闲程度保存在单独的文件中，使用 DiskBufferPool 管理。页面0是 buffer pool 的文件头，
+ * 从页面1开始，每个页面依次记录 PAGES_PER_FSM_PAGE 个数据页面的空闲程度。
+ * 一个文件中可以保存多个映射(fork)，各个映射的页面依次交替存放。
+ * 与 PostgreSQL 的 FSM 一样，这里只是一个提示，修改时不记录日志：
+ * UNKNOWN 表示没有记录过(比如之前版本创建的表，或者崩溃前没有刷盘)，查找时当做可能有空闲空间的页面返回，
+ * 由调用者读取页面确认以后再更新，所以不准确的值最多导致多读取一次页面。
+ * 没有提供文件时只在内存中维护，重启以后同样通过 UNKNOWN 逐步建立。
+ * 这个类不是线程安全的，由 RecordFileHandler 加锁保护。
+ */
+class FreeSpaceMap
+{
+public:
+  static constexpr uint8_t UNKNOWN        = 0;   ///< 没有记录过
+  static constexpr uint8_t FULL           = 1;   ///< 没有空闲空间
+  static constexpr uint8_t MIN_FREE_LEVEL = 2;   ///< 有空闲空间的最小的等级
+  static constexpr uint8_t MAX_LEVEL      = 15;  ///< 整个页面都是空闲的
+
+  static constexpr int PAGES_PER_FSM_PAGE = BP_PAGE_DATA_SIZE * 2;
+
+  /**
+   * @brief 同一个文件中保存的不同映射
+   * @details OVERFLOW_PAGES 只记录溢出页面的空闲程度。溢出页面不插入新的记录，在 DATA_PAGES 中是满的，
+   * 迁移记录时通过这个映射找到还有空间的溢出页面。没有记录过的页面不是溢出页面，查找时不会返回
+   */
+  enum class Fork
+  {
+    DATA_PAGES     = 0,
+    OVERFLOW_PAGES = 1,
+  };
+  static constexpr int FORK_NUM = 2;
+
+public:
+  FreeSpaceMap()  = default;
+  ~FreeSpaceMap() = default;
+
+  /**
+   * @brief 初始化
+   * @param buffer_pool 保存空闲空间映射的文件，为空时只在内存中维护
+   * @param fork 使用文件中的哪个映射
+   */
+  RC   init(DiskBufferPool *buffer_pool, Fork fork = Fork::DATA_PAGES);
+  void close();
+
+  /**
+   * @brief 根据页面的空闲空间计算等级
+   * @param free_space  空闲空间，可以是字节数，也可以是空闲的记录槽位个数
+   * @param total_space 页面上总的空间，与 free_space 的单位相同
+   */
+  static uint8_t level_of(int free_space, int total_space);
+
+  /**
+   * @brief 设置数据页面的空闲程度
+   */
+  RC update(PageNum page_num, uint8_t level);
+  RC update(PageNum page_num, int free_space, int total_space) { return update(page_num, level_of(free_space, total_space)); }
+
+  RC get(PageNum page_num, uint8_t &level);
+
+  /**
+   * @brief 查找空闲等级不小于 min_level 或者没有记录过的数据页面(只有 DATA_PAGES)
+   * @details 从上次查找停下的位置开始，已经满了的页面会被跳过，不会重复检查，所以插入时是均摊O(1)的。
+   * 调用者需要读取页面确认，如果页面实际已满，就更新为 FULL 再继续查找
+   * @param page_limit 数据文件的页面个数，只在 [1, page_limit) 中查找
+   * @return 找不到时返回 RECORD_EOF
+   */
+  RC find(PageNum page_limit, uint8_t min_level, PageNum &page_num);
+
+private:
+  /**
+   * @brief 获取第 fsm_page_index 个映射页面的数据
+   * @param create 页面不存在时是否创建
+   * @param[out] data 页面不存在并且不创建时返回空
+   * @param[out] frame 使用文件时返回对应的页帧，需要调用 release 释放
+   */
+  RC   get_page(int fsm_page_index, bool create, char *&data, Frame *&frame);
+  void release(Frame *frame);
+
+  /// 查找时可以直接跳过的页面
+  bool is_full(uint8_t level) const { return level == FULL || (level == UNKNOWN && fork_ == Fork::OVERFLOW_PAGES); }
+
+  static uint8_t get_level(const char *data, int index);
+  static void    set_level(char *data, int index, uint8_t level);
+
+private:
+  DiskBufferPool *buffer_pool_ = nullptr;  ///< 为空时使用 memory_pages_
+  Fork            fork_        = Fork::DATA_PAGES;
+  vector<string>  memory_pages_;
+  PageNum         search_start_ = 1;  ///< 在这个页面之前的数据页面都已经满了
+};
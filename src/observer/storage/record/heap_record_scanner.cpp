@@ -18,15 +18,23 @@ RC HeapRecordScanner::open_scan()
   ASSERT(disk_buffer_pool_ != nullptr, "disk buffer pool is null");
   ASSERT(log_handler_ != nullptr, "log handler is null");
 
-  RC rc = bp_iterator_.init(*disk_buffer_pool_, 1);
+  RC rc = RC::SUCCESS;
+  if (morsels_ != nullptr) {
+    // 并行扫描时先遍历第一个领取到的片段，遍历完以后再领取下一个
+    if (!fetch_next_morsel()) {
+      rc = bp_iterator_.init(*disk_buffer_pool_, 1, 1);
+    }
+  } else {
+    rc = bp_iterator_.init(*disk_buffer_pool_, 1);
+  }
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to init bp iterator. rc=%d:%s", rc, strrc(rc));
     return rc;
   }
-  if (table_ == nullptr || table_->table_meta().storage_format() == StorageFormat::ROW_FORMAT) {
+  if (table_ == nullptr) {
     record_page_handler_ = new RowRecordPageHandler();
   } else {
-    record_page_handler_ = new PaxRecordPageHandler();
+    record_page_handler_ = RecordPageHandler::create(table_->table_meta().storage_format());
   }
 
   return rc;
@@ -53,24 +61,27 @@ RC HeapRecordScanner::fetch_next_record()
   }
 
   // 上个页面遍历完了，或者还没有开始遍历某个页面，那么就从一个新的页面开始遍历查找
-  while (bp_iterator_.has_next()) {
-    PageNum page_num = bp_iterator_.next();
-    record_page_handler_->cleanup();
-    rc = record_page_handler_->init(*disk_buffer_pool_, *log_handler_, page_num, rw_mode_);
-    if (OB_FAIL(rc)) {
-      LOG_WARN("failed to init record page handler. page_num=%d, rc=%s", page_num, strrc(rc));
-      return rc;
-    }
-
-    record_page_iterator_.init(record_page_handler_);
-    rc = fetch_next_record_in_page();
-    if (rc == RC::SUCCESS || rc != RC::RECORD_EOF) {
-      // 有有效记录：RC::SUCCESS
-      // 或者出现了错误，rc != (RC::SUCCESS or RC::RECORD_EOF)
-      // RECORD_EOF 表示当前页面已经遍历完了
-      return rc;
+  // 并行扫描时当前片段遍历完了再领取下一个片段
+  do {
+    while (bp_iterator_.has_next()) {
+      PageNum page_num = bp_iterator_.next();
+      record_page_handler_->cleanup();
+      rc = record_page_handler_->init(*disk_buffer_pool_, *log_handler_, page_num, rw_mode_);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to init record page handler. page_num=%d, rc=%s", page_num, strrc(rc));
+        return rc;
+      }
+
+      record_page_iterator_.init(record_page_handler_);
+      rc = fetch_next_record_in_page();
+      if (rc == RC::SUCCESS || rc != RC::RECORD_EOF) {
+        // 有有效记录：RC::SUCCESS
+        // 或者出现了错误，rc != (RC::SUCCESS or RC::RECORD_EOF)
+        // RECORD_EOF 表示当前页面已经遍历完了
+        return rc;
+      }
     }
-  }
+  } while (fetch_next_morsel());
 
   // 所有的页面都遍历完了，没有数据了
   next_record_.rid().slot_num = -1;
@@ -92,24 +103,30 @@ RC HeapRecordScanner::fetch_next_record_in_page()
       return rc;
     }
 
-    // 如果有过滤条件，就用过滤条件过滤一下
-    if (condition_filter_ != nullptr && !condition_filter_->filter(next_record_)) {
-      continue;
-    }
-
     // 如果是某个事务上遍历数据，还要看看事务访问是否有冲突
     if (trx_ == nullptr) {
+      // 如果有过滤条件，就用过滤条件过滤一下
+      if (condition_filter_ != nullptr && !condition_filter_->filter(next_record_)) {
+        continue;
+      }
       return rc;
     }
 
     // 让当前事务探测一下是否访问冲突，或者需要加锁、等锁等操作，由事务自己决定
     // TODO 把判断事务有效性的逻辑从Scanner中移除
+    // 事务可能会把记录换成快照中的旧版本，所以要在这之后再过滤。页面上的版本不满足条件时，旧版本依然可能满足
     rc = trx_->visit_record(table_, next_record_, rw_mode_);
     if (rc == RC::RECORD_INVISIBLE) {
       // 可以参考MvccTrx，表示当前记录不可见
       // 这种模式仅在 readonly 事务下是有效的
       continue;
     }
+    if (condition_filter_ != nullptr && !condition_filter_->filter(next_record_)) {
+      // 冲突时记录还是页面上的最新版本。与之前一样，最新版本不满足条件时不报告冲突
+      if (OB_SUCC(rc) || rc == RC::LOCKED_CONCURRENCY_CONFLICT) {
+        continue;
+      }
+    }
     return rc;
   }
 
@@ -117,6 +134,18 @@ RC HeapRecordScanner::fetch_next_record_in_page()
   return RC::RECORD_EOF;
 }
 
+bool HeapRecordScanner::fetch_next_morsel()
+{
+  PageNum start_page = 0;
+  PageNum end_page   = 0;
+  if (morsels_ == nullptr || !morsels_->next(start_page, end_page)) {
+    return false;
+  }
+
+  bp_iterator_.init(*disk_buffer_pool_, start_page, end_page);
+  return true;
+}
+
 RC HeapRecordScanner::close_scan()
 {
   if (disk_buffer_pool_ != nullptr) {
@@ -142,6 +171,10 @@ RC HeapRecordScanner::next(Record &record)
     return rc;
   }
 
-  record = next_record_;
+  if (zero_copy_) {
+    record.refer(next_record_);
+  } else {
+    record = next_record_;
+  }
   return RC::SUCCESS;
 }
@@ -10,14 +10,17 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include "common/lang/memory.h"
 #include "storage/record/record_scanner.h"
+#include "storage/record/page_morsel.h"
 #include "storage/buffer/disk_buffer_pool.h"
 #include "storage/trx/trx.h"
 
 /**
  * @brief 遍历某个文件中所有记录
  * @ingroup RecordManager
- * @details 遍历所有的页面，同时访问这些页面中所有的记录
+ * @details 遍历所有的页面，同时访问这些页面中所有的记录。
+ * 设置了页面片段队列时只遍历从队列中领取到的页面，多个线程各自使用一个扫描器就可以并行扫描整个文件。
  */
 class HeapRecordScanner : public RecordScanner
 {
@@ -50,12 +53,29 @@ public:
    */
   RC next(Record &record) override;
 
+  /**
+   * @brief 设置并行扫描的页面片段队列，需要在 open_scan 之前调用
+   */
+  void set_morsel_queue(shared_ptr<PageMorselQueue> morsels) { morsels_ = std::move(morsels); }
+
+  RC set_condition_filter(ConditionFilter *condition_filter) override
+  {
+    condition_filter_ = condition_filter;
+    return RC::SUCCESS;
+  }
+
 private:
   /**
    * @brief 获取该文件中的下一条记录
    */
   RC fetch_next_record();
 
+  /**
+   * @brief 从队列中领取下一个页面片段
+   * @return 没有设置队列或者队列中的片段都被领取了，返回 false
+   */
+  bool fetch_next_morsel();
+
   /**
    * @brief 获取一个页面内的下一条记录
    */
@@ -70,7 +90,8 @@ private:
   LogHandler     *log_handler_      = nullptr;
   ReadWriteMode   rw_mode_ = ReadWriteMode::READ_WRITE;  ///< 遍历出来的数据，是否可能对它做修改
 
-  BufferPoolIterator bp_iterator_;                    ///< 遍历buffer pool的所有页面
+  BufferPoolIterator          bp_iterator_;  ///< 遍历buffer pool的所有页面
+  shared_ptr<PageMorselQueue> morsels_;      ///< 并行扫描时领取页面片段的队列
   ConditionFilter   *condition_filter_    = nullptr;  ///< 过滤record
   RecordPageHandler *record_page_handler_ = nullptr;  ///< 处理文件某页面的记录
   RecordPageIterator record_page_iterator_;           ///< 遍历某个页面上的所有record
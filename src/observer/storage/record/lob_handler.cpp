@@ -9,6 +9,11 @@ MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
 See the Mulan PSL v2 for more details. */
 
 #include "storage/record/lob_handler.h"
+#include "common/lang/algorithm.h"
+#include "common/log/log.h"
+
+atomic<int>     LobFileHandler::inline_threshold_{LobFileHandler::DEFAULT_INLINE_THRESHOLD};
+atomic<int64_t> LobFileHandler::default_cache_capacity_{LobFileHandler::DEFAULT_CACHE_CAPACITY};
 
 RC LobFileHandler::create_file(const char *file_name)
 {
@@ -26,6 +31,16 @@ RC LobFileHandler::open_file(const char *file_name)
   return RC::INTERNAL;
 }
 
+RC LobFileHandler::close_file()
+{
+  {
+    lock_guard<common::Mutex> guard(cache_lock_);
+    cache_.destroy();
+    cached_bytes_ = 0;
+  }
+  return file_.close_file();
+}
+
 RC LobFileHandler::insert_data(int64_t &offset, int64_t length, const char *data)
 {
   RC       rc         = RC::SUCCESS;
@@ -42,3 +57,116 @@ RC LobFileHandler::insert_data(int64_t &offset, int64_t length, const char *data
 
   return rc;
 }
+
+RC LobFileHandler::write_field(const char *data, int64_t length, char *field_data, int field_len)
+{
+  if (field_len < static_cast<int>(sizeof(LobRef)) || length < 0 || length > INT32_MAX) {
+    LOG_WARN("invalid text field. field_len=%d, length=%ld", field_len, length);
+    return RC::INVALID_ARGUMENT;
+  }
+
+  LobRef ref;
+  ref.offset   = 0;
+  ref.length   = static_cast<int32_t>(length);
+  ref.reserved = 0;
+
+  memset(field_data, 0, field_len);
+  if (length <= field_len - static_cast<int>(sizeof(LobRef))) {
+    ref.reserved |= LobRef::INLINE;
+    memcpy(field_data + sizeof(LobRef), data, length);
+  } else {
+    RC rc = insert_data(ref.offset, length, data);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to insert lob data. length=%ld, rc=%s", length, strrc(rc));
+      return rc;
+    }
+  }
+
+  memcpy(field_data, &ref, sizeof(ref));
+  return RC::SUCCESS;
+}
+
+RC LobFileHandler::read_field(const char *field_data, int field_len, string &text)
+{
+  LobRef ref;
+  memcpy(&ref, field_data, sizeof(ref));
+  if (ref.length < 0) {
+    LOG_WARN("invalid lob ref. offset=%ld, length=%d", ref.offset, ref.length);
+    return RC::INTERNAL;
+  }
+
+  if (ref.is_inline()) {
+    if (ref.length > field_len - static_cast<int>(sizeof(LobRef))) {
+      LOG_WARN("invalid inline text. length=%d, field_len=%d", ref.length, field_len);
+      return RC::INTERNAL;
+    }
+    text.assign(field_data + sizeof(LobRef), ref.length);
+    return RC::SUCCESS;
+  }
+
+  {
+    lock_guard<common::Mutex> guard(cache_lock_);
+    if (cache_.get(ref.offset, text) && static_cast<int64_t>(text.size()) == ref.length) {
+      cache_hits_++;
+      return RC::SUCCESS;
+    }
+  }
+
+  cache_misses_++;
+  text.resize(ref.length);
+  RC rc = file_.read_at(ref.offset, ref.length, text.data());
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to read lob data. offset=%ld, length=%d, rc=%s", ref.offset, ref.length, strrc(rc));
+    return rc;
+  }
+
+  put_cache(ref.offset, text);
+  return RC::SUCCESS;
+}
+
+void LobFileHandler::put_cache(int64_t offset, const string &text)
+{
+  lock_guard<common::Mutex> guard(cache_lock_);
+
+  // 比较大的对象只会被读取一次的可能性更高，缓存它们会淘汰掉很多小对象
+  const int64_t size = static_cast<int64_t>(text.size());
+  if (size == 0 || size > cache_capacity_ / 16) {
+    return;
+  }
+
+  string old_text;
+  if (cache_.get(offset, old_text)) {
+    cached_bytes_ -= static_cast<int64_t>(old_text.size());
+  }
+  cache_.put(offset, text);
+  cached_bytes_ += size;
+
+  while (cached_bytes_ > cache_capacity_ && cache_.count() > 0) {
+    int64_t victim      = 0;
+    int64_t victim_size = 0;
+    cache_.foreach_reverse([&victim, &victim_size](const int64_t &key, const string &value) {
+      victim      = key;
+      victim_size = static_cast<int64_t>(value.size());
+      return false;
+    });
+    cache_.remove(victim);
+    cached_bytes_ -= victim_size;
+  }
+}
+
+void LobFileHandler::set_cache_capacity(int64_t capacity)
+{
+  lock_guard<common::Mutex> guard(cache_lock_);
+  cache_capacity_ = max(capacity, static_cast<int64_t>(0));
+  if (cache_capacity_ == 0 || cached_bytes_ > cache_capacity_) {
+    cache_.destroy();
+    cached_bytes_ = 0;
+  }
+}
+
+void LobFileHandler::set_inline_threshold(int threshold) { inline_threshold_ = max(threshold, 0); }
+
+void LobFileHandler::set_default_cache_capacity(int64_t capacity)
+{
+  default_cache_capacity_ = max(capacity, static_cast<int64_t>(0));
+}
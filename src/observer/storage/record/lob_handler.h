@@ -10,19 +10,30 @@ See the Mulan PSL v2 for more details. */
 
 #pragma once
 
+#include "common/lang/atomic.h"
+#include "common/lang/lru_cache.h"
 #include "common/lang/mutex.h"
 #include "common/lang/sstream.h"
+#include "common/lang/string.h"
 #include "common/types.h"
 #include "storage/persist/persist.h"
+#include "storage/record/lob_ref.h"
 
 /**
  * @brief 管理LOB文件中的 LOB 对象
  * @ingroup RecordManager
+ * @details 比较短的文本直接保存在记录中(参考 LobRef)，不需要访问 LOB 文件。
+ * LOB 文件只会追加，写入以后的数据不会再修改，所以读取过的数据可以按照偏移量缓存起来，
+ * 缓存使用 LRU 淘汰，总大小不超过 cache_capacity，比较大的对象不放到缓存中，避免把其它对象都淘汰掉。
  */
 class LobFileHandler
 {
 public:
-  LobFileHandler() {}
+  static constexpr int     DEFAULT_INLINE_THRESHOLD = 64;
+  static constexpr int64_t DEFAULT_CACHE_CAPACITY   = 4 * 1024 * 1024;
+
+public:
+  LobFileHandler() : cache_capacity_(default_cache_capacity_.load()) {}
 
   ~LobFileHandler() { close_file(); }
 
@@ -30,12 +41,56 @@ public:
 
   RC open_file(const char *file_name);
 
-  RC close_file() { return file_.close_file(); }
+  RC close_file();
 
   RC insert_data(int64_t &offset, int64_t length, const char *data);
 
   RC get_data(int64_t offset, int64_t length, char *data) { return file_.read_at(offset, length, data); }
 
+  /**
+   * @brief 把文本写到 TEXT 字段中
+   * @details 字段中除了 LobRef 以外的空间可以放下时直接保存在记录中，否则追加到 LOB 文件
+   * @param field_data 记录中字段的数据
+   * @param field_len  字段的长度，不小于 sizeof(LobRef)
+   */
+  RC write_field(const char *data, int64_t length, char *field_data, int field_len);
+
+  /**
+   * @brief 读取 TEXT 字段中的文本
+   * @details 保存在 LOB 文件中的文本优先从缓存中读取
+   */
+  RC read_field(const char *field_data, int field_len, string &text);
+
+  void    set_cache_capacity(int64_t capacity);
+  int64_t cache_capacity() const { return cache_capacity_; }
+  int64_t cached_bytes() const { return cached_bytes_; }
+  int64_t cache_hit_count() const { return cache_hits_.load(); }
+  int64_t cache_miss_count() const { return cache_misses_.load(); }
+
+  /**
+   * @brief 新建表时 TEXT 字段在记录中可以保存的最大文本长度
+   * @details 字段的长度是 sizeof(LobRef) 加上这个值，已经创建的表不受影响。可以通过配置文件修改
+   */
+  static int  inline_threshold() { return inline_threshold_.load(); }
+  static void set_inline_threshold(int threshold);
+  static int  text_field_len() { return static_cast<int>(sizeof(LobRef)) + inline_threshold(); }
+
+  /// @brief 之后打开的 LOB 文件使用的缓存大小
+  static void set_default_cache_capacity(int64_t capacity);
+
+private:
+  void put_cache(int64_t offset, const string &text);
+
 private:
   PersistHandler file_;
-};
\ No newline at end of file
+
+  common::Mutex                       cache_lock_;
+  common::LruCache<int64_t, string>   cache_;
+  int64_t                             cache_capacity_ = DEFAULT_CACHE_CAPACITY;
+  int64_t                             cached_bytes_   = 0;
+  atomic<int64_t>                     cache_hits_{0};
+  atomic<int64_t>                     cache_misses_{0};
+
+  static atomic<int>     inline_threshold_;
+  static atomic<int64_t> default_cache_capacity_;
+};
@@ -4,9 +4,19 @@
 
 /**
  * @brief 行内存储 TEXT 字段时用的 LOB 引用结构
+ * @details 字段的长度可能比 LobRef 长，多出来的部分用来保存比较短的文本。
+ * 文本可以放下时直接保存在 LobRef 的后面，reserved 中设置 INLINE 标记，offset 不使用；
+ * 放不下时保存在 LOB 文件中，offset 是在文件中的偏移。
  */
 struct LobRef {
+  static constexpr int32_t INLINE = 0x1;  ///< reserved 中的标记，文本保存在记录中
+
   int64_t offset;   ///< 在 LOB 文件中的偏移
   int32_t length;   ///< 文本长度（字节数）
   int32_t reserved; ///< 预留字段，便于将来扩展
-};
\ No newline at end of file
+
+  bool is_inline() const { return (reserved & INLINE) != 0; }
+
+  /// @brief 保存在记录中的文本，紧跟在 LobRef 的后面
+  const char *inline_data() const { return reinterpret_cast<const char *>(this) + sizeof(LobRef); }
+};
@@ -0,0 +1,58 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/algorithm.h"
+#include "common/lang/atomic.h"
+#include "common/types.h"
+
+/**
+ * @brief 并行扫描时使用的页面片段(morsel)队列
+ * @ingroup RecordManager
+ * @details 把数据文件中 [start_page, end_page) 范围内的页面按照 morsel_pages 个一组划分成多个片段，
+ * 每个扫描线程使用自己的扫描器，从同一个队列中动态领取片段，领取到的页面只会被一个扫描器访问。
+ * 处理得快的线程会领取更多的片段，不会因为某个线程分到的数据多而拖慢整个扫描。
+ * 队列创建以后新分配的页面不在扫描范围内，与串行扫描打开时的行为一致。
+ */
+class PageMorselQueue
+{
+public:
+  static constexpr int DEFAULT_MORSEL_PAGES = 16;
+
+public:
+  PageMorselQueue(PageNum start_page, PageNum end_page, int morsel_pages = DEFAULT_MORSEL_PAGES)
+      : end_page_(end_page), morsel_pages_(max(morsel_pages, 1)), next_page_(start_page)
+  {}
+
+  /**
+   * @brief 领取下一个片段，可以在多个线程中同时调用
+   * @param[out] start_page 片段的第一个页面
+   * @param[out] end_page   片段最后一个页面的下一个页面
+   * @return 所有的片段都被领取以后返回 false
+   */
+  bool next(PageNum &start_page, PageNum &end_page)
+  {
+    start_page = next_page_.fetch_add(morsel_pages_);
+    if (start_page >= end_page_) {
+      return false;
+    }
+    end_page = min(start_page + morsel_pages_, end_page_);
+    return true;
+  }
+
+  PageNum end_page() const { return end_page_; }
+  int     morsel_pages() const { return morsel_pages_; }
+
+private:
+  const PageNum   end_page_;
+  const int       morsel_pages_;
+  atomic<PageNum> next_page_;
+};
@@ -172,8 +172,16 @@ public:
     return *this;
   }
 
+  /**
+   * @brief 引用外部的数据，不拥有内存
+   * @details 之前拥有的内存会被释放，比如事务把旧版本复制到了记录中
+   */
   void set_data(char *data, int len = 0)
   {
+    if (owner_ && data_ != data) {
+      free(data_);
+      owner_ = false;
+    }
     this->data_ = data;
     this->len_  = len;
   }
@@ -187,9 +195,37 @@ public:
     this->owner_ = true;
   }
 
+  /**
+   * @brief 引用其它记录的数据，不复制也不拥有内存
+   * @details 引用的数据只在被引用的记录有效期间有效
+   */
+  void refer(const Record &other)
+  {
+    if (this == &other) {
+      return;
+    }
+
+    this->~Record();
+    new (this) Record();
+    rid_  = other.rid_;
+    key_  = other.key_;
+    data_ = other.data_;
+    len_  = other.len_;
+  }
+
+  /**
+   * @brief 把数据复制到自己管理的内存中，已经拥有长度相同的内存时直接复用
+   */
   RC copy_data(const char *data, int len)
   {
     ASSERT(len!= 0, "the len of data should not be 0");
+    if (owner_ && len_ == len) {
+      if (data_ != data) {
+        memcpy(data_, data, len);
+      }
+      return RC::SUCCESS;
+    }
+
     char *tmp = (char *)malloc(len);
     if (nullptr == tmp) {
       LOG_WARN("failed to allocate memory. size=%d", len);
@@ -201,9 +237,16 @@ public:
     return RC::SUCCESS;
   }
 
+  /**
+   * @brief 分配 len 字节的内存，已经拥有长度相同的内存时直接复用，内存中的数据是不确定的
+   */
   RC new_record(int len)
   {
     ASSERT(len!= 0, "the len of data should not be 0");
+    if (owner_ && len_ == len) {
+      return RC::SUCCESS;
+    }
+
     char *tmp = (char *)malloc(len);
     if (nullptr == tmp) {
       LOG_WARN("failed to allocate memory. size=%d", len);
@@ -37,6 +37,9 @@ string RecordOperation::to_string() const
     case Type::INSERT: return ret + "INSERT";
     case Type::DELETE: return ret + "DELETE";
     case Type::UPDATE: return ret + "UPDATE";
+    case Type::UPDATE_BATCH: return ret + "UPDATE_BATCH";
+    case Type::FORWARD: return ret + "FORWARD";
+    case Type::INSERT_MOVED: return ret + "INSERT_MOVED";
     default: return ret + "UNKNOWN";
   }
 }
@@ -58,9 +61,14 @@ string RecordLogHeader::to_string() const
     } break;
     case RecordOperation::Type::INSERT:
     case RecordOperation::Type::DELETE:
-    case RecordOperation::Type::UPDATE: {
+    case RecordOperation::Type::UPDATE:
+    case RecordOperation::Type::FORWARD:
+    case RecordOperation::Type::INSERT_MOVED: {
       ss << ", slot_num:" << slot_num;
     } break;
+    case RecordOperation::Type::UPDATE_BATCH: {
+      ss << ", record_num:" << record_num;
+    } break;
     default: {
       ss << ", unknown operation type";
     } break;
@@ -110,12 +118,27 @@ RC RecordLogHandler::init_new_page(Frame *frame, PageNum page_num, span<const ch
 }
 
 RC RecordLogHandler::insert_record(Frame *frame, const RID &rid, const char *record)
+{
+  return append_record(frame, RecordOperation::Type::INSERT, rid, record);
+}
+
+RC RecordLogHandler::update_record(Frame *frame, const RID &rid, const char *record)
+{
+  return append_record(frame, RecordOperation::Type::UPDATE, rid, record);
+}
+
+RC RecordLogHandler::insert_moved_record(Frame *frame, const RID &rid, const char *record)
+{
+  return append_record(frame, RecordOperation::Type::INSERT_MOVED, rid, record);
+}
+
+RC RecordLogHandler::append_record(Frame *frame, RecordOperation::Type type, const RID &rid, const char *record)
 {
   const int        log_payload_size = RecordLogHeader::SIZE + record_size_;
   vector<char>     log_payload(log_payload_size);
   RecordLogHeader *header = reinterpret_cast<RecordLogHeader *>(log_payload.data());
   header->buffer_pool_id  = buffer_pool_id_;
-  header->operation_type  = RecordOperation(RecordOperation::Type::INSERT).type_id();
+  header->operation_type  = RecordOperation(type).type_id();
   header->page_num        = rid.page_num;
   header->slot_num        = rid.slot_num;
   header->storage_format  = static_cast<int>(storage_format_);
@@ -129,17 +152,19 @@ RC RecordLogHandler::insert_record(Frame *frame, const RID &rid, const char *rec
   return rc;
 }
 
-RC RecordLogHandler::update_record(Frame *frame, const RID &rid, const char *record)
+RC RecordLogHandler::update_records(Frame *frame, span<const SlotNum> slots, const char *records)
 {
-  const int        log_payload_size = RecordLogHeader::SIZE + record_size_;
+  const int        slots_size       = static_cast<int>(slots.size() * sizeof(SlotNum));
+  const int        log_payload_size = RecordLogHeader::SIZE + slots_size + static_cast<int>(slots.size()) * record_size_;
   vector<char>     log_payload(log_payload_size);
   RecordLogHeader *header = reinterpret_cast<RecordLogHeader *>(log_payload.data());
   header->buffer_pool_id  = buffer_pool_id_;
-  header->operation_type  = RecordOperation(RecordOperation::Type::UPDATE).type_id();
-  header->page_num        = rid.page_num;
-  header->slot_num        = rid.slot_num;
+  header->operation_type  = RecordOperation(RecordOperation::Type::UPDATE_BATCH).type_id();
+  header->page_num        = frame->page_num();
+  header->record_num      = static_cast<int32_t>(slots.size());
   header->storage_format  = static_cast<int>(storage_format_);
-  memcpy(log_payload.data() + RecordLogHeader::SIZE, record, record_size_);
+  memcpy(log_payload.data() + RecordLogHeader::SIZE, slots.data(), slots_size);
+  memcpy(log_payload.data() + RecordLogHeader::SIZE + slots_size, records, slots.size() * record_size_);
 
   LSN lsn = 0;
   RC  rc  = log_handler_->append(lsn, LogModule::Id::RECORD_MANAGER, std::move(log_payload));
@@ -168,6 +193,26 @@ RC RecordLogHandler::delete_record(Frame *frame, const RID &rid)
   return rc;
 }
 
+RC RecordLogHandler::forward_record(Frame *frame, const RID &rid, const RID &target)
+{
+  const int        log_payload_size = RecordLogHeader::SIZE + sizeof(RID);
+  vector<char>     log_payload(log_payload_size);
+  RecordLogHeader *header = reinterpret_cast<RecordLogHeader *>(log_payload.data());
+  header->buffer_pool_id  = buffer_pool_id_;
+  header->operation_type  = RecordOperation(RecordOperation::Type::FORWARD).type_id();
+  header->page_num        = rid.page_num;
+  header->slot_num        = rid.slot_num;
+  header->storage_format  = static_cast<int>(storage_format_);
+  memcpy(log_payload.data() + RecordLogHeader::SIZE, &target, sizeof(target));
+
+  LSN lsn = 0;
+  RC  rc  = log_handler_->append(lsn, LogModule::Id::RECORD_MANAGER, std::move(log_payload));
+  if (OB_SUCC(rc) && lsn > 0) {
+    frame->set_lsn(lsn);
+  }
+  return rc;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // class RecordLogReplayer
 
@@ -226,6 +271,15 @@ RC RecordLogReplayer::replay(const LogEntry &entry)
     case RecordOperation::Type::UPDATE: {
       rc = replay_update(*buffer_pool, *log_header);
     } break;
+    case RecordOperation::Type::UPDATE_BATCH: {
+      rc = replay_update_batch(*buffer_pool, *log_header);
+    } break;
+    case RecordOperation::Type::FORWARD: {
+      rc = replay_forward(*buffer_pool, *log_header);
+    } break;
+    case RecordOperation::Type::INSERT_MOVED: {
+      rc = replay_insert_moved(*buffer_pool, *log_header);
+    } break;
     default: {
       LOG_WARN("unknown record operation type: %d", log_header->operation_type);
       return RC::INVALID_ARGUMENT;
@@ -275,7 +329,8 @@ RC RecordLogReplayer::replay_insert(DiskBufferPool &buffer_pool, const RecordLog
 
   const char *record = log_header.data;
   RID         rid(log_header.page_num, log_header.slot_num);
-  rc = record_page_handler->insert_record(record, &rid);
+  // 按照日志中的槽位恢复，变长行存页面上记录的位置与插入顺序有关，不能重新选择槽位
+  rc = record_page_handler->recover_insert_record(record, rid);
   if (OB_FAIL(rc)) {
     LOG_WARN("fail to recover insert record. page num=%d, slot num=%d, rc=%s", 
              log_header.page_num, log_header.slot_num, strrc(rc));
@@ -329,3 +384,71 @@ RC RecordLogReplayer::replay_update(DiskBufferPool &buffer_pool, const RecordLog
 
   return rc;
 }
+
+RC RecordLogReplayer::replay_update_batch(DiskBufferPool &buffer_pool, const RecordLogHeader &header)
+{
+  VacuousLogHandler             vacuous_log_handler;
+  unique_ptr<RecordPageHandler> record_page_handler(RecordPageHandler::create(StorageFormat(header.storage_format)));
+
+  RC rc = record_page_handler->init(buffer_pool, vacuous_log_handler, header.page_num, ReadWriteMode::READ_WRITE);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("fail to init record page handler. page num=%d, rc=%s", header.page_num, strrc(rc));
+    return rc;
+  }
+
+  span<const SlotNum> slots(reinterpret_cast<const SlotNum *>(header.data), header.record_num);
+  const char         *records = header.data + header.record_num * sizeof(SlotNum);
+  rc = record_page_handler->update_records(slots, records);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("fail to recover update records. page num=%d, record num=%d, rc=%s", 
+             header.page_num, header.record_num, strrc(rc));
+    return rc;
+  }
+
+  return rc;
+}
+
+RC RecordLogReplayer::replay_forward(DiskBufferPool &buffer_pool, const RecordLogHeader &header)
+{
+  VacuousLogHandler        vacuous_log_handler;
+  SlottedRecordPageHandler record_page_handler;
+
+  RC rc = record_page_handler.init(buffer_pool, vacuous_log_handler, header.page_num, ReadWriteMode::READ_WRITE);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("fail to init record page handler. page num=%d, rc=%s", header.page_num, strrc(rc));
+    return rc;
+  }
+
+  RID target;
+  memcpy(&target, header.data, sizeof(target));
+  rc = record_page_handler.recover_forward_record(header.slot_num, target);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("fail to recover forward record. page num=%d, slot num=%d, target=%s, rc=%s", 
+             header.page_num, header.slot_num, target.to_string().c_str(), strrc(rc));
+    return rc;
+  }
+
+  return rc;
+}
+
+RC RecordLogReplayer::replay_insert_moved(DiskBufferPool &buffer_pool, const RecordLogHeader &header)
+{
+  VacuousLogHandler        vacuous_log_handler;
+  SlottedRecordPageHandler record_page_handler;
+
+  RC rc = record_page_handler.init(buffer_pool, vacuous_log_handler, header.page_num, ReadWriteMode::READ_WRITE);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("fail to init record page handler. page num=%d, rc=%s", header.page_num, strrc(rc));
+    return rc;
+  }
+
+  RID rid(header.page_num, header.slot_num);
+  rc = record_page_handler.recover_insert_moved_record(header.data, rid);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("fail to recover insert moved record. page num=%d, slot num=%d, rc=%s", 
+             header.page_num, header.slot_num, strrc(rc));
+    return rc;
+  }
+
+  return rc;
+}
@@ -41,7 +41,10 @@ public:
     INIT_PAGE,  /// 初始化空页面
     INSERT,     /// 插入一条记录
     DELETE,     /// 删除一条记录
-    UPDATE      /// 更新一条记录
+    UPDATE,     /// 更新一条记录
+    UPDATE_BATCH,  /// 更新同一个页面上的多条记录
+    FORWARD,       /// 变长行存页面上的记录迁移到其它页面，原来的槽位指向新位置
+    INSERT_MOVED   /// 在溢出页面上插入一条迁移过来的记录
   };
 
 public:
@@ -69,6 +72,7 @@ struct RecordLogHeader
   {
     SlotNum slot_num;
     int32_t record_size;
+    int32_t record_num;  ///< UPDATE_BATCH 中的记录条数
   };
 
   char data[0];
@@ -125,6 +129,34 @@ public:
    */
   RC update_record(Frame *frame, const RID &rid, const char *record);
 
+  /**
+   * @brief 更新同一个页面上的多条记录
+   * @param frame 页帧
+   * @param slots 记录所在的槽位
+   * @param records 按照 slots 的顺序存放的更新后的记录
+   * @details 日志中先存放所有的槽位，再存放所有的记录
+   */
+  RC update_records(Frame *frame, span<const SlotNum> slots, const char *records);
+
+  /**
+   * @brief 记录迁移到了其它页面，原来的槽位改为指向新位置
+   * @param frame 页帧
+   * @param rid 记录原来的位置
+   * @param target 记录迁移后的位置
+   */
+  RC forward_record(Frame *frame, const RID &rid, const RID &target);
+
+  /**
+   * @brief 在溢出页面上插入一条迁移过来的记录
+   * @param frame 页帧
+   * @param rid 记录在溢出页面上的位置
+   * @param record 记录的内容
+   */
+  RC insert_moved_record(Frame *frame, const RID &rid, const char *record);
+
+private:
+  RC append_record(Frame *frame, RecordOperation::Type type, const RID &rid, const char *record);
+
 private:
   LogHandler   *log_handler_    = nullptr;
   int32_t       buffer_pool_id_ = -1;
@@ -149,6 +181,9 @@ private:
   RC replay_insert(DiskBufferPool &buffer_pool, const RecordLogHeader &log_header);
   RC replay_delete(DiskBufferPool &buffer_pool, const RecordLogHeader &log_header);
   RC replay_update(DiskBufferPool &buffer_pool, const RecordLogHeader &log_header);
+  RC replay_update_batch(DiskBufferPool &buffer_pool, const RecordLogHeader &log_header);
+  RC replay_forward(DiskBufferPool &buffer_pool, const RecordLogHeader &log_header);
+  RC replay_insert_moved(DiskBufferPool &buffer_pool, const RecordLogHeader &log_header);
 
 private:
   BufferPoolManager &bpm_;
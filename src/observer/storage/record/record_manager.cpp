@@ -16,14 +16,49 @@ See the Mulan PSL v2 for more details. */
 #include "storage/common/condition_filter.h"
 #include "storage/trx/trx.h"
 #include "storage/clog/log_handler.h"
+#include "storage/clog/vacuous_log_handler.h"
 
 using namespace common;
 
 static constexpr int PAGE_HEADER_SIZE = (sizeof(PageHeader));
+
+/**
+ * @brief 变长行存页面上槽位目录的信息，存放在 column descriptors 后面
+ */
+struct SlottedPageHeader
+{
+  int32_t slot_num;      ///< 槽位目录的长度，包括已经删除的槽位
+  int32_t free_end;      ///< 记录数据的起始位置，记录从页面末尾向前存放
+  int32_t garbage_size;  ///< 删除和更新以后留下的空洞大小，页内整理时回收
+  int32_t overflow;      ///< 是否是溢出页面，只存放从其它页面迁移过来的记录
+};
+
+/**
+ * @brief 变长行存页面上的一个槽位，删除以后 offset 和 length 都是0
+ * @details 记录迁移到其它页面以后，length 的最高位置为1，槽位上保存的是记录迁移后的 RID
+ */
+struct SlottedPageSlot
+{
+  uint16_t offset;
+  uint16_t length;
+};
+
+static constexpr int SLOT_SIZE           = sizeof(SlottedPageSlot);
+static constexpr int VAR_LENGTH_SIZE     = sizeof(uint16_t);
+static constexpr int SLOTTED_PAGE_RESERVE = BP_PAGE_DATA_SIZE / 16;  ///< 为记录变长预留的空间
+static constexpr uint16_t SLOT_FORWARDED   = 0x8000;                   ///< 槽位是转发槽位
+static constexpr uint16_t SLOT_LENGTH_MASK = SLOT_FORWARDED - 1;
+static constexpr int      MIN_SLOTTED_RECORD_SIZE = sizeof(RID);  ///< 记录占用的最小空间，可以放下转发槽位的 RID
+static_assert(BP_PAGE_DATA_SIZE <= SLOT_LENGTH_MASK, "slot length overlaps the forwarded flag");
+
+static int slot_length(const SlottedPageSlot &slot) { return slot.length & SLOT_LENGTH_MASK; }
+
 RecordPageHandler   *RecordPageHandler::create(StorageFormat format)
 {
   if (format == StorageFormat::ROW_FORMAT) {
     return new RowRecordPageHandler();
+  } else if (format == StorageFormat::SLOTTED_FORMAT) {
+    return new SlottedRecordPageHandler();
   } else {
     return new PaxRecordPageHandler();
   }
@@ -76,7 +111,8 @@ void RecordPageIterator::init(RecordPageHandler *record_page_handler, SlotNum st
   record_page_handler_ = record_page_handler;
   page_num_            = record_page_handler->get_page_num();
   bitmap_.init(record_page_handler->bitmap_, record_page_handler->page_header_->record_capacity);
-  next_slot_num_ = bitmap_.next_setted_bit(start_slot_num);
+  // 溢出页面上的记录通过原来页面上的槽位访问
+  next_slot_num_ = record_page_handler->is_overflow() ? -1 : bitmap_.next_setted_bit(start_slot_num);
 }
 
 bool RecordPageIterator::has_next() { return -1 != next_slot_num_; }
@@ -195,10 +231,9 @@ RC RecordPageHandler::init_empty_page(DiskBufferPool &buffer_pool, LogHandler &l
   memset(bitmap_, 0, page_bitmap_size(page_header_->record_capacity));
   // column_index[i] store the end offset of column `i` or the start offset of column `i+1`
 
-  // 计算列偏移
+  // 计算列偏移。页面上的第 i 列就是表中的第 i 个字段，包括前面的事务字段，用 TableMeta::field_index 从 field_id 转换过来
   int *column_index = reinterpret_cast<int *>(frame_->data() + page_header_->col_idx_offset);
   for (int i = 0; i < column_num; ++i) {
-    ASSERT(i == table_meta->field(i)->field_id(), "i should be the col_id of fields[i]");
     if (i == 0) {
       column_index[i] = table_meta->field(i)->len() * page_header_->record_capacity;
     } else {
@@ -392,6 +427,33 @@ RC RowRecordPageHandler::update_record(const RID &rid, const char *data)
   }
 }
 
+RC RowRecordPageHandler::update_records(span<const SlotNum> slots, const char *data)
+{
+  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, "cannot update record of page while the page is readonly");
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  for (SlotNum slot_num : slots) {
+    if (slot_num >= page_header_->record_capacity || !bitmap.get_bit(slot_num)) {
+      LOG_DEBUG("Invalid slot_num %d, slot is empty, page_num %d.", slot_num, frame_->page_num());
+      return RC::RECORD_NOT_EXIST;
+    }
+  }
+
+  frame_->mark_dirty();
+  const int record_size = page_header_->record_real_size;
+  for (size_t i = 0; i < slots.size(); i++) {
+    memcpy(get_record_data(slots[i]), data + i * record_size, record_size);
+  }
+
+  RC rc = log_handler_.update_records(frame_, slots, data);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to update records. page_num %d:%d. rc=%s",
+              disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+    // return rc; // ignore errors
+  }
+  return RC::SUCCESS;
+}
+
 RC RowRecordPageHandler::get_record(const RID &rid, Record &record)
 {
   if (rid.slot_num >= page_header_->record_capacity) {
@@ -411,273 +473,1155 @@ RC RowRecordPageHandler::get_record(const RID &rid, Record &record)
   return RC::SUCCESS;
 }
 
-PageNum RecordPageHandler::get_page_num() const
-{
-  if (nullptr == page_header_) {
-    return (PageNum)(-1);
-  }
-  return frame_->page_num();
-}
-
-bool RecordPageHandler::is_full() const { return page_header_->record_num >= page_header_->record_capacity; }
-
-RC PaxRecordPageHandler::insert_record(const char *data, RID *rid)
-{
-  // your code here
-  // Todo:
-  // 1.参考RowRecordPageHandler::insert_record完成大体实现
-  // 2.将一行数据拆分成不同的列插入到不同偏移中
-  // 对应列的偏移可以参照RecordPageHandler::init_empty_page
-  return RC::UNIMPLEMENTED;
-}
-
-RC PaxRecordPageHandler::insert_chunk(const Chunk &chunk, int start_row, int &insert_rows)
+RC RowRecordPageHandler::get_chunk(Chunk &chunk, const TableMeta &table_meta)
 {
-  // your code here
-  return RC::UNIMPLEMENTED;
-}
+  vector<const FieldMeta *> field_metas(chunk.column_num());
+  for (int i = 0; i < chunk.column_num(); i++) {
+    const int col_id = chunk.column_ids(i);
+    const int index  = table_meta.field_index(col_id);
+    if (index < 0) {
+      LOG_WARN("invalid column id. col_id=%d, field_num=%d", col_id, table_meta.field_num());
+      return RC::INVALID_ARGUMENT;
+    }
 
-RC PaxRecordPageHandler::delete_record(const RID *rid)
-{
-  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, 
-         "cannot delete record from page while the page is readonly");
+    const FieldMeta *field_meta = table_meta.field(index);
+    if (chunk.column(i).attr_len() != field_meta->len() ||
+        field_meta->offset() + field_meta->len() > page_header_->record_real_size) {
+      LOG_WARN("column mismatch. col_id=%d, column len=%d, field offset=%d, field len=%d, record size=%d",
+               col_id, chunk.column(i).attr_len(), field_meta->offset(), field_meta->len(),
+               page_header_->record_real_size);
+      return RC::INVALID_ARGUMENT;
+    }
+    field_metas[i] = field_meta;
+  }
 
+  vector<const char *> records;
+  records.reserve(page_header_->record_num);
   Bitmap bitmap(bitmap_, page_header_->record_capacity);
-  if (bitmap.get_bit(rid->slot_num)) {
-    bitmap.clear_bit(rid->slot_num);
-    page_header_->record_num--;
-    frame_->mark_dirty();
+  for (int slot_num = bitmap.next_setted_bit(0); slot_num >= 0; slot_num = bitmap.next_setted_bit(slot_num + 1)) {
+    records.push_back(get_record_data(slot_num));
+  }
 
-    RC rc = log_handler_.delete_record(frame_, *rid);
-    if (OB_FAIL(rc)) {
-      LOG_ERROR("Failed to delete record. page_num %d:%d. rc=%s", disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
-      // return rc; // ignore errors
+  const int rows = static_cast<int>(records.size());
+  for (int i = 0; i < chunk.column_num(); i++) {
+    const int offset = field_metas[i]->offset();
+
+    Column &column = chunk.column(i);
+    for (int row = 0; row < rows; row++) {
+      RC rc = column.append_one(records[row] + offset);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to append column data. col_id=%d, rc=%s", chunk.column_ids(i), strrc(rc));
+        return rc;
+      }
     }
-
-    return RC::SUCCESS;
-  } else {
-    LOG_DEBUG("Invalid slot_num %d, slot is empty, page_num %d.", rid->slot_num, frame_->page_num());
-    return RC::RECORD_NOT_EXIST;
   }
+  return RC::SUCCESS;
 }
 
-RC PaxRecordPageHandler::get_record(const RID &rid, Record &record)
+////////////////////////////////////////////////////////////////////////////////
+static SlottedPageHeader *slotted_page_header(Frame *frame, const PageHeader *page_header)
 {
-  // your code here
-  // Todo:
-  // 1.参考RowRecordPageHandler::get_record完成大体实现
-  // 2.通过列的偏移拼接出完整的行数据
-  // 可以参照PaxRecordPageHandler::insert_record的实现
-  return RC::UNIMPLEMENTED;
+  return reinterpret_cast<SlottedPageHeader *>(
+      frame->data() + page_header->col_idx_offset + page_header->column_num * sizeof(int32_t));
 }
 
-// TODO: specify the column_ids that chunk needed. currenly we get all columns
-RC PaxRecordPageHandler::get_chunk(Chunk &chunk)
+static SlottedPageSlot *slotted_page_slots(Frame *frame, const PageHeader *page_header)
 {
-  // your code here
-  // Todo:
-  // 参照PaxRecordPageHandler::get_record
-  // 一次性获得一个page的所有record
-  return RC::UNIMPLEMENTED;
+  return reinterpret_cast<SlottedPageSlot *>(frame->data() + page_header->data_offset);
 }
 
-char *PaxRecordPageHandler::get_field_data(SlotNum slot_num, int col_id)
+RC SlottedRecordPageHandler::init_empty_page(DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num,
+    int record_size, TableMeta *table_meta, LobFileHandler *lob_handler)
 {
-  int *col_idx = reinterpret_cast<int *>(frame_->data() + page_header_->col_idx_offset);
-  if (col_id == 0) {
-    return frame_->data() + page_header_->data_offset + (get_field_len(col_id) * slot_num);
-  } else {
-    return frame_->data() + page_header_->data_offset + col_idx[col_id - 1] + (get_field_len(col_id) * slot_num);
+  // CHARS 字段是变长的，其它字段都按照定长存放。没有表的元数据时，整条记录当做一个定长字段
+  vector<int32_t> columns;
+  if (table_meta != nullptr) {
+    for (int i = 0; i < table_meta->field_num(); i++) {
+      const FieldMeta *field = table_meta->field(i);
+      columns.push_back(field->type() == AttrType::CHARS ? -field->len() : field->len());
+    }
+  }
+  int total_len = 0;
+  for (int32_t column : columns) {
+    total_len += abs(column);
+  }
+  if (total_len != record_size) {
+    columns.assign(1, record_size);
   }
-}
 
-int PaxRecordPageHandler::get_field_len(int col_id)
-{
-  int *col_idx = reinterpret_cast<int *>(frame_->data() + page_header_->col_idx_offset);
-  if (col_id == 0) {
-    return col_idx[col_id] / page_header_->record_capacity;
-  } else {
-    return (col_idx[col_id] - col_idx[col_id - 1]) / page_header_->record_capacity;
+  RC rc = init_empty_page(buffer_pool, log_handler, page_num, record_size, static_cast<int>(columns.size()),
+      reinterpret_cast<const char *>(columns.data()), lob_handler);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  rc = log_handler_.init_new_page(
+      frame_, page_num, span(reinterpret_cast<const char *>(columns.data()), columns.size() * sizeof(int32_t)));
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to init empty page: write log failed. page_num:record_size %d:%d. rc=%s",
+              page_num, record_size, strrc(rc));
+    return rc;
   }
+  return RC::SUCCESS;
 }
 
-////////////////////////////////////////////////////////////////////////////////
+RC SlottedRecordPageHandler::init_empty_page(DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num,
+    int record_size, int column_num, const char *col_idx_data, LobFileHandler *lob_handler)
+{
+  RC rc = init(buffer_pool, log_handler, page_num, ReadWriteMode::READ_WRITE);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to init empty page page_num:record_size %d:%d. rc=%s", page_num, record_size, strrc(rc));
+    return rc;
+  }
+  lob_handler_ = lob_handler;
 
-RecordFileHandler::~RecordFileHandler() { this->close(); }
+  (void)log_handler_.init(log_handler, buffer_pool.id(), record_size, storage_format_);
 
-RC RecordFileHandler::init(
-    DiskBufferPool &buffer_pool, LogHandler &log_handler, TableMeta *table_meta, LobFileHandler *lob_handler)
-{
-  if (disk_buffer_pool_ != nullptr) {
-    LOG_ERROR("record file handler has been openned.");
-    return RC::RECORD_OPENNED;
+  const int32_t *columns = reinterpret_cast<const int32_t *>(col_idx_data);
+  int            max_len = 0;
+  int            min_len = 0;
+  for (int i = 0; i < column_num; i++) {
+    if (columns[i] < 0) {
+      max_len += VAR_LENGTH_SIZE - columns[i];
+      min_len += VAR_LENGTH_SIZE;
+    } else {
+      max_len += columns[i];
+      min_len += columns[i];
+    }
   }
 
-  disk_buffer_pool_ = &buffer_pool;
-  log_handler_      = &log_handler;
-  table_meta_       = table_meta;
-  lob_handler_      = lob_handler;
+  // 槽位个数按照最短的记录计算
+  const int fixed_size = column_num * sizeof(int32_t) + sizeof(SlottedPageHeader) + 8 /*对齐*/;
+  page_header_->record_num       = 0;
+  page_header_->column_num       = column_num;
+  page_header_->record_real_size = record_size;
+  page_header_->record_size      = max_len;
+  page_header_->record_capacity  = page_record_capacity(BP_PAGE_DATA_SIZE, max(min_len, MIN_SLOTTED_RECORD_SIZE) + SLOT_SIZE, fixed_size);
+  page_header_->col_idx_offset   = align8(PAGE_HEADER_SIZE + page_bitmap_size(page_header_->record_capacity));
+  page_header_->data_offset =
+      page_header_->col_idx_offset + column_num * sizeof(int32_t) + sizeof(SlottedPageHeader);
+  ASSERT(page_header_->data_offset + max_len + SLOT_SIZE <= BP_PAGE_DATA_SIZE, "Record overflow the page size");
 
-  RC rc = init_free_pages();
+  bitmap_ = frame_->data() + PAGE_HEADER_SIZE;
+  memset(bitmap_, 0, page_bitmap_size(page_header_->record_capacity));
+  memcpy(frame_->data() + page_header_->col_idx_offset, col_idx_data, column_num * sizeof(int32_t));
 
-  LOG_INFO("open record file handle done. rc=%s", strrc(rc));
+  SlottedPageHeader *slotted_header = slotted_page_header(frame_, page_header_);
+  slotted_header->slot_num          = 0;
+  slotted_header->free_end          = BP_PAGE_DATA_SIZE;
+  slotted_header->garbage_size      = 0;
+  slotted_header->overflow          = 0;
+
+  frame_->mark_dirty();
   return RC::SUCCESS;
 }
 
-void RecordFileHandler::close()
+int SlottedRecordPageHandler::encoded_size(const char *data) const
 {
-  if (disk_buffer_pool_ != nullptr) {
-    free_pages_.clear();
-    disk_buffer_pool_ = nullptr;
-    log_handler_      = nullptr;
-    table_meta_       = nullptr;
+  const int32_t *columns = reinterpret_cast<const int32_t *>(frame_->data() + page_header_->col_idx_offset);
+  int            size    = 0;
+  for (int i = 0; i < page_header_->column_num; i++) {
+    const int len = abs(columns[i]);
+    if (columns[i] < 0) {
+      int value_len = len;
+      while (value_len > 0 && data[value_len - 1] == 0) {
+        value_len--;
+      }
+      size += VAR_LENGTH_SIZE + value_len;
+    } else {
+      size += len;
+    }
+    data += len;
   }
+  return size;
 }
 
-RC RecordFileHandler::init_free_pages()
+void SlottedRecordPageHandler::encode(const char *data, char *encoded) const
 {
-  // 遍历当前文件上所有页面，找到没有满的页面
-  // 这个效率很低，会降低启动速度
-  // NOTE: 由于是初始化时的动作，所以不需要加锁控制并发
-
-  RC rc = RC::SUCCESS;
-
-  BufferPoolIterator bp_iterator;
-  bp_iterator.init(*disk_buffer_pool_, 1);
-  unique_ptr<RecordPageHandler> record_page_handler(RecordPageHandler::create(storage_format_));
-  PageNum                       current_page_num = 0;
-
-  while (bp_iterator.has_next()) {
-    current_page_num = bp_iterator.next();
-
-    rc = record_page_handler->init(*disk_buffer_pool_, *log_handler_, current_page_num, ReadWriteMode::READ_ONLY);
-    if (rc != RC::SUCCESS) {
-      LOG_WARN("failed to init record page handler. page num=%d, rc=%d:%s", current_page_num, rc, strrc(rc));
-      return rc;
-    }
-
-    if (!record_page_handler->is_full()) {
-      free_pages_.insert(current_page_num);
+  const int32_t *columns = reinterpret_cast<const int32_t *>(frame_->data() + page_header_->col_idx_offset);
+  for (int i = 0; i < page_header_->column_num; i++) {
+    const int len = abs(columns[i]);
+    if (columns[i] < 0) {
+      uint16_t value_len = static_cast<uint16_t>(len);
+      while (value_len > 0 && data[value_len - 1] == 0) {
+        value_len--;
+      }
+      memcpy(encoded, &value_len, VAR_LENGTH_SIZE);
+      memcpy(encoded + VAR_LENGTH_SIZE, data, value_len);
+      encoded += VAR_LENGTH_SIZE + value_len;
+    } else {
+      memcpy(encoded, data, len);
+      encoded += len;
     }
-    record_page_handler->cleanup();
+    data += len;
   }
-  LOG_INFO("record file handler init free pages done. free page num=%d, rc=%s", free_pages_.size(), strrc(rc));
-  return rc;
 }
 
-RC RecordFileHandler::insert_record(const char *data, int record_size, RID *rid)
+void SlottedRecordPageHandler::decode(const char *encoded, char *data) const
 {
-  RC ret = RC::SUCCESS;
-
-  unique_ptr<RecordPageHandler> record_page_handler(RecordPageHandler::create(storage_format_));
-  bool                          page_found       = false;
-  PageNum                       current_page_num = 0;
-
-  // 当前要访问free_pages对象，所以需要加锁。在非并发编译模式下，不需要考虑这个锁
-  lock_.lock();
-
-  // 找到没有填满的页面
-  while (!free_pages_.empty()) {
-    current_page_num = *free_pages_.begin();
-
-    ret = record_page_handler->init(*disk_buffer_pool_, *log_handler_, current_page_num, ReadWriteMode::READ_WRITE);
-    if (OB_FAIL(ret)) {
-      lock_.unlock();
-      LOG_WARN("failed to init record page handler. page num=%d, rc=%d:%s", current_page_num, ret, strrc(ret));
-      return ret;
-    }
-
-    if (!record_page_handler->is_full()) {
-      page_found = true;
-      break;
+  const int32_t *columns = reinterpret_cast<const int32_t *>(frame_->data() + page_header_->col_idx_offset);
+  for (int i = 0; i < page_header_->column_num; i++) {
+    const int len = abs(columns[i]);
+    if (columns[i] < 0) {
+      uint16_t value_len = 0;
+      memcpy(&value_len, encoded, VAR_LENGTH_SIZE);
+      memcpy(data, encoded + VAR_LENGTH_SIZE, value_len);
+      memset(data + value_len, 0, len - value_len);
+      encoded += VAR_LENGTH_SIZE + value_len;
+    } else {
+      memcpy(data, encoded, len);
+      encoded += len;
     }
-    record_page_handler->cleanup();
-    free_pages_.erase(free_pages_.begin());
+    data += len;
   }
-  lock_.unlock();  // 如果找到了一个有效的页面，那么此时已经拿到了页面的写锁
+}
 
-  // 找不到就分配一个新的页面
-  if (!page_found) {
-    Frame *frame = nullptr;
-    if ((ret = disk_buffer_pool_->allocate_page(&frame)) != RC::SUCCESS) {
-      LOG_ERROR("Failed to allocate page while inserting record. ret:%d", ret);
-      return ret;
+void SlottedRecordPageHandler::compact()
+{
+  SlottedPageHeader *slotted_header = slotted_page_header(frame_, page_header_);
+  SlottedPageSlot   *slots          = slotted_page_slots(frame_, page_header_);
+  Bitmap             bitmap(bitmap_, page_header_->record_capacity);
+
+  vector<char> buffer(BP_PAGE_DATA_SIZE);
+  int          free_end = BP_PAGE_DATA_SIZE;
+  for (int i = 0; i < slotted_header->slot_num; i++) {
+    if (!bitmap.get_bit(i)) {
+      continue;
     }
+    free_end -= slot_length(slots[i]);
+    memcpy(buffer.data() + free_end, frame_->data() + slots[i].offset, slot_length(slots[i]));
+    slots[i].offset = static_cast<uint16_t>(free_end);
+  }
+  memcpy(frame_->data() + free_end, buffer.data() + free_end, BP_PAGE_DATA_SIZE - free_end);
 
-    current_page_num = frame->page_num();
+  slotted_header->free_end     = free_end;
+  slotted_header->garbage_size = 0;
+  frame_->mark_dirty();
+}
 
-    ret = record_page_handler->init_empty_page(
-        *disk_buffer_pool_, *log_handler_, current_page_num, record_size, table_meta_, lob_handler_);
-    if (OB_FAIL(ret)) {
-      frame->unpin();
-      LOG_ERROR("Failed to init empty page. ret:%d", ret);
-      // this is for allocate_page
-      return ret;
-    }
+RC SlottedRecordPageHandler::allocate_slot(SlotNum slot_num, int size, char *&dest)
+{
+  SlottedPageHeader *slotted_header = slotted_page_header(frame_, page_header_);
+  SlottedPageSlot   *slots          = slotted_page_slots(frame_, page_header_);
+  Bitmap             bitmap(bitmap_, page_header_->record_capacity);
+
+  const bool exists   = bitmap.get_bit(slot_num);
+  const int  old_size = exists ? slot_length(slots[slot_num]) : 0;
+  if (exists && size <= old_size) {
+    // 原地更新，剩下的空间留给页内整理
+    slotted_header->garbage_size += old_size - size;
+    slots[slot_num].length = static_cast<uint16_t>(size);
+    dest                   = frame_->data() + slots[slot_num].offset;
+    frame_->mark_dirty();
+    return RC::SUCCESS;
+  }
 
-    // frame 在allocate_page的时候，是有一个pin的，在init_empty_page时又会增加一个，所以这里手动释放一个
-    frame->unpin();
+  const int slot_space = slot_num >= slotted_header->slot_num ? (slot_num + 1 - slotted_header->slot_num) * SLOT_SIZE : 0;
+  const int free_start = page_header_->data_offset + slotted_header->slot_num * SLOT_SIZE;
+  if (slotted_header->free_end - free_start + slotted_header->garbage_size + old_size < size + slot_space) {
+    // 更新时由调用者把记录迁移到其它页面
+    LOG_TRACE("no enough space in page. page_num=%d, slot_num=%d, record size=%d, free_end=%d, garbage=%d",
+              get_page_num(), slot_num, size, slotted_header->free_end, slotted_header->garbage_size);
+    return RC::RECORD_NOMEM;
+  }
 
-    // 这里的加锁顺序看起来与上面是相反的，但是不会出现死锁
-    // 上面的逻辑是先加lock锁，然后加页面写锁，这里是先加上
-    // 了页面写锁，然后加lock的锁，但是不会引起死锁。
-    // 为什么？
-    lock_.lock();
-    free_pages_.insert(current_page_num);
-    lock_.unlock();
+  if (exists) {
+    slotted_header->garbage_size += old_size;
+    slots[slot_num].offset = 0;
+    slots[slot_num].length = 0;
+  }
+  if (slotted_header->free_end - free_start < size + slot_space) {
+    compact();
+  }
+  if (slot_num >= slotted_header->slot_num) {
+    memset(slots + slotted_header->slot_num, 0, slot_space);
+    slotted_header->slot_num = slot_num + 1;
   }
 
-  // 找到空闲位置
-  return record_page_handler->insert_record(data, rid);
+  slotted_header->free_end -= size;
+  slots[slot_num].offset = static_cast<uint16_t>(slotted_header->free_end);
+  slots[slot_num].length = static_cast<uint16_t>(size);
+  dest                   = frame_->data() + slotted_header->free_end;
+
+  if (!exists) {
+    bitmap.set_bit(slot_num);
+    page_header_->record_num++;
+  }
+  frame_->mark_dirty();
+  return RC::SUCCESS;
 }
 
-RC RecordFileHandler::insert_chunk(const Chunk &chunk, int record_size)
+RC SlottedRecordPageHandler::put_record(SlotNum slot_num, const char *data)
 {
-  // your code here
-  return RC::UNIMPLEMENTED;
+  // 每条记录至少占用一个 RID 的空间，迁移以后转发槽位可以原地保存新的位置
+  char *dest = nullptr;
+  RC    rc   = allocate_slot(slot_num, max(encoded_size(data), MIN_SLOTTED_RECORD_SIZE), dest);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+  encode(data, dest);
+  return RC::SUCCESS;
 }
 
-RC RecordFileHandler::recover_insert_record(const char *data, int record_size, const RID &rid)
+RC SlottedRecordPageHandler::put_forward(SlotNum slot_num, const RID &target)
 {
-  RC ret = RC::SUCCESS;
-
-  unique_ptr<RecordPageHandler> record_page_handler(RecordPageHandler::create(storage_format_));
-
-  ret = record_page_handler->recover_init(*disk_buffer_pool_, rid.page_num);
-  if (OB_FAIL(ret)) {
-    LOG_WARN("failed to init record page handler. page num=%d, rc=%s", rid.page_num, strrc(ret));
-    return ret;
+  char *dest = nullptr;
+  RC    rc   = allocate_slot(slot_num, sizeof(target), dest);
+  if (OB_FAIL(rc)) {
+    return rc;
   }
-
-  return record_page_handler->recover_insert_record(data, rid);
+  memcpy(dest, &target, sizeof(target));
+  slotted_page_slots(frame_, page_header_)[slot_num].length |= SLOT_FORWARDED;
+  return RC::SUCCESS;
 }
 
-RC RecordFileHandler::delete_record(const RID *rid)
+RC SlottedRecordPageHandler::insert_record(const char *data, RID *rid)
 {
-  RC rc = RC::SUCCESS;
+  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, "cannot insert record into page while the page is readonly");
 
-  unique_ptr<RecordPageHandler> record_page_handler(RecordPageHandler::create(storage_format_));
+  if (page_header_->record_num >= page_header_->record_capacity) {
+    LOG_WARN("Page is full, page_num %d:%d.", disk_buffer_pool_->file_desc(), frame_->page_num());
+    return RC::RECORD_NOMEM;
+  }
 
-  rc = record_page_handler->init(*disk_buffer_pool_, *log_handler_, rid->page_num, ReadWriteMode::READ_WRITE);
+  // 优先使用已经删除的槽位
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  int    index = bitmap.next_unsetted_bit(0);
+  RC     rc    = put_record(index, data);
   if (OB_FAIL(rc)) {
-    LOG_ERROR("Failed to init record page handler.page number=%d. rc=%s", rid->page_num, strrc(rc));
     return rc;
   }
 
-  rc = record_page_handler->delete_record(rid);
-  // 📢 这里注意要清理掉资源，否则会与insert_record中的加锁顺序冲突而可能出现死锁
-  // delete record的加锁逻辑是拿到页面锁，删除指定记录，然后加上和释放record manager锁
-  // insert record是加上 record manager锁，然后拿到指定页面锁再释放record manager锁
-  record_page_handler->cleanup();
-  if (OB_SUCC(rc)) {
-    // 因为这里已经释放了页面锁，并发时，其它线程可能又把该页面填满了，那就不应该再放入 free_pages_
-    // 中。但是这里可以不关心，因为在查找空闲页面时，会自动过滤掉已经满的页面
-    lock_.lock();
-    free_pages_.insert(rid->page_num);
-    LOG_TRACE("add free page %d to free page list", rid->page_num);
-    lock_.unlock();
+  // 记录日志，与数据库恢复相关
+  rc = log_handler_.insert_record(frame_, RID(get_page_num(), index), data);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to insert record. page_num %d:%d. rc=%s", disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+    // return rc; // ignore errors
+  }
+
+  if (rid) {
+    rid->page_num = get_page_num();
+    rid->slot_num = index;
+  }
+  return RC::SUCCESS;
+}
+
+RC SlottedRecordPageHandler::recover_insert_record(const char *data, const RID &rid)
+{
+  if (rid.slot_num >= page_header_->record_capacity) {
+    LOG_WARN("slot_num illegal, slot_num(%d) > record_capacity(%d).", rid.slot_num, page_header_->record_capacity);
+    return RC::RECORD_INVALID_RID;
+  }
+
+  return put_record(rid.slot_num, data);
+}
+
+RC SlottedRecordPageHandler::delete_record(const RID *rid)
+{
+  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, "cannot delete record from page while the page is readonly");
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (rid->slot_num >= page_header_->record_capacity || !bitmap.get_bit(rid->slot_num)) {
+    LOG_DEBUG("Invalid slot_num %d, slot is empty, page_num %d.", rid->slot_num, frame_->page_num());
+    return RC::RECORD_NOT_EXIST;
+  }
+
+  SlottedPageHeader *slotted_header = slotted_page_header(frame_, page_header_);
+  SlottedPageSlot   *slots          = slotted_page_slots(frame_, page_header_);
+
+  bitmap.clear_bit(rid->slot_num);
+  page_header_->record_num--;
+  slotted_header->garbage_size += slot_length(slots[rid->slot_num]);
+  slots[rid->slot_num].offset = 0;
+  slots[rid->slot_num].length = 0;
+
+  // 末尾的空槽位可以直接回收
+  while (slotted_header->slot_num > 0 && !bitmap.get_bit(slotted_header->slot_num - 1)) {
+    slotted_header->slot_num--;
+  }
+  frame_->mark_dirty();
+
+  RC rc = log_handler_.delete_record(frame_, *rid);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to delete record. page_num %d:%d. rc=%s", disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+    // return rc; // ignore errors
+  }
+  return RC::SUCCESS;
+}
+
+RC SlottedRecordPageHandler::update_record(const RID &rid, const char *data)
+{
+  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, "cannot update record of page while the page is readonly");
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (rid.slot_num >= page_header_->record_capacity || !bitmap.get_bit(rid.slot_num)) {
+    LOG_DEBUG("Invalid slot_num %d, slot is empty, page_num %d.", rid.slot_num, frame_->page_num());
+    return RC::RECORD_NOT_EXIST;
+  }
+
+  RID target;
+  if (forwarded(rid.slot_num, target)) {
+    LOG_WARN("record has been moved, should update it on the target page. rid=%s, target=%s",
+             rid.to_string().c_str(), target.to_string().c_str());
+    return RC::INVALID_ARGUMENT;
+  }
+
+  RC rc = put_record(rid.slot_num, data);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  rc = log_handler_.update_record(frame_, rid, data);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to update record. page_num %d:%d. rc=%s",
+              disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+    // return rc; // ignore errors
+  }
+  return RC::SUCCESS;
+}
+
+RC SlottedRecordPageHandler::update_records(span<const SlotNum> slots, const char *data)
+{
+  vector<size_t> deferred;
+  RC             rc = update_records(slots, data, deferred);
+  if (OB_SUCC(rc) && !deferred.empty()) {
+    rc = RC::RECORD_NOMEM;
+  }
+  return rc;
+}
+
+RC SlottedRecordPageHandler::update_records(span<const SlotNum> slots, const char *data, vector<size_t> &deferred)
+{
+  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, "cannot update record of page while the page is readonly");
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  for (SlotNum slot_num : slots) {
+    if (slot_num >= page_header_->record_capacity || !bitmap.get_bit(slot_num)) {
+      LOG_DEBUG("Invalid slot_num %d, slot is empty, page_num %d.", slot_num, frame_->page_num());
+      return RC::RECORD_NOT_EXIST;
+    }
+  }
+
+  const int record_size = page_header_->record_real_size;
+  for (size_t i = 0; i < slots.size(); i++) {
+    RID target;
+    if (forwarded(slots[i], target)) {
+      deferred.push_back(i);
+      continue;
+    }
+    RC rc = put_record(slots[i], data + i * record_size);
+    if (rc == RC::RECORD_NOMEM) {
+      deferred.push_back(i);
+    } else if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+
+  // 日志中只记录在当前页面上更新了的记录
+  RC log_rc = RC::SUCCESS;
+  if (deferred.empty()) {
+    log_rc = log_handler_.update_records(frame_, slots, data);
+  } else if (deferred.size() < slots.size()) {
+    vector<SlotNum> updated_slots;
+    vector<char>    updated_data;
+    for (size_t i = 0, next_deferred = 0; i < slots.size(); i++) {
+      if (next_deferred < deferred.size() && deferred[next_deferred] == i) {
+        next_deferred++;
+        continue;
+      }
+      updated_slots.push_back(slots[i]);
+      updated_data.insert(updated_data.end(), data + i * record_size, data + (i + 1) * record_size);
+    }
+    log_rc = log_handler_.update_records(frame_, updated_slots, updated_data.data());
+  }
+  if (OB_FAIL(log_rc)) {
+    LOG_ERROR("Failed to update records. page_num %d:%d. rc=%s",
+              disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(log_rc));
+    // return rc; // ignore errors
+  }
+  return RC::SUCCESS;
+}
+
+RC SlottedRecordPageHandler::get_record(const RID &rid, Record &record)
+{
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (rid.slot_num >= page_header_->record_capacity || !bitmap.get_bit(rid.slot_num)) {
+    LOG_ERROR("Invalid slot_num:%d, slot is empty, page_num %d.", rid.slot_num, frame_->page_num());
+    return RC::RECORD_NOT_EXIST;
+  }
+
+  RC rc = record.new_record(page_header_->record_real_size);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to allocate record. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  RID target;
+  if (forwarded(rid.slot_num, target)) {
+    // 记录已经迁移到了溢出页面。持有当前页面的锁，记录不会再次迁移
+    VacuousLogHandler        vacuous_log_handler;
+    SlottedRecordPageHandler target_page;
+    rc = target_page.init(*disk_buffer_pool_, vacuous_log_handler, target.page_num, ReadWriteMode::READ_ONLY, lob_handler_);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to init overflow page. rid=%s, target=%s, rc=%s",
+               rid.to_string().c_str(), target.to_string().c_str(), strrc(rc));
+      return rc;
+    }
+    rc = target_page.get_record(target, record);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to get moved record. rid=%s, target=%s, rc=%s",
+               rid.to_string().c_str(), target.to_string().c_str(), strrc(rc));
+      return rc;
+    }
+    record.set_rid(rid);
+    return RC::SUCCESS;
+  }
+
+  const SlottedPageSlot &slot = slotted_page_slots(frame_, page_header_)[rid.slot_num];
+  decode(frame_->data() + slot.offset, record.data());
+  record.set_rid(rid);
+  return RC::SUCCESS;
+}
+
+bool SlottedRecordPageHandler::forwarded(SlotNum slot_num, RID &target) const
+{
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (slot_num < 0 || slot_num >= page_header_->record_capacity || !bitmap.get_bit(slot_num)) {
+    return false;
+  }
+
+  const SlottedPageSlot &slot = slotted_page_slots(frame_, page_header_)[slot_num];
+  if ((slot.length & SLOT_FORWARDED) == 0) {
+    return false;
+  }
+  memcpy(&target, frame_->data() + slot.offset, sizeof(target));
+  return true;
+}
+
+RC SlottedRecordPageHandler::insert_moved_record(const char *data, RID *rid)
+{
+  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, "cannot insert record into page while the page is readonly");
+
+  if (page_header_->record_num >= page_header_->record_capacity) {
+    return RC::RECORD_NOMEM;
+  }
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  int    index = bitmap.next_unsetted_bit(0);
+  RC     rc    = put_record(index, data);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+  slotted_page_header(frame_, page_header_)->overflow = 1;
+
+  rc = log_handler_.insert_moved_record(frame_, RID(get_page_num(), index), data);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to insert moved record. page_num %d:%d. rc=%s",
+              disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+    // return rc; // ignore errors
+  }
+
+  rid->page_num = get_page_num();
+  rid->slot_num = index;
+  return RC::SUCCESS;
+}
+
+RC SlottedRecordPageHandler::recover_insert_moved_record(const char *data, const RID &rid)
+{
+  RC rc = recover_insert_record(data, rid);
+  if (OB_SUCC(rc)) {
+    slotted_page_header(frame_, page_header_)->overflow = 1;
+  }
+  return rc;
+}
+
+RC SlottedRecordPageHandler::forward_record(SlotNum slot_num, const RID &target)
+{
+  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, "cannot update record of page while the page is readonly");
+
+  RC rc = recover_forward_record(slot_num, target);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  rc = log_handler_.forward_record(frame_, RID(get_page_num(), slot_num), target);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to forward record. page_num %d:%d. rc=%s",
+              disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+    // return rc; // ignore errors
+  }
+  return RC::SUCCESS;
+}
+
+RC SlottedRecordPageHandler::recover_forward_record(SlotNum slot_num, const RID &target)
+{
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (slot_num >= page_header_->record_capacity || !bitmap.get_bit(slot_num)) {
+    LOG_DEBUG("Invalid slot_num %d, slot is empty, page_num %d.", slot_num, frame_->page_num());
+    return RC::RECORD_NOT_EXIST;
+  }
+  return put_forward(slot_num, target);
+}
+
+bool SlottedRecordPageHandler::is_full() const
+{
+  // 溢出页面不插入新的记录
+  if (is_overflow() || page_header_->record_num >= page_header_->record_capacity) {
+    return true;
+  }
+  if (page_header_->record_num == 0) {
+    return false;
+  }
+
+  // 保证最长的记录也可以插入，并且为已有记录变长预留空间
+  const SlottedPageHeader *slotted_header = slotted_page_header(frame_, page_header_);
+  const int free_start = page_header_->data_offset + slotted_header->slot_num * SLOT_SIZE;
+  const int free_size  = slotted_header->free_end - free_start + slotted_header->garbage_size;
+  return free_size < page_header_->record_size + SLOT_SIZE + SLOTTED_PAGE_RESERVE;
+}
+
+bool SlottedRecordPageHandler::is_overflow() const { return slotted_page_header(frame_, page_header_)->overflow != 0; }
+
+int SlottedRecordPageHandler::free_space() const
+{
+  if (is_full()) {
+    return 0;
+  }
+  const SlottedPageHeader *slotted_header = slotted_page_header(frame_, page_header_);
+  const int free_start = page_header_->data_offset + slotted_header->slot_num * SLOT_SIZE;
+  return slotted_header->free_end - free_start + slotted_header->garbage_size;
+}
+
+int SlottedRecordPageHandler::total_space() const { return BP_PAGE_DATA_SIZE - page_header_->data_offset; }
+
+int SlottedRecordPageHandler::moved_free_space() const
+{
+  if (page_header_->record_num >= page_header_->record_capacity) {
+    return 0;
+  }
+  const SlottedPageHeader *slotted_header = slotted_page_header(frame_, page_header_);
+  const int free_start = page_header_->data_offset + slotted_header->slot_num * SLOT_SIZE;
+  return slotted_header->free_end - free_start + slotted_header->garbage_size;
+}
+
+PageNum RecordPageHandler::get_page_num() const
+{
+  if (nullptr == page_header_) {
+    return (PageNum)(-1);
+  }
+  return frame_->page_num();
+}
+
+bool RecordPageHandler::is_full() const { return page_header_->record_num >= page_header_->record_capacity; }
+
+RC PaxRecordPageHandler::insert_record(const char *data, RID *rid)
+{
+  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, 
+         "cannot insert record into page while the page is readonly");
+
+  if (page_header_->record_num == page_header_->record_capacity) {
+    LOG_WARN("Page is full, page_num %d:%d.", disk_buffer_pool_->file_desc(), frame_->page_num());
+    return RC::RECORD_NOMEM;
+  }
+
+  // 找到空闲位置
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  int    index = bitmap.next_unsetted_bit(0);
+  bitmap.set_bit(index);
+  page_header_->record_num++;
+
+  // 记录日志，与数据库恢复相关。日志中记录的是整行数据
+  RC rc = log_handler_.insert_record(frame_, RID(get_page_num(), index), data);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to insert record. page_num %d:%d. rc=%s", disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+    // return rc; // ignore errors
+  }
+
+  write_record(index, data);
+
+  frame_->mark_dirty();
+
+  if (rid) {
+    rid->page_num = get_page_num();
+    rid->slot_num = index;
+  }
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::recover_insert_record(const char *data, const RID &rid)
+{
+  if (rid.slot_num >= page_header_->record_capacity) {
+    LOG_WARN("slot_num illegal, slot_num(%d) > record_capacity(%d).", rid.slot_num, page_header_->record_capacity);
+    return RC::RECORD_INVALID_RID;
+  }
+
+  // 更新位图
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (!bitmap.get_bit(rid.slot_num)) {
+    bitmap.set_bit(rid.slot_num);
+    page_header_->record_num++;
+  }
+
+  // 恢复数据
+  write_record(rid.slot_num, data);
+
+  frame_->mark_dirty();
+
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::insert_chunk(const Chunk &chunk, int start_row, int &insert_rows)
+{
+  // your code here
+  return RC::UNIMPLEMENTED;
+}
+
+RC PaxRecordPageHandler::delete_record(const RID *rid)
+{
+  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, 
+         "cannot delete record from page while the page is readonly");
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (bitmap.get_bit(rid->slot_num)) {
+    bitmap.clear_bit(rid->slot_num);
+    page_header_->record_num--;
+    frame_->mark_dirty();
+
+    RC rc = log_handler_.delete_record(frame_, *rid);
+    if (OB_FAIL(rc)) {
+      LOG_ERROR("Failed to delete record. page_num %d:%d. rc=%s", disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+      // return rc; // ignore errors
+    }
+
+    return RC::SUCCESS;
+  } else {
+    LOG_DEBUG("Invalid slot_num %d, slot is empty, page_num %d.", rid->slot_num, frame_->page_num());
+    return RC::RECORD_NOT_EXIST;
+  }
+}
+
+RC PaxRecordPageHandler::update_record(const RID &rid, const char *data)
+{
+  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, "cannot update record from page while the page is readonly");
+
+  if (rid.slot_num >= page_header_->record_capacity) {
+    LOG_ERROR("Invalid slot_num %d, exceed page's record capacity, frame=%s, page_header=%s",
+              rid.slot_num, frame_->to_string().c_str(), page_header_->to_string().c_str());
+    return RC::INVALID_ARGUMENT;
+  }
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (!bitmap.get_bit(rid.slot_num)) {
+    LOG_DEBUG("Invalid slot_num %d, slot is empty, page_num %d.", rid.slot_num, frame_->page_num());
+    return RC::RECORD_NOT_EXIST;
+  }
+
+  frame_->mark_dirty();
+  write_record(rid.slot_num, data);
+
+  RC rc = log_handler_.update_record(frame_, rid, data);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to update record. page_num %d:%d. rc=%s", 
+              disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+    // return rc; // ignore errors
+  }
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::update_records(span<const SlotNum> slots, const char *data)
+{
+  ASSERT(rw_mode_ != ReadWriteMode::READ_ONLY, "cannot update record from page while the page is readonly");
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  for (SlotNum slot_num : slots) {
+    if (slot_num >= page_header_->record_capacity || !bitmap.get_bit(slot_num)) {
+      LOG_DEBUG("Invalid slot_num %d, slot is empty, page_num %d.", slot_num, frame_->page_num());
+      return RC::RECORD_NOT_EXIST;
+    }
+  }
+
+  frame_->mark_dirty();
+  const int record_size = page_header_->record_real_size;
+  for (size_t i = 0; i < slots.size(); i++) {
+    write_record(slots[i], data + i * record_size);
+  }
+
+  RC rc = log_handler_.update_records(frame_, slots, data);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to update records. page_num %d:%d. rc=%s",
+              disk_buffer_pool_->file_desc(), frame_->page_num(), strrc(rc));
+    // return rc; // ignore errors
+  }
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::get_record(const RID &rid, Record &record)
+{
+  if (rid.slot_num >= page_header_->record_capacity) {
+    LOG_ERROR("Invalid slot_num %d, exceed page's record capacity, frame=%s, page_header=%s",
+              rid.slot_num, frame_->to_string().c_str(), page_header_->to_string().c_str());
+    return RC::RECORD_INVALID_RID;
+  }
+
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (!bitmap.get_bit(rid.slot_num)) {
+    LOG_ERROR("Invalid slot_num:%d, slot is empty, page_num %d.", rid.slot_num, frame_->page_num());
+    return RC::RECORD_NOT_EXIST;
+  }
+
+  // 各列的数据不在一起，需要复制出来拼成一行
+  RC rc = record.new_record(page_header_->record_real_size);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to allocate record. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  char *data = record.data();
+  for (int col_id = 0, offset = 0; col_id < page_header_->column_num; col_id++) {
+    const int field_len = get_field_len(col_id);
+    memcpy(data + offset, get_field_data(rid.slot_num, col_id), field_len);
+    offset += field_len;
+  }
+  record.set_rid(rid);
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::chunk_columns(Chunk &chunk, const TableMeta *table_meta, vector<int> &columns)
+{
+  columns.resize(chunk.column_num());
+  for (int i = 0; i < chunk.column_num(); i++) {
+    const int col_id = table_meta != nullptr ? table_meta->field_index(chunk.column_ids(i)) : chunk.column_ids(i);
+    if (col_id < 0 || col_id >= page_header_->column_num) {
+      LOG_WARN("invalid column id. col_id=%d, column_num=%d", chunk.column_ids(i), page_header_->column_num);
+      return RC::INVALID_ARGUMENT;
+    }
+
+    const int field_len = get_field_len(col_id);
+    if (chunk.column(i).attr_len() != field_len) {
+      LOG_WARN("column length mismatch. col_id=%d, column len=%d, field len=%d",
+               col_id, chunk.column(i).attr_len(), field_len);
+      return RC::INVALID_ARGUMENT;
+    }
+    columns[i] = col_id;
+  }
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::get_chunk(Chunk &chunk)
+{
+  vector<int> columns;
+  RC          rc = chunk_columns(chunk, nullptr, columns);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+  return copy_columns(chunk, columns);
+}
+
+RC PaxRecordPageHandler::get_chunk(Chunk &chunk, const TableMeta &table_meta)
+{
+  vector<int> columns;
+  RC          rc = chunk_columns(chunk, &table_meta, columns);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+  return copy_columns(chunk, columns);
+}
+
+RC PaxRecordPageHandler::get_chunk(Chunk &chunk, const TableMeta &table_meta, span<const int> slots)
+{
+  vector<int> columns;
+  RC          rc = chunk_columns(chunk, &table_meta, columns);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  for (int i = 0; i < chunk.column_num(); i++) {
+    const int col_id = columns[i];
+    Column   &column = chunk.column(i);
+    for (const int slot : slots) {
+      rc = column.append_one(get_field_data(slot, col_id));
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to append column data. col_id=%d, rc=%s", col_id, strrc(rc));
+        return rc;
+      }
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC PaxRecordPageHandler::copy_columns(Chunk &chunk, span<const int> columns)
+{
+  RC     rc = RC::SUCCESS;
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  for (int i = 0; i < chunk.column_num(); i++) {
+    const int col_id = columns[i];
+    Column   &column = chunk.column(i);
+
+    // 同一列的数据在页面中是连续存放的，连续的有效记录一次复制
+    for (int start = bitmap.next_setted_bit(0); start >= 0;) {
+      int end = bitmap.next_unsetted_bit(start);
+      if (end < 0) {
+        end = page_header_->record_capacity;
+      }
+
+      rc = column.append(get_field_data(start, col_id), end - start);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to append column data. col_id=%d, rc=%s", col_id, strrc(rc));
+        return rc;
+      }
+
+      start = end < page_header_->record_capacity ? bitmap.next_setted_bit(end) : -1;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+void PaxRecordPageHandler::valid_slots(vector<int> &slots) const
+{
+  slots.clear();
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  for (int slot = bitmap.next_setted_bit(0); slot >= 0; slot = bitmap.next_setted_bit(slot + 1)) {
+    slots.push_back(slot);
+    if (slot + 1 >= page_header_->record_capacity) {
+      break;
+    }
+  }
+}
+
+void PaxRecordPageHandler::build_zone(const ZoneMap &zone_map, PageZone &zone)
+{
+  Bitmap bitmap(bitmap_, page_header_->record_capacity);
+  if (page_header_->record_num > 0) {
+    zone.set_not_empty();
+  }
+
+  const int column_num = std::min(page_header_->column_num, zone_map.column_num());
+  for (int col_id = 0; col_id < column_num; col_id++) {
+    if (!zone_map.support_column(col_id)) {
+      continue;
+    }
+    for (int slot = bitmap.next_setted_bit(0); slot >= 0; slot = bitmap.next_setted_bit(slot + 1)) {
+      zone_map.update_zone(zone, col_id, get_field_data(slot, col_id));
+      if (slot + 1 >= page_header_->record_capacity) {
+        break;
+      }
+    }
+  }
+}
+
+void PaxRecordPageHandler::write_record(SlotNum slot_num, const char *data)
+{
+  for (int col_id = 0, offset = 0; col_id < page_header_->column_num; col_id++) {
+    const int field_len = get_field_len(col_id);
+    memcpy(get_field_data(slot_num, col_id), data + offset, field_len);
+    offset += field_len;
+  }
+}
+
+char *PaxRecordPageHandler::get_field_data(SlotNum slot_num, int col_id)
+{
+  int *col_idx = reinterpret_cast<int *>(frame_->data() + page_header_->col_idx_offset);
+  if (col_id == 0) {
+    return frame_->data() + page_header_->data_offset + (get_field_len(col_id) * slot_num);
+  } else {
+    return frame_->data() + page_header_->data_offset + col_idx[col_id - 1] + (get_field_len(col_id) * slot_num);
+  }
+}
+
+int PaxRecordPageHandler::get_field_len(int col_id)
+{
+  int *col_idx = reinterpret_cast<int *>(frame_->data() + page_header_->col_idx_offset);
+  if (col_id == 0) {
+    return col_idx[col_id] / page_header_->record_capacity;
+  } else {
+    return (col_idx[col_id] - col_idx[col_id - 1]) / page_header_->record_capacity;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+RecordFileHandler::~RecordFileHandler() { this->close(); }
+
+RC RecordFileHandler::init(DiskBufferPool &buffer_pool, LogHandler &log_handler, TableMeta *table_meta,
+    LobFileHandler *lob_handler, DiskBufferPool *fsm_buffer_pool)
+{
+  if (disk_buffer_pool_ != nullptr) {
+    LOG_ERROR("record file handler has been openned.");
+    return RC::RECORD_OPENNED;
+  }
+
+  disk_buffer_pool_ = &buffer_pool;
+  log_handler_      = &log_handler;
+  table_meta_       = table_meta;
+  lob_handler_      = lob_handler;
+
+  if (storage_format_ == StorageFormat::PAX_FORMAT && table_meta != nullptr) {
+    zone_map_.init(*table_meta);
+  }
+
+  // 空闲空间映射中没有记录的页面在插入时再检查，不需要在这里遍历所有页面
+  RC rc = free_space_map_.init(fsm_buffer_pool);
+  if (OB_SUCC(rc)) {
+    rc = overflow_space_map_.init(fsm_buffer_pool, FreeSpaceMap::Fork::OVERFLOW_PAGES);
+  }
+
+  LOG_INFO("open record file handle done. rc=%s", strrc(rc));
+  return rc;
+}
+
+void RecordFileHandler::close()
+{
+  if (disk_buffer_pool_ != nullptr) {
+    free_space_map_.close();
+    overflow_space_map_.close();
+    disk_buffer_pool_ = nullptr;
+    log_handler_      = nullptr;
+    table_meta_       = nullptr;
   }
-  return rc;
+}
+
+RC RecordFileHandler::insert_record(const char *data, int record_size, RID *rid)
+{
+  RC ret = RC::SUCCESS;
+
+  unique_ptr<RecordPageHandler> record_page_handler(RecordPageHandler::create(storage_format_));
+  bool                          page_found       = false;
+  PageNum                       current_page_num = 0;
+
+  // 当前要访问free_space_map_对象，所以需要加锁。在非并发编译模式下，不需要考虑这个锁
+  lock_.lock();
+
+  // 找到没有填满的页面。空闲空间映射可能不准确，需要读取页面确认
+  while (OB_SUCC(ret = free_space_map_.find(
+                     disk_buffer_pool_->page_count(), FreeSpaceMap::MIN_FREE_LEVEL, current_page_num))) {
+    ret = record_page_handler->init(*disk_buffer_pool_, *log_handler_, current_page_num, ReadWriteMode::READ_WRITE);
+    if (OB_FAIL(ret)) {
+      lock_.unlock();
+      LOG_WARN("failed to init record page handler. page num=%d, rc=%d:%s", current_page_num, ret, strrc(ret));
+      return ret;
+    }
+
+    if (!record_page_handler->is_full()) {
+      page_found = true;
+      break;
+    }
+    record_page_handler->cleanup();
+    free_space_map_.update(current_page_num, FreeSpaceMap::FULL);
+  }
+  lock_.unlock();  // 如果找到了一个有效的页面，那么此时已经拿到了页面的写锁
+
+  if (ret != RC::SUCCESS && ret != RC::RECORD_EOF) {
+    LOG_WARN("failed to find free page from free space map. rc=%s", strrc(ret));
+    return ret;
+  }
+
+  // 找不到就分配一个新的页面
+  if (!page_found) {
+    Frame *frame = nullptr;
+    if ((ret = disk_buffer_pool_->allocate_page(&frame)) != RC::SUCCESS) {
+      LOG_ERROR("Failed to allocate page while inserting record. ret:%d", ret);
+      return ret;
+    }
+
+    current_page_num = frame->page_num();
+
+    ret = record_page_handler->init_empty_page(
+        *disk_buffer_pool_, *log_handler_, current_page_num, record_size, table_meta_, lob_handler_);
+    if (OB_FAIL(ret)) {
+      frame->unpin();
+      LOG_ERROR("Failed to init empty page. ret:%d", ret);
+      // this is for allocate_page
+      return ret;
+    }
+
+    // frame 在allocate_page的时候，是有一个pin的，在init_empty_page时又会增加一个，所以这里手动释放一个
+    frame->unpin();
+  }
+
+  // 找到空闲位置
+  ret = record_page_handler->insert_record(data, rid);
+  if (OB_SUCC(ret) && storage_format_ == StorageFormat::PAX_FORMAT) {
+    // 仍然持有页面的写锁，与扫描时计算 zone 是互斥的
+    zone_map_.update(current_page_num, data, !page_found /*new_page*/);
+  }
+
+  const int free_space  = record_page_handler->free_space();
+  const int total_space = record_page_handler->total_space();
+  // 📢 与 delete_record 相同，必须先释放页面锁再加lock锁。
+  // 其它线程可能持有lock锁并在空闲空间映射中找到了当前页面，正在等待这个页面的写锁
+  record_page_handler->cleanup();
+
+  lock_.lock();
+  free_space_map_.update(current_page_num, free_space, total_space);
+  lock_.unlock();
+  return ret;
+}
+
+RC RecordFileHandler::insert_chunk(const Chunk &chunk, int record_size)
+{
+  // your code here
+  return RC::UNIMPLEMENTED;
+}
+
+RC RecordFileHandler::recover_insert_record(const char *data, int record_size, const RID &rid)
+{
+  RC ret = RC::SUCCESS;
+
+  unique_ptr<RecordPageHandler> record_page_handler(RecordPageHandler::create(storage_format_));
+
+  ret = record_page_handler->recover_init(*disk_buffer_pool_, rid.page_num);
+  if (OB_FAIL(ret)) {
+    LOG_WARN("failed to init record page handler. page num=%d, rc=%s", rid.page_num, strrc(ret));
+    return ret;
+  }
+
+  if (storage_format_ == StorageFormat::PAX_FORMAT) {
+    zone_map_.invalidate(rid.page_num);
+  }
+  return record_page_handler->recover_insert_record(data, rid);
+}
+
+RC RecordFileHandler::delete_record(const RID *rid)
+{
+  RC rc = RC::SUCCESS;
+
+  unique_ptr<RecordPageHandler> record_page_handler(RecordPageHandler::create(storage_format_));
+
+  rc = record_page_handler->init(*disk_buffer_pool_, *log_handler_, rid->page_num, ReadWriteMode::READ_WRITE);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to init record page handler.page number=%d. rc=%s", rid->page_num, strrc(rc));
+    return rc;
+  }
+
+  RID target;
+  if (storage_format_ == StorageFormat::SLOTTED_FORMAT &&
+      static_cast<SlottedRecordPageHandler *>(record_page_handler.get())->forwarded(rid->slot_num, target)) {
+    rc = delete_moved_record(target);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+
+  rc = record_page_handler->delete_record(rid);
+  if (OB_SUCC(rc) && storage_format_ == StorageFormat::PAX_FORMAT) {
+    // 删除以后最小值和最大值可能会变化，下次扫描时重新计算
+    zone_map_.invalidate(rid->page_num);
+  }
+  const int free_space  = record_page_handler->free_space();
+  const int total_space = record_page_handler->total_space();
+  // 📢 这里注意要清理掉资源，否则会与insert_record中的加锁顺序冲突而可能出现死锁
+  // delete record的加锁逻辑是拿到页面锁，删除指定记录，然后加上和释放record manager锁
+  // insert record是加上 record manager锁，然后拿到指定页面锁再释放record manager锁
+  record_page_handler->cleanup();
+  if (OB_SUCC(rc)) {
+    // 因为这里已经释放了页面锁，并发时，其它线程可能又把该页面填满了，那就不应该再标记为有空闲空间。
+    // 但是这里可以不关心，因为在查找空闲页面时，会自动过滤掉已经满的页面
+    lock_.lock();
+    free_space_map_.update(rid->page_num, free_space, total_space);
+    LOG_TRACE("update free space of page %d. free space=%d", rid->page_num, free_space);
+    lock_.unlock();
+  }
+  return rc;
 }
 
 RC RecordFileHandler::get_record(const RID &rid, Record &record)
@@ -727,8 +1671,211 @@ RC RecordFileHandler::visit_record(const RID &rid, function<bool(Record &)> upda
 
   bool updated = updater(record);
   if (updated) {
-    rc = page_handler->update_record(rid, record.data());
+    if (storage_format_ == StorageFormat::SLOTTED_FORMAT) {
+      rc = update_slotted_record(
+          *static_cast<SlottedRecordPageHandler *>(page_handler.get()), rid, record.data(), record.len());
+    } else {
+      rc = page_handler->update_record(rid, record.data());
+    }
+    if (OB_SUCC(rc) && storage_format_ == StorageFormat::PAX_FORMAT) {
+      zone_map_.update(rid.page_num, record.data(), false /*new_page*/);
+    }
+  }
+  return rc;
+}
+
+RC RecordFileHandler::visit_records(span<const RID> rids, function<bool(Record &)> updater)
+{
+  RC              rc = RC::SUCCESS;
+  vector<char>    updated_data;
+  vector<SlotNum> updated_slots;
+  for (size_t begin = 0, end = 0; begin < rids.size(); begin = end) {
+    const PageNum page_num = rids[begin].page_num;
+    for (end = begin + 1; end < rids.size() && rids[end].page_num == page_num; end++) {
+    }
+
+    unique_ptr<RecordPageHandler> page_handler(RecordPageHandler::create(storage_format_));
+    rc = page_handler->init(*disk_buffer_pool_, *log_handler_, page_num, ReadWriteMode::READ_WRITE);
+    if (OB_FAIL(rc)) {
+      LOG_ERROR("Failed to init record page handler.page number=%d", page_num);
+      return rc;
+    }
+
+    // 与 visit_record 相同，先在复制出来的数据上修改，最后一起写回页面
+    updated_data.clear();
+    updated_slots.clear();
+    for (size_t i = begin; i < end; i++) {
+      Record inplace_record;
+      rc = page_handler->get_record(rids[i], inplace_record);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to get record from record page handle. rid=%s, rc=%s", rids[i].to_string().c_str(), strrc(rc));
+        return rc;
+      }
+
+      Record record;
+      record.copy_data(inplace_record.data(), inplace_record.len());
+      record.set_rid(rids[i]);
+      if (updater(record)) {
+        updated_slots.push_back(rids[i].slot_num);
+        updated_data.insert(updated_data.end(), record.data(), record.data() + record.len());
+      }
+    }
+
+    if (updated_slots.empty()) {
+      continue;
+    }
+
+    const int record_size = static_cast<int>(updated_data.size() / updated_slots.size());
+    if (storage_format_ == StorageFormat::SLOTTED_FORMAT) {
+      // 已经迁移的记录和当前页面上放不下的记录逐条更新
+      auto          *slotted_page = static_cast<SlottedRecordPageHandler *>(page_handler.get());
+      vector<size_t> deferred;
+      rc = slotted_page->update_records(updated_slots, updated_data.data(), deferred);
+      for (size_t i = 0; OB_SUCC(rc) && i < deferred.size(); i++) {
+        const size_t index = deferred[i];
+        rc                 = update_slotted_record(*slotted_page,
+            RID(page_num, updated_slots[index]),
+            updated_data.data() + index * record_size,
+            record_size);
+      }
+    } else {
+      rc = page_handler->update_records(updated_slots, updated_data.data());
+    }
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to update records. page_num=%d, rc=%s", page_num, strrc(rc));
+      return rc;
+    }
+    if (storage_format_ == StorageFormat::PAX_FORMAT) {
+      for (size_t i = 0; i < updated_slots.size(); i++) {
+        zone_map_.update(page_num, updated_data.data() + i * record_size, false /*new_page*/);
+      }
+    }
+  }
+  return rc;
+}
+
+RC RecordFileHandler::update_slotted_record(
+    SlottedRecordPageHandler &home_page, const RID &rid, const char *data, int record_size)
+{
+  RID        old_target;
+  const bool moved = home_page.forwarded(rid.slot_num, old_target);
+  RC         rc    = RC::SUCCESS;
+  if (!moved) {
+    rc = home_page.update_record(rid, data);
+  } else {
+    SlottedRecordPageHandler target_page;
+    rc = target_page.init(*disk_buffer_pool_, *log_handler_, old_target.page_num, ReadWriteMode::READ_WRITE, lob_handler_);
+    if (OB_SUCC(rc)) {
+      rc = target_page.update_record(old_target, data);
+    }
+  }
+  if (rc != RC::RECORD_NOMEM) {
+    return rc;
+  }
+
+  // 页面上放不下更新以后的记录，迁移到溢出页面，原来的槽位指向新的位置
+  RID new_target;
+  rc = insert_moved_record(data, record_size, new_target);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to move record to overflow page. rid=%s, rc=%s", rid.to_string().c_str(), strrc(rc));
+    return rc;
+  }
+
+  rc = home_page.forward_record(rid.slot_num, new_target);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to forward record. rid=%s, target=%s, rc=%s",
+             rid.to_string().c_str(), new_target.to_string().c_str(), strrc(rc));
+    (void)delete_moved_record(new_target);
+    return rc;
+  }
+
+  LOG_TRACE("record moved. rid=%s, target=%s", rid.to_string().c_str(), new_target.to_string().c_str());
+  if (moved) {
+    rc = delete_moved_record(old_target);
+  }
+  return rc;
+}
+
+RC RecordFileHandler::insert_moved_record(const char *data, int record_size, RID &target)
+{
+  SlottedRecordPageHandler page_handler;
+
+  lock_guard<common::Mutex> guard(overflow_lock_);
+
+  // 映射只是提示，页面上实际放不下时标记为满的再继续查找
+  PageNum page_num = BP_INVALID_PAGE_NUM;
+  RC      rc       = RC::SUCCESS;
+  while (OB_SUCC(rc = overflow_space_map_.find(
+                     disk_buffer_pool_->page_count(), FreeSpaceMap::MIN_FREE_LEVEL, page_num))) {
+    rc = page_handler.init(*disk_buffer_pool_, *log_handler_, page_num, ReadWriteMode::READ_WRITE, lob_handler_);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to init overflow page. page num=%d, rc=%s", page_num, strrc(rc));
+      return rc;
+    }
+
+    if (page_handler.is_overflow()) {
+      rc = page_handler.insert_moved_record(data, &target);
+      if (rc != RC::RECORD_NOMEM) {
+        overflow_space_map_.update(page_num, page_handler.moved_free_space(), page_handler.total_space());
+        return rc;
+      }
+    }
+    page_handler.cleanup();
+    overflow_space_map_.update(page_num, FreeSpaceMap::FULL);
+  }
+
+  if (rc != RC::RECORD_EOF) {
+    LOG_WARN("failed to find overflow page. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  // 没有可以使用的溢出页面，分配一个新的。溢出页面总是满的，插入新记录时不会使用
+  Frame *frame = nullptr;
+  rc           = disk_buffer_pool_->allocate_page(&frame);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to allocate overflow page. rc=%s", strrc(rc));
+    return rc;
+  }
+
+  page_num = frame->page_num();
+  rc = page_handler.init_empty_page(*disk_buffer_pool_, *log_handler_, page_num, record_size, table_meta_, lob_handler_);
+  // frame 在allocate_page的时候，是有一个pin的，在init_empty_page时又会增加一个，所以这里手动释放一个
+  frame->unpin();
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to init overflow page. page num=%d, rc=%s", page_num, strrc(rc));
+    return rc;
+  }
+
+  rc = page_handler.insert_moved_record(data, &target);
+  if (OB_SUCC(rc)) {
+    overflow_space_map_.update(page_num, page_handler.moved_free_space(), page_handler.total_space());
+  }
+  return rc;
+}
+
+RC RecordFileHandler::delete_moved_record(const RID &target)
+{
+  SlottedRecordPageHandler page_handler;
+
+  RC rc = page_handler.init(*disk_buffer_pool_, *log_handler_, target.page_num, ReadWriteMode::READ_WRITE, lob_handler_);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to init overflow page. page num=%d, rc=%s", target.page_num, strrc(rc));
+    return rc;
+  }
+
+  rc = page_handler.delete_record(&target);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to delete moved record. target=%s, rc=%s", target.to_string().c_str(), strrc(rc));
+    return rc;
   }
+
+  // 先释放页面锁再访问 overflow_space_map_，insert_moved_record 是先加 overflow_lock_ 再加页面锁的
+  const int free_space  = page_handler.moved_free_space();
+  const int total_space = page_handler.total_space();
+  page_handler.cleanup();
+
+  lock_guard<common::Mutex> guard(overflow_lock_);
+  overflow_space_map_.update(target.page_num, free_space, total_space);
   return rc;
 }
 
@@ -740,6 +1887,9 @@ RC ChunkFileScanner::close_scan()
     disk_buffer_pool_ = nullptr;
   }
 
+  zone_map_ = nullptr;
+  zone_predicates_.clear();
+
   if (record_page_handler_ != nullptr) {
     record_page_handler_->cleanup();
     delete record_page_handler_;
@@ -759,17 +1909,30 @@ RC ChunkFileScanner::open_scan_chunk(
   log_handler_      = &log_handler;
   rw_mode_          = mode;
 
-  RC rc = bp_iterator_.init(buffer_pool, 1);
+  RC rc = RC::SUCCESS;
+  if (morsels_ != nullptr) {
+    if (!fetch_next_morsel()) {
+      rc = bp_iterator_.init(buffer_pool, 1, 1);
+    }
+  } else {
+    rc = bp_iterator_.init(buffer_pool, 1);
+  }
   if (rc != RC::SUCCESS) {
     LOG_WARN("failed to init bp iterator. rc=%d:%s", rc, strrc(rc));
     return rc;
   }
-  if (table == nullptr || table->table_meta().storage_format() == StorageFormat::ROW_FORMAT) {
+  if (table == nullptr) {
     record_page_handler_ = new RowRecordPageHandler();
   } else {
-    record_page_handler_ = new PaxRecordPageHandler();
+    record_page_handler_ = RecordPageHandler::create(table->table_meta().storage_format());
   }
 
+  trx_columns_.reset();
+  if (trx_ != nullptr && table != nullptr && table->table_meta().storage_format() == StorageFormat::PAX_FORMAT) {
+    for (const FieldMeta &field_meta : table->table_meta().trx_fields()) {
+      trx_columns_.add_column(make_unique<Column>(field_meta), field_meta.field_id());
+    }
+  }
   return rc;
 }
 
@@ -777,25 +1940,194 @@ RC ChunkFileScanner::next_chunk(Chunk &chunk)
 {
   RC rc = RC::SUCCESS;
 
-  while (bp_iterator_.has_next()) {
-    PageNum page_num = bp_iterator_.next();
-    record_page_handler_->cleanup();
-    rc = record_page_handler_->init(*disk_buffer_pool_, *log_handler_, page_num, rw_mode_, table_->lob_handler());
+  do {
+    while (bp_iterator_.has_next()) {
+      PageNum page_num = bp_iterator_.next();
+      record_page_handler_->cleanup();
+      if (!page_may_match(page_num, false /*page_fetched*/)) {
+        continue;
+      }
+
+      rc = record_page_handler_->init(*disk_buffer_pool_, *log_handler_, page_num, rw_mode_, table_->lob_handler());
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to init record page handler. page_num=%d, rc=%s", page_num, strrc(rc));
+        return rc;
+      }
+      if (!page_may_match(page_num, true /*page_fetched*/)) {
+        continue;
+      }
+
+      const int           rows           = chunk.rows();
+      const StorageFormat storage_format = table_->table_meta().storage_format();
+      if (storage_format == StorageFormat::PAX_FORMAT && trx_ != nullptr) {
+        rc = get_visible_pax_chunk(chunk);
+      } else if (storage_format == StorageFormat::PAX_FORMAT && table_->table_meta().sys_field_num() == 0) {
+        // 没有事务字段时 field_id 就是页面上列的下标
+        rc = record_page_handler_->get_chunk(chunk);
+      } else if (storage_format == StorageFormat::PAX_FORMAT) {
+        rc = static_cast<PaxRecordPageHandler *>(record_page_handler_)->get_chunk(chunk, table_->table_meta());
+      } else if (trx_ != nullptr) {
+        rc = get_visible_chunk(chunk);
+      } else if (storage_format == StorageFormat::ROW_FORMAT) {
+        rc = static_cast<RowRecordPageHandler *>(record_page_handler_)->get_chunk(chunk, table_->table_meta());
+      } else {
+        rc = get_visible_chunk(chunk);
+      }
+      if (rc == RC::SUCCESS) {
+        if (trx_ != nullptr && chunk.column_num() > 0 && chunk.rows() == rows) {
+          // 页面上的记录都不可见
+          continue;
+        }
+        return rc;
+      } else if (rc == RC::RECORD_EOF) {
+        break;
+      } else {
+        LOG_WARN("failed to get chunk from page. page_num=%d, rc=%s", page_num, strrc(rc));
+        return rc;
+      }
+    }
+    // 并行扫描时当前片段遍历完了再领取下一个片段
+  } while (rc != RC::RECORD_EOF && fetch_next_morsel());
+
+  record_page_handler_->cleanup();
+  return RC::RECORD_EOF;
+}
+
+bool ChunkFileScanner::fetch_next_morsel()
+{
+  PageNum start_page = 0;
+  PageNum end_page   = 0;
+  if (morsels_ == nullptr || !morsels_->next(start_page, end_page)) {
+    return false;
+  }
+
+  bp_iterator_.init(*disk_buffer_pool_, start_page, end_page);
+  return true;
+}
+
+RC ChunkFileScanner::get_visible_chunk(Chunk &chunk)
+{
+  const TableMeta   &table_meta = table_->table_meta();
+  RecordPageIterator iterator;
+  iterator.init(record_page_handler_);
+
+  RC     rc = RC::SUCCESS;
+  Record record;
+  while (iterator.has_next()) {
+    rc = iterator.next(record);
     if (OB_FAIL(rc)) {
-      LOG_WARN("failed to init record page handler. page_num=%d, rc=%s", page_num, strrc(rc));
+      LOG_WARN("failed to get next record from page. page_num=%d, rc=%s", record_page_handler_->get_page_num(), strrc(rc));
       return rc;
     }
-    rc = record_page_handler_->get_chunk(chunk);
-    if (rc == RC::SUCCESS) {
+
+    if (trx_ != nullptr) {
+      rc = trx_->visit_record(table_, record, rw_mode_);
+      if (rc == RC::RECORD_INVISIBLE) {
+        continue;
+      }
+      if (OB_FAIL(rc)) {
+        return rc;
+      }
+    }
+
+    for (int i = 0; i < chunk.column_num(); i++) {
+      const FieldMeta *field_meta = table_meta.field(table_meta.field_index(chunk.column_ids(i)));
+      rc                          = chunk.column(i).append_one(record.data() + field_meta->offset());
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to append field to column. col_id=%d, rc=%s", chunk.column_ids(i), strrc(rc));
+        return rc;
+      }
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC ChunkFileScanner::get_visible_pax_chunk(Chunk &chunk)
+{
+  auto            *page_handler = static_cast<PaxRecordPageHandler *>(record_page_handler_);
+  const TableMeta &table_meta   = table_->table_meta();
+  const PageNum    page_num     = page_handler->get_page_num();
+
+  // 按列读取所有有效记录的事务字段
+  vector<int> valid_slots;
+  page_handler->valid_slots(valid_slots);
+  trx_columns_.reset_data();
+  RC rc = page_handler->get_chunk(trx_columns_, table_meta, valid_slots);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to get trx fields from page. page_num=%d, rc=%s", page_num, strrc(rc));
+    return rc;
+  }
+
+  // 事务只读取事务字段判断可见性，需要旧版本时会把整条旧版本复制到 record 中
+  span<const FieldMeta> trx_fields = table_meta.trx_fields();
+  vector<char>          buffer(table_meta.record_size(), 0);
+  vector<int>           visible_slots;
+  vector<char>          old_versions;
+  Record                record;
+  for (size_t row = 0; row < valid_slots.size(); row++) {
+    const int slot = valid_slots[row];
+    for (size_t i = 0; i < trx_fields.size(); i++) {
+      const int len = trx_fields[i].len();
+      memcpy(buffer.data() + trx_fields[i].offset(), trx_columns_.column(i).data() + row * len, len);
+    }
+    record.set_data(buffer.data(), static_cast<int>(buffer.size()));
+    record.set_rid(page_num, slot);
+
+    rc = trx_->visit_record(table_, record, rw_mode_);
+    if (rc == RC::RECORD_INVISIBLE) {
+      continue;
+    }
+    if (OB_FAIL(rc)) {
       return rc;
-    } else if (rc == RC::RECORD_EOF) {
-      break;
+    }
+
+    if (record.data() != buffer.data()) {
+      // 快照中可见的是旧版本，旧版本不在页面上
+      old_versions.insert(old_versions.end(), record.data(), record.data() + record.len());
     } else {
-      LOG_WARN("failed to get chunk from page. page_num=%d, rc=%s", page_num, strrc(rc));
-      return rc;
+      visible_slots.push_back(slot);
     }
   }
 
-  record_page_handler_->cleanup();
-  return RC::RECORD_EOF;
+  rc = page_handler->get_chunk(chunk, table_meta, visible_slots);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to get visible records from page. page_num=%d, rc=%s", page_num, strrc(rc));
+    return rc;
+  }
+
+  for (size_t offset = 0; offset < old_versions.size(); offset += buffer.size()) {
+    for (int i = 0; i < chunk.column_num(); i++) {
+      const FieldMeta *field_meta = table_meta.field(table_meta.field_index(chunk.column_ids(i)));
+      rc                          = chunk.column(i).append_one(old_versions.data() + offset + field_meta->offset());
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to append field to column. col_id=%d, rc=%s", chunk.column_ids(i), strrc(rc));
+        return rc;
+      }
+    }
+  }
+  return RC::SUCCESS;
+}
+
+bool ChunkFileScanner::page_may_match(PageNum page_num, bool page_fetched)
+{
+  if (zone_map_ == nullptr || zone_predicates_.empty() || table_ == nullptr ||
+      table_->table_meta().storage_format() != StorageFormat::PAX_FORMAT) {
+    return true;
+  }
+
+  PageZone zone;
+  if (zone_map_->get(page_num, zone)) {
+    return zone.may_match(zone_predicates_);
+  }
+
+  if (!page_fetched) {
+    return true;
+  }
+
+  // 页面已经读取并加了锁，在这里重新计算 zone
+  zone = PageZone(zone_map_->column_num());
+  static_cast<PaxRecordPageHandler *>(record_page_handler_)->build_zone(*zone_map_, zone);
+  const bool match = zone.may_match(zone_predicates_);
+  zone_map_->put(page_num, std::move(zone));
+  return match;
 }
@@ -18,9 +18,12 @@ See the Mulan PSL v2 for more details. */
 #include "common/lang/sstream.h"
 #include "storage/buffer/disk_buffer_pool.h"
 #include "storage/common/chunk.h"
+#include "storage/record/free_space_map.h"
 #include "storage/record/record.h"
 #include "storage/record/record_log.h"
 #include "storage/record/lob_handler.h"
+#include "storage/record/page_morsel.h"
+#include "storage/record/zone_map.h"
 #include "common/types.h"
 
 class LogHandler;
@@ -55,6 +58,7 @@ class Table;
  * - RecordScanner：可以用来遍历整个文件上的所有记录
  * - RecordPageIterator：可以用来遍历指定页面上的所有记录
  * - PageHeader：每个页面上都会记录的页面头信息
+ * - FreeSpaceMap：记录每个页面的空闲程度，保存在单独的文件中，插入记录时用来查找有空闲空间的页面
  */
 
 /**
@@ -156,7 +160,7 @@ public:
    * @param record_size 每个记录的大小
    * @param table_meta  表的元数据
    */
-  RC init_empty_page(DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num, int record_size,
+  virtual RC init_empty_page(DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num, int record_size,
       TableMeta *table_meta, LobFileHandler *lob_handler = nullptr);
 
   /**
@@ -167,7 +171,7 @@ public:
    * @param col_num  表中包含的列数
    * @param col_idx_data 列索引数据
    */
-  RC init_empty_page(DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num, int record_size,
+  virtual RC init_empty_page(DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num, int record_size,
       int col_num, const char *col_idx_data, LobFileHandler *lob_handler = nullptr);
 
   /**
@@ -206,6 +210,14 @@ public:
    */
   virtual RC update_record(const RID &rid, const char *data) { return RC::UNIMPLEMENTED; }
 
+  /**
+   * @brief 更新当前页面上的多条记录，只记录一条日志
+   *
+   * @param slots 要更新的记录的槽位
+   * @param data  按照 slots 的顺序依次存放的记录，每条记录 record_real_size 字节
+   */
+  virtual RC update_records(span<const SlotNum> slots, const char *data) { return RC::UNIMPLEMENTED; }
+
   /**
    * @brief 获取指定位置的记录数据
    *
@@ -218,7 +230,7 @@ public:
    * @brief 获取整个页面中指定列的所有记录。
    *
    * @param chunk 由 chunk.column(i).col_id() 指定列。
-   * 只需由 PaxRecordPageHandler 实现。
+   * 由 PaxRecordPageHandler 实现。行存格式的页面中没有列的信息，需要使用 RowRecordPageHandler 中带有表元数据的版本。
    */
   virtual RC get_chunk(Chunk &chunk) { return RC::UNIMPLEMENTED; }
 
@@ -230,7 +242,20 @@ public:
   /**
    * @brief 当前页面是否已经没有空闲位置插入新的记录
    */
-  bool is_full() const;
+  virtual bool is_full() const;
+
+  /**
+   * @brief 是否是只存放从其它页面迁移过来的记录的溢出页面
+   * @details 溢出页面上的记录通过原来页面上的槽位访问，遍历页面时跳过
+   */
+  virtual bool is_overflow() const { return false; }
+
+  /**
+   * @brief 页面的空闲空间和总的空间，用来维护空闲空间映射
+   * @details 定长记录的单位是记录的个数，变长记录的单位是字节
+   */
+  virtual int free_space() const { return page_header_->record_capacity - page_header_->record_num; }
+  virtual int total_space() const { return page_header_->record_capacity; }
 
 protected:
   /**
@@ -295,6 +320,8 @@ public:
 
   virtual RC update_record(const RID &rid, const char *data) override;
 
+  virtual RC update_records(span<const SlotNum> slots, const char *data) override;
+
   /**
    * @brief 获取指定位置的记录数据
    *
@@ -302,6 +329,118 @@ public:
    * @param record 返回指定的数据。这里不会将数据复制出来，而是使用指针，所以调用者必须保证数据使用期间受到保护
    */
   virtual RC get_record(const RID &rid, Record &record) override;
+
+  /**
+   * @brief 把页面上所有的记录按列转置到 chunk 中
+   * @details 先找出页面上所有的有效记录，再逐列复制，每一列写入的内存是连续的。
+   * 行存格式的页面中没有保存列的信息，列的偏移量和长度从表元数据中获取。
+   * @param chunk 由 chunk.column_ids(i) 指定列，是字段的 field_id
+   */
+  RC get_chunk(Chunk &chunk, const TableMeta &table_meta);
+};
+
+/**
+ * @brief 负责处理变长行存格式的页面(slotted page)中各种操作
+ * @ingroup RecordManager
+ * @details 定长的行存格式按照声明的最大长度存放 CHARS 字段，字段值比较短时浪费大量空间，扫描时也要读取更多数据。
+ * 这里把记录编码成变长格式：CHARS 字段去掉末尾的0以后，以2字节长度加数据的方式保存，其它字段原样保存，
+ * 读取时再还原成定长的记录，上层看到的记录格式与 ROW_FORMAT 相同。页面的组织方式：
+ * @code
+ * | PageHeader | record allocate bitmap | column descriptors | slot directory header |
+ * |------------------------------------------------------------------------------------|
+ * | slot0 | slot1 | ... | slotN | --> free space <-- | recordN | ... | record1 | record0 |
+ * @endcode
+ * 槽位目录从前向后增长，记录从页面末尾向前存放。RID 中的 slot num 就是槽位的编号，记录在页面内移动时不变。
+ * column descriptors 是每一列的长度，变长的列使用负数表示。它也记录在初始化页面的日志中，回放时不依赖表的元数据。
+ * 删除和更新留下的空洞在连续的空闲空间不够时，通过页内整理(compact)回收。
+ * 插入时为页面上已有记录变长预留 1/16 的空间。更新以后的记录仍然放不下时，由 RecordFileHandler 把记录迁移到溢出页面，
+ * 原来的槽位改为转发槽位(forwarding slot)，只保存记录新的位置，这样 RID 保持不变，索引、MVCC 版本链和行锁都不受影响。
+ * 溢出页面只存放迁移过来的记录，不会再插入新记录，也不会作为记录原来的页面，所以页面加锁的顺序总是原页面在前、溢出页面在后。
+ * PageHeader 中 record_capacity 是最多可以有多少个槽位，record_size 是编码以后记录的最大长度。
+ * 日志中记录的是没有编码的记录，所有操作都按照槽位重做，与记录在页面内的位置无关，所以页内整理不需要记录日志。
+ */
+class SlottedRecordPageHandler : public RecordPageHandler
+{
+public:
+  SlottedRecordPageHandler() : RecordPageHandler(StorageFormat::SLOTTED_FORMAT) {}
+
+  RC init_empty_page(DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num, int record_size,
+      TableMeta *table_meta, LobFileHandler *lob_handler = nullptr) override;
+
+  /**
+   * @param col_idx_data 每一列的长度，变长的列使用负数表示
+   */
+  RC init_empty_page(DiskBufferPool &buffer_pool, LogHandler &log_handler, PageNum page_num, int record_size,
+      int col_num, const char *col_idx_data, LobFileHandler *lob_handler = nullptr) override;
+
+  virtual RC insert_record(const char *data, RID *rid) override;
+
+  virtual RC recover_insert_record(const char *data, const RID &rid) override;
+
+  virtual RC delete_record(const RID *rid) override;
+
+  virtual RC update_record(const RID &rid, const char *data) override;
+
+  virtual RC update_records(span<const SlotNum> slots, const char *data) override;
+
+  /**
+   * @brief 更新同一个页面上的多条记录，页面上放不下的记录和已经迁移的记录不更新
+   * @param deferred 没有更新的记录在 slots 中的下标，由调用者处理
+   */
+  RC update_records(span<const SlotNum> slots, const char *data, vector<size_t> &deferred);
+
+  /**
+   * @brief 获取指定位置的记录数据
+   * @details 记录是编码以后存放的，这里会解码复制到 record 自己的内存中。记录已经迁移时从溢出页面读取
+   */
+  virtual RC get_record(const RID &rid, Record &record) override;
+
+  /**
+   * @brief 指定槽位上的记录是否已经迁移到了其它页面
+   * @param target 记录迁移后的位置
+   */
+  bool forwarded(SlotNum slot_num, RID &target) const;
+
+  /**
+   * @brief 把迁移过来的记录插入到溢出页面
+   * @details 第一次插入时把页面标记为溢出页面
+   */
+  RC insert_moved_record(const char *data, RID *rid);
+  RC recover_insert_moved_record(const char *data, const RID &rid);
+
+  /**
+   * @brief 把槽位改为指向 target 的转发槽位，槽位上原来的记录数据被释放
+   */
+  RC forward_record(SlotNum slot_num, const RID &target);
+  RC recover_forward_record(SlotNum slot_num, const RID &target);
+
+  bool is_full() const override;
+  bool is_overflow() const override;
+  int  free_space() const override;
+  int  total_space() const override;
+
+  /**
+   * @brief 溢出页面上还可以存放迁移记录的空间
+   * @details 溢出页面在 is_full 中总是满的，free_space 返回0，迁移记录时使用这里的值
+   */
+  int moved_free_space() const;
+
+  /**
+   * @brief 页内整理，把所有记录移动到页面末尾连续存放
+   */
+  void compact();
+
+private:
+  // 把记录编码以后放到指定的槽位，槽位上已经有记录时替换。不记录日志
+  RC put_record(SlotNum slot_num, const char *data);
+  // 把槽位改为转发槽位，保存记录迁移后的位置。不记录日志
+  RC put_forward(SlotNum slot_num, const RID &target);
+  // 在槽位上分配 size 字节的空间，返回写入数据的位置
+  RC allocate_slot(SlotNum slot_num, int size, char *&dest);
+
+  int  encoded_size(const char *data) const;
+  void encode(const char *data, char *encoded) const;
+  void decode(const char *encoded, char *data) const;
 };
 
 /**
@@ -332,8 +471,14 @@ public:
   // TODO: insert chunk only used in load_data
   virtual RC insert_chunk(const Chunk &chunk, int start_row, int &insert_rows) override;
 
+  virtual RC recover_insert_record(const char *data, const RID &rid) override;
+
   virtual RC delete_record(const RID *rid) override;
 
+  virtual RC update_record(const RID &rid, const char *data) override;
+
+  virtual RC update_records(span<const SlotNum> slots, const char *data) override;
+
   /**
    * @brief 获取指定位置的记录数据
    *
@@ -346,11 +491,44 @@ public:
   /**
    * @brief 以 Chunk 格式获取整个页面中指定列的所有记录。
    *
-   * @param chunk 由 chunk.column(i).col_id() 指定列。
+   * @param chunk 由 chunk.column_ids(i) 指定列，是页面上列的下标，只会复制这些列的数据。
+   * 一列的数据在页面中是连续存放的，连续的有效记录会一次复制。
    */
   virtual RC get_chunk(Chunk &chunk) override;
 
+  /**
+   * @brief 与 get_chunk(Chunk &) 相同，但 chunk.column_ids(i) 是字段的 field_id
+   * @details 表中有事务字段时，field_id 与页面上列的下标不同，需要通过 table_meta 转换
+   */
+  RC get_chunk(Chunk &chunk, const TableMeta &table_meta);
+
+  /**
+   * @brief 获取页面中指定槽位上的记录的列，按照 slots 的顺序追加到 chunk 中
+   * @param chunk 由 chunk.column_ids(i) 指定列，是字段的 field_id
+   */
+  RC get_chunk(Chunk &chunk, const TableMeta &table_meta, span<const int> slots);
+
+  /**
+   * @brief 页面上所有有效记录的槽位，按照槽位排序
+   */
+  void valid_slots(vector<int> &slots) const;
+
+  /**
+   * @brief 计算页面上各列的最小值和最大值
+   */
+  void build_zone(const ZoneMap &zone_map, PageZone &zone);
+
 private:
+  // map the columns of chunk to the column index on the page and check them.
+  // the column ids of chunk are field ids if `table_meta` is not null
+  RC chunk_columns(Chunk &chunk, const TableMeta *table_meta, vector<int> &columns);
+
+  // copy `columns` of all valid records to chunk
+  RC copy_columns(Chunk &chunk, span<const int> columns);
+
+  // split the row `data` into columns and write them to `slot_num`
+  void write_record(SlotNum slot_num, const char *data);
+
   // get the field data by `slot_num` and `column id`
   char *get_field_data(SlotNum slot_num, int col_id);
 
@@ -372,8 +550,10 @@ public:
    * @brief 初始化
    *
    * @param buffer_pool 当前操作的是哪个文件
+   * @param fsm_buffer_pool 保存空闲空间映射的文件，为空时只在内存中维护
    */
-  RC init(DiskBufferPool &buffer_pool, LogHandler &log_handler, TableMeta *table_meta, LobFileHandler *lob_handler);
+  RC init(DiskBufferPool &buffer_pool, LogHandler &log_handler, TableMeta *table_meta, LobFileHandler *lob_handler,
+      DiskBufferPool *fsm_buffer_pool = nullptr);
 
   /**
    * @brief 关闭，做一些资源清理的工作
@@ -411,20 +591,54 @@ public:
 
   RC visit_record(const RID &rid, function<bool(Record &)> updater);
 
+  /**
+   * @brief 按照顺序访问多条记录，同一个页面上的记录只加一次锁，所有的修改记录一条日志
+   * @details rids 需要按照页面排列，同一个页面的记录放在一起，否则同一个页面会访问多次
+   */
+  RC visit_records(span<const RID> rids, function<bool(Record &)> updater);
+
+  /**
+   * @brief PAX 格式的表维护了每个页面的最小值和最大值，其它格式返回空
+   */
+  ZoneMap *zone_map() { return storage_format_ == StorageFormat::PAX_FORMAT ? &zone_map_ : nullptr; }
+
+  /**
+   * @brief 页面的空闲空间映射
+   */
+  FreeSpaceMap &free_space_map() { return free_space_map_; }
+
 private:
   /**
-   * @brief 初始化当前没有填满记录的页面，初始化free_pages_成员
+   * @brief 更新变长行存页面上的记录，页面上放不下时把记录迁移到溢出页面，RID 不变
+   * @param home_page 记录所在的页面，调用者持有页面的写锁
    */
-  RC init_free_pages();
+  RC update_slotted_record(SlottedRecordPageHandler &home_page, const RID &rid, const char *data, int record_size);
+
+  /**
+   * @brief 把记录插入到有空闲空间的溢出页面，没有找到时分配一个新的溢出页面
+   * @details 调用者持有记录所在页面的写锁，所以这里只使用 overflow_lock_，不能使用 lock_，
+   * 否则与 insert_record 先加 lock_ 再加页面锁的顺序相反
+   */
+  RC insert_moved_record(const char *data, int record_size, RID &target);
+
+  /**
+   * @brief 删除迁移到溢出页面上的记录，释放的空间记录到 overflow_space_map_ 中，后面迁移记录时重新使用
+   */
+  RC delete_moved_record(const RID &target);
 
 private:
-  DiskBufferPool        *disk_buffer_pool_ = nullptr;
-  LogHandler            *log_handler_      = nullptr;  ///< 记录日志的处理器
-  unordered_set<PageNum> free_pages_;                  ///< 没有填充满的页面集合
-  common::Mutex          lock_;  ///< 当编译时增加-DCONCURRENCY=ON 选项时，才会真正的支持并发
-  StorageFormat          storage_format_;
-  TableMeta             *table_meta_;
-  LobFileHandler        *lob_handler_ = nullptr;
+  DiskBufferPool *disk_buffer_pool_ = nullptr;
+  LogHandler     *log_handler_      = nullptr;  ///< 记录日志的处理器
+  FreeSpaceMap    free_space_map_;              ///< 记录每个页面的空闲程度，访问时需要加锁
+  common::Mutex   lock_;  ///< 当编译时增加-DCONCURRENCY=ON 选项时，才会真正的支持并发
+  StorageFormat   storage_format_;
+  TableMeta      *table_meta_;
+  LobFileHandler *lob_handler_ = nullptr;
+  ZoneMap         zone_map_;  ///< 只有 PAX 格式使用
+
+  /// 溢出页面的空闲程度，与 free_space_map_ 保存在同一个文件中，只有 SLOTTED 格式使用
+  FreeSpaceMap  overflow_space_map_;
+  common::Mutex overflow_lock_;  ///< 保护 overflow_space_map_
 };
 
 /**
@@ -438,7 +652,7 @@ public:
   ChunkFileScanner() = default;
   ~ChunkFileScanner();
 
-  // TODO: not support filter and transaction
+  // TODO: not support filter
   RC open_scan_chunk(Table *table, DiskBufferPool &buffer_pool, LogHandler &log_handler, ReadWriteMode mode);
 
   /**
@@ -451,6 +665,51 @@ public:
    */
   RC next_chunk(Chunk &chunk);
 
+  /**
+   * @brief 设置页面过滤条件
+   * @details 根据 zone map 判断页面上不可能有满足条件的记录时，直接跳过这个页面，不需要读取。
+   * zone_map 由存储引擎在打开扫描时设置，过滤条件由上层算子设置。
+   */
+  void set_zone_map(ZoneMap *zone_map) { zone_map_ = zone_map; }
+  void set_zone_predicates(vector<ZonePredicate> &&predicates) { zone_predicates_ = std::move(predicates); }
+
+  /**
+   * @brief 设置扫描数据的事务
+   * @details 设置以后逐条检查记录对事务是否可见，不可见的记录不会出现在 chunk 中，需要在 open_scan_chunk 之前调用
+   */
+  void set_trx(Trx *trx) { trx_ = trx; }
+
+  /**
+   * @brief 设置并行扫描的页面片段队列，只遍历从队列中领取到的页面，需要在 open_scan_chunk 之前调用
+   */
+  void set_morsel_queue(shared_ptr<PageMorselQueue> morsels) { morsels_ = std::move(morsels); }
+
+private:
+  /**
+   * @brief 从队列中领取下一个页面片段
+   * @return 没有设置队列或者队列中的片段都被领取了，返回 false
+   */
+  bool fetch_next_morsel();
+
+  /**
+   * @brief 逐条读取当前页面上的记录放到 chunk 中
+   * @details 设置了事务时只返回对事务可见的记录。没有按列读取页面的方法时也使用这种方式，比如变长行存格式
+   */
+  RC get_visible_chunk(Chunk &chunk);
+
+  /**
+   * @brief 按列读取 PAX 页面上对事务可见的记录
+   * @details 先按列读取所有记录的事务字段逐条检查可见性，当前版本可见的记录与没有事务时一样按列复制；
+   * 快照中可见的是版本链上的旧版本时，追加旧版本的数据
+   */
+  RC get_visible_pax_chunk(Chunk &chunk);
+
+  /**
+   * @brief 页面上是否可能有满足过滤条件的记录
+   * @param page_fetched 页面是否已经读取。没有 zone 信息时需要读取页面才能计算
+   */
+  bool page_may_match(PageNum page_num, bool page_fetched);
+
 private:
   Table *table_ = nullptr;  ///< 当前遍历的是哪张表。
 
@@ -458,6 +717,14 @@ private:
   LogHandler     *log_handler_      = nullptr;
   ReadWriteMode   rw_mode_ = ReadWriteMode::READ_WRITE;  ///< 遍历出来的数据，是否可能对它做修改
 
+  Trx               *trx_ = nullptr;                 ///< 为空时不检查记录的可见性
   BufferPoolIterator bp_iterator_;                    ///< 遍历buffer pool的所有页面
   RecordPageHandler *record_page_handler_ = nullptr;  ///< 处理文件某页面的记录
+
+  shared_ptr<PageMorselQueue> morsels_;  ///< 并行扫描时领取页面片段的队列
+
+  ZoneMap              *zone_map_ = nullptr;
+  vector<ZonePredicate> zone_predicates_;
+
+  Chunk trx_columns_;  ///< 事务字段，检查 PAX 页面上记录的可见性时使用
 };
@@ -39,4 +39,27 @@ public:
    * @param record 返回的下一条记录
    */
   virtual RC next(Record &record) = 0;
+
+  /**
+   * @brief 设置是否零拷贝
+   * @details 零拷贝时 next 返回的记录不拥有内存，直接指向扫描器当前固定(pin)住的页面，
+   * 或者扫描器内部解码记录使用的内存，只在下一次调用 next 或者 close_scan 之前有效。
+   * 需要更长时间持有记录的调用者自己复制一份，比如只复制通过过滤条件的记录。
+   * 不支持零拷贝的扫描器忽略这个设置。
+   */
+  void set_zero_copy(bool zero_copy) { zero_copy_ = zero_copy; }
+  bool zero_copy() const { return zero_copy_; }
+
+  /**
+   * @brief 设置存储层的过滤条件，可以在 open_scan 之后调用，但是要在第一次调用 next 之前
+   * @details 过滤条件直接在原始的记录数据上计算，不满足条件的记录不会返回。
+   * 有事务时先检查事务可见性，过滤条件作用在事务能看到的版本上(可能是快照中的旧版本)，
+   * 所以不满足条件的记录也会检查可见性，只是省去了上层复制和计算表达式的开销。
+   * 扫描器不拥有过滤条件，调用者需要保证扫描过程中过滤条件有效。
+   * @return 不支持时返回 UNSUPPORTED，调用者需要自己过滤
+   */
+  virtual RC set_condition_filter(ConditionFilter *condition_filter) { return RC::UNSUPPORTED; }
+
+protected:
+  bool zero_copy_ = false;
 };
\ No newline at end of file
@@ -0,0 +1,162 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/record/zone_map.h"
+#include "common/log/log.h"
+#include "storage/table/table_meta.h"
+
+static bool is_numeric(AttrType type) { return type == AttrType::INTS || type == AttrType::FLOATS; }
+
+////////////////////////////////////////////////////////////////////////////////
+void PageZone::update(int col_id, const Value &value)
+{
+  empty_ = false;
+
+  Value &min_value = min_values_[col_id];
+  if (min_value.attr_type() == AttrType::UNDEFINED || value.compare(min_value) < 0) {
+    min_value = value;
+  }
+  Value &max_value = max_values_[col_id];
+  if (max_value.attr_type() == AttrType::UNDEFINED || value.compare(max_value) > 0) {
+    max_value = value;
+  }
+}
+
+bool PageZone::may_match(const vector<ZonePredicate> &predicates) const
+{
+  if (empty_) {
+    return false;
+  }
+
+  for (const ZonePredicate &predicate : predicates) {
+    if (!predicate_may_match(predicate)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool PageZone::predicate_may_match(const ZonePredicate &predicate) const
+{
+  if (predicate.col_id < 0 || predicate.col_id >= static_cast<int>(min_values_.size())) {
+    return true;
+  }
+
+  const Value &min_value = min_values_[predicate.col_id];
+  const Value &max_value = max_values_[predicate.col_id];
+  if (min_value.attr_type() == AttrType::UNDEFINED || max_value.attr_type() == AttrType::UNDEFINED) {
+    return true;
+  }
+
+  // 类型不同时比较的语义不好确定，只处理相同类型以及数字之间的比较
+  const AttrType value_type = predicate.value.attr_type();
+  if (value_type != min_value.attr_type() && !(is_numeric(value_type) && is_numeric(min_value.attr_type()))) {
+    return true;
+  }
+
+  const int cmp_min = min_value.compare(predicate.value);
+  const int cmp_max = max_value.compare(predicate.value);
+  if (cmp_min == INT32_MAX || cmp_max == INT32_MAX) {
+    return true;
+  }
+
+  switch (predicate.comp) {
+    case EQUAL_TO: return cmp_min <= 0 && cmp_max >= 0;
+    case NOT_EQUAL: return !(cmp_min == 0 && cmp_max == 0);
+    case LESS_THAN: return cmp_min < 0;
+    case LESS_EQUAL: return cmp_min <= 0;
+    case GREAT_THAN: return cmp_max > 0;
+    case GREAT_EQUAL: return cmp_max >= 0;
+    default: return true;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+void ZoneMap::init(const TableMeta &table_meta)
+{
+  columns_.resize(table_meta.field_num());
+  for (int i = 0; i < table_meta.field_num(); i++) {
+    const FieldMeta *field_meta = table_meta.field(i);
+    ColumnInfo      &column     = columns_[i];
+    column.type                 = field_meta->type();
+    column.offset               = field_meta->offset();
+    column.len                  = field_meta->len();
+    switch (column.type) {
+      case AttrType::INTS:
+      case AttrType::FLOATS:
+      case AttrType::DATES:
+      case AttrType::CHARS: column.supported = true; break;
+      default: column.supported = false; break;
+    }
+    // 没有设置偏移量的字段无法从记录中取值
+    if (column.offset < 0 || column.len <= 0) {
+      column.supported = false;
+    }
+  }
+
+  lock_guard<common::Mutex> guard(lock_);
+  zones_.clear();
+}
+
+bool ZoneMap::support_column(int col_id) const
+{
+  return col_id >= 0 && col_id < static_cast<int>(columns_.size()) && columns_[col_id].supported;
+}
+
+void ZoneMap::update_zone(PageZone &zone, int col_id, const char *field_data) const
+{
+  const ColumnInfo &column = columns_[col_id];
+  Value             value(column.type, const_cast<char *>(field_data), column.len);
+  zone.update(col_id, value);
+}
+
+void ZoneMap::update(PageNum page_num, const char *record, bool new_page)
+{
+  lock_guard<common::Mutex> guard(lock_);
+
+  auto iter = zones_.find(page_num);
+  if (iter == zones_.end()) {
+    if (!new_page) {
+      // 不知道页面上已有记录的范围，等扫描时再计算
+      return;
+    }
+    iter = zones_.emplace(page_num, PageZone(column_num())).first;
+  }
+
+  iter->second.set_not_empty();
+  for (int col_id = 0; col_id < column_num(); col_id++) {
+    if (columns_[col_id].supported) {
+      update_zone(iter->second, col_id, record + columns_[col_id].offset);
+    }
+  }
+}
+
+void ZoneMap::invalidate(PageNum page_num)
+{
+  lock_guard<common::Mutex> guard(lock_);
+  zones_.erase(page_num);
+}
+
+bool ZoneMap::get(PageNum page_num, PageZone &zone)
+{
+  lock_guard<common::Mutex> guard(lock_);
+  auto                      iter = zones_.find(page_num);
+  if (iter == zones_.end()) {
+    return false;
+  }
+  zone = iter->second;
+  return true;
+}
+
+void ZoneMap::put(PageNum page_num, PageZone &&zone)
+{
+  lock_guard<common::Mutex> guard(lock_);
+  zones_[page_num] = std::move(zone);
+}
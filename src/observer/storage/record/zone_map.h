@@ -0,0 +1,129 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/mutex.h"
+#include "common/lang/unordered_map.h"
+#include "common/lang/vector.h"
+#include "common/types.h"
+#include "common/value.h"
+#include "sql/parser/parse_defs.h"
+
+class TableMeta;
+
+/**
+ * @brief 可以用来过滤页面的简单比较条件，即 `列 op 常量`
+ * @ingroup RecordManager
+ */
+struct ZonePredicate
+{
+  int    col_id = -1;  ///< 页面上列的下标，即字段在 TableMeta 中的下标，不是 field_id
+  CompOp comp   = NO_OP;
+  Value  value;
+};
+
+/**
+ * @brief 一个页面上每一列的最小值和最大值
+ * @ingroup RecordManager
+ * @details 只有可以比较大小的定长类型才会记录，其它列的最小值和最大值都是 UNDEFINED。
+ */
+class PageZone
+{
+public:
+  PageZone() = default;
+  explicit PageZone(int column_num) : min_values_(column_num), max_values_(column_num) {}
+
+  /**
+   * @brief 页面上有了记录
+   */
+  void set_not_empty() { empty_ = false; }
+
+  /**
+   * @brief 把一个值合并到列的范围中
+   */
+  void update(int col_id, const Value &value);
+
+  /**
+   * @brief 页面中是否可能有满足所有条件的记录
+   * @details 无法判断时返回 true。页面中没有任何记录时返回 false
+   */
+  bool may_match(const vector<ZonePredicate> &predicates) const;
+
+  const Value &min_value(int col_id) const { return min_values_[col_id]; }
+  const Value &max_value(int col_id) const { return max_values_[col_id]; }
+
+private:
+  bool predicate_may_match(const ZonePredicate &predicate) const;
+
+private:
+  bool          empty_ = true;  ///< 页面上没有任何记录
+  vector<Value> min_values_;
+  vector<Value> max_values_;
+};
+
+/**
+ * @brief PAX 表的区域映射(zone map)
+ * @ingroup RecordManager
+ * @details 在内存中为每个页面维护各列的最小值和最大值，扫描时可以根据下推的比较条件跳过整个页面，
+ * 不需要读取页面。插入和更新记录时扩大范围；删除记录后范围可能不准确，直接丢弃，
+ * 下次扫描读取该页面时再重新计算。重启以后也是在扫描时逐步建立。
+ * NULL 与 0 在存储上无法区分，所以这里不统计 NULL 的个数，NULL 按照 0 参与最小值和最大值的计算。
+ */
+class ZoneMap
+{
+public:
+  ZoneMap()  = default;
+  ~ZoneMap() = default;
+
+  void init(const TableMeta &table_meta);
+
+  /**
+   * @brief 某一列是否记录最小值和最大值
+   */
+  bool support_column(int col_id) const;
+  int  column_num() const { return static_cast<int>(columns_.size()); }
+
+  /**
+   * @brief 把某一列的一个字段值合并到 zone 中
+   */
+  void update_zone(PageZone &zone, int col_id, const char *field_data) const;
+
+  /**
+   * @brief 页面上插入或者更新了一行记录
+   * @param new_page 是否是新分配的页面，新页面是空的，可以直接建立 zone
+   */
+  void update(PageNum page_num, const char *record, bool new_page);
+
+  /**
+   * @brief 页面上删除了记录，丢弃这个页面的 zone
+   */
+  void invalidate(PageNum page_num);
+
+  /**
+   * @brief 获取页面的 zone
+   * @return 没有时返回 false，需要读取页面重新计算
+   */
+  bool get(PageNum page_num, PageZone &zone);
+  void put(PageNum page_num, PageZone &&zone);
+
+private:
+  struct ColumnInfo
+  {
+    AttrType type      = AttrType::UNDEFINED;
+    int      offset    = 0;
+    int      len       = 0;
+    bool     supported = false;
+  };
+
+  vector<ColumnInfo>               columns_;
+  common::Mutex                    lock_;
+  unordered_map<PageNum, PageZone> zones_;
+};
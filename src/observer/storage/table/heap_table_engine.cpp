@@ -10,11 +10,20 @@ See the Mulan PSL v2 for more details. */
 
 #include "storage/table/heap_table_engine.h"
 #include "storage/record/heap_record_scanner.h"
+#include "common/lang/filesystem.h"
 #include "common/log/log.h"
 #include "storage/index/bplus_tree_index.h"
+#include "storage/index/hash_index.h"
 #include "storage/common/meta_util.h"
 #include "storage/db/db.h"
 
+static Index *new_index(IndexType index_type)
+{
+  switch (index_type) {
+    case IndexType::HASH: return new HashIndex();
+    default: return new BplusTreeIndex();
+  }
+}
 
 HeapTableEngine::~HeapTableEngine()
 {
@@ -28,6 +37,11 @@ HeapTableEngine::~HeapTableEngine()
     data_buffer_pool_ = nullptr;
   }
 
+  if (fsm_buffer_pool_ != nullptr) {
+    fsm_buffer_pool_->close_file();
+    fsm_buffer_pool_ = nullptr;
+  }
+
   for (vector<Index *>::iterator it = indexes_.begin(); it != indexes_.end(); ++it) {
     Index *index = *it;
     delete index;
@@ -63,14 +77,73 @@ RC HeapTableEngine::insert_record(Record &record)
 
 RC HeapTableEngine::insert_chunk(const Chunk& chunk)
 {
-  RC rc = RC::SUCCESS;
-  rc    = record_handler_->insert_chunk(chunk, table_meta_->record_size());
+  const int field_num = table_meta_->field_num();
+  if (chunk.column_num() != field_num) {
+    LOG_WARN("chunk columns don't match the table's schema. table name=%s, column num=%d, field num=%d",
+             table_meta_->name(), chunk.column_num(), field_num);
+    return RC::SCHEMA_FIELD_MISSING;
+  }
+
+  // 按行拆分成记录，这样可以与普通的插入一样批量更新索引
+  const int      record_size = table_meta_->record_size();
+  vector<Record> records(chunk.rows());
+  for (int row = 0; row < chunk.rows(); row++) {
+    Record &record = records[row];
+    RC      rc     = record.new_record(record_size);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to alloc record. table name=%s, rc=%s", table_meta_->name(), strrc(rc));
+      return rc;
+    }
+
+    for (int col = 0; col < field_num; col++) {
+      const FieldMeta *field  = table_meta_->field(col);
+      const Column    &column = chunk.column(col);
+      const int        index  = column.column_type() == Column::Type::CONSTANT_COLUMN ? 0 : row;
+      memcpy(record.data() + field->offset(), column.data() + index * column.attr_len(),
+             min(field->len(), column.attr_len()));
+    }
+  }
+
+  RC rc = insert_records(records);
   if (rc != RC::SUCCESS) {
     LOG_ERROR("Insert chunk failed. table name=%s, rc=%s", table_meta_->name(), strrc(rc));
-    return rc;
   }
+  return rc;
+}
 
-  // TODO: insert chunk support update index
+RC HeapTableEngine::insert_records(vector<Record> &records)
+{
+  RC     rc       = RC::SUCCESS;
+  size_t inserted = 0;
+  for (; inserted < records.size(); inserted++) {
+    Record &record = records[inserted];
+    rc             = record_handler_->insert_record(record.data(), table_meta_->record_size(), &record.rid());
+    if (rc != RC::SUCCESS) {
+      LOG_ERROR("Insert record failed. table name=%s, rc=%s", table_meta_->name(), strrc(rc));
+      break;
+    }
+  }
+
+  if (OB_SUCC(rc)) {
+    rc = insert_entries_of_indexes(records);
+  }
+
+  if (OB_FAIL(rc)) {  // 可能出现了键值重复，回滚已经插入的索引和记录
+    for (size_t i = 0; i < inserted; i++) {
+      const Record &record = records[i];
+
+      RC rc2 = delete_entry_of_indexes(record.data(), record.rid(), false /*error_on_not_exists*/);
+      if (rc2 != RC::SUCCESS) {
+        LOG_ERROR("Failed to rollback index data when insert index entries failed. table name=%s, rc=%d:%s",
+                  table_meta_->name(), rc2, strrc(rc2));
+      }
+      rc2 = record_handler_->delete_record(&record.rid());
+      if (rc2 != RC::SUCCESS) {
+        LOG_PANIC("Failed to rollback record data when insert index entries failed. table name=%s, rc=%d:%s",
+                  table_meta_->name(), rc2, strrc(rc2));
+      }
+    }
+  }
   return rc;
 }
 
@@ -79,6 +152,11 @@ RC HeapTableEngine::visit_record(const RID &rid, function<bool(Record &)> visito
   return record_handler_->visit_record(rid, visitor);
 }
 
+RC HeapTableEngine::visit_records(span<const RID> rids, function<bool(Record &)> visitor)
+{
+  return record_handler_->visit_records(rids, visitor);
+}
+
 RC HeapTableEngine::get_record(const RID &rid, Record &record)
 {
   RC rc = record_handler_->get_record(rid, record);
@@ -105,7 +183,27 @@ RC HeapTableEngine::delete_record(const Record &record)
 
 RC HeapTableEngine::get_record_scanner(RecordScanner *&scanner, Trx *trx, ReadWriteMode mode)
 {
-  scanner = new HeapRecordScanner(table_, *data_buffer_pool_, trx, db_->log_handler(), mode, nullptr);
+  return get_parallel_record_scanner(scanner, trx, mode, nullptr);
+}
+
+RC HeapTableEngine::get_chunk_scanner(ChunkFileScanner &scanner, Trx *trx, ReadWriteMode mode)
+{
+  return get_parallel_chunk_scanner(scanner, trx, mode, nullptr);
+}
+
+RC HeapTableEngine::create_morsel_queue(shared_ptr<PageMorselQueue> &morsels, int morsel_pages)
+{
+  // 页面0是文件头
+  morsels = make_shared<PageMorselQueue>(1, data_buffer_pool_->page_count(), morsel_pages);
+  return RC::SUCCESS;
+}
+
+RC HeapTableEngine::get_parallel_record_scanner(
+    RecordScanner *&scanner, Trx *trx, ReadWriteMode mode, shared_ptr<PageMorselQueue> morsels)
+{
+  auto heap_scanner = new HeapRecordScanner(table_, *data_buffer_pool_, trx, db_->log_handler(), mode, nullptr);
+  heap_scanner->set_morsel_queue(std::move(morsels));
+  scanner = heap_scanner;
   RC rc = scanner->open_scan();
   if (rc != RC::SUCCESS) {
     LOG_ERROR("failed to open scanner. rc=%s", strrc(rc));
@@ -113,16 +211,23 @@ RC HeapTableEngine::get_record_scanner(RecordScanner *&scanner, Trx *trx, ReadWr
   return rc;
 }
 
-RC HeapTableEngine::get_chunk_scanner(ChunkFileScanner &scanner, Trx *trx, ReadWriteMode mode)
+RC HeapTableEngine::get_parallel_chunk_scanner(
+    ChunkFileScanner &scanner, Trx *trx, ReadWriteMode mode, shared_ptr<PageMorselQueue> morsels)
 {
+  // 没有事务字段的表上所有的记录都是可见的，不需要逐条检查
+  scanner.set_trx(table_meta_->trx_fields().empty() ? nullptr : trx);
+  scanner.set_morsel_queue(std::move(morsels));
   RC rc = scanner.open_scan_chunk(table_, *data_buffer_pool_, db_->log_handler(), mode);
   if (rc != RC::SUCCESS) {
     LOG_ERROR("failed to open scanner. rc=%s", strrc(rc));
+    return rc;
   }
+  scanner.set_zone_map(record_handler_->zone_map());
   return rc;
 }
 
-RC HeapTableEngine::create_index(Trx *trx, const FieldMeta *field_meta, const char *index_name, bool Unique)
+RC HeapTableEngine::create_index(
+    Trx *trx, const FieldMeta *field_meta, const char *index_name, bool Unique, IndexType index_type)
 {
   if (common::is_blank(index_name) || nullptr == field_meta) {
     LOG_INFO("Invalid input arguments, table name is %s, index_name is blank or attribute_name is blank", table_meta_->name());
@@ -131,7 +236,7 @@ RC HeapTableEngine::create_index(Trx *trx, const FieldMeta *field_meta, const ch
 
   IndexMeta new_index_meta;
 
-  RC rc = new_index_meta.init(index_name, *field_meta, Unique);
+  RC rc = new_index_meta.init(index_name, *field_meta, Unique, index_type);
   if (rc != RC::SUCCESS) {
     LOG_INFO("Failed to init IndexMeta in table:%s, index_name:%s, field_name:%s", 
              table_meta_->name(), index_name, field_meta->name());
@@ -139,13 +244,13 @@ RC HeapTableEngine::create_index(Trx *trx, const FieldMeta *field_meta, const ch
   }
 
   // 创建索引相关数据
-  BplusTreeIndex *index      = new BplusTreeIndex();
-  string          index_file = table_index_file(db_->path().c_str(), table_meta_->name(), index_name);
+  Index *index      = new_index(index_type);
+  string index_file = table_index_file(db_->path().c_str(), table_meta_->name(), index_name);
 
   rc = index->create(table_, index_file.c_str(), new_index_meta, *field_meta);
   if (rc != RC::SUCCESS) {
     delete index;
-    LOG_ERROR("Failed to create bplus tree index. file name=%s, rc=%d:%s", index_file.c_str(), rc, strrc(rc));
+    LOG_ERROR("Failed to create index. file name=%s, rc=%d:%s", index_file.c_str(), rc, strrc(rc));
     return rc;
   }
 
@@ -233,6 +338,31 @@ RC HeapTableEngine::insert_entry_of_indexes(const char *record, const RID &rid)
   return rc;
 }
 
+RC HeapTableEngine::insert_entries_of_indexes(const vector<Record> &records)
+{
+  if (indexes_.empty() || records.empty()) {
+    return RC::SUCCESS;
+  }
+
+  vector<const char *> datas;
+  vector<RID>          rids;
+  datas.reserve(records.size());
+  rids.reserve(records.size());
+  for (const Record &record : records) {
+    datas.push_back(record.data());
+    rids.push_back(record.rid());
+  }
+
+  RC rc = RC::SUCCESS;
+  for (Index *index : indexes_) {
+    rc = index->insert_entries(datas, rids);
+    if (rc != RC::SUCCESS) {
+      break;
+    }
+  }
+  return rc;
+}
+
 RC HeapTableEngine::delete_entry_of_indexes(const char *record, const RID &rid, bool error_on_not_exists)
 {
   RC rc = RC::SUCCESS;
@@ -263,6 +393,18 @@ RC HeapTableEngine::sync()
   }
 
   rc = data_buffer_pool_->flush_all_pages();
+  if (rc != RC::SUCCESS) {
+    LOG_ERROR("Failed to flush table's data pages. table=%s, rc=%d:%s", table_meta_->name(), rc, strrc(rc));
+    return rc;
+  }
+
+  if (fsm_buffer_pool_ != nullptr) {
+    rc = fsm_buffer_pool_->flush_all_pages();
+    if (rc != RC::SUCCESS) {
+      LOG_ERROR("Failed to flush table's free space map. table=%s, rc=%d:%s", table_meta_->name(), rc, strrc(rc));
+      return rc;
+    }
+  }
   LOG_INFO("Sync table over. table=%s", table_meta_->name());
   return rc;
 }
@@ -296,9 +438,25 @@ RC HeapTableEngine::init()
     return rc;
   }
 
+  // 之前版本创建的表没有空闲空间映射文件，这里创建一个空的，插入记录时再逐步建立
+  string fsm_file = table_fsm_file(db_->path().c_str(), table_meta_->name());
+  if (!filesystem::exists(fsm_file)) {
+    rc = bpm.create_file(fsm_file.c_str());
+    if (OB_FAIL(rc)) {
+      LOG_ERROR("Failed to create free space map file:%s. rc=%s", fsm_file.c_str(), strrc(rc));
+      return rc;
+    }
+  }
+  rc = bpm.open_file(db_->log_handler(), fsm_file.c_str(), fsm_buffer_pool_);
+  if (OB_FAIL(rc)) {
+    LOG_ERROR("Failed to open disk buffer pool for file:%s. rc=%s", fsm_file.c_str(), strrc(rc));
+    return rc;
+  }
+
   record_handler_ = new RecordFileHandler(table_meta_->storage_format());
 
-  rc = record_handler_->init(*data_buffer_pool_, db_->log_handler(), table_meta_, table_->lob_handler_);
+  rc = record_handler_->init(
+      *data_buffer_pool_, db_->log_handler(), table_meta_, table_->lob_handler_, fsm_buffer_pool_);
   if (rc != RC::SUCCESS) {
     LOG_ERROR("Failed to init record handler. rc=%s", strrc(rc));
     delete record_handler_;
@@ -325,8 +483,8 @@ RC HeapTableEngine::open()
       return RC::INTERNAL;
     }
 
-    BplusTreeIndex *index      = new BplusTreeIndex();
-    string          index_file = table_index_file(db_->path().c_str(), table_meta_->name(), index_meta->name());
+    Index *index      = new_index(index_meta->type());
+    string index_file = table_index_file(db_->path().c_str(), table_meta_->name(), index_meta->name());
 
     rc = index->open(table_, index_file.c_str(), *index_meta, *field_meta);
     if (rc != RC::SUCCESS) {
@@ -28,6 +28,7 @@ public:
 
   RC insert_record(Record &record) override;
   RC insert_chunk(const Chunk &chunk) override;
+  RC insert_records(vector<Record> &records) override;
   RC delete_record(const Record &record) override;
   RC insert_record_with_trx(Record &record, Trx *trx) override { return RC::UNSUPPORTED; }
   RC delete_record_with_trx(const Record &record, Trx *trx) override { return RC::UNSUPPORTED; }
@@ -37,10 +38,17 @@ public:
   }
   RC get_record(const RID &rid, Record &record) override;
 
-  RC create_index(Trx *trx, const FieldMeta *field_meta, const char *index_name, bool Unique) override; 
+  RC create_index(
+      Trx *trx, const FieldMeta *field_meta, const char *index_name, bool Unique, IndexType index_type) override;
   RC get_record_scanner(RecordScanner *&scanner, Trx *trx, ReadWriteMode mode) override;
   RC get_chunk_scanner(ChunkFileScanner &scanner, Trx *trx, ReadWriteMode mode) override;
+  RC create_morsel_queue(shared_ptr<PageMorselQueue> &morsels, int morsel_pages) override;
+  RC get_parallel_record_scanner(
+      RecordScanner *&scanner, Trx *trx, ReadWriteMode mode, shared_ptr<PageMorselQueue> morsels) override;
+  RC get_parallel_chunk_scanner(
+      ChunkFileScanner &scanner, Trx *trx, ReadWriteMode mode, shared_ptr<PageMorselQueue> morsels) override;
   RC visit_record(const RID &rid, function<bool(Record &)> visitor) override;
+  RC visit_records(span<const RID> rids, function<bool(Record &)> visitor) override;
   RC sync() override;
 
   Index *find_index(const char *index_name) const override;
@@ -51,10 +59,12 @@ public:
 
 private:
   RC insert_entry_of_indexes(const char *record, const RID &rid);
+  RC insert_entries_of_indexes(const vector<Record> &records);
   RC delete_entry_of_indexes(const char *record, const RID &rid, bool error_on_not_exists);
 
 private:
   DiskBufferPool    *data_buffer_pool_ = nullptr;  /// 数据文件关联的buffer pool
+  DiskBufferPool    *fsm_buffer_pool_  = nullptr;  /// 空闲空间映射文件关联的buffer pool
   RecordFileHandler *record_handler_   = nullptr;  /// 记录操作
   vector<Index *>    indexes_;
   Db                *db_;
@@ -29,6 +29,18 @@ RC LsmTableEngine::insert_record(Record &record)
   return rc;
 }
 
+RC LsmTableEngine::insert_records(vector<Record> &records)
+{
+  RC rc = RC::SUCCESS;
+  for (Record &record : records) {
+    rc = insert_record(record);
+    if (OB_FAIL(rc)) {
+      break;
+    }
+  }
+  return rc;
+}
+
 RC LsmTableEngine::get_record_scanner(RecordScanner *&scanner, Trx *trx, ReadWriteMode mode)
 {
   scanner = new LsmRecordScanner(table_, db_->lsm(), trx);
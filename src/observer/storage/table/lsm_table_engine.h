@@ -30,6 +30,7 @@ public:
 
   RC insert_record(Record &record) override;
   RC insert_chunk(const Chunk &chunk) override { return RC::UNIMPLEMENTED; }
+  RC insert_records(vector<Record> &records) override;
   RC delete_record(const Record &record) override { return RC::UNIMPLEMENTED; }
   RC insert_record_with_trx(Record &record, Trx *trx) override { return RC::UNIMPLEMENTED; }
   RC delete_record_with_trx(const Record &record, Trx *trx) override { return RC::UNIMPLEMENTED; }
@@ -39,10 +40,26 @@ public:
   }
   RC get_record(const RID &rid, Record &record) override { return RC::UNIMPLEMENTED; }
 
-  RC create_index(Trx *trx, const FieldMeta *field_meta, const char *index_name, bool Unique) override { return RC::UNIMPLEMENTED; }
+  RC create_index(Trx *trx, const FieldMeta *field_meta, const char *index_name, bool Unique,
+      IndexType index_type) override
+  {
+    return RC::UNIMPLEMENTED;
+  }
   RC get_record_scanner(RecordScanner *&scanner, Trx *trx, ReadWriteMode mode) override;
   RC get_chunk_scanner(ChunkFileScanner &scanner, Trx *trx, ReadWriteMode mode) override { return RC::UNIMPLEMENTED; }
+  RC create_morsel_queue(shared_ptr<PageMorselQueue> &morsels, int morsel_pages) override { return RC::UNIMPLEMENTED; }
+  RC get_parallel_record_scanner(
+      RecordScanner *&scanner, Trx *trx, ReadWriteMode mode, shared_ptr<PageMorselQueue> morsels) override
+  {
+    return RC::UNIMPLEMENTED;
+  }
+  RC get_parallel_chunk_scanner(
+      ChunkFileScanner &scanner, Trx *trx, ReadWriteMode mode, shared_ptr<PageMorselQueue> morsels) override
+  {
+    return RC::UNIMPLEMENTED;
+  }
   RC visit_record(const RID &rid, function<bool(Record &)> visitor) override { return RC::UNIMPLEMENTED; }
+  RC visit_records(span<const RID> rids, function<bool(Record &)> visitor) override { return RC::UNIMPLEMENTED; }
   // TODO:
   RC     sync() override { return RC::SUCCESS; }
   Index *find_index(const char *index_name) const override { return nullptr; }
@@ -176,6 +176,15 @@ RC Table::drop(Db *db, const char *path)
     }
   }
   
+  // 删除空闲空间映射文件
+  string fsm_file = table_fsm_file(db_->path().c_str(), name());
+  if (std::filesystem::exists(fsm_file)) {
+    if (!std::filesystem::remove(fsm_file)) {
+      printf("Failed to remove free space map file: %s\n", fsm_file.c_str());
+      return rc;
+    }
+  }
+
   printf("Successfully dropped table %s\n", name());
   return rc;
 }
@@ -247,6 +256,11 @@ RC Table::insert_record(Record &record)
   return engine_->insert_record(record);
 }
 
+RC Table::insert_records(vector<Record> &records)
+{
+  return engine_->insert_records(records);
+}
+
 RC Table::insert_chunk(const Chunk& chunk)
 {
   return engine_->insert_chunk(chunk);
@@ -257,6 +271,11 @@ RC Table::visit_record(const RID &rid, function<bool(Record &)> visitor)
   return engine_->visit_record(rid, visitor);
 }
 
+RC Table::visit_records(span<const RID> rids, function<bool(Record &)> visitor)
+{
+  return engine_->visit_records(rids, visitor);
+}
+
 RC Table::insert_record_with_trx(Record &record, Trx *trx)
 {
   return engine_->insert_record_with_trx(record, trx);
@@ -344,26 +363,18 @@ RC Table::set_value_to_record(char *record_data, const Value &value, const Field
     }
 
     string text = value.get_string();
-    int64_t offset = 0;
     int64_t length = static_cast<int64_t>(text.size());
     // TEXT 最多保留 4096 字节，多余部分截断
     static const int64_t MAX_TEXT_LENGTH = 4096;
     if (length > MAX_TEXT_LENGTH) {
       length = MAX_TEXT_LENGTH;
     }
-    RC rc = lob_handler_->insert_data(offset, length, text.c_str());
+    RC rc = lob_handler_->write_field(text.c_str(), length, record_data + field->offset(), field->len());
     if (OB_FAIL(rc)) {
-      LOG_WARN("failed to insert lob data. table=%s field=%s rc=%s",
+      LOG_WARN("failed to write lob data. table=%s field=%s rc=%s",
                table_meta_.name(), field->name(), strrc(rc));
       return rc;
     }
-
-    LobRef ref;
-    ref.offset   = offset;
-    ref.length   = static_cast<int32_t>(length);
-    ref.reserved = 0;
-
-    memcpy(record_data + field->offset(), &ref, sizeof(ref));
     return RC::SUCCESS;
   }
 
@@ -388,9 +399,26 @@ RC Table::get_chunk_scanner(ChunkFileScanner &scanner, Trx *trx, ReadWriteMode m
   return engine_->get_chunk_scanner(scanner, trx, mode);
 }
 
-RC Table::create_index(Trx *trx, const FieldMeta *field_meta, const char *index_name, bool Unique)
+RC Table::create_morsel_queue(shared_ptr<PageMorselQueue> &morsels, int morsel_pages)
+{
+  return engine_->create_morsel_queue(morsels, morsel_pages);
+}
+
+RC Table::get_parallel_record_scanner(
+    RecordScanner *&scanner, Trx *trx, ReadWriteMode mode, shared_ptr<PageMorselQueue> morsels)
+{
+  return engine_->get_parallel_record_scanner(scanner, trx, mode, std::move(morsels));
+}
+
+RC Table::get_parallel_chunk_scanner(
+    ChunkFileScanner &scanner, Trx *trx, ReadWriteMode mode, shared_ptr<PageMorselQueue> morsels)
+{
+  return engine_->get_parallel_chunk_scanner(scanner, trx, mode, std::move(morsels));
+}
+
+RC Table::create_index(Trx *trx, const FieldMeta *field_meta, const char *index_name, bool Unique, IndexType index_type)
 {
-  return engine_->create_index(trx, field_meta, index_name, Unique);
+  return engine_->create_index(trx, field_meta, index_name, Unique, index_type);
 }
 
 RC Table::delete_record(const Record &record)
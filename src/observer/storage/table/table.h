@@ -91,6 +91,13 @@ public:
    */
   RC insert_record(Record &record);
 
+  /**
+   * @brief 在当前的表中批量插入记录
+   * @details 与 insert_record 一样不关心事务，但是会批量更新索引。任何一条插入失败，所有的记录都不会插入
+   * @param records[in/out] 插入成功会通过每个记录返回RID
+   */
+  RC insert_records(vector<Record> &records);
+
   RC insert_chunk(const Chunk &chunk);
   RC delete_record(const Record &record);
 
@@ -100,12 +107,24 @@ public:
   RC get_record(const RID &rid, Record &record);
 
   // TODO refactor
-  RC create_index(Trx *trx, const FieldMeta *field_meta, const char *index_name, bool Unique);
+  RC create_index(Trx *trx, const FieldMeta *field_meta, const char *index_name, bool Unique,
+      IndexType index_type = IndexType::BPLUS_TREE);
 
   RC get_record_scanner(RecordScanner *&scanner, Trx *trx, ReadWriteMode mode);
 
   RC get_chunk_scanner(ChunkFileScanner &scanner, Trx *trx, ReadWriteMode mode);
 
+  /**
+   * @brief 并行扫描
+   * @details 先创建一个页面片段队列，每个工作线程再使用这个队列创建自己的扫描器
+   * @param morsel_pages 每个片段包含的页面个数
+   */
+  RC create_morsel_queue(shared_ptr<PageMorselQueue> &morsels, int morsel_pages = PageMorselQueue::DEFAULT_MORSEL_PAGES);
+  RC get_parallel_record_scanner(
+      RecordScanner *&scanner, Trx *trx, ReadWriteMode mode, shared_ptr<PageMorselQueue> morsels);
+  RC get_parallel_chunk_scanner(
+      ChunkFileScanner &scanner, Trx *trx, ReadWriteMode mode, shared_ptr<PageMorselQueue> morsels);
+
   /**
    * @brief 可以在页面锁保护的情况下访问记录
    * @details 当前是在事务中访问记录，为了提供一个“原子性”的访问模式
@@ -115,6 +134,12 @@ public:
    */
   RC visit_record(const RID &rid, function<bool(Record &)> visitor);
 
+  /**
+   * @brief 在页面锁保护的情况下依次访问多条记录
+   * @details 同一个页面上的记录只加一次锁，修改只记录一条日志。rids 需要按照页面排列
+   */
+  RC visit_records(span<const RID> rids, function<bool(Record &)> visitor);
+
 public:
   int32_t     table_id() const { return table_meta_.table_id(); }
   const char *name() const;
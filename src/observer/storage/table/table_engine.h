@@ -12,8 +12,10 @@ See the Mulan PSL v2 for more details. */
 
 #include "common/types.h"
 #include "common/lang/functional.h"
+#include "common/lang/span.h"
 #include "storage/table/table_meta.h"
 #include "storage/common/chunk.h"
+#include "storage/record/page_morsel.h"
 
 struct RID;
 class Record;
@@ -40,16 +42,32 @@ public:
 
   virtual RC insert_record(Record &record)                                                        = 0;
   virtual RC insert_chunk(const Chunk &chunk)                                                     = 0;
+  virtual RC insert_records(vector<Record> &records)                                              = 0;
   virtual RC delete_record(const Record &record)                                                  = 0;
   virtual RC insert_record_with_trx(Record &record, Trx *trx)                                     = 0;
   virtual RC delete_record_with_trx(const Record &record, Trx *trx)                               = 0;
   virtual RC update_record_with_trx(const Record &old_record, const Record &new_record, Trx *trx) = 0;
   virtual RC get_record(const RID &rid, Record &record)                                           = 0;
 
-  virtual RC     create_index(Trx *trx, const FieldMeta *field_meta, const char *index_name, bool Unique) = 0;
+  virtual RC     create_index(
+      Trx *trx, const FieldMeta *field_meta, const char *index_name, bool Unique, IndexType index_type) = 0;
   virtual RC     get_record_scanner(RecordScanner *&scanner, Trx *trx, ReadWriteMode mode)   = 0;
   virtual RC     get_chunk_scanner(ChunkFileScanner &scanner, Trx *trx, ReadWriteMode mode)  = 0;
+
+  /**
+   * @brief 创建并行扫描使用的页面片段队列
+   * @details 把表当前已经分配的页面划分成多个片段。每个工作线程使用同一个队列创建自己的扫描器，
+   * 动态领取片段，所有扫描器合起来访问到表中所有的记录，每个扫描器仍然逐条检查记录对事务的可见性。
+   * @param morsel_pages 每个片段包含的页面个数
+   */
+  virtual RC create_morsel_queue(shared_ptr<PageMorselQueue> &morsels, int morsel_pages) = 0;
+  virtual RC get_parallel_record_scanner(
+      RecordScanner *&scanner, Trx *trx, ReadWriteMode mode, shared_ptr<PageMorselQueue> morsels) = 0;
+  virtual RC get_parallel_chunk_scanner(
+      ChunkFileScanner &scanner, Trx *trx, ReadWriteMode mode, shared_ptr<PageMorselQueue> morsels) = 0;
+
   virtual RC     visit_record(const RID &rid, function<bool(Record &)> visitor)              = 0;
+  virtual RC     visit_records(span<const RID> rids, function<bool(Record &)> visitor)        = 0;
   virtual RC     sync()                                                                      = 0;
   virtual Index *find_index(const char *index_name) const                                    = 0;
   virtual Index *find_index_by_field(const char *field_name) const                           = 0;
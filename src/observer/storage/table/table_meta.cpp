@@ -19,7 +19,7 @@ See the Mulan PSL v2 for more details. */
 #include "common/type/attr_type.h"
 #include "storage/table/table_meta.h"
 #include "storage/trx/trx.h"
-#include "storage/record/lob_ref.h"
+#include "storage/record/lob_handler.h"
 #include "json/json.h"
 
 static const Json::StaticString FIELD_TABLE_ID("table_id");
@@ -86,9 +86,9 @@ RC TableMeta::init(int32_t table_id, const char *name, const vector<FieldMeta> *
     const AttrInfoSqlNode &attr_info = attributes[i];
     int                   attr_len  = attr_info.length;
 
-    // TEXT 字段在行内只存储 LobRef，而不是整段文本
+    // TEXT 字段在行内存储 LobRef，以及可以直接放在记录中的短文本
     if (attr_info.type == AttrType::TEXTS) {
-      attr_len = static_cast<int>(sizeof(LobRef));
+      attr_len = LobFileHandler::text_field_len();
     }
 
     // `i` is the col_id of fields[i]
@@ -150,6 +150,21 @@ const FieldMeta *TableMeta::find_field_by_offset(int offset) const
   }
   return nullptr;
 }
+int TableMeta::field_index(int field_id) const
+{
+  // 用户字段的 field_id 从 0 开始编号，排在事务字段的后面
+  if (field_id >= 0) {
+    const int index = field_id + sys_field_num();
+    return index < field_num() ? index : -1;
+  }
+  for (int i = 0; i < sys_field_num(); i++) {
+    if (fields_[i].field_id() == field_id) {
+      return i;
+    }
+  }
+  return -1;
+}
+
 int TableMeta::field_num() const { return fields_.size(); }
 
 int TableMeta::sys_field_num() const { return static_cast<int>(trx_fields_.size()); }
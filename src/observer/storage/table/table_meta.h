@@ -48,6 +48,8 @@ public:
   const FieldMeta    *field(int index) const;
   const FieldMeta    *field(const char *name) const;
   const FieldMeta    *find_field_by_offset(int offset) const;
+  /// 根据 field_id 找到字段在 fields_ 中的下标，也就是 PAX 页面上列的下标。事务字段的 field_id 是负数
+  int                 field_index(int field_id) const;
   auto                field_metas() const -> const vector<FieldMeta>                *{ return &fields_; }
   auto                trx_fields() const -> span<const FieldMeta>;
   const StorageFormat storage_format() const { return storage_format_; }
@@ -0,0 +1,161 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/trx/mvcc_lock_manager.h"
+#include "common/lang/chrono.h"
+#include "common/lang/sstream.h"
+#include "common/log/log.h"
+
+static atomic<int> default_wait_timeout_ms_{MvccLockManager::DEFAULT_WAIT_TIMEOUT_MS};
+
+string MvccLockStats::to_string() const
+{
+  stringstream ss;
+  ss << "waits:" << waits << ", timeouts:" << timeouts << ", deadlocks:" << deadlocks;
+  return ss.str();
+}
+
+void MvccLockManager::set_default_wait_timeout_ms(int timeout_ms) { default_wait_timeout_ms_ = max(timeout_ms, 0); }
+int  MvccLockManager::default_wait_timeout_ms() { return default_wait_timeout_ms_; }
+
+MvccLockManager::MvccLockManager() : wait_timeout_ms_(default_wait_timeout_ms_.load()) {}
+
+RC MvccLockManager::lock(int32_t trx_id, int32_t table_id, const RID &rid)
+{
+  const LockKey      key{table_id, rid};
+  unique_lock<mutex> guard(lock_);
+
+  auto [iter, inserted] = locks_.try_emplace(key);
+  LockEntry &entry      = iter->second;  // 等待期间其它记录加锁解锁也不会让这个引用失效
+  if (inserted) {
+    entry.owner = trx_id;
+    trx_locks_[trx_id].push_back(key);
+    return RC::SUCCESS;
+  }
+
+  if (entry.owner == trx_id) {
+    return RC::SUCCESS;
+  }
+
+  const int timeout_ms = wait_timeout_ms_;
+  if (timeout_ms <= 0) {
+    LOG_TRACE("row is locked by another trx. trx id=%d, owner=%d, table id=%d, rid=%s",
+              trx_id, entry.owner, table_id, rid.to_string().c_str());
+    return RC::LOCKED_CONCURRENCY_CONFLICT;
+  }
+
+  if (would_deadlock(trx_id, entry.owner)) {
+    deadlocks_++;
+    LOG_INFO("deadlock detected. trx id=%d, owner=%d, table id=%d, rid=%s",
+             trx_id, entry.owner, table_id, rid.to_string().c_str());
+    return RC::LOCKED_DEADLOCK;
+  }
+
+  waits_++;
+  entry.waiters.push_back(trx_id);
+  waiting_.emplace(trx_id, key);
+  LOG_TRACE("wait for row lock. trx id=%d, owner=%d, table id=%d, rid=%s",
+            trx_id, entry.owner, table_id, rid.to_string().c_str());
+
+  // 持有者释放锁时直接把锁交给队头的事务，并把它从 waiting_ 中删除
+  const auto deadline = chrono::steady_clock::now() + chrono::milliseconds(timeout_ms);
+  if (cond_.wait_until(guard, deadline, [&entry, trx_id] { return entry.owner == trx_id; })) {
+    return RC::SUCCESS;
+  }
+
+  timeouts_++;
+  waiting_.erase(trx_id);
+  for (auto waiter = entry.waiters.begin(); waiter != entry.waiters.end(); ++waiter) {
+    if (*waiter == trx_id) {
+      entry.waiters.erase(waiter);
+      break;
+    }
+  }
+  LOG_INFO("wait for row lock timeout. trx id=%d, owner=%d, table id=%d, rid=%s, timeout=%dms",
+           trx_id, entry.owner, table_id, rid.to_string().c_str(), timeout_ms);
+  return RC::LOCKED_WAIT_TIMEOUT;
+}
+
+void MvccLockManager::unlock_all(int32_t trx_id)
+{
+  lock_guard<mutex> guard(lock_);
+
+  auto iter = trx_locks_.find(trx_id);
+  if (iter == trx_locks_.end()) {
+    return;
+  }
+
+  vector<LockKey> keys = std::move(iter->second);
+  trx_locks_.erase(iter);
+
+  bool handed_over = false;
+  for (const LockKey &key : keys) {
+    auto lock_iter = locks_.find(key);
+    ASSERT(lock_iter != locks_.end() && lock_iter->second.owner == trx_id,
+           "row lock is not held by trx. trx id=%d, table id=%d, rid=%s",
+           trx_id, key.table_id, key.rid.to_string().c_str());
+
+    LockEntry &entry = lock_iter->second;
+    if (entry.waiters.empty()) {
+      locks_.erase(lock_iter);
+      continue;
+    }
+
+    entry.owner = entry.waiters.front();
+    entry.waiters.pop_front();
+    waiting_.erase(entry.owner);
+    trx_locks_[entry.owner].push_back(key);
+    handed_over = true;
+  }
+
+  if (handed_over) {
+    cond_.notify_all();
+  }
+}
+
+bool MvccLockManager::would_deadlock(int32_t trx_id, int32_t owner) const
+{
+  // 每个事务最多等待一把锁，沿着等待链最多走 waiting_.size() 步
+  int32_t current = owner;
+  for (size_t i = 0; i <= waiting_.size(); i++) {
+    if (current == trx_id) {
+      return true;
+    }
+
+    auto iter = waiting_.find(current);
+    if (iter == waiting_.end()) {
+      return false;
+    }
+    current = locks_.at(iter->second).owner;
+  }
+  return false;
+}
+
+int MvccLockManager::lock_count() const
+{
+  lock_guard<mutex> guard(lock_);
+  return static_cast<int>(locks_.size());
+}
+
+int MvccLockManager::waiting_count() const
+{
+  lock_guard<mutex> guard(lock_);
+  return static_cast<int>(waiting_.size());
+}
+
+MvccLockStats MvccLockManager::stats() const
+{
+  lock_guard<mutex> guard(lock_);
+  MvccLockStats     stats;
+  stats.waits     = waits_;
+  stats.timeouts  = timeouts_;
+  stats.deadlocks = deadlocks_;
+  return stats;
+}
@@ -0,0 +1,137 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/algorithm.h"
+#include "common/lang/atomic.h"
+#include "common/lang/condition_variable.h"
+#include "common/lang/deque.h"
+#include "common/lang/mutex.h"
+#include "common/lang/string.h"
+#include "common/lang/unordered_map.h"
+#include "common/lang/vector.h"
+#include "common/sys/rc.h"
+#include "storage/record/record.h"
+
+/**
+ * @brief 行锁的统计信息
+ * @ingroup Transaction
+ */
+struct MvccLockStats
+{
+  int64_t waits     = 0;  ///< 需要等待的加锁次数
+  int64_t timeouts  = 0;  ///< 等待超时的次数
+  int64_t deadlocks = 0;  ///< 检测到死锁的次数
+
+  string to_string() const;
+};
+
+/**
+ * @brief MVCC 事务的行锁
+ * @ingroup Transaction
+ * @details 事务在删除或更新一条记录之前，先对 (表, RID) 加排他锁，锁一直持有到事务提交或回滚。
+ * 锁被其它事务持有时，按照先来先到的顺序在锁的等待队列中等待，持有者释放锁时直接交给队头的事务。
+ * 等待超过 wait_timeout_ms 返回 LOCKED_WAIT_TIMEOUT，超时时间为0时不等待，直接返回 LOCKED_CONCURRENCY_CONFLICT。
+ *
+ * 每个事务同一时间最多等待一把锁，而一把锁只有一个持有者，所以等待图(wait-for graph)中每个事务最多只有一条出边，
+ * 开始等待之前沿着 "持有者 -> 持有者正在等待的锁 -> 这把锁的持有者" 一直找下去，回到自己说明会形成死锁，
+ * 当前事务不再等待，返回 LOCKED_DEADLOCK，由上层回滚事务。锁交给等待者时，新的持有者已经不在等待了，
+ * 其它等待者的出边指向它也不会形成新的环，只需要在加入等待时检测。
+ *
+ * 等待需要真正的条件变量，这里使用 std::mutex，不受 CONCURRENCY 编译选项的影响。
+ * 不能在持有页面锁的时候加行锁，否则持有者提交时修改页面也要等待页面锁，两边互相等待。
+ */
+class MvccLockManager
+{
+public:
+  static constexpr int DEFAULT_WAIT_TIMEOUT_MS = 10000;
+
+  /**
+   * @brief 设置等锁的超时时间，之后创建的锁管理器使用
+   */
+  static void set_default_wait_timeout_ms(int timeout_ms);
+  static int  default_wait_timeout_ms();
+
+public:
+  MvccLockManager();
+  ~MvccLockManager() = default;
+
+  /**
+   * @brief 对一条记录加排他锁，已经持有时直接返回成功
+   * @return RC - SUCCESS 加锁成功
+   *            - LOCKED_CONCURRENCY_CONFLICT 超时时间为0，不等待
+   *            - LOCKED_WAIT_TIMEOUT 等待超时
+   *            - LOCKED_DEADLOCK 等待会形成死锁
+   */
+  RC lock(int32_t trx_id, int32_t table_id, const RID &rid);
+
+  /**
+   * @brief 释放事务持有的所有锁，事务提交或回滚时调用
+   */
+  void unlock_all(int32_t trx_id);
+
+  void set_wait_timeout_ms(int timeout_ms) { wait_timeout_ms_ = max(timeout_ms, 0); }
+  int  wait_timeout_ms() const { return wait_timeout_ms_; }
+
+  /**
+   * @brief 被锁住的记录个数
+   */
+  int lock_count() const;
+
+  /**
+   * @brief 正在等锁的事务个数
+   */
+  int waiting_count() const;
+
+  MvccLockStats stats() const;
+
+private:
+  struct LockKey
+  {
+    int32_t table_id;
+    RID     rid;
+
+    bool operator==(const LockKey &other) const { return table_id == other.table_id && rid == other.rid; }
+  };
+
+  struct LockKeyHash
+  {
+    size_t operator()(const LockKey &key) const
+    {
+      return (static_cast<size_t>(key.table_id) << 48) ^ (static_cast<size_t>(key.rid.page_num) << 16) ^
+             static_cast<size_t>(key.rid.slot_num);
+    }
+  };
+
+  struct LockEntry
+  {
+    int32_t        owner = 0;
+    deque<int32_t> waiters;  ///< 等待这把锁的事务，按照开始等待的顺序排列
+  };
+
+  /**
+   * @brief trx_id 等待 owner 持有的锁是否会形成死锁
+   */
+  bool would_deadlock(int32_t trx_id, int32_t owner) const;
+
+private:
+  atomic<int> wait_timeout_ms_;
+
+  mutable mutex                                   lock_;
+  condition_variable                              cond_;
+  unordered_map<LockKey, LockEntry, LockKeyHash>  locks_;
+  unordered_map<int32_t, vector<LockKey>>         trx_locks_;  ///< 每个事务持有的锁
+  unordered_map<int32_t, LockKey>                 waiting_;    ///< 每个事务正在等待的锁
+
+  int64_t waits_     = 0;
+  int64_t timeouts_  = 0;
+  int64_t deadlocks_ = 0;
+};
@@ -15,13 +15,16 @@ See the Mulan PSL v2 for more details. */
 #include "storage/trx/mvcc_trx.h"
 #include "storage/db/db.h"
 #include "storage/field/field.h"
+#include "storage/index/index.h"
+#include "storage/table/table.h"
 #include "storage/trx/mvcc_trx_log.h"
+#include "storage/trx/mvcc_vacuum.h"
 #include "common/lang/algorithm.h"
 
 MvccTrxKit::~MvccTrxKit()
 {
   vector<Trx *> tmp_trxes;
-  tmp_trxes.swap(trxes_);
+  registry_.take_all(tmp_trxes);
 
   for (Trx *trx : tmp_trxes) {
     delete trx;
@@ -42,7 +45,115 @@ RC MvccTrxKit::init()
 
 const vector<FieldMeta> *MvccTrxKit::trx_fields() const { return &fields_; }
 
-int32_t MvccTrxKit::next_trx_id() { return ++current_trx_id_; }
+int32_t MvccTrxKit::next_trx_id() { return registry_.next_trx_id(); }
+
+int32_t MvccTrxKit::start_trx(const Trx *trx) { return registry_.begin_snapshot(trx); }
+
+int32_t MvccTrxKit::start_read_only_trx(const Trx *trx) { return registry_.begin_read_snapshot(trx); }
+
+void MvccTrxKit::end_trx(const Trx *trx, int32_t trx_id)
+{
+  registry_.end_snapshot(trx, trx_id);
+
+  if (++ended_since_purge_ % PURGE_INTERVAL == 0 && undo_store_.version_count() > 0) {
+    purge_undo();
+  }
+}
+
+int32_t MvccTrxKit::oldest_active_trx_id() { return registry_.oldest_active_trx_id(); }
+
+int MvccTrxKit::purge_undo()
+{
+  vector<MvccPurgedVersion> index_changed_versions;
+  const int purged = undo_store_.purge(oldest_active_trx_id(), db_ != nullptr ? &index_changed_versions : nullptr);
+  if (index_changed_versions.empty()) {
+    return purged;
+  }
+
+  // 与清理线程一样持有建表删表的锁，避免访问已经删除的表
+  unique_lock<common::Mutex> table_guard;
+  if (db_->vacuum() != nullptr) {
+    table_guard = unique_lock<common::Mutex>(db_->vacuum()->table_lock());
+  }
+
+  for (const MvccPurgedVersion &version : index_changed_versions) {
+    Table *table = db_->find_table(version.table_id);
+    if (table != nullptr) {
+      clean_index_entries(table, version.rid, version.data.data());
+    }
+  }
+  return purged;
+}
+
+void MvccTrxKit::clean_index_entries(Table *table, const RID &rid, const char *stale_data)
+{
+  const TableMeta &table_meta = table->table_meta();
+  if (table_meta.index_num() == 0) {
+    return;
+  }
+
+  vector<string> versions;
+  RC             rc = undo_store_.find_all(table->table_id(), rid, versions);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to load versions of record, keep its index entries. table=%s, rid=%s, rc=%s",
+             table->name(), rid.to_string().c_str(), strrc(rc));
+    return;
+  }
+
+  Record     page_record;
+  const bool page_exists = OB_SUCC(table->get_record(rid, page_record));
+
+  for (int i = 0; i < table_meta.index_num(); i++) {
+    Index *index = table->find_index(table_meta.index(i)->name());
+    if (nullptr == index || index->is_vector_index()) {
+      continue;
+    }
+
+    const char *stale_key  = stale_data + index->field_meta().offset();
+    auto        key_in_use = [index, stale_key](const char *data) { return index->key_equals(data, stale_key); };
+    if ((page_exists && key_in_use(page_record.data())) ||
+        any_of(versions.begin(), versions.end(), [&key_in_use](const string &data) { return key_in_use(data.data()); })) {
+      continue;
+    }
+
+    rc = index->delete_entry(stale_data, &rid);
+    if (OB_FAIL(rc)) {
+      LOG_TRACE("failed to delete index entry of old version. table=%s, index=%s, rid=%s, rc=%s",
+                table->name(), table_meta.index(i)->name(), rid.to_string().c_str(), strrc(rc));
+      continue;
+    }
+
+    // 清理旧版本时没有加行锁，并发的更新可能刚把记录改回这个键值，插入时发现索引项已经存在。
+    // 更新先修改页面再插入索引项，所以删除以后重新检查一次页面上的版本
+    if (OB_SUCC(table->get_record(rid, page_record)) && key_in_use(page_record.data())) {
+      index->insert_entry(page_record.data(), &rid);
+    }
+  }
+}
+
+bool MvccTrxKit::index_key_in_use(Table *table, const Index &index, const RID &rid, const char *key)
+{
+  Record page_record;
+  RC     rc = table->get_record(rid, page_record);
+  if (rc == RC::RECORD_NOT_EXIST) {
+    return false;
+  }
+  if (OB_FAIL(rc) || index.key_equals(page_record.data(), key)) {
+    return true;
+  }
+
+  // 页面上的版本还没有提交时，它替换掉的版本在回滚以后还会使用这个键值
+  vector<string> versions;
+  rc = undo_store_.find_uncommitted(table->table_id(), rid, versions);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to load uncommitted versions of record. table=%s, rid=%s, rc=%s",
+             table->name(), rid.to_string().c_str(), strrc(rc));
+    return true;
+  }
+  return any_of(versions.begin(), versions.end(), [&index, key](const string &data) {
+    return index.key_equals(data.data(), key);
+  });
+}
 
 int32_t MvccTrxKit::max_trx_id() const { return numeric_limits<int32_t>::max(); }
 
@@ -50,9 +161,7 @@ Trx *MvccTrxKit::create_trx(LogHandler &log_handler)
 {
   Trx *trx = new MvccTrx(*this, log_handler);
   if (trx != nullptr) {
-    lock_.lock();
-    trxes_.push_back(trx);
-    lock_.unlock();
+    registry_.add(trx);
   }
   return trx;
 }
@@ -61,36 +170,27 @@ Trx *MvccTrxKit::create_trx(LogHandler &log_handler, int32_t trx_id)
 {
   Trx *trx = new MvccTrx(*this, log_handler, trx_id);
   if (trx != nullptr) {
-    lock_.lock();
-    trxes_.push_back(trx);
-    if (current_trx_id_ < trx_id) {
-      current_trx_id_ = trx_id;
-    }
-    lock_.unlock();
+    registry_.add(trx);
+    registry_.advance_trx_id(trx_id);
   }
   return trx;
 }
 
+Trx *MvccTrxKit::create_read_only_trx(LogHandler &log_handler)
+{
+  // 只读事务不需要恢复或者回滚，不用注册
+  return new MvccReadOnlyTrx(*this);
+}
+
 void MvccTrxKit::destroy_trx(Trx *trx)
 {
-  lock_.lock();
-  for (auto iter = trxes_.begin(), itend = trxes_.end(); iter != itend; ++iter) {
-    if (*iter == trx) {
-      trxes_.erase(iter);
-      break;
-    }
+  if (!trx->read_only()) {
+    registry_.remove(trx);
   }
-  lock_.unlock();
-
   delete trx;
 }
 
-void MvccTrxKit::all_trxes(vector<Trx *> &trxes)
-{
-  lock_.lock();
-  trxes = trxes_;
-  lock_.unlock();
-}
+void MvccTrxKit::all_trxes(vector<Trx *> &trxes) { registry_.all_trxes(trxes); }
 
 LogReplayer *MvccTrxKit::create_log_replayer(Db &db, LogHandler &log_handler)
 {
@@ -140,10 +240,24 @@ RC MvccTrx::delete_record(Table *table, Record &record)
   Field end_field;
   trx_fields(table, begin_field, end_field);
 
+  // 先加行锁，记录正在被其它事务修改时在这里等待，不能在访问页面时等待
+  RC rc = trx_kit_.lock_manager().lock(trx_id_, table->table_id(), record.rid());
+  if (OB_FAIL(rc)) {
+    LOG_TRACE("failed to lock record. trx id=%d, rid=%s, rc=%s", trx_id_, record.rid().to_string().c_str(), strrc(rc));
+    return rc;
+  }
+
   RC delete_result = RC::SUCCESS;
 
-  RC rc = table->visit_record(record.rid(), [this, table, &delete_result, &end_field](Record &inplace_record) -> bool {
+  rc = table->visit_record(record.rid(), [this, table, &record, &delete_result, &end_field](Record &inplace_record) -> bool {
     RC rc = this->visit_record(table, inplace_record, ReadWriteMode::READ_WRITE);
+    if (rc == RC::LOCKED_CONCURRENCY_CONFLICT && autocommit()) {
+      rc = visit_latest_version(table, inplace_record);
+      if (OB_SUCC(rc) && !same_user_data(table, record, inplace_record)) {
+        // 语句需要在最新的版本上重新检查条件
+        rc = RC::LOCKED_CONCURRENCY_CONFLICT;
+      }
+    }
     if (OB_FAIL(rc)) {
       delete_result = rc;
       return false;
@@ -158,6 +272,11 @@ RC MvccTrx::delete_record(Table *table, Record &record)
     return rc;
   }
 
+  if (delete_result == RC::RECORD_NOT_EXIST) {
+    // 等待行锁期间已经被其它事务删除了，自动提交的语句跳过这条记录
+    LOG_TRACE("record has been deleted by another trx. rid=%s", record.rid().to_string().c_str());
+    return RC::SUCCESS;
+  }
   if (OB_FAIL(delete_result)) {
     LOG_TRACE("record is not visible. rid=%s, rc=%s", record.rid().to_string().c_str(), strrc(delete_result));
     return delete_result;
@@ -178,40 +297,102 @@ RC MvccTrx::update_record(Table *table, Record &old_record, Record &new_record)
   Field end_field;
   trx_fields(table, begin_field, end_field);
 
-  RC update_result = RC::SUCCESS;
+  RC rc = trx_kit_.lock_manager().lock(trx_id_, table->table_id(), old_record.rid());
+  if (OB_FAIL(rc)) {
+    LOG_TRACE("failed to lock record. trx id=%d, rid=%s, rc=%s",
+              trx_id_, old_record.rid().to_string().c_str(), strrc(rc));
+    return rc;
+  }
 
-  // First, check if old record is visible and can be updated
-  RC rc = table->visit_record(old_record.rid(), [this, table, &update_result, &end_field, &new_record](Record &inplace_record) -> bool {
-    RC rc = this->visit_record(table, inplace_record, ReadWriteMode::READ_WRITE);
-    if (OB_FAIL(rc)) {
-      update_result = rc;
-      return false;
-    }
+  RC     update_result = RC::SUCCESS;
+  bool   new_version   = false;
+  string before_image;
+
+  // 页面上始终保存最新的版本，旧版本放到 undo 存储中，其它事务的快照需要时从版本链上读取
+  rc = table->visit_record(old_record.rid(),
+      [this, table, &update_result, &new_version, &before_image, &begin_field, &end_field, &old_record, &new_record](
+          Record &inplace_record) -> bool {
+        RC rc = this->visit_record(table, inplace_record, ReadWriteMode::READ_WRITE);
+        if (rc == RC::LOCKED_CONCURRENCY_CONFLICT && autocommit()) {
+          rc = visit_latest_version(table, inplace_record);
+          if (OB_SUCC(rc) && !same_user_data(table, old_record, inplace_record)) {
+            // 语句需要在最新的版本上重新检查条件和计算新的记录
+            rc = RC::LOCKED_CONCURRENCY_CONFLICT;
+          }
+        }
+        if (OB_FAIL(rc)) {
+          update_result = rc;
+          return false;
+        }
 
-    // Update the record data in place
-    // For MVCC, we keep the same RID but update the data
-    // The begin_xid and end_xid remain the same for now
-    // They will be updated during commit/rollback
-    memcpy(inplace_record.data(), new_record.data(), new_record.len());
-    return true;
-  });
+        // 当前事务插入或者更新过的记录，旧版本已经保存过了(或者回滚时直接删除)，不需要再保存
+        const int32_t begin_xid = begin_field.get_int(inplace_record);
+        if (begin_xid != -trx_id_) {
+          rc = trx_kit_.undo_store().push(table->table_id(), inplace_record.rid(), begin_xid, -trx_id_,
+                                          inplace_record.data(), inplace_record.len());
+          if (OB_FAIL(rc)) {
+            update_result = rc;
+            return false;
+          }
+          new_version = true;
+        }
+        before_image.assign(inplace_record.data(), inplace_record.len());
+
+        memcpy(inplace_record.data(), new_record.data(), new_record.len());
+        begin_field.set_int(inplace_record, -trx_id_);
+        end_field.set_int(inplace_record, trx_kit_.max_trx_id());
+        return true;
+      });
 
   if (OB_FAIL(rc)) {
     LOG_WARN("failed to visit record for update. rc=%s", strrc(rc));
+    if (new_version) {
+      trx_kit_.undo_store().pop(table->table_id(), old_record.rid(), -trx_id_, before_image);
+    }
     return rc;
   }
 
+  if (update_result == RC::RECORD_NOT_EXIST) {
+    LOG_TRACE("record has been deleted by another trx. rid=%s", old_record.rid().to_string().c_str());
+    return RC::SUCCESS;
+  }
   if (OB_FAIL(update_result)) {
     LOG_TRACE("record is not visible or cannot be updated. rid=%s, rc=%s", old_record.rid().to_string().c_str(), strrc(update_result));
     return update_result;
   }
 
-  // For MVCC, we log the update as a DELETE followed by an INSERT
-  // But for simplicity, we can log it as an UPDATE operation
-  // Since there's no UPDATE_RECORD log type, we'll use DELETE log for now
-  // The actual implementation depends on how the engine handles updates
-  rc = log_handler_.delete_record(trx_id_, table, old_record.rid());
-  ASSERT(rc == RC::SUCCESS, "failed to append update record log (as delete). trx id=%d, table id=%d, rid=%s, rc=%s",
+  // 先修改页面再插入索引项，清理旧版本的索引项时依赖这个顺序
+  bool index_changed = false;
+  rc = insert_index_entries(table, old_record.rid(), before_image.data(), new_record.data(), index_changed);
+  if (OB_FAIL(rc)) {
+    LOG_TRACE("failed to insert index entries of new version. rid=%s, rc=%s",
+              old_record.rid().to_string().c_str(), strrc(rc));
+    table->visit_record(old_record.rid(), [&before_image](Record &inplace_record) -> bool {
+      memcpy(inplace_record.data(), before_image.data(), before_image.size());
+      return true;
+    });
+    if (new_version) {
+      string popped_image;
+      trx_kit_.undo_store().pop(table->table_id(), old_record.rid(), -trx_id_, popped_image);
+    }
+    trx_kit_.clean_index_entries(table, old_record.rid(), new_record.data());
+    return rc;
+  }
+
+  if (index_changed) {
+    trx_kit_.undo_store().mark_index_changed(table->table_id(), old_record.rid(), trx_id_);
+    if (!new_version) {
+      // 被替换的是当前事务自己的版本，其它事务都看不到，直接删除它的索引项
+      trx_kit_.clean_index_entries(table, old_record.rid(), before_image.data());
+    }
+  }
+
+  if (!new_version) {
+    return RC::SUCCESS;
+  }
+
+  rc = log_handler_.update_record(trx_id_, table, old_record.rid(), before_image);
+  ASSERT(rc == RC::SUCCESS, "failed to append update record log. trx id=%d, table id=%d, rid=%s, rc=%s",
       trx_id_, table->table_id(), old_record.rid().to_string().c_str(), strrc(rc));
 
   operations_.push_back(Operation(Operation::Type::UPDATE, table, old_record.rid()));
@@ -219,6 +400,36 @@ RC MvccTrx::update_record(Table *table, Record &old_record, Record &new_record)
   return RC::SUCCESS;
 }
 
+RC MvccTrx::insert_index_entries(
+    Table *table, const RID &rid, const char *old_data, const char *new_data, bool &index_changed)
+{
+  index_changed = false;
+
+  const TableMeta &table_meta = table->table_meta();
+  for (int i = 0; i < table_meta.index_num(); i++) {
+    Index *index = table->find_index(table_meta.index(i)->name());
+    if (nullptr == index || index->is_vector_index()) {
+      continue;
+    }
+    if (index->key_equals(new_data, old_data + index->field_meta().offset())) {
+      continue;
+    }
+
+    index_changed = true;
+    RC rc = index->insert_entry(new_data, &rid);
+    if (rc == RC::RECORD_DUPLICATE_KEY && !index->unique() && index->has_entry(new_data, rid)) {
+      // 记录以前的版本使用过这个键值，索引项还没有清理。唯一索引在检查重复键值时已经复用了这个索引项
+      rc = RC::SUCCESS;
+    }
+    if (OB_FAIL(rc)) {
+      LOG_TRACE("failed to insert index entry. table=%s, index=%s, rid=%s, rc=%s",
+                table->name(), table_meta.index(i)->name(), rid.to_string().c_str(), strrc(rc));
+      return rc;
+    }
+  }
+  return RC::SUCCESS;
+}
+
 RC MvccTrx::visit_record(Table *table, Record &record, ReadWriteMode mode)
 {
   Field begin_field;
@@ -231,49 +442,119 @@ RC MvccTrx::visit_record(Table *table, Record &record, ReadWriteMode mode)
   RC rc = RC::SUCCESS;
   if (begin_xid > 0 && end_xid > 0) {
     if (trx_id_ >= begin_xid && trx_id_ <= end_xid) {
-      rc = RC::SUCCESS;
+      if (mode == ReadWriteMode::READ_WRITE && end_xid != trx_kit_.max_trx_id()) {
+        // 在当前事务的快照之后被其它事务删除了
+        LOG_TRACE("concurrency conflict. record has been deleted by a newer trx. trx id=%d, begin xid=%d, end xid=%d",
+                  trx_id_, begin_xid, end_xid);
+        rc = RC::LOCKED_CONCURRENCY_CONFLICT;
+      } else {
+        rc = RC::SUCCESS;
+      }
+    } else if (begin_xid > trx_id_) {
+      // 在当前事务的快照之后插入或者更新的，旧版本可能在版本链上
+      rc = visit_old_version(table, record, mode);
     } else {
       LOG_TRACE("record invisible. trx id=%d, begin xid=%d, end xid=%d", trx_id_, begin_xid, end_xid);
       rc = RC::RECORD_INVISIBLE;
     }
   } else if (begin_xid < 0) {
-    // begin xid 小于0说明是刚插入而且没有提交的数据
+    // begin xid 小于0说明是刚插入或者刚更新而且没有提交的数据
     if (-begin_xid == trx_id_) {
-      rc = RC::SUCCESS;
+      if (end_xid == -trx_id_) {
+        LOG_TRACE("record invisible. self has deleted this record. trx id=%d, begin xid=%d, end xid=%d",
+                  trx_id_, begin_xid, end_xid);
+        rc = RC::RECORD_INVISIBLE;
+      } else {
+        rc = RC::SUCCESS;
+      }
     } else {
-      LOG_TRACE("record invisible. someone is updating this record right now. trx id=%d, begin xid=%d, end xid=%d",
+      // 修改这条记录的事务持有行锁，当前事务要修改时会在加锁时等待，这里只需要返回快照中的版本
+      LOG_TRACE("someone is updating this record right now. trx id=%d, begin xid=%d, end xid=%d",
                 trx_id_, begin_xid, end_xid);
-      rc = RC::RECORD_INVISIBLE;
+      rc = visit_old_version(table, record, ReadWriteMode::READ_ONLY);
     }
   } else if (end_xid < 0) {
     // end xid 小于0 说明是正在删除但是还没有提交的数据
-    if (mode == ReadWriteMode::READ_ONLY) {
-      // 如果 -end_xid 就是当前事务的事务号，说明是当前事务删除的
-      if (-end_xid != trx_id_) {
-        rc = RC::SUCCESS;
-      } else {
-        LOG_TRACE("record invisible. self has deleted this record. trx id=%d, begin xid=%d, end xid=%d",
-                  trx_id_, begin_xid, end_xid);
-        rc = RC::RECORD_INVISIBLE;
-      }
+    // 如果 -end_xid 就是当前事务的事务号，说明是当前事务删除的。
+    // 其它事务正在删除时，与正在更新一样，当前事务要修改这条记录时在加行锁时等待对方结束
+    if (-end_xid != trx_id_ && begin_xid <= trx_id_) {
+      rc = RC::SUCCESS;
+    } else if (-end_xid != trx_id_) {
+      rc = visit_old_version(table, record, ReadWriteMode::READ_ONLY);
     } else {
-      // 如果当前想要修改此条数据，并且不是当前事务删除的，简单的报错
-      // 这是事务并发处理的一种方式，非常简单粗暴。其它的并发处理方法，可以等待，或者让客户端重试
-      // 或者等事务结束后，再检测修改的数据是否有冲突
-      if (-end_xid != trx_id_) {
-        LOG_TRACE("concurrency conflit. someone is deleting this record right now. trx id=%d, begin xid=%d, end xid=%d",
-                  trx_id_, begin_xid, end_xid);
-        rc = RC::LOCKED_CONCURRENCY_CONFLICT;
-      } else {
-        LOG_TRACE("record invisible. self has deleted this record. trx id=%d, begin xid=%d, end xid=%d",
-                  trx_id_, begin_xid, end_xid);
-        rc = RC::RECORD_INVISIBLE;
-      }
+      LOG_TRACE("record invisible. self has deleted this record. trx id=%d, begin xid=%d, end xid=%d",
+                trx_id_, begin_xid, end_xid);
+      rc = RC::RECORD_INVISIBLE;
     }
   }
   return rc;
 }
 
+RC MvccTrx::visit_old_version(Table *table, Record &record, ReadWriteMode mode)
+{
+  string data;
+  RC     rc = trx_kit_.undo_store().find(table->table_id(), record.rid(), trx_id_, data);
+  if (rc == RC::RECORD_INVISIBLE) {
+    // 没有旧版本，说明是其它事务新插入的记录
+    return rc;
+  }
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to find old version of record. table=%s, rid=%s, rc=%s",
+             table->name(), record.rid().to_string().c_str(), strrc(rc));
+    return rc;
+  }
+
+  if (mode == ReadWriteMode::READ_WRITE) {
+    // 当前事务快照中的版本已经被其它事务修改了，不能在旧版本上修改
+    LOG_TRACE("concurrency conflict. record has been updated by another trx. trx id=%d, rid=%s",
+              trx_id_, record.rid().to_string().c_str());
+    return RC::LOCKED_CONCURRENCY_CONFLICT;
+  }
+
+  return record.copy_data(data.data(), static_cast<int>(data.size()));
+}
+
+RC MvccTrx::visit_latest_version(Table *table, const Record &record) const
+{
+  Field begin_field;
+  Field end_field;
+  trx_fields(table, begin_field, end_field);
+
+  const int32_t begin_xid = begin_field.get_int(record);
+  const int32_t end_xid   = end_field.get_int(record);
+  if (begin_xid < 0 || end_xid < 0) {
+    LOG_WARN("latest version is not committed while holding row lock. trx id=%d, begin xid=%d, end xid=%d",
+             trx_id_, begin_xid, end_xid);
+    return RC::LOCKED_CONCURRENCY_CONFLICT;
+  }
+  if (end_xid != trx_kit_.max_trx_id()) {
+    return RC::RECORD_NOT_EXIST;
+  }
+
+  LOG_TRACE("modify the latest committed version. trx id=%d, rid=%s, begin xid=%d",
+            trx_id_, record.rid().to_string().c_str(), begin_xid);
+  return RC::SUCCESS;
+}
+
+RC MvccTrx::read_latest_version(Table *table, const RID &rid, Record &record)
+{
+  RC rc = table->get_record(rid, record);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to get latest version. table=%s, rid=%s, rc=%s", table->name(), rid.to_string().c_str(), strrc(rc));
+    return rc;
+  }
+  return visit_latest_version(table, record);
+}
+
+bool MvccTrx::same_user_data(Table *table, const Record &read_record, const Record &latest_record) const
+{
+  // 事务字段在记录的最前面
+  const TableMeta &table_meta = table->table_meta();
+  const int        offset     = table_meta.field(table_meta.sys_field_num())->offset();
+  return read_record.len() == latest_record.len() &&
+         memcmp(read_record.data() + offset, latest_record.data() + offset, read_record.len() - offset) == 0;
+}
+
 /**
  * @brief 获取指定表上的事务使用的字段
  *
@@ -297,7 +578,7 @@ RC MvccTrx::start_if_need()
 {
   if (!started_) {
     ASSERT(operations_.empty(), "try to start a new trx while operations is not empty");
-    trx_id_ = trx_kit_.next_trx_id();
+    trx_id_ = trx_kit_.start_trx(this);
     LOG_DEBUG("current thread change to new trx with %d", trx_id_);
     started_ = true;
   }
@@ -313,91 +594,113 @@ RC MvccTrx::commit()
 RC MvccTrx::commit_with_trx_id(int32_t commit_xid)
 {
   // TODO 原子性提交BUG：这里存在一个很大的问题，不能让其他事务一次性看到当前事务更新到的数据或同时看不到
-  RC rc    = RC::SUCCESS;
-  started_ = false;
-
+  RC         rc      = RC::SUCCESS;
+  const bool started = started_;
+  started_           = false;
+
+  // 按照表和页面排序，同一个页面上的记录只访问一次页面，修改只记录一条日志。
+  // 同一条记录上的多个操作(比如插入以后又删除)修改的是不同的字段，可以一起处理
+  vector<const Operation *> sorted_operations;
+  sorted_operations.reserve(operations_.size());
   for (const Operation &operation : operations_) {
-    switch (operation.type()) {
-      case Operation::Type::INSERT: {
-        RID    rid(operation.page_num(), operation.slot_num());
-        Table *table = operation.table();
-        Field  begin_xid_field, end_xid_field;
-        trx_fields(table, begin_xid_field, end_xid_field);
-
-        auto record_updater = [this, &begin_xid_field, commit_xid](Record &record) -> bool {
-          LOG_DEBUG("before commit insert record. trx id=%d, begin xid=%d, commit xid=%d, lbt=%s",
-                    trx_id_, begin_xid_field.get_int(record), commit_xid, lbt());
-          ASSERT(begin_xid_field.get_int(record) == -this->trx_id_ && (!recovering_), 
-                 "got an invalid record while committing. begin xid=%d, this trx id=%d", 
-                 begin_xid_field.get_int(record), trx_id_);
-
-          begin_xid_field.set_int(record, commit_xid);
-          return true;
-        };
-
-        rc = operation.table()->visit_record(rid, record_updater);
-        ASSERT(rc == RC::SUCCESS, "failed to get record while committing. rid=%s, rc=%s",
-               rid.to_string().c_str(), strrc(rc));
-      } break;
-
-      case Operation::Type::DELETE: {
-        Table *table = operation.table();
-        RID    rid(operation.page_num(), operation.slot_num());
-
-        Field begin_xid_field, end_xid_field;
-        trx_fields(table, begin_xid_field, end_xid_field);
-
-        auto record_updater = [this, &end_xid_field, commit_xid](Record &record) -> bool {
-          (void)this;
-          ASSERT(end_xid_field.get_int(record) == -trx_id_, 
-                 "got an invalid record while committing. end xid=%d, this trx id=%d", 
-                 end_xid_field.get_int(record), trx_id_);
-
-          end_xid_field.set_int(record, commit_xid);
-          return true;
-        };
+    sorted_operations.push_back(&operation);
+  }
+  stable_sort(sorted_operations.begin(), sorted_operations.end(), [](const Operation *a, const Operation *b) {
+    if (a->table_id() != b->table_id()) {
+      return a->table_id() < b->table_id();
+    }
+    if (a->page_num() != b->page_num()) {
+      return a->page_num() < b->page_num();
+    }
+    return a->slot_num() < b->slot_num();
+  });
 
-        rc = operation.table()->visit_record(rid, record_updater);
-        ASSERT(rc == RC::SUCCESS, "failed to get record while committing. rid=%s, rc=%s",
-               rid.to_string().c_str(), strrc(rc));
-      } break;
+  vector<RID> rids;
+  for (size_t begin = 0, end = 0; begin < sorted_operations.size(); begin = end) {
+    Table *table = sorted_operations[begin]->table();
+    rids.clear();
+    for (end = begin; end < sorted_operations.size() && sorted_operations[end]->table() == table; end++) {
+      RID rid(sorted_operations[end]->page_num(), sorted_operations[end]->slot_num());
+      if (rids.empty() || rids.back() != rid) {
+        rids.push_back(rid);
+      }
+    }
 
-      case Operation::Type::UPDATE: {
-        // For UPDATE, the record data has already been updated in place
-        // The begin_xid and end_xid remain the same, so no special handling is needed
-        // However, we should verify that the update was successful
-        Table *table = operation.table();
-        RID    rid(operation.page_num(), operation.slot_num());
-        
-        // Just verify the record exists and is accessible
-        Record dummy_record;
-        dummy_record.set_rid(rid);
-        rc = table->get_record(rid, dummy_record);
-        if (OB_FAIL(rc)) {
-          LOG_WARN("failed to verify updated record exists. rid=%s, rc=%s", rid.to_string().c_str(), strrc(rc));
-        }
-      } break;
+    Field begin_xid_field, end_xid_field;
+    trx_fields(table, begin_xid_field, end_xid_field);
 
-      default: {
-        ASSERT(false, "unsupported operation. type=%d", static_cast<int>(operation.type()));
+    // 记录按照 rids 的顺序访问，依次处理每条记录上的操作
+    size_t pos            = begin;
+    auto   record_updater = [&](Record &record) -> bool {
+      for (; pos < end && RID(sorted_operations[pos]->page_num(), sorted_operations[pos]->slot_num()) == record.rid();
+           pos++) {
+        commit_operation(*sorted_operations[pos], record, begin_xid_field, end_xid_field, commit_xid);
       }
-    }
+      return true;
+    };
+
+    rc = table->visit_records(rids, record_updater);
+    ASSERT(rc == RC::SUCCESS && pos == end, "failed to get records while committing. table=%s, rc=%s",
+           table->name(), strrc(rc));
   }
 
   if (!recovering_) {
-    rc = log_handler_.commit(trx_id_, commit_xid);
+    rc = log_handler_.commit(trx_id_, commit_xid, synchronous_commit());
+    trx_kit_.lock_manager().unlock_all(trx_id_);
   }
 
   operations_.clear();
+  if (started && !recovering_) {
+    trx_kit_.end_trx(this, trx_id_);
+  }
 
   LOG_TRACE("append trx commit log. trx id=%d, commit_xid=%d, rc=%s", trx_id_, commit_xid, strrc(rc));
   return rc;
 }
 
+void MvccTrx::commit_operation(
+    const Operation &operation, Record &record, Field &begin_xid_field, Field &end_xid_field, int32_t commit_xid)
+{
+  switch (operation.type()) {
+    case Operation::Type::INSERT: {
+      LOG_DEBUG("before commit insert record. trx id=%d, begin xid=%d, commit xid=%d, lbt=%s",
+                trx_id_, begin_xid_field.get_int(record), commit_xid, lbt());
+      ASSERT(begin_xid_field.get_int(record) == -this->trx_id_ && (!recovering_), 
+             "got an invalid record while committing. begin xid=%d, this trx id=%d", 
+             begin_xid_field.get_int(record), trx_id_);
+
+      begin_xid_field.set_int(record, commit_xid);
+    } break;
+
+    case Operation::Type::DELETE: {
+      ASSERT(end_xid_field.get_int(record) == -trx_id_, 
+             "got an invalid record while committing. end xid=%d, this trx id=%d", 
+             end_xid_field.get_int(record), trx_id_);
+
+      end_xid_field.set_int(record, commit_xid);
+    } break;
+
+    case Operation::Type::UPDATE: {
+      ASSERT(begin_xid_field.get_int(record) == -trx_id_,
+             "got an invalid record while committing. begin xid=%d, this trx id=%d",
+             begin_xid_field.get_int(record), trx_id_);
+
+      // 在页面锁中同时修改新版本的 begin xid 和旧版本的 end xid，读事务看到的版本链是一致的
+      trx_kit_.undo_store().commit(operation.table()->table_id(), record.rid(), trx_id_, commit_xid);
+      begin_xid_field.set_int(record, commit_xid);
+    } break;
+
+    default: {
+      ASSERT(false, "unsupported operation. type=%d", static_cast<int>(operation.type()));
+    }
+  }
+}
+
 RC MvccTrx::rollback()
 {
-  RC rc    = RC::SUCCESS;
-  started_ = false;
+  RC         rc      = RC::SUCCESS;
+  const bool started = started_;
+  started_           = false;
 
   for (auto iter = operations_.rbegin(), itend = operations_.rend(); iter != itend; ++iter) {
     const Operation &operation = *iter;
@@ -457,6 +760,44 @@ RC MvccTrx::rollback()
                rid.to_string().c_str(), strrc(rc));
       } break;
 
+      case Operation::Type::UPDATE: {
+        Table *table = operation.table();
+        RID    rid(operation.page_num(), operation.slot_num());
+
+        Field begin_xid_field, end_xid_field;
+        trx_fields(table, begin_xid_field, end_xid_field);
+
+        // 从版本链上取回旧版本覆盖页面上的记录，包括事务字段
+        string rolled_back_image;
+        auto   record_updater = [this, table, &begin_xid_field, &rolled_back_image](Record &record) -> bool {
+          if (recovering_ && begin_xid_field.get_int(record) != -trx_id_) {
+            return false;
+          }
+
+          ASSERT(begin_xid_field.get_int(record) == -trx_id_,
+                "got an invalid record while rollback. begin xid=%d, this trx id=%d",
+                begin_xid_field.get_int(record), trx_id_);
+
+          string before_image;
+          RC     rc = trx_kit_.undo_store().pop(table->table_id(), record.rid(), -trx_id_, before_image);
+          ASSERT(rc == RC::SUCCESS && static_cast<int>(before_image.size()) == record.len(),
+                 "failed to get old version while rollback. rid=%s, rc=%s",
+                 record.rid().to_string().c_str(), strrc(rc));
+          rolled_back_image.assign(record.data(), record.len());
+          memcpy(record.data(), before_image.data(), before_image.size());
+          return true;
+        };
+
+        rc = table->visit_record(rid, record_updater);
+        ASSERT(rc == RC::SUCCESS, "failed to get record while rollback. rid=%s, rc=%s",
+               rid.to_string().c_str(), strrc(rc));
+
+        // 删除回滚掉的版本插入的索引项
+        if (!rolled_back_image.empty()) {
+          trx_kit_.clean_index_entries(table, rid, rolled_back_image.data());
+        }
+      } break;
+
       default: {
         ASSERT(false, "unsupported operation. type=%d", static_cast<int>(operation.type()));
       }
@@ -467,6 +808,10 @@ RC MvccTrx::rollback()
 
   if (!recovering_) {
     rc = log_handler_.rollback(trx_id_);
+    trx_kit_.lock_manager().unlock_all(trx_id_);
+  }
+  if (started && !recovering_) {
+    trx_kit_.end_trx(this, trx_id_);
   }
   LOG_TRACE("append trx rollback log. trx id=%d, rc=%s", trx_id_, strrc(rc));
   return rc;
@@ -477,7 +822,8 @@ RC find_table(Db *db, const LogEntry &log_entry, Table *&table)
   auto *trx_log_header = reinterpret_cast<const MvccTrxLogHeader *>(log_entry.data());
   switch (MvccTrxLogOperation(trx_log_header->operation_type).type()) {
     case MvccTrxLogOperation::Type::INSERT_RECORD:
-    case MvccTrxLogOperation::Type::DELETE_RECORD: {
+    case MvccTrxLogOperation::Type::DELETE_RECORD:
+    case MvccTrxLogOperation::Type::UPDATE_RECORD: {
       auto *trx_log_record = reinterpret_cast<const MvccTrxRecordLogEntry *>(log_entry.data());
       table                = db->find_table(trx_log_record->table_id);
       if (nullptr == table) {
@@ -512,15 +858,37 @@ RC MvccTrx::redo(Db *db, const LogEntry &log_entry)
       operations_.push_back(Operation(Operation::Type::DELETE, table, trx_log_record->rid));
     } break;
 
-    case MvccTrxLogOperation::Type::COMMIT: {
-      // auto *trx_log_record = reinterpret_cast<const MvccTrxCommitLogEntry *>(log_entry.data());
-      // commit_with_trx_id(trx_log_record->commit_trx_id);
-      // 遇到了提交日志，说明前面的记录都已经提交成功了
+    case MvccTrxLogOperation::Type::UPDATE_RECORD: {
+      // 恢复时需要用旧版本回滚没有提交的更新
+      auto *trx_log_record = reinterpret_cast<const MvccTrxRecordLogEntry *>(log_entry.data());
+      const char *before_image = log_entry.data() + MvccTrxRecordLogEntry::SIZE;
+      const int   image_len    = log_entry.payload_size() - MvccTrxRecordLogEntry::SIZE;
+      rc = trx_kit_.undo_store().push(table->table_id(), trx_log_record->rid, 0 /*begin_xid*/, -trx_id_,
+                                      before_image, image_len);
+      if (OB_FAIL(rc)) {
+        LOG_WARN("failed to save old version while redo. log record=%s, rc=%s",
+                 trx_log_record->to_string().c_str(), strrc(rc));
+        return rc;
+      }
+      operations_.push_back(Operation(Operation::Type::UPDATE, table, trx_log_record->rid));
     } break;
 
+    case MvccTrxLogOperation::Type::COMMIT:
     case MvccTrxLogOperation::Type::ROLLBACK: {
-      // do nothing
-      // 遇到了回滚日志，前面的回滚操作也都执行完成了
+      if (MvccTrxLogOperation(trx_log_header->operation_type).type() == MvccTrxLogOperation::Type::COMMIT) {
+        // 页面上已经是提交的事务ID了，只读事务直接使用当前的事务ID作为快照，必须能看到这些记录
+        auto *trx_log_record = reinterpret_cast<const MvccTrxCommitLogEntry *>(log_entry.data());
+        trx_kit_.advance_trx_id(trx_log_record->commit_trx_id);
+      }
+      // 遇到了提交或回滚日志，说明前面的记录都已经提交或回滚成功了。
+      // 重做时保存的旧版本不会再有事务访问，直接丢弃
+      for (auto iter = operations_.rbegin(); iter != operations_.rend(); ++iter) {
+        if (iter->type() == Operation::Type::UPDATE) {
+          string before_image;
+          trx_kit_.undo_store().pop(
+              iter->table()->table_id(), RID(iter->page_num(), iter->slot_num()), -trx_id_, before_image);
+        }
+      }
     } break;
 
     default: {
@@ -531,3 +899,87 @@ RC MvccTrx::redo(Db *db, const LogEntry &log_entry)
 
   return RC::SUCCESS;
 }
+
+////////////////////////////////////////////////////////////////////////////////
+
+MvccReadOnlyTrx::MvccReadOnlyTrx(MvccTrxKit &kit) : Trx(TrxKit::Type::MVCC), trx_kit_(kit) {}
+
+RC MvccReadOnlyTrx::insert_record(Table *table, Record &record)
+{
+  LOG_WARN("cannot insert record in a read only trx. table=%s", table->name());
+  return RC::UNSUPPORTED;
+}
+
+RC MvccReadOnlyTrx::delete_record(Table *table, Record &record)
+{
+  LOG_WARN("cannot delete record in a read only trx. table=%s", table->name());
+  return RC::UNSUPPORTED;
+}
+
+RC MvccReadOnlyTrx::update_record(Table *table, Record &old_record, Record &new_record)
+{
+  LOG_WARN("cannot update record in a read only trx. table=%s", table->name());
+  return RC::UNSUPPORTED;
+}
+
+RC MvccReadOnlyTrx::visit_record(Table *table, Record &record, ReadWriteMode mode)
+{
+  if (mode == ReadWriteMode::READ_WRITE) {
+    LOG_WARN("cannot visit record for write in a read only trx. table=%s", table->name());
+    return RC::UNSUPPORTED;
+  }
+
+  span<const FieldMeta> trx_fields = table->table_meta().trx_fields();
+  ASSERT(trx_fields.size() >= 2, "invalid trx fields number. %d", trx_fields.size());
+  Field begin_xid_field(table, &trx_fields[0]);
+  Field end_xid_field(table, &trx_fields[1]);
+
+  const int32_t begin_xid = begin_xid_field.get_int(record);
+  const int32_t end_xid   = end_xid_field.get_int(record);
+
+  // 快照之后提交的修改，以及还没有提交的插入和更新，都要到版本链上找快照中的版本
+  bool old_version = begin_xid < 0 || begin_xid > snapshot_xid_;
+  if (!old_version) {
+    if (end_xid > 0 && end_xid <= snapshot_xid_) {
+      LOG_TRACE("record invisible. snapshot=%d, begin xid=%d, end xid=%d", snapshot_xid_, begin_xid, end_xid);
+      return RC::RECORD_INVISIBLE;
+    }
+    // 还没有提交的删除对快照没有影响
+    return RC::SUCCESS;
+  }
+
+  string data;
+  RC     rc = trx_kit_.undo_store().find(table->table_id(), record.rid(), snapshot_xid_, 0 /*self_xid*/, data);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+  return record.copy_data(data.data(), static_cast<int>(data.size()));
+}
+
+RC MvccReadOnlyTrx::start_if_need()
+{
+  if (!started_) {
+    snapshot_xid_ = trx_kit_.start_read_only_trx(this);
+    started_      = true;
+  }
+  return RC::SUCCESS;
+}
+
+RC MvccReadOnlyTrx::commit() { return end(); }
+
+RC MvccReadOnlyTrx::rollback() { return end(); }
+
+RC MvccReadOnlyTrx::end()
+{
+  if (started_) {
+    trx_kit_.end_trx(this, snapshot_xid_);
+    started_ = false;
+  }
+  return RC::SUCCESS;
+}
+
+RC MvccReadOnlyTrx::redo(Db *db, const LogEntry &log_entry)
+{
+  LOG_WARN("read only trx has no log to redo");
+  return RC::INTERNAL;
+}
@@ -16,7 +16,10 @@ See the Mulan PSL v2 for more details. */
 
 #include "common/lang/vector.h"
 #include "storage/trx/trx.h"
+#include "storage/trx/mvcc_lock_manager.h"
 #include "storage/trx/mvcc_trx_log.h"
+#include "storage/trx/mvcc_trx_registry.h"
+#include "storage/trx/mvcc_undo.h"
 
 class CLogManager;
 class LogHandler;
@@ -25,39 +28,95 @@ class MvccTrxLogHandler;
 class MvccTrxKit : public TrxKit
 {
 public:
-  MvccTrxKit() = default;
+  explicit MvccTrxKit(Db *db = nullptr) : db_(db) {}
   virtual ~MvccTrxKit();
 
   RC                       init() override;
+  Type                     type() const override { return Type::MVCC; }
   const vector<FieldMeta> *trx_fields() const override;
 
   Trx *create_trx(LogHandler &log_handler) override;
   Trx *create_trx(LogHandler &log_handler, int32_t trx_id) override;
+  Trx *create_read_only_trx(LogHandler &log_handler) override;
   void destroy_trx(Trx *trx) override;
 
   void all_trxes(vector<Trx *> &trxes) override;
 
   LogReplayer *create_log_replayer(Db &db, LogHandler &log_handler) override;
 
+  bool index_key_in_use(Table *table, const Index &index, const RID &rid, const char *key) override;
+
 public:
   int32_t next_trx_id();
 
+  /**
+   * @brief 重放日志时使用，保证之后分配的事务ID和只读事务的快照不小于已经提交的事务ID
+   */
+  void advance_trx_id(int32_t trx_id) { registry_.advance_trx_id(trx_id); }
+
+  /**
+   * @brief 为事务分配一个新的事务ID，并记录为活跃事务
+   * @details 分配和记录在同一个锁中完成，计算最老的活跃事务时不会漏掉刚开始的事务
+   */
+  int32_t start_trx(const Trx *trx);
+
+  /**
+   * @brief 只读事务开始，使用当前的事务ID作为快照，不分配新的事务ID
+   * @details 快照仍然要记录为活跃事务，清理旧版本时不会清理只读事务还要访问的版本
+   */
+  int32_t start_read_only_trx(const Trx *trx);
+
+  /**
+   * @brief 事务结束，不再是活跃事务
+   * @details 每结束 PURGE_INTERVAL 个事务清理一次 undo 存储中不再需要的旧版本
+   */
+  void end_trx(const Trx *trx, int32_t trx_id);
+
+  /**
+   * @brief 最老的活跃事务的事务ID，没有活跃事务时返回下一个事务ID
+   */
+  int32_t oldest_active_trx_id();
+
+  /**
+   * @brief 清理所有活跃事务都不会再访问的旧版本
+   * @details 清理掉的版本修改过索引字段时，同时删除不再有版本使用的索引项
+   * @return 清理的版本个数
+   */
+  int purge_undo();
+
+  /**
+   * @brief 删除记录的一个版本 stale_data 的索引项，页面上和版本链上还在使用的键值保留
+   */
+  void clean_index_entries(Table *table, const RID &rid, const char *stale_data);
+
+  MvccUndoStore &undo_store() { return undo_store_; }
+  MvccLockManager &lock_manager() { return lock_manager_; }
+
 public:
   int32_t max_trx_id() const;
 
 private:
-  vector<FieldMeta> fields_;  // 存储事务数据需要用到的字段元数据，所有表结构都需要带的
+  static constexpr int PURGE_INTERVAL = 64;
 
-  atomic<int32_t> current_trx_id_{0};
+private:
+  Db               *db_ = nullptr;  ///< 清理旧版本的索引项时查找表
+  vector<FieldMeta> fields_;  // 存储事务数据需要用到的字段元数据，所有表结构都需要带的
 
-  common::Mutex lock_;
-  vector<Trx *> trxes_;
+  MvccTrxRegistry registry_;  ///< 所有的事务对象和活跃事务
+  atomic<int>     ended_since_purge_{0};
+  MvccUndoStore   undo_store_;  ///< 被更新的记录的旧版本
+  MvccLockManager lock_manager_;  ///< 删除和更新记录时加的行锁
 };
 
 /**
  * @brief 多版本并发事务
  * @ingroup Transaction
- * TODO 没有垃圾回收
+ * @details 页面上保存记录最新的版本，更新时把旧版本放到 MvccUndoStore 中，
+ * 读操作在最新版本不可见时从版本链中找到自己快照中的版本，不会因为写操作等待或者失败。
+ * 删除和更新记录之前先加行锁(MvccLockManager)，记录正在被其它事务修改时等待它提交或回滚。
+ * 对方回滚以后可以继续修改，对方提交了说明记录在当前事务的快照之后被修改过，与在快照之后已经提交的修改一样，返回写写冲突。
+ * 自动提交的语句(autocommit)例外，最新提交的版本与语句读到的版本内容相同时直接修改最新的版本，
+ * 否则返回写写冲突，由语句调用 read_latest_version 重新检查条件和计算新的记录，再修改最新的版本。
  */
 class MvccTrx : public Trx
 {
@@ -74,6 +133,7 @@ public:
   RC insert_record(Table *table, Record &record) override;
   RC delete_record(Table *table, Record &record) override;
   RC update_record(Table *table, Record &old_record, Record &new_record) override;
+  RC read_latest_version(Table *table, const RID &rid, Record &record) override;
 
   /**
    * @brief 当访问到某条数据时，使用此函数来判断是否可见，或者是否有访问冲突
@@ -84,6 +144,8 @@ public:
    * @return RC      - SUCCESS 成功
    *                 - RECORD_INVISIBLE 此数据对当前事务不可见，应该跳过
    *                 - LOCKED_CONCURRENCY_CONFLICT 与其它事务有冲突
+   * @note 以 READ_WRITE 方式访问其它事务正在修改的记录时，返回当前事务快照中的版本，
+   * 修改之前加行锁时再等待对方结束，这里不能等待，因为调用者持有页面的锁
    */
   RC visit_record(Table *table, Record &record, ReadWriteMode mode) override;
 
@@ -97,8 +159,42 @@ public:
 
 private:
   RC   commit_with_trx_id(int32_t commit_id);
+
+  /**
+   * @brief 提交时修改一条记录上的事务字段，在页面锁中调用
+   */
+  void commit_operation(
+      const Operation &operation, Record &record, Field &begin_xid_field, Field &end_xid_field, int32_t commit_xid);
   void trx_fields(Table *table, Field &begin_xid_field, Field &end_xid_field) const;
 
+  /**
+   * @brief 读取记录时，页面上的版本对当前事务不可见，到版本链上查找
+   * @details 找到的版本复制到 record 中。写操作(READ_WRITE)时不能修改旧版本，找到就是写写冲突
+   */
+  RC visit_old_version(Table *table, Record &record, ReadWriteMode mode);
+
+  /**
+   * @brief 自动提交的语句修改记录时快照中的版本已经被其它事务修改并提交了，改为修改页面上最新提交的版本
+   * @details 调用时持有行锁，页面上的版本一定已经提交
+   * @return RC - SUCCESS 可以修改页面上的版本
+   *            - RECORD_NOT_EXIST 记录已经被其它事务删除
+   */
+  RC visit_latest_version(Table *table, const Record &record) const;
+
+  /**
+   * @brief 语句读到的版本与最新提交的版本中用户字段的值是否相同
+   * @details 相同时在最新版本上执行语句的结果与在读到的版本上执行相同，可以直接修改最新的版本
+   */
+  bool same_user_data(Table *table, const Record &read_record, const Record &latest_record) const;
+
+  /**
+   * @brief 更新记录时插入新版本的索引项
+   * @details 旧版本的索引项保留到旧版本清理时，其它事务的快照仍然可以通过索引找到旧版本。
+   * 新的键值已经有旧版本的索引项时直接使用
+   * @param[out] index_changed 是否修改了索引字段
+   */
+  RC insert_index_entries(Table *table, const RID &rid, const char *old_data, const char *new_data, bool &index_changed);
+
 private:
   static const int32_t MAX_TRX_ID = numeric_limits<int32_t>::max();
 
@@ -113,3 +209,39 @@ private:
   bool              recovering_ = false;
   OperationSet      operations_;
 };
+
+/**
+ * @brief MVCC 的只读事务
+ * @ingroup Transaction
+ * @details 自动提交的查询语句使用。开始时以当前的事务ID作为快照，不分配事务ID，
+ * 不注册事务对象，也不写日志，避免所有的查询都去竞争事务ID和事务注册表。
+ * 快照可以看到提交的事务ID不超过快照的修改，看不到任何未提交的修改。
+ */
+class MvccReadOnlyTrx : public Trx
+{
+public:
+  explicit MvccReadOnlyTrx(MvccTrxKit &trx_kit);
+  virtual ~MvccReadOnlyTrx() = default;
+
+  RC insert_record(Table *table, Record &record) override;
+  RC delete_record(Table *table, Record &record) override;
+  RC update_record(Table *table, Record &old_record, Record &new_record) override;
+  RC visit_record(Table *table, Record &record, ReadWriteMode mode) override;
+
+  RC start_if_need() override;
+  RC commit() override;
+  RC rollback() override;
+
+  RC redo(Db *db, const LogEntry &log_entry) override;
+
+  int32_t id() const override { return snapshot_xid_; }
+  bool    read_only() const override { return true; }
+
+private:
+  RC end();
+
+private:
+  MvccTrxKit &trx_kit_;
+  int32_t     snapshot_xid_ = -1;
+  bool        started_      = false;
+};
@@ -31,6 +31,7 @@ string MvccTrxLogOperation::to_string() const
     case Type::DELETE_RECORD: return ret + "DELETE_RECORD";
     case Type::COMMIT: return ret + "COMMIT";
     case Type::ROLLBACK: return ret + "ROLLBACK";
+    case Type::UPDATE_RECORD: return ret + "UPDATE_RECORD";
     default: return ret + "UNKNOWN";
   }
 }
@@ -98,7 +99,25 @@ RC MvccTrxLogHandler::delete_record(int32_t trx_id, Table *table, const RID &rid
       lsn, LogModule::Id::TRANSACTION, span<const char>(reinterpret_cast<const char *>(&log_entry), sizeof(log_entry)));
 }
 
-RC MvccTrxLogHandler::commit(int32_t trx_id, int32_t commit_trx_id)
+RC MvccTrxLogHandler::update_record(int32_t trx_id, Table *table, const RID &rid, const string &before_image)
+{
+  ASSERT(trx_id > 0, "invalid trx_id:%d", trx_id);
+
+  MvccTrxRecordLogEntry log_entry;
+  log_entry.header.operation_type = MvccTrxLogOperation(MvccTrxLogOperation::Type::UPDATE_RECORD).index();
+  log_entry.header.trx_id         = trx_id;
+  log_entry.table_id              = table->table_id();
+  log_entry.rid                   = rid;
+
+  vector<char> data(sizeof(log_entry) + before_image.size());
+  memcpy(data.data(), &log_entry, sizeof(log_entry));
+  memcpy(data.data() + sizeof(log_entry), before_image.data(), before_image.size());
+
+  LSN lsn = 0;
+  return log_handler_.append(lsn, LogModule::Id::TRANSACTION, std::move(data));
+}
+
+RC MvccTrxLogHandler::commit(int32_t trx_id, int32_t commit_trx_id, bool wait_durable)
 {
   ASSERT(trx_id > 0 && commit_trx_id > trx_id, "invalid trx_id:%d, commit_trx_id:%d", trx_id, commit_trx_id);
 
@@ -110,12 +129,11 @@ RC MvccTrxLogHandler::commit(int32_t trx_id, int32_t commit_trx_id)
   LSN lsn = 0;
   RC rc = log_handler_.append(
       lsn, LogModule::Id::TRANSACTION, span<const char>(reinterpret_cast<const char *>(&log_entry), sizeof(log_entry)));
-  if (OB_FAIL(rc)) {
+  if (OB_FAIL(rc) || !wait_durable) {
     return rc;
   }
 
   // 我们在这里粗暴的等待日志写入到磁盘
-  // 有必要的话，可以让上层来决定如何等待
   return log_handler_.wait_lsn(lsn);
 }
 
@@ -156,6 +174,7 @@ RC MvccTrxLogReplayer::replay(const LogEntry &entry)
   if (trx_iter == trx_map_.end()) {
     trx = static_cast<MvccTrx *>(trx_kit_.create_trx(log_handler_, header->trx_id));
     // trx = new MvccTrx(trx_kit_, log_handler_, header->trx_id);
+    trx_map_.emplace(header->trx_id, trx);
   } else {
     trx = trx_iter->second;
   }
@@ -166,7 +185,6 @@ RC MvccTrxLogReplayer::replay(const LogEntry &entry)
   /// 如果事务结束了，需要从内存中把它删除
   if (MvccTrxLogOperation(header->operation_type).type() == MvccTrxLogOperation::Type::ROLLBACK ||
       MvccTrxLogOperation(header->operation_type).type() == MvccTrxLogOperation::Type::COMMIT) {
-    Trx *trx = trx_map_[header->trx_id];
     trx_kit_.destroy_trx(trx);
     trx_map_.erase(header->trx_id);
   }
@@ -180,7 +198,7 @@ RC MvccTrxLogReplayer::on_done()
   for (auto &pair : trx_map_) {
     MvccTrx *trx = pair.second;
     trx->rollback(); // 恢复时的rollback，可能遇到之前已经回滚一半的事务又再次调用回滚的情况
-    delete pair.second;
+    trx_kit_.destroy_trx(trx);
   }
   trx_map_.clear();
 
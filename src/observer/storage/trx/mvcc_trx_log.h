@@ -40,7 +40,8 @@ public:
     INSERT_RECORD,  ///< 插入一条记录
     DELETE_RECORD,  ///< 删除一条记录
     COMMIT,         ///< 提交事务
-    ROLLBACK        ///< 回滚事务
+    ROLLBACK,       ///< 回滚事务
+    UPDATE_RECORD   ///< 更新一条记录
   };
 
 public:
@@ -75,6 +76,7 @@ struct MvccTrxLogHeader
  * @brief 表示事务日志中操作行数据的日志，比如插入和删除
  * @ingroup CLog
  * @details 并不记录具体的行数据。
+ * 更新记录的日志在后面跟着记录的旧版本，恢复时用来回滚没有提交的更新。
  */
 struct MvccTrxRecordLogEntry
 {
@@ -122,11 +124,18 @@ public:
    */
   RC delete_record(int32_t trx_id, Table *table, const RID &rid);
 
+  /**
+   * @brief 记录更新一条记录的日志
+   * @param before_image 记录更新前的完整数据
+   */
+  RC update_record(int32_t trx_id, Table *table, const RID &rid, const string &before_image);
+
   /**
    * @brief 记录提交事务的日志
-   * @details 会等待日志落地
+   * @param wait_durable 是否等待日志落地。不等待时，日志写入缓冲区后就返回，
+   *                     日志线程下次刷盘之前宕机会丢失这个事务
    */
-  RC commit(int32_t trx_id, int32_t commit_trx_id);
+  RC commit(int32_t trx_id, int32_t commit_trx_id, bool wait_durable = true);
 
   /**
    * @brief 记录回滚事务的日志
@@ -0,0 +1,124 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/trx/mvcc_trx_registry.h"
+#include "common/lang/algorithm.h"
+
+MvccTrxRegistry::Shard &MvccTrxRegistry::shard_of(const Trx *trx)
+{
+  // 事务对象是堆上分配的，低位基本相同，去掉以后再取模
+  return shards_[(reinterpret_cast<uintptr_t>(trx) >> 6) % SHARD_NUM];
+}
+
+const MvccTrxRegistry::Shard &MvccTrxRegistry::shard_of(const Trx *trx) const
+{
+  return shards_[(reinterpret_cast<uintptr_t>(trx) >> 6) % SHARD_NUM];
+}
+
+void MvccTrxRegistry::add(Trx *trx)
+{
+  Shard                    &shard = shard_of(trx);
+  lock_guard<common::Mutex> guard(shard.lock);
+  shard.trxes.insert(trx);
+}
+
+bool MvccTrxRegistry::remove(Trx *trx)
+{
+  Shard                    &shard = shard_of(trx);
+  lock_guard<common::Mutex> guard(shard.lock);
+  return shard.trxes.erase(trx) > 0;
+}
+
+void MvccTrxRegistry::all_trxes(vector<Trx *> &trxes) const
+{
+  trxes.clear();
+  for (const Shard &shard : shards_) {
+    lock_guard<common::Mutex> guard(shard.lock);
+    trxes.insert(trxes.end(), shard.trxes.begin(), shard.trxes.end());
+  }
+}
+
+void MvccTrxRegistry::take_all(vector<Trx *> &trxes)
+{
+  trxes.clear();
+  for (Shard &shard : shards_) {
+    lock_guard<common::Mutex> guard(shard.lock);
+    trxes.insert(trxes.end(), shard.trxes.begin(), shard.trxes.end());
+    shard.trxes.clear();
+  }
+}
+
+void MvccTrxRegistry::advance_trx_id(int32_t trx_id)
+{
+  int32_t current = current_trx_id_.load();
+  while (current < trx_id && !current_trx_id_.compare_exchange_weak(current, trx_id)) {
+  }
+}
+
+int32_t MvccTrxRegistry::begin_snapshot(const Trx *trx)
+{
+  Shard                    &shard = shard_of(trx);
+  lock_guard<common::Mutex> guard(shard.lock);
+  int32_t                   trx_id = next_trx_id();
+  shard.active_ids.push_back(trx_id);
+  return trx_id;
+}
+
+int32_t MvccTrxRegistry::begin_read_snapshot(const Trx *trx)
+{
+  Shard                    &shard = shard_of(trx);
+  lock_guard<common::Mutex> guard(shard.lock);
+  int32_t                   snapshot = current_trx_id();
+  shard.active_ids.push_back(snapshot);
+  return snapshot;
+}
+
+void MvccTrxRegistry::end_snapshot(const Trx *trx, int32_t trx_id)
+{
+  Shard                    &shard = shard_of(trx);
+  lock_guard<common::Mutex> guard(shard.lock);
+  if (shard.active_ids.empty() || shard.active_ids.front() != trx_id) {
+    shard.ended_ids.insert(trx_id);
+    return;
+  }
+
+  shard.active_ids.pop_front();
+  while (!shard.active_ids.empty()) {
+    auto iter = shard.ended_ids.find(shard.active_ids.front());
+    if (iter == shard.ended_ids.end()) {
+      break;
+    }
+    shard.ended_ids.erase(iter);
+    shard.active_ids.pop_front();
+  }
+}
+
+int32_t MvccTrxRegistry::oldest_active_trx_id() const
+{
+  // 必须先读取当前事务ID，再查看各个分片
+  int32_t oldest = current_trx_id_.load() + 1;
+  for (const Shard &shard : shards_) {
+    lock_guard<common::Mutex> guard(shard.lock);
+    if (!shard.active_ids.empty()) {
+      oldest = min(oldest, shard.active_ids.front());
+    }
+  }
+  return oldest;
+}
+
+int MvccTrxRegistry::active_count() const
+{
+  int count = 0;
+  for (const Shard &shard : shards_) {
+    lock_guard<common::Mutex> guard(shard.lock);
+    count += static_cast<int>(shard.active_ids.size() - shard.ended_ids.size());
+  }
+  return count;
+}
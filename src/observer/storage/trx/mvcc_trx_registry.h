@@ -0,0 +1,119 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/array.h"
+#include "common/lang/atomic.h"
+#include "common/lang/deque.h"
+#include "common/lang/mutex.h"
+#include "common/lang/unordered_set.h"
+#include "common/lang/vector.h"
+
+class Trx;
+
+/**
+ * @brief MVCC 的事务注册表
+ * @ingroup Transaction
+ * @details 记录所有创建的事务对象，以及正在运行的事务(活跃事务)的事务ID。
+ * 按照事务对象的地址分成 SHARD_NUM 个分片，每个分片使用自己的锁，不同的事务之间基本没有锁竞争。
+ * 注册和注销事务对象都是O(1)的。
+ *
+ * 事务ID在分片的锁中分配，并且马上记录为活跃事务，所以同一个分片中活跃事务的ID是递增的，
+ * 使用一个队列保存，队头就是分片中最老的活跃事务。结束的事务如果不在队头，先记在 ended_ids 中，
+ * 等它前面的事务都结束以后再出队，开始和结束事务也都是均摊O(1)的。
+ *
+ * 计算最老的活跃事务(水位线)时，先读取当前的事务ID，再依次查看每个分片的队头。
+ * 查看某个分片时还没有分配ID的事务，得到的ID一定大于之前读到的当前事务ID，不会被漏掉。
+ *
+ * 只读事务不分配事务ID，直接使用当前的事务ID作为快照，也放到分片的队列中，
+ * 所以队列中的ID可能重复，结束的事务使用 multiset 记录。
+ */
+class MvccTrxRegistry
+{
+public:
+  static constexpr int SHARD_NUM = 16;
+
+public:
+  MvccTrxRegistry()  = default;
+  ~MvccTrxRegistry() = default;
+
+  /**
+   * @brief 注册和注销事务对象
+   */
+  void add(Trx *trx);
+  bool remove(Trx *trx);
+
+  /**
+   * @brief 获取所有的事务对象
+   */
+  void all_trxes(vector<Trx *> &trxes) const;
+
+  /**
+   * @brief 取出所有的事务对象，注册表被清空
+   */
+  void take_all(vector<Trx *> &trxes);
+
+  /**
+   * @brief 分配下一个事务ID，不记录为活跃事务，比如提交时使用的事务ID
+   */
+  int32_t next_trx_id() { return ++current_trx_id_; }
+
+  /**
+   * @brief 至少推进到指定的事务ID，恢复时使用
+   */
+  void advance_trx_id(int32_t trx_id);
+
+  int32_t current_trx_id() const { return current_trx_id_.load(); }
+
+  /**
+   * @brief 分配一个事务ID作为事务的快照，并记录为活跃事务
+   */
+  int32_t begin_snapshot(const Trx *trx);
+
+  /**
+   * @brief 使用当前的事务ID作为只读事务的快照，并记录为活跃事务
+   * @details 不分配新的事务ID，结束时同样调用 end_snapshot
+   */
+  int32_t begin_read_snapshot(const Trx *trx);
+
+  /**
+   * @brief 事务结束，不再是活跃事务
+   * @details trx 需要与 begin_snapshot 时相同
+   */
+  void end_snapshot(const Trx *trx, int32_t trx_id);
+
+  /**
+   * @brief 最老的活跃事务的事务ID，没有活跃事务时返回下一个事务ID
+   * @details 事务ID小于这个值的已提交事务，它们的修改对所有活跃事务都是可见的
+   */
+  int32_t oldest_active_trx_id() const;
+
+  /**
+   * @brief 活跃事务的个数
+   */
+  int active_count() const;
+
+private:
+  struct alignas(64) Shard
+  {
+    mutable common::Mutex       lock;
+    unordered_set<Trx *>        trxes;
+    deque<int32_t>              active_ids;  ///< 按照事务ID递增的顺序排列，可能包含 ended_ids 中已经结束的事务
+    unordered_multiset<int32_t> ended_ids;  ///< 已经结束但是还没有出队的事务
+  };
+
+  Shard       &shard_of(const Trx *trx);
+  const Shard &shard_of(const Trx *trx) const;
+
+private:
+  atomic<int32_t>         current_trx_id_{0};
+  array<Shard, SHARD_NUM> shards_;
+};
@@ -0,0 +1,299 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <unistd.h>
+
+#include "storage/trx/mvcc_undo.h"
+#include "common/lang/atomic.h"
+#include "common/lang/filesystem.h"
+#include "common/log/log.h"
+#include "storage/persist/persist.h"
+
+MvccUndoStore::~MvccUndoStore()
+{
+  if (spill_file_) {
+    spill_file_->remove_file();
+    spill_file_.reset();
+  }
+}
+
+bool MvccUndoStore::version_visible(int32_t begin_xid, int32_t end_xid, int32_t snapshot_xid, int32_t self_xid)
+{
+  if (begin_xid <= 0 || begin_xid > snapshot_xid) {
+    return false;
+  }
+  if (end_xid < 0) {
+    // 替换它的事务还没有提交，除非就是当前事务自己
+    return -end_xid != self_xid;
+  }
+  return snapshot_xid < end_xid;
+}
+
+RC MvccUndoStore::push(int32_t table_id, const RID &rid, int32_t begin_xid, int32_t end_xid, const char *data, int len)
+{
+  MvccUndoVersion version;
+  version.begin_xid = begin_xid;
+  version.end_xid   = end_xid;
+  version.length    = len;
+
+  lock_guard<common::Mutex> guard(lock_);
+  if (memory_bytes_ + len > memory_limit_) {
+    RC rc = spill(version, data, len);
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  } else {
+    version.data.assign(data, len);
+    memory_bytes_ += len;
+  }
+
+  chains_[ChainKey{table_id, rid}].push_front(std::move(version));
+  version_count_++;
+  return RC::SUCCESS;
+}
+
+RC MvccUndoStore::pop(int32_t table_id, const RID &rid, int32_t end_xid, string &data)
+{
+  lock_guard<common::Mutex> guard(lock_);
+  auto iter = chains_.find(ChainKey{table_id, rid});
+  if (iter == chains_.end() || iter->second.empty() || iter->second.front().end_xid != end_xid) {
+    return RC::RECORD_NOT_EXIST;
+  }
+
+  VersionChain &chain = iter->second;
+  RC            rc    = load(chain.front(), data);
+  if (OB_FAIL(rc)) {
+    return rc;
+  }
+
+  release(chain.front());
+  chain.pop_front();
+  if (chain.empty()) {
+    chains_.erase(iter);
+  }
+  return RC::SUCCESS;
+}
+
+void MvccUndoStore::commit(int32_t table_id, const RID &rid, int32_t trx_id, int32_t commit_xid)
+{
+  lock_guard<common::Mutex> guard(lock_);
+  auto iter = chains_.find(ChainKey{table_id, rid});
+  if (iter == chains_.end()) {
+    return;
+  }
+
+  for (MvccUndoVersion &version : iter->second) {
+    if (version.end_xid == -trx_id) {
+      version.end_xid = commit_xid;
+      break;
+    }
+  }
+}
+
+void MvccUndoStore::mark_index_changed(int32_t table_id, const RID &rid, int32_t trx_id)
+{
+  lock_guard<common::Mutex> guard(lock_);
+  auto iter = chains_.find(ChainKey{table_id, rid});
+  if (iter == chains_.end()) {
+    return;
+  }
+
+  for (MvccUndoVersion &version : iter->second) {
+    if (version.end_xid == -trx_id) {
+      version.index_changed = true;
+      break;
+    }
+  }
+}
+
+RC MvccUndoStore::find(int32_t table_id, const RID &rid, int32_t snapshot_xid, string &data)
+{
+  return find(table_id, rid, snapshot_xid, snapshot_xid, data);
+}
+
+RC MvccUndoStore::find(int32_t table_id, const RID &rid, int32_t snapshot_xid, int32_t self_xid, string &data)
+{
+  lock_guard<common::Mutex> guard(lock_);
+  auto iter = chains_.find(ChainKey{table_id, rid});
+  if (iter == chains_.end()) {
+    return RC::RECORD_INVISIBLE;
+  }
+
+  for (const MvccUndoVersion &version : iter->second) {
+    if (version_visible(version.begin_xid, version.end_xid, snapshot_xid, self_xid)) {
+      return load(version, data);
+    }
+  }
+  return RC::RECORD_INVISIBLE;
+}
+
+RC MvccUndoStore::find_all(int32_t table_id, const RID &rid, vector<string> &datas)
+{
+  datas.clear();
+
+  lock_guard<common::Mutex> guard(lock_);
+  auto iter = chains_.find(ChainKey{table_id, rid});
+  if (iter == chains_.end()) {
+    return RC::SUCCESS;
+  }
+
+  for (const MvccUndoVersion &version : iter->second) {
+    RC rc = load(version, datas.emplace_back());
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+RC MvccUndoStore::find_uncommitted(int32_t table_id, const RID &rid, vector<string> &datas)
+{
+  datas.clear();
+
+  lock_guard<common::Mutex> guard(lock_);
+  auto iter = chains_.find(ChainKey{table_id, rid});
+  if (iter == chains_.end()) {
+    return RC::SUCCESS;
+  }
+
+  for (const MvccUndoVersion &version : iter->second) {
+    if (version.end_xid > 0) {
+      // 更旧的版本都是被已经提交的事务替换掉的
+      break;
+    }
+    RC rc = load(version, datas.emplace_back());
+    if (OB_FAIL(rc)) {
+      return rc;
+    }
+  }
+  return RC::SUCCESS;
+}
+
+int MvccUndoStore::purge(int32_t oldest_xid, vector<MvccPurgedVersion> *index_changed_versions)
+{
+  lock_guard<common::Mutex> guard(lock_);
+
+  int purged = 0;
+  for (auto iter = chains_.begin(); iter != chains_.end();) {
+    // 越旧的版本 end_xid 越小，从链表尾部开始清理。
+    // 替换操作在 oldest_xid 之前就提交了，所有活跃事务都能看到更新的版本
+    VersionChain &chain = iter->second;
+    while (!chain.empty() && chain.back().end_xid > 0 && chain.back().end_xid <= oldest_xid) {
+      if (index_changed_versions != nullptr && chain.back().index_changed) {
+        MvccPurgedVersion &purged_version = index_changed_versions->emplace_back();
+        purged_version.table_id           = iter->first.table_id;
+        purged_version.rid                = iter->first.rid;
+        if (OB_FAIL(load(chain.back(), purged_version.data))) {
+          // 读不到旧版本时只能把它的索引项留在索引中，扫描时会跳过键值与可见版本不一致的索引项
+          index_changed_versions->pop_back();
+        }
+      }
+      release(chain.back());
+      chain.pop_back();
+      purged++;
+    }
+
+    if (chain.empty()) {
+      iter = chains_.erase(iter);
+    } else {
+      ++iter;
+    }
+  }
+
+  if (spill_file_ && spill_live_ == 0) {
+    reset_spill_file();
+  }
+
+  if (purged > 0) {
+    LOG_DEBUG("purge undo versions. oldest xid=%d, purged=%d, remain=%ld", oldest_xid, purged, version_count_);
+  }
+  return purged;
+}
+
+int64_t MvccUndoStore::version_count() const
+{
+  lock_guard<common::Mutex> guard(lock_);
+  return version_count_;
+}
+
+int64_t MvccUndoStore::memory_bytes() const
+{
+  lock_guard<common::Mutex> guard(lock_);
+  return memory_bytes_;
+}
+
+int64_t MvccUndoStore::spilled_count() const
+{
+  lock_guard<common::Mutex> guard(lock_);
+  return spilled_count_;
+}
+
+RC MvccUndoStore::load(const MvccUndoVersion &version, string &data)
+{
+  if (version.spill_offset < 0) {
+    data = version.data;
+    return RC::SUCCESS;
+  }
+
+  data.resize(version.length);
+  RC rc = spill_file_->read_at(version.spill_offset, version.length, data.data());
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to read undo version from spill file. offset=%ld, length=%d, rc=%s",
+             version.spill_offset, version.length, strrc(rc));
+  }
+  return rc;
+}
+
+RC MvccUndoStore::spill(MvccUndoVersion &version, const char *data, int len)
+{
+  RC rc = RC::SUCCESS;
+  if (!spill_file_) {
+    static atomic<int> file_seq{0};
+
+    filesystem::path path = filesystem::temp_directory_path() /
+                            ("miniob_undo_" + std::to_string(getpid()) + "_" + std::to_string(file_seq++) + ".tmp");
+    spill_file_ = make_unique<PersistHandler>();
+    rc          = spill_file_->create_file(path.c_str());
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to create undo spill file. file=%s, rc=%s", path.c_str(), strrc(rc));
+      spill_file_.reset();
+      return rc;
+    }
+  }
+
+  int64_t offset = 0;
+  rc             = spill_file_->append(len, data, nullptr, &offset);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to append undo version to spill file. length=%d, rc=%s", len, strrc(rc));
+    return rc;
+  }
+
+  version.spill_offset = offset;
+  spilled_count_++;
+  spill_live_++;
+  return RC::SUCCESS;
+}
+
+void MvccUndoStore::release(MvccUndoVersion &version)
+{
+  if (version.spill_offset < 0) {
+    memory_bytes_ -= version.length;
+  } else {
+    spill_live_--;
+  }
+  version_count_--;
+}
+
+void MvccUndoStore::reset_spill_file()
+{
+  // 溢出文件只追加写入，里面的版本都清理掉以后直接删除文件，回收磁盘空间
+  spill_file_->remove_file();
+  spill_file_.reset();
+}
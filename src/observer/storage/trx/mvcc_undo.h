@@ -0,0 +1,175 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/deque.h"
+#include "common/lang/memory.h"
+#include "common/lang/mutex.h"
+#include "common/lang/string.h"
+#include "common/lang/unordered_map.h"
+#include "common/lang/vector.h"
+#include "common/sys/rc.h"
+#include "storage/record/record.h"
+
+class PersistHandler;
+
+/**
+ * @brief 记录的一个旧版本(before-image)
+ * @ingroup Transaction
+ * @details 版本的可见范围是 [begin_xid, end_xid)。end_xid 小于0表示把它替换掉的事务还没有提交，
+ * 值为替换它的事务ID的相反数，提交以后修改为提交时的事务ID。
+ */
+struct MvccUndoVersion
+{
+  int32_t begin_xid     = 0;
+  int32_t end_xid       = 0;
+  int32_t length        = 0;
+  int64_t spill_offset  = -1;     ///< 数据保存在溢出文件中时的偏移量，否则为-1
+  bool    index_changed = false;  ///< 替换它的版本修改了索引字段，清理时可能要删除它的索引项
+  string  data;                   ///< 完整的记录数据，包括事务字段
+};
+
+/**
+ * @brief 清理掉的修改过索引字段的旧版本
+ * @ingroup Transaction
+ * @details 更新索引字段时不删除旧的索引项，快照中还在使用旧版本的事务仍然可以通过索引找到它。
+ * 旧版本清理以后，如果其它版本都不再使用这个键值，再删除它的索引项
+ */
+struct MvccPurgedVersion
+{
+  int32_t table_id = 0;
+  RID     rid;
+  string  data;
+};
+
+/**
+ * @brief MVCC 的 undo 存储
+ * @ingroup Transaction
+ * @details 更新记录时，记录的旧版本保存在这里，页面上始终是最新的版本。
+ * 每条记录的旧版本按照从新到旧的顺序组成一个版本链，使用表ID和RID查找。
+ * 读事务在页面上的版本不可见时，沿着版本链找到自己快照中的版本，不需要等待或者中止；
+ * 写事务回滚时从版本链上取回旧版本。
+ * 旧版本的数据默认保存在内存中，超过内存上限以后写入临时的溢出文件。
+ * 所有活跃事务都能看到页面上的版本(或者更新的版本)时，旧版本就不会再被访问，由 purge 清理。
+ */
+class MvccUndoStore
+{
+public:
+  static constexpr int64_t DEFAULT_MEMORY_LIMIT = 64 * 1024 * 1024;
+
+public:
+  MvccUndoStore() = default;
+  ~MvccUndoStore();
+
+  /**
+   * @brief 设置旧版本在内存中最多占用的空间，超过以后的版本写入溢出文件
+   */
+  void set_memory_limit(int64_t bytes) { memory_limit_ = bytes; }
+
+  /**
+   * @brief 保存记录的旧版本，作为版本链上最新的版本
+   * @param end_xid 正在修改记录的事务ID的相反数
+   */
+  RC push(int32_t table_id, const RID &rid, int32_t begin_xid, int32_t end_xid, const char *data, int len);
+
+  /**
+   * @brief 取回并删除版本链上最新的版本，用于回滚
+   * @details 只有最新版本的 end_xid 与参数相同时才会删除，否则返回 RECORD_NOT_EXIST
+   */
+  RC pop(int32_t table_id, const RID &rid, int32_t end_xid, string &data);
+
+  /**
+   * @brief 事务提交时，把它替换掉的版本的 end_xid 修改为提交的事务ID
+   */
+  void commit(int32_t table_id, const RID &rid, int32_t trx_id, int32_t commit_xid);
+
+  /**
+   * @brief 事务 trx_id 修改了记录的索引字段，标记它替换掉的版本
+   */
+  void mark_index_changed(int32_t table_id, const RID &rid, int32_t trx_id);
+
+  /**
+   * @brief 在版本链上查找对快照 snapshot_xid 可见的版本
+   * @details 读写事务的快照就是它自己的事务ID
+   * @return 找不到时返回 RECORD_INVISIBLE
+   */
+  RC find(int32_t table_id, const RID &rid, int32_t snapshot_xid, string &data);
+
+  /**
+   * @brief 在版本链上查找对快照 snapshot_xid 可见的版本
+   * @param self_xid 当前事务的事务ID，这个事务自己正在修改的版本不可见。只读事务没有事务ID，使用0
+   */
+  RC find(int32_t table_id, const RID &rid, int32_t snapshot_xid, int32_t self_xid, string &data);
+
+  /**
+   * @brief 取出版本链上所有版本的数据，从新到旧
+   */
+  RC find_all(int32_t table_id, const RID &rid, vector<string> &datas);
+
+  /**
+   * @brief 取出被还没有提交的事务替换掉的版本的数据
+   * @details 替换它的事务回滚时，这些版本会重新回到页面上
+   */
+  RC find_uncommitted(int32_t table_id, const RID &rid, vector<string> &datas);
+
+  /**
+   * @brief 清理不会再被访问的旧版本
+   * @param oldest_xid 最老的活跃事务的事务ID，提交时间不晚于它的替换操作所替换的版本都可以清理
+   * @param[out] index_changed_versions 不为空时返回清理掉的修改过索引字段的版本
+   * @return 清理的版本个数
+   */
+  int purge(int32_t oldest_xid, vector<MvccPurgedVersion> *index_changed_versions = nullptr);
+
+  /**
+   * @brief 判断版本 [begin_xid, end_xid) 对事务 self_xid 的快照 snapshot_xid 是否可见
+   */
+  static bool version_visible(int32_t begin_xid, int32_t end_xid, int32_t snapshot_xid, int32_t self_xid);
+
+  int64_t version_count() const;
+  int64_t memory_bytes() const;
+  int64_t spilled_count() const;
+
+private:
+  struct ChainKey
+  {
+    int32_t table_id;
+    RID     rid;
+
+    bool operator==(const ChainKey &other) const { return table_id == other.table_id && rid == other.rid; }
+  };
+
+  struct ChainKeyHash
+  {
+    size_t operator()(const ChainKey &key) const
+    {
+      return (static_cast<size_t>(key.table_id) << 48) ^ (static_cast<size_t>(key.rid.page_num) << 16) ^
+             static_cast<size_t>(key.rid.slot_num);
+    }
+  };
+
+  /// 版本链，最新的版本在最前面
+  using VersionChain = deque<MvccUndoVersion>;
+
+  RC   load(const MvccUndoVersion &version, string &data);
+  RC   spill(MvccUndoVersion &version, const char *data, int len);
+  void release(MvccUndoVersion &version);
+  void reset_spill_file();
+
+private:
+  mutable common::Mutex                               lock_;
+  unordered_map<ChainKey, VersionChain, ChainKeyHash> chains_;
+  int64_t                                             version_count_ = 0;
+  int64_t                                             memory_bytes_  = 0;
+  int64_t                                             memory_limit_  = DEFAULT_MEMORY_LIMIT;
+  int64_t                                             spilled_count_ = 0;  ///< 写入过溢出文件的版本个数
+  int64_t                                             spill_live_    = 0;  ///< 溢出文件中还在使用的版本个数
+  unique_ptr<PersistHandler>                          spill_file_;
+};
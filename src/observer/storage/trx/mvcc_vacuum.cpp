@@ -0,0 +1,261 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "storage/trx/mvcc_vacuum.h"
+#include "common/lang/algorithm.h"
+#include "common/lang/chrono.h"
+#include "common/lang/sstream.h"
+#include "common/lang/vector.h"
+#include "common/log/log.h"
+#include "common/thread/thread_util.h"
+#include "storage/db/db.h"
+#include "storage/field/field.h"
+#include "storage/record/page_morsel.h"
+#include "storage/record/record_scanner.h"
+#include "storage/table/table.h"
+#include "storage/trx/mvcc_trx.h"
+
+static atomic<int> default_interval_ms_{MvccVacuum::DEFAULT_INTERVAL_MS};
+static atomic<int> default_pages_per_second_{MvccVacuum::DEFAULT_PAGES_PER_SECOND};
+
+string MvccVacuumStats::to_string() const
+{
+  stringstream ss;
+  ss << "passes:" << passes << ", pages_scanned:" << pages_scanned << ", records_removed:" << records_removed
+     << ", undo_purged:" << undo_purged << ", watermark:" << watermark;
+  return ss.str();
+}
+
+void MvccVacuum::set_default_interval_ms(int interval_ms) { default_interval_ms_ = max(interval_ms, 0); }
+int  MvccVacuum::default_interval_ms() { return default_interval_ms_; }
+void MvccVacuum::set_default_pages_per_second(int pages) { default_pages_per_second_ = max(pages, 1); }
+int  MvccVacuum::default_pages_per_second() { return default_pages_per_second_; }
+
+MvccVacuum::MvccVacuum(Db &db, MvccTrxKit &trx_kit)
+    : db_(db),
+      trx_kit_(trx_kit),
+      interval_ms_(default_interval_ms_),
+      pages_per_second_(default_pages_per_second_)
+{}
+
+MvccVacuum::~MvccVacuum() { stop(); }
+
+RC MvccVacuum::start()
+{
+  if (thread_) {
+    LOG_ERROR("vacuum has been started");
+    return RC::INTERNAL;
+  }
+  if (interval_ms_ <= 0) {
+    LOG_INFO("vacuum is disabled");
+    return RC::SUCCESS;
+  }
+
+#ifndef CONCURRENCY
+  // 没有 CONCURRENCY 编译选项时页面和表上的锁都不生效，不能在后台线程中修改数据
+  LOG_INFO("vacuum thread is disabled because CONCURRENCY is off");
+  return RC::SUCCESS;
+#endif
+
+  running_.store(true);
+  thread_ = make_unique<thread>(&MvccVacuum::thread_func, this);
+  LOG_INFO("vacuum started. interval=%dms, pages per second=%d", interval_ms_, pages_per_second_);
+  return RC::SUCCESS;
+}
+
+RC MvccVacuum::stop()
+{
+  if (!thread_) {
+    return RC::SUCCESS;
+  }
+
+  {
+    lock_guard<mutex> guard(wait_lock_);
+    running_.store(false);
+  }
+  wait_cond_.notify_all();
+
+  thread_->join();
+  thread_.reset();
+  LOG_INFO("vacuum stopped. %s", stats().to_string().c_str());
+  return RC::SUCCESS;
+}
+
+void MvccVacuum::thread_func()
+{
+  common::thread_set_name("Vacuum");
+
+  const int page_budget = max(1, static_cast<int>(static_cast<int64_t>(pages_per_second_) * interval_ms_ / 1000));
+  while (running_.load()) {
+    {
+      unique_lock<mutex> lock(wait_lock_);
+      wait_cond_.wait_for(lock, chrono::milliseconds(interval_ms_), [this] { return !running_.load(); });
+    }
+    if (!running_.load()) {
+      break;
+    }
+
+    int pages_scanned = 0;
+    RC  rc            = run_once(page_budget, pages_scanned);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to vacuum. rc=%s", strrc(rc));
+    }
+  }
+}
+
+RC MvccVacuum::run_once(int page_budget, int &pages_scanned)
+{
+  pages_scanned = 0;
+
+  const int32_t watermark = trx_kit_.oldest_active_trx_id();
+  watermark_.store(watermark);
+  // 同时删除清理掉的旧版本不再使用的索引项，要在删除记录之前，避免记录位置被重用以后留下旧的索引项
+  undo_purged_ += trx_kit_.purge_undo();
+
+  lock_guard<common::Mutex> guard(table_lock_);
+
+  vector<string> table_names;
+  db_.all_tables(table_names);
+  vector<Table *> tables;
+  for (const string &table_name : table_names) {
+    Table *table = db_.find_table(table_name.c_str());
+    if (table != nullptr) {
+      tables.push_back(table);
+    }
+  }
+  sort(tables.begin(), tables.end(), [](Table *a, Table *b) { return a->table_id() < b->table_id(); });
+
+  // 从上一轮停下的表开始，所有表最多访问一遍
+  auto start = find_if(tables.begin(), tables.end(), [this](Table *t) { return t->table_id() >= next_table_id_; });
+  rotate(tables.begin(), start, tables.end());
+
+  RC rc = RC::SUCCESS;
+  for (Table *table : tables) {
+    next_table_id_ = table->table_id();
+    if (pages_scanned >= page_budget) {
+      break;
+    }
+
+    int  table_pages = 0;
+    bool finished    = false;
+    rc = vacuum_table(table, watermark, page_budget - pages_scanned, table_pages, finished);
+    pages_scanned += table_pages;
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to vacuum table. table=%s, rc=%s", table->name(), strrc(rc));
+      finished = true;
+    }
+    if (!finished) {
+      break;
+    }
+    next_table_id_ = table->table_id() + 1;
+  }
+
+  passes_++;
+  pages_scanned_ += pages_scanned;
+  return rc;
+}
+
+RC MvccVacuum::vacuum_table(Table *table, int32_t watermark, int page_budget, int &pages_scanned, bool &finished)
+{
+  pages_scanned = 0;
+  finished      = false;
+
+  shared_ptr<PageMorselQueue> all_pages;
+  RC                          rc = table->create_morsel_queue(all_pages);
+  if (OB_FAIL(rc)) {
+    // 不是堆表，比如LSM表，不需要清理
+    finished = true;
+    return RC::SUCCESS;
+  }
+
+  PageNum &cursor   = cursors_.emplace(table->table_id(), 1).first->second;
+  PageNum  end_page = all_pages->end_page();
+  if (cursor >= end_page) {
+    cursor   = 1;
+    finished = true;
+    return RC::SUCCESS;
+  }
+
+  const PageNum batch_end = min(end_page, static_cast<PageNum>(cursor + page_budget));
+  auto          morsels   = make_shared<PageMorselQueue>(cursor, batch_end, batch_end - cursor);
+
+  // 扫描时持有页面的锁，先把要删除的记录复制出来，扫描结束以后再删除
+  RecordScanner *scanner = nullptr;
+  rc = table->get_parallel_record_scanner(scanner, nullptr /*trx*/, ReadWriteMode::READ_ONLY, morsels);
+  if (OB_FAIL(rc)) {
+    LOG_WARN("failed to create scanner. table=%s, rc=%s", table->name(), strrc(rc));
+    return rc;
+  }
+
+  vector<Record> dead_records;
+  Record         record;
+  while (OB_SUCC(rc = scanner->next(record))) {
+    if (is_dead(table, record, watermark)) {
+      Record &dead = dead_records.emplace_back();
+      dead.copy_data(record.data(), record.len());
+      dead.set_rid(record.rid());
+    }
+  }
+  delete scanner;
+  if (rc != RC::RECORD_EOF) {
+    LOG_WARN("failed to scan table. table=%s, rc=%s", table->name(), strrc(rc));
+    return rc;
+  }
+
+  // 删除操作已经对所有事务可见，记录不会再被任何事务修改，可以直接删除
+  for (const Record &dead : dead_records) {
+    rc = table->delete_record(dead);
+    if (OB_FAIL(rc)) {
+      LOG_WARN("failed to remove dead record. table=%s, rid=%s, rc=%s",
+               table->name(), dead.rid().to_string().c_str(), strrc(rc));
+      return rc;
+    }
+  }
+
+  if (!dead_records.empty()) {
+    LOG_DEBUG("vacuum table. table=%s, pages=[%d, %d), removed=%d",
+              table->name(), cursor, batch_end, static_cast<int>(dead_records.size()));
+  }
+  records_removed_ += dead_records.size();
+  pages_scanned = batch_end - cursor;
+  cursor        = batch_end;
+  if (cursor >= end_page) {
+    cursor   = 1;
+    finished = true;
+  }
+  return RC::SUCCESS;
+}
+
+bool MvccVacuum::is_dead(Table *table, const Record &record, int32_t watermark) const
+{
+  span<const FieldMeta> trx_fields = table->table_meta().trx_fields();
+  if (trx_fields.size() < 2) {
+    return false;
+  }
+
+  Field begin_xid_field(table, &trx_fields[0]);
+  Field end_xid_field(table, &trx_fields[1]);
+
+  // 插入和删除都已经提交，并且删除在所有活跃事务开始之前提交
+  const int32_t begin_xid = begin_xid_field.get_int(record);
+  const int32_t end_xid   = end_xid_field.get_int(record);
+  return begin_xid > 0 && end_xid > 0 && end_xid != trx_kit_.max_trx_id() && end_xid < watermark;
+}
+
+MvccVacuumStats MvccVacuum::stats() const
+{
+  MvccVacuumStats stats;
+  stats.passes          = passes_.load();
+  stats.pages_scanned   = pages_scanned_.load();
+  stats.records_removed = records_removed_.load();
+  stats.undo_purged     = undo_purged_.load();
+  stats.watermark       = watermark_.load();
+  return stats;
+}
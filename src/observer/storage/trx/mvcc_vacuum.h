@@ -0,0 +1,131 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#pragma once
+
+#include "common/lang/atomic.h"
+#include "common/lang/condition_variable.h"
+#include "common/lang/memory.h"
+#include "common/lang/mutex.h"
+#include "common/lang/string.h"
+#include "common/lang/thread.h"
+#include "common/lang/unordered_map.h"
+#include "common/sys/rc.h"
+#include "common/types.h"
+
+class Db;
+class Table;
+class Record;
+class MvccTrxKit;
+
+/**
+ * @brief 清理线程的统计信息
+ * @ingroup Transaction
+ */
+struct MvccVacuumStats
+{
+  int64_t passes          = 0;  ///< 执行的轮数
+  int64_t pages_scanned   = 0;  ///< 扫描过的数据页面个数
+  int64_t records_removed = 0;  ///< 物理删除的记录条数
+  int64_t undo_purged     = 0;  ///< 清理的旧版本个数
+  int32_t watermark       = 0;  ///< 最近一轮使用的水位线(最老的活跃事务ID)
+
+  string to_string() const;
+};
+
+/**
+ * @brief MVCC 的后台清理(vacuum)
+ * @ingroup Transaction
+ * @details 事务删除记录时只是把 end xid 设置为提交时的事务ID，记录仍然留在页面上，
+ * 扫描时还要读取并判断可见性，页面空间也不会释放。
+ * 删除操作在最老的活跃事务之前提交时，所有事务(包括以后开始的事务)都看不到这条记录了，
+ * 清理线程把这样的记录连同索引项一起物理删除，页面的空闲空间记录到空闲空间映射中，之后插入时可以重用。
+ * 同时清理 undo 存储中不再需要的旧版本，以及只有这些旧版本使用的索引项。
+ *
+ * 清理按照页面个数限制IO：每 interval_ms 毫秒执行一轮，一轮最多扫描 pages_per_second * interval_ms / 1000 个页面，
+ * 每张表记录扫描到的位置，下一轮从这里继续，扫描到文件末尾以后从头开始。
+ * 后台线程依赖页面和表上的锁，只有在 CONCURRENCY 编译模式下才会启动。
+ */
+class MvccVacuum
+{
+public:
+  static constexpr int DEFAULT_INTERVAL_MS      = 1000;
+  static constexpr int DEFAULT_PAGES_PER_SECOND = 1024;
+
+  /**
+   * @brief 设置清理的间隔和速度，之后创建的清理线程使用
+   * @details 间隔为0时不启动清理线程，可以手动调用 run_once
+   */
+  static void set_default_interval_ms(int interval_ms);
+  static int  default_interval_ms();
+  static void set_default_pages_per_second(int pages);
+  static int  default_pages_per_second();
+
+public:
+  MvccVacuum(Db &db, MvccTrxKit &trx_kit);
+  ~MvccVacuum();
+
+  /**
+   * @brief 启动清理线程
+   */
+  RC start();
+
+  /**
+   * @brief 停止清理线程，等待线程结束
+   */
+  RC stop();
+
+  /**
+   * @brief 执行一轮清理
+   * @param page_budget 最多扫描的页面个数
+   * @param[out] pages_scanned 实际扫描的页面个数，小于 page_budget 表示所有表都扫描了一遍
+   */
+  RC run_once(int page_budget, int &pages_scanned);
+
+  MvccVacuumStats stats() const;
+
+  /**
+   * @brief 创建和删除表时需要加这把锁，避免清理线程访问已经删除的表
+   */
+  common::Mutex &table_lock() { return table_lock_; }
+
+private:
+  void thread_func();
+
+  /**
+   * @brief 清理一张表，从上次停下的页面开始
+   * @param[out] finished 是否已经扫描到文件末尾
+   */
+  RC vacuum_table(Table *table, int32_t watermark, int page_budget, int &pages_scanned, bool &finished);
+
+  bool is_dead(Table *table, const Record &record, int32_t watermark) const;
+
+private:
+  Db         &db_;
+  MvccTrxKit &trx_kit_;
+
+  int interval_ms_;
+  int pages_per_second_;
+
+  unique_ptr<thread> thread_;
+  atomic_bool        running_{false};
+  mutex              wait_lock_;
+  condition_variable wait_cond_;
+
+  common::Mutex                   table_lock_;
+  unordered_map<int32_t, PageNum> cursors_;            ///< 每张表下次开始扫描的页面
+  int32_t                         next_table_id_ = 0;  ///< 下一轮从这张表开始
+
+  atomic<int64_t> passes_{0};
+  atomic<int64_t> pages_scanned_{0};
+  atomic<int64_t> records_removed_{0};
+  atomic<int64_t> undo_purged_{0};
+  atomic<int32_t> watermark_{0};
+};
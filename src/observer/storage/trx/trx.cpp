@@ -29,7 +29,7 @@ TrxKit *TrxKit::create(const char *name, Db* db)
   if (common::is_blank(name) || 0 == strcasecmp(name, "vacuous")) {
     trx_kit = new VacuousTrxKit();
   } else if (0 == strcasecmp(name, "mvcc")) {
-    trx_kit = new MvccTrxKit();
+    trx_kit = new MvccTrxKit(db);
   } else if (0 == strcasecmp(name, "lsm")) {
     trx_kit = new LsmMvccTrxKit(db);
   } else {
@@ -34,6 +34,7 @@ class LogHandler;
 class LogEntry;
 class Trx;
 class LogReplayer;
+class Index;
 
 /**
  * @brief 描述一个操作，比如插入、删除行等
@@ -115,6 +116,7 @@ public:
   virtual ~TrxKit() = default;
 
   virtual RC                       init()             = 0;
+  virtual Type                     type() const       = 0;
   virtual const vector<FieldMeta> *trx_fields() const = 0;
 
   virtual Trx *create_trx(LogHandler &log_handler) = 0;
@@ -123,12 +125,25 @@ public:
    * @brief 创建一个事务，日志回放时使用
    */
   virtual Trx *create_trx(LogHandler &log_handler, int32_t trx_id) = 0;
+
+  /**
+   * @brief 创建一个只读事务，自动提交的查询语句使用
+   * @details 只读事务不能修改数据。不支持只读事务的事务管理器创建普通的事务
+   */
+  virtual Trx *create_read_only_trx(LogHandler &log_handler) { return create_trx(log_handler); }
   virtual void all_trxes(vector<Trx *> &trxes)                     = 0;
 
   virtual void destroy_trx(Trx *trx) = 0;
 
   virtual LogReplayer *create_log_replayer(Db &db, LogHandler &log_handler) = 0;
 
+  /**
+   * @brief 记录 rid 是否还在使用索引 index 的键值 key
+   * @details 唯一索引检查重复键值时使用。更新索引字段以后旧的索引项保留到旧版本清理时，
+   * 这些索引项不算重复的键值。不保留旧版本的事务管理器认为所有的索引项都在使用
+   */
+  virtual bool index_key_in_use(Table *table, const Index &index, const RID &rid, const char *key) { return true; }
+
 public:
   static TrxKit *create(const char *name, Db *db);
 };
@@ -148,6 +163,15 @@ public:
   virtual RC update_record(Table *table, Record &old_record, Record &new_record) = 0;
   virtual RC visit_record(Table *table, Record &record, ReadWriteMode mode)      = 0;
 
+  /**
+   * @brief 读取记录最新提交的版本
+   * @details 自动提交的语句修改记录时返回了写写冲突，说明语句读到的版本已经被其它事务修改并提交，
+   * 语句使用最新的版本重新检查条件，再修改最新的版本。调用时当前事务已经持有这条记录的行锁
+   * @return RC - SUCCESS 最新版本复制到 record 中
+   *            - RECORD_NOT_EXIST 记录已经被其它事务删除
+   */
+  virtual RC read_latest_version(Table *table, const RID &rid, Record &record) { return RC::UNSUPPORTED; }
+
   virtual RC start_if_need() = 0;
   virtual RC commit()        = 0;
   virtual RC rollback()      = 0;
@@ -157,6 +181,25 @@ public:
   virtual int32_t id() const = 0;
   TrxKit::Type    type() const { return type_; }
 
+  virtual bool read_only() const { return false; }
+
+  /**
+   * @brief 提交时是否等待日志落地
+   * @details 关闭以后提交日志写入日志缓冲区就返回，宕机时可能丢失最近一次刷盘之后提交的事务，
+   * 但不会破坏数据的一致性
+   */
+  void set_synchronous_commit(bool synchronous_commit) { synchronous_commit_ = synchronous_commit; }
+  bool synchronous_commit() const { return synchronous_commit_; }
+
+  /**
+   * @brief 是否单语句自动提交的事务
+   * @details 自动提交的语句按照读已提交处理，等待行锁以后在最新提交的版本上重新检查条件并修改，见 read_latest_version
+   */
+  void set_autocommit(bool autocommit) { autocommit_ = autocommit; }
+  bool autocommit() const { return autocommit_; }
+
 private:
   TrxKit::Type type_;
+  bool         synchronous_commit_ = true;
+  bool         autocommit_         = false;
 };
@@ -26,6 +26,7 @@ public:
   virtual ~VacuousTrxKit() = default;
 
   RC                       init() override;
+  Type                     type() const override { return Type::VACUOUS; }
   const vector<FieldMeta> *trx_fields() const override;
 
   Trx *create_trx(LogHandler &log_handler) override;
@@ -20,6 +20,7 @@ See the Mulan PSL v2 for more details. */
 #include "storage/buffer/buffer_pool_log.h"
 #include "storage/record/record_log.h"
 #include "storage/index/bplus_tree_log_entry.h"
+#include "storage/index/extendible_hash_log.h"
 #include "storage/trx/mvcc_trx_log.h"
 #include "common/lang/serializer.h"
 
@@ -57,6 +58,16 @@ public:
         ss << BplusTreeLogger::log_entry_to_string(entry);
       } break;
 
+      case LogModule::Id::HASH_INDEX: {
+        if (entry.payload_size() < ExtendibleHashLogHeader::SIZE) {
+          ss << "invalid hash index log entry. "
+             << "payload size = " << entry.payload_size() << ", expected size = " << ExtendibleHashLogHeader::SIZE;
+        } else {
+          auto *hash_log_header = reinterpret_cast<const ExtendibleHashLogHeader *>(entry.data());
+          ss << hash_log_header->to_string();
+        }
+      } break;
+
       case LogModule::Id::TRANSACTION: {
         auto *header = reinterpret_cast<const MvccTrxLogHeader *>(entry.data());
 
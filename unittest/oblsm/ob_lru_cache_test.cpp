@@ -10,6 +10,7 @@ See the Mulan PSL v2 for more details. */
 
 #include "gtest/gtest.h"
 
+#include "common/lang/memory.h"
 #include "common/lang/string.h"
 #include "common/lang/vector.h"
 #include "common/lang/thread.h"
@@ -33,7 +34,7 @@ protected:
   }
 };
 
-TEST_P(ObLRUCacheTest, DISABLED_lru_capacity) {
+TEST_P(ObLRUCacheTest, lru_capacity) {
   ASSERT_NE(cache, nullptr);
 
   for (size_t i = 0; i < capacity + 2; ++i) {
@@ -54,7 +55,7 @@ TEST_P(ObLRUCacheTest, DISABLED_lru_capacity) {
   }
 }
 
-TEST_P(ObLRUCacheTest, DISABLED_update_exist_key) {
+TEST_P(ObLRUCacheTest, update_exist_key) {
   ASSERT_NE(cache, nullptr);
 
   cache->put("key1", "value1");
@@ -70,7 +71,7 @@ TEST_P(ObLRUCacheTest, DISABLED_update_exist_key) {
   EXPECT_EQ(value, "value2");
 }
 
-TEST_P(ObLRUCacheTest, DISABLED_contains_key) {
+TEST_P(ObLRUCacheTest, contains_key) {
     ASSERT_NE(cache, nullptr);
 
     cache->put("key1", "value1");
@@ -98,6 +99,93 @@ TEST(lru_test, zero_capacity)
   ASSERT_FALSE(lru_cache.contains(1));
 }
 
+TEST(lru_test, charge)
+{
+  ObLRUCache<int, string> lru_cache(100);
+  lru_cache.put(1, "one", 40);
+  lru_cache.put(2, "two", 40);
+  ASSERT_EQ(lru_cache.usage(), 80);
+
+  // 1 becomes the most recently used one, 2 is evicted
+  string value;
+  ASSERT_TRUE(lru_cache.get(1, value));
+  lru_cache.put(3, "three", 40);
+  ASSERT_TRUE(lru_cache.contains(1));
+  ASSERT_FALSE(lru_cache.contains(2));
+  ASSERT_TRUE(lru_cache.contains(3));
+  ASSERT_EQ(lru_cache.usage(), 80);
+
+  // update with a new charge
+  lru_cache.put(3, "three", 10);
+  ASSERT_EQ(lru_cache.usage(), 50);
+
+  // larger than the capacity, not cached
+  lru_cache.put(4, "four", 101);
+  ASSERT_FALSE(lru_cache.contains(4));
+  ASSERT_EQ(lru_cache.usage(), 50);
+
+  ASSERT_FALSE(lru_cache.get(2, value));
+  ASSERT_EQ(lru_cache.hit_count(), 1);
+  ASSERT_EQ(lru_cache.miss_count(), 1);
+}
+
+TEST(lru_test, shards)
+{
+  const size_t              capacity = 1024;
+  ObLRUCache<uint64_t, int> lru_cache(capacity, 4);
+  ASSERT_EQ(lru_cache.shard_count(), 16);
+
+  for (uint64_t i = 0; i < capacity * 4; i++) {
+    lru_cache.put(i, static_cast<int>(i));
+    ASSERT_LE(lru_cache.usage(), capacity);
+  }
+  // sequential keys are spread over all shards, every shard is full
+  ASSERT_EQ(lru_cache.usage(), capacity);
+
+  int hits = 0;
+  for (uint64_t i = 0; i < capacity * 4; i++) {
+    int value = 0;
+    if (lru_cache.get(i, value)) {
+      ASSERT_EQ(value, static_cast<int>(i));
+      hits++;
+    }
+  }
+  ASSERT_EQ(hits, static_cast<int>(capacity));
+  ASSERT_EQ(lru_cache.hit_count(), capacity);
+  ASSERT_EQ(lru_cache.miss_count(), capacity * 3);
+}
+
+TEST(lru_test, concurrent)
+{
+  const int                                thread_num = 8;
+  const int                                key_num    = 2000;
+  ObLRUCache<uint64_t, shared_ptr<string>> lru_cache(key_num / 2 * 16, 4);
+
+  vector<thread> threads;
+  for (int t = 0; t < thread_num; t++) {
+    threads.emplace_back([&lru_cache, t] {
+      for (int n = 0; n < 10; n++) {
+        for (uint64_t i = 0; i < key_num; i++) {
+          const uint64_t     key = (i * 7 + t) % key_num;
+          shared_ptr<string> value;
+          if (lru_cache.get(key, value)) {
+            EXPECT_EQ(*value, to_string(key));
+          } else {
+            auto new_value = make_shared<string>(to_string(key));
+            lru_cache.put(key, new_value, 16);
+          }
+        }
+      }
+    });
+  }
+  for (auto &th : threads) {
+    th.join();
+  }
+
+  ASSERT_LE(lru_cache.usage(), lru_cache.capacity());
+  ASSERT_EQ(lru_cache.hit_count() + lru_cache.miss_count(), static_cast<uint64_t>(thread_num * 10 * key_num));
+}
+
 int main(int argc, char **argv)
 {
   ::testing::InitGoogleTest(&argc, argv);
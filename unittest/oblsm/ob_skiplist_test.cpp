@@ -31,7 +31,7 @@ struct Comparator {
   }
 };
 
-TEST(skiplist_test, DISABLED_skiplist_test_basic)
+TEST(skiplist_test, skiplist_test_basic)
 {
   common::RandomGenerator rnd;
   const int N = 2000;
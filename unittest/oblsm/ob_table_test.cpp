@@ -14,10 +14,11 @@ See the Mulan PSL v2 for more details. */
 #include "oblsm/util/ob_comparator.h"
 #include "oblsm/table/ob_sstable_builder.h"
 #include "oblsm/table/ob_sstable.h"
+#include "oblsm/util/ob_coding.h"
 
 using namespace oceanbase;
 
-TEST(table_test, DISABLED_table_test_basic)
+TEST(table_test, table_test_basic)
 {
   ObDefaultComparator comparator;
   shared_ptr<ObMemTable> table = make_shared<ObMemTable>();
@@ -40,6 +41,138 @@ TEST(table_test, DISABLED_table_test_basic)
 
 }
 
+TEST(table_test, table_test_bloom_filter)
+{
+  ObDefaultComparator    comparator;
+  shared_ptr<ObMemTable> table = make_shared<ObMemTable>();
+  uint64_t               seq   = 0;
+  const int              count = 2000;
+  for (int i = 0; i < count; i++) {
+    string key("key" + to_string(i));
+    table->put(seq++, key, key);
+  }
+  ObSSTableBuilder tb(&comparator, nullptr, 10);
+  ASSERT_EQ(tb.build(table, "test_bloom_filter.sst", 1), RC::SUCCESS);
+  tb.reset();
+
+  // reopen the sstable, the filter is loaded from the file.
+  auto sst = make_shared<ObSSTable>(1, "test_bloom_filter.sst", &comparator, nullptr);
+  sst->init();
+  ASSERT_TRUE(sst->has_filter());
+  ASSERT_GT(sst->block_count(), 1);
+  for (int i = 0; i < count; i++) {
+    ASSERT_TRUE(sst->may_contain("key" + to_string(i)));
+  }
+  int false_positives = 0;
+  for (int i = count; i < 2 * count; i++) {
+    false_positives += sst->may_contain("key" + to_string(i)) ? 1 : 0;
+  }
+  // about 1% false positive rate with 10 bits per key
+  ASSERT_LT(false_positives, count / 20);
+  ASSERT_EQ(sst->block_read_count(), 0);
+
+  unique_ptr<ObLsmIterator> sst_iter(sst->new_iterator());
+  int                       scanned = 0;
+  for (sst_iter->seek_to_first(); sst_iter->valid(); sst_iter->next()) {
+    scanned++;
+  }
+  ASSERT_EQ(scanned, count);
+  ASSERT_EQ(sst->block_read_count(), sst->block_count());
+  sst->remove();
+
+  // no filter, every key may be in the sstable.
+  ObSSTableBuilder no_filter_tb(&comparator, nullptr, 0);
+  ASSERT_EQ(no_filter_tb.build(table, "test_no_filter.sst", 2), RC::SUCCESS);
+  shared_ptr<ObSSTable> no_filter_sst = no_filter_tb.get_built_table();
+  ASSERT_FALSE(no_filter_sst->has_filter());
+  ASSERT_TRUE(no_filter_sst->may_contain("key" + to_string(count)));
+  ASSERT_EQ(no_filter_sst->block_count(), sst->block_count());
+  no_filter_sst->remove();
+}
+
+
+static string lookup_key(const string &user_key, uint64_t seq)
+{
+  string key;
+  put_lookup_key(&key, user_key, seq);
+  return key;
+}
+
+TEST(table_test, table_test_get)
+{
+  ObDefaultComparator    comparator;
+  shared_ptr<ObMemTable> table = make_shared<ObMemTable>();
+  uint64_t               seq   = 0;
+  const int              count = 1000;
+  for (int i = 0; i < count; i++) {
+    table->put(seq++, "key" + to_string(i), "v0_" + to_string(i));
+  }
+  // reads at old_seq don't see the updates below
+  const uint64_t old_seq = seq - 1;
+  // new versions of some keys, deletions of others. A large value makes the versions of key1 span blocks.
+  const string large_value(1000, 'x');
+  for (int v = 1; v <= 6; v++) {
+    table->put(seq++, "key1", large_value + to_string(v));
+  }
+  table->put(seq++, "key2", "");
+  table->put(seq++, "key3", "v1_3");
+
+  string value;
+  ASSERT_EQ(table->get(lookup_key("key1", seq), &value), RC::SUCCESS);
+  ASSERT_EQ(value, large_value + "6");
+  ASSERT_EQ(table->get(lookup_key("key1", old_seq), &value), RC::SUCCESS);
+  ASSERT_EQ(value, "v0_1");
+  ASSERT_EQ(table->get(lookup_key("key2", seq), &value), RC::NOT_EXIST);
+  ASSERT_EQ(table->get(lookup_key("key2", old_seq), &value), RC::SUCCESS);
+  ASSERT_EQ(table->get(lookup_key("key", seq), &value), RC::NOTFOUND);
+  ASSERT_EQ(table->get(lookup_key("key4", 0), &value), RC::NOTFOUND);
+
+  ObSSTableBuilder tb(&comparator, nullptr);
+  ASSERT_EQ(tb.build(table, "test_get.sst", 3), RC::SUCCESS);
+  shared_ptr<ObSSTable> sst = tb.get_built_table();
+  ASSERT_GT(sst->block_count(), 2);
+
+  for (int i = 0; i < count; i++) {
+    const string key = "key" + to_string(i);
+    ASSERT_EQ(sst->get(lookup_key(key, old_seq), &value), RC::SUCCESS) << key;
+    ASSERT_EQ(value, "v0_" + to_string(i));
+  }
+  for (int v = 1; v <= 6; v++) {
+    ASSERT_EQ(sst->get(lookup_key("key1", old_seq + v), &value), RC::SUCCESS);
+    ASSERT_EQ(value, large_value + to_string(v));
+  }
+  ASSERT_EQ(sst->get(lookup_key("key2", seq), &value), RC::NOT_EXIST);
+  ASSERT_EQ(sst->get(lookup_key("key3", seq), &value), RC::SUCCESS);
+  ASSERT_EQ(value, "v1_3");
+  // before the first key, between keys, after the last key
+  ASSERT_EQ(sst->get(lookup_key("a", seq), &value), RC::NOTFOUND);
+  ASSERT_EQ(sst->get(lookup_key("key10000", seq), &value), RC::NOTFOUND);
+  ASSERT_EQ(sst->get(lookup_key("z", seq), &value), RC::NOTFOUND);
+  ASSERT_EQ(sst->compare_key_range("a"), -1);
+  ASSERT_EQ(sst->compare_key_range("key5"), 0);
+  ASSERT_EQ(sst->compare_key_range("z"), 1);
+
+  // blocks are read from the file only once with a block cache
+  ObLRUCache<uint64_t, shared_ptr<ObBlock>> block_cache(1024 * 1024, 4);
+  ObSSTable cached_sst(3, "test_get.sst", &comparator, &block_cache);
+  cached_sst.init();
+  for (int n = 0; n < 3; n++) {
+    for (int i = 0; i < count; i++) {
+      ASSERT_EQ(cached_sst.get(lookup_key("key" + to_string(i), old_seq), &value), RC::SUCCESS);
+    }
+  }
+  ASSERT_EQ(cached_sst.block_read_count(), block_cache.miss_count());
+  ASSERT_LE(cached_sst.block_read_count(), cached_sst.block_count());
+  ASSERT_GE(block_cache.hit_count(), 2 * count);
+  ASSERT_GT(block_cache.usage(), 0);
+
+  // seek through the table iterator finds the same entries as get
+  unique_ptr<ObLsmIterator> iter(sst->new_iterator());
+  iter->seek(lookup_key("key500", seq));
+  ASSERT_TRUE(iter->valid());
+  ASSERT_EQ(extract_user_key(iter->key()), "key500");
+  sst->remove();
+}
 
 int main(int argc, char **argv)
 {
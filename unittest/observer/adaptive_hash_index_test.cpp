@@ -0,0 +1,196 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include "gtest/gtest.h"
+#include "storage/index/adaptive_hash_index.h"
+
+using namespace std;
+
+TEST(AdaptiveHashIndex, hot_key)
+{
+  AdaptiveHashIndex ahi;
+  ahi.init(AttrType::INTS, 4);
+
+  int  tree_lookups = 0;
+  auto tree_lookup  = [&tree_lookups](list<RID> &rids) {
+    tree_lookups++;
+    rids.push_back(RID(1, 1));
+    rids.push_back(RID(1, 2));
+    return RC::SUCCESS;
+  };
+
+  const int   key = 100;
+  RC          rc  = RC::SUCCESS;
+  vector<RID> rids;
+
+  // 访问次数不够时由调用者自己查询B+树
+  for (int i = 1; i < AdaptiveHashIndex::HOT_THRESHOLD; i++) {
+    ASSERT_FALSE(ahi.lookup(reinterpret_cast<const char *>(&key), 4, tree_lookup, rc, rids));
+  }
+  ASSERT_EQ(0, tree_lookups);
+  ASSERT_EQ(0, ahi.size());
+
+  // 成为热点以后查询B+树并缓存
+  ASSERT_TRUE(ahi.lookup(reinterpret_cast<const char *>(&key), 4, tree_lookup, rc, rids));
+  ASSERT_EQ(RC::SUCCESS, rc);
+  ASSERT_EQ(1, tree_lookups);
+  ASSERT_EQ(2, rids.size());
+  ASSERT_EQ(1, ahi.size());
+
+  for (int i = 0; i < 10; i++) {
+    rids.clear();
+    ASSERT_TRUE(ahi.lookup(reinterpret_cast<const char *>(&key), 4, tree_lookup, rc, rids));
+    ASSERT_EQ(2, rids.size());
+  }
+  ASSERT_EQ(1, tree_lookups);
+  ASSERT_EQ(10, ahi.hit_count());
+
+  // 键值修改以后缓存失效，需要重新变成热点
+  ahi.invalidate(reinterpret_cast<const char *>(&key), 4);
+  ASSERT_EQ(0, ahi.size());
+  ASSERT_FALSE(ahi.lookup(reinterpret_cast<const char *>(&key), 4, tree_lookup, rc, rids));
+
+  // 关闭以后不再使用缓存
+  ahi.set_enabled(false);
+  for (int i = 0; i < AdaptiveHashIndex::HOT_THRESHOLD * 2; i++) {
+    ASSERT_FALSE(ahi.lookup(reinterpret_cast<const char *>(&key), 4, tree_lookup, rc, rids));
+  }
+  ASSERT_EQ(0, ahi.size());
+}
+
+TEST(AdaptiveHashIndex, bounded)
+{
+  const int         capacity = 16;
+  AdaptiveHashIndex ahi;
+  ahi.init(AttrType::CHARS, 8, capacity);
+
+  auto tree_lookup = [](list<RID> &rids) {
+    rids.push_back(RID(1, 1));
+    return RC::SUCCESS;
+  };
+
+  RC          rc = RC::SUCCESS;
+  vector<RID> rids;
+  for (int i = 0; i < capacity * 4; i++) {
+    char key[8] = {0};
+    snprintf(key, sizeof(key), "k%d", i);
+    for (int j = 0; j < AdaptiveHashIndex::HOT_THRESHOLD; j++) {
+      ahi.lookup(key, strlen(key), tree_lookup, rc, rids);
+    }
+    ASSERT_LE(ahi.size(), capacity);
+  }
+  ASSERT_EQ(capacity, ahi.size());
+
+  // 最近访问的键值还在缓存中，字符串后面的内容不影响查找
+  char key[8] = "k63\0xyz";
+  rids.clear();
+  ASSERT_TRUE(ahi.lookup(key, sizeof(key), tree_lookup, rc, rids));
+  ASSERT_EQ(1, ahi.hit_count());
+
+  // 太多的RID不缓存
+  auto large_lookup = [](list<RID> &rids) {
+    for (int i = 0; i <= AdaptiveHashIndex::MAX_RIDS_PER_KEY; i++) {
+      rids.push_back(RID(2, i));
+    }
+    return RC::SUCCESS;
+  };
+  ahi.clear();
+  for (int j = 0; j < AdaptiveHashIndex::HOT_THRESHOLD; j++) {
+    rids.clear();
+    ahi.lookup("large", 5, large_lookup, rc, rids);
+  }
+  ASSERT_EQ(AdaptiveHashIndex::MAX_RIDS_PER_KEY + 1, rids.size());
+  ASSERT_EQ(0, ahi.size());
+}
+
+TEST(AdaptiveHashIndex, shards)
+{
+  AdaptiveHashIndex ahi;
+  ahi.init(AttrType::INTS, 4);
+  ASSERT_EQ(AdaptiveHashIndex::MAX_SHARDS, ahi.shard_count());
+
+  int  tree_lookups = 0;
+  auto tree_lookup  = [&tree_lookups](list<RID> &rids) {
+    tree_lookups++;
+    rids.push_back(RID(1, tree_lookups));
+    return RC::SUCCESS;
+  };
+
+  // 键值分布在不同的分片上，都可以缓存
+  const int   key_num = 1000;
+  RC          rc      = RC::SUCCESS;
+  vector<RID> rids;
+  for (int key = 0; key < key_num; key++) {
+    for (int i = 0; i < AdaptiveHashIndex::HOT_THRESHOLD; i++) {
+      ahi.lookup(reinterpret_cast<const char *>(&key), 4, tree_lookup, rc, rids);
+    }
+  }
+  ASSERT_EQ(key_num, ahi.size());
+  ASSERT_EQ(key_num, tree_lookups);
+
+  for (int key = 0; key < key_num; key++) {
+    rids.clear();
+    ASSERT_TRUE(ahi.lookup(reinterpret_cast<const char *>(&key), 4, tree_lookup, rc, rids));
+    ASSERT_EQ(1, rids.size());
+    ASSERT_EQ(key + 1, rids[0].slot_num);
+  }
+  ASSERT_EQ(key_num, ahi.hit_count());
+
+  for (int key = 0; key < key_num; key++) {
+    ahi.invalidate(reinterpret_cast<const char *>(&key), 4);
+  }
+  ASSERT_EQ(0, ahi.size());
+
+  // 容量小的时候不分片，保证严格的LRU顺序
+  AdaptiveHashIndex small;
+  small.init(AttrType::INTS, 4, AdaptiveHashIndex::MIN_SHARD_SIZE);
+  ASSERT_EQ(1, small.shard_count());
+}
+
+TEST(AdaptiveHashIndex, default_enabled)
+{
+  ASSERT_TRUE(AdaptiveHashIndex::default_enabled());
+
+  AdaptiveHashIndex::set_default_enabled(false);
+  AdaptiveHashIndex disabled;
+  AdaptiveHashIndex::set_default_enabled(true);
+  AdaptiveHashIndex enabled;
+  ASSERT_FALSE(disabled.enabled());
+  ASSERT_TRUE(enabled.enabled());
+}
+
+TEST(AdaptiveHashIndex, scanner)
+{
+  AdaptiveHashIndex ahi;
+  ahi.init(AttrType::INTS, 4);
+
+  const int   key = 7;
+  vector<RID> rids{RID(1, 1), RID(1, 2), RID(1, 3)};
+  auto *scanner = new AdaptiveHashIndexScanner(std::move(rids), ahi.normalize_key(reinterpret_cast<const char *>(&key), 4));
+
+  RID rid;
+  int key_out = 0;
+  ASSERT_EQ(RC::SUCCESS, scanner->next_entry_with_key(&rid, reinterpret_cast<char *>(&key_out)));
+  ASSERT_EQ(RID(1, 1), rid);
+  ASSERT_EQ(key, key_out);
+
+  vector<RID> batch;
+  ASSERT_EQ(RC::SUCCESS, scanner->next_entries(batch, 10));
+  ASSERT_EQ(2, batch.size());
+  ASSERT_EQ(RC::RECORD_EOF, scanner->next_entries(batch, 10));
+  ASSERT_EQ(RC::RECORD_EOF, scanner->next_entry(&rid));
+  scanner->destroy();
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
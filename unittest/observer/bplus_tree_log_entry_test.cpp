@@ -121,6 +121,34 @@ TEST(BplusTreeLogEntry, normal_operation_log_entry)
   ASSERT_EQ(0, memcmp(insert_items.data(), entry2->items(), insert_items.size()));
 }
 
+TEST(BplusTreeLogEntry, leaf_batch_insert_log_entry)
+{
+  Frame frame;
+  frame.set_page_num(100);
+  vector<int>  indexes{1, 3, 4, 8};
+  vector<char> items(indexes.size() * 12);
+  for (size_t i = 0; i < items.size(); i++) {
+    items[i] = static_cast<char>(i);
+  }
+  LeafBatchInsertLogEntryHandler entry(&frame, indexes, items);
+
+  // test serializer and desirializer
+  Serializer serializer;
+  ASSERT_EQ(RC::SUCCESS, entry.serialize(serializer));
+
+  Deserializer                deserializer(serializer.data());
+  unique_ptr<LogEntryHandler> handler;
+  ASSERT_EQ(RC::SUCCESS, LogEntryHandler::from_buffer(deserializer, handler));
+
+  auto entry2 = dynamic_cast<LeafBatchInsertLogEntryHandler *>(handler.get());
+  ASSERT_NE(nullptr, entry2);
+  ASSERT_EQ(LogOperation::Type::LEAF_BATCH_INSERT, entry2->operation_type().type());
+  ASSERT_EQ(static_cast<int>(indexes.size()), entry2->item_num());
+  ASSERT_EQ(0, memcmp(indexes.data(), entry2->indexes(), indexes.size() * sizeof(int)));
+  ASSERT_EQ(static_cast<int32_t>(items.size()), entry2->item_bytes());
+  ASSERT_EQ(0, memcmp(items.data(), entry2->items(), items.size()));
+}
+
 TEST(BplusTreeLogEntry, leaf_init_empty_log_entry)
 {
   Frame frame;
@@ -87,12 +87,22 @@ TEST(BplusTreeLog, base)
   mt19937       generator(rd());
   shuffle(keys.begin(), keys.end(), generator);
 
-  for (int i : keys) {
-    RID rid(i, i);
-    int key = i;
+  // 前一半逐条插入，后一半批量插入，每个叶子节点上批量插入的键值只记录一条日志
+  const int single_num = insert_num / 2;
+  for (int i = 0; i < single_num; i++) {
+    RID rid(keys[i], keys[i]);
+    int key = keys[i];
     ASSERT_EQ(RC::SUCCESS, bplus_tree->insert_entry(reinterpret_cast<const char *>(&key), &rid));
   }
 
+  vector<const char *> batch_keys;
+  vector<RID>          batch_rids;
+  for (int i = single_num; i < insert_num; i++) {
+    batch_keys.push_back(reinterpret_cast<const char *>(&keys[i]));
+    batch_rids.push_back(RID(keys[i], keys[i]));
+  }
+  ASSERT_EQ(RC::SUCCESS, bplus_tree->insert_entries(batch_keys, batch_rids));
+
   // 3. write logs to disk
   ASSERT_EQ(log_handler->stop(), RC::SUCCESS);
   ASSERT_EQ(log_handler->await_termination(), RC::SUCCESS);
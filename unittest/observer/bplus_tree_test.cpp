@@ -22,6 +22,7 @@ See the Mulan PSL v2 for more details. */
 #include "sql/parser/parse_defs.h"
 #include "storage/buffer/disk_buffer_pool.h"
 #include "storage/index/bplus_tree.h"
+#include "storage/index/bplus_tree_index.h"
 #include "storage/clog/vacuous_log_handler.h"
 #include "storage/buffer/double_write_buffer.h"
 #include "gtest/gtest.h"
@@ -790,6 +791,157 @@ TEST(test_bplus_tree, test_scanner)
 
   scanner.close();
 
+  // 扫描时同时返回索引中的 key
+  begin = 21;
+  end   = 59;
+  rc    = scanner.open((const char *)&begin, 4, true, (const char *)&end, 4, true /*inclusive*/);
+  ASSERT_EQ(RC::SUCCESS, rc);
+  count   = 0;
+  int key = 0;
+  while ((rc = scanner.next_entry(rid, (char *)&key)) == RC::SUCCESS) {
+    ASSERT_EQ(begin + count * 2, key);
+    ASSERT_EQ(key, rid.slot_num);
+    count++;
+  }
+  ASSERT_EQ(20, count);
+  ASSERT_EQ(RC::RECORD_EOF, rc);
+
+  scanner.close();
+
+  // 开启和关闭预读的结果应该一样
+  for (int prefetch_depth : {0, BplusTreeScanner::DEFAULT_PREFETCH_DEPTH}) {
+    BplusTreeScanner prefetch_scanner(handler);
+    prefetch_scanner.set_prefetch_depth(prefetch_depth);
+    begin = 20;
+    end   = 180;
+    rc    = prefetch_scanner.open((const char *)&begin, 4, true, (const char *)&end, 4, true /*inclusive*/);
+    ASSERT_EQ(RC::SUCCESS, rc);
+
+    count = 0;
+    while ((rc = prefetch_scanner.next_entry(rid)) == RC::SUCCESS) {
+      ASSERT_EQ(21 + count * 2, rid.slot_num);
+      count++;
+    }
+    ASSERT_EQ(80, count);
+    ASSERT_EQ(RC::RECORD_EOF, rc);
+    prefetch_scanner.close();
+  }
+
+  // 批量获取
+  BplusTreeIndexScanner batch_scanner(handler);
+  begin = 20;
+  end   = 180;
+  rc    = batch_scanner.open((const char *)&begin, 4, true, (const char *)&end, 4, true /*inclusive*/);
+  ASSERT_EQ(RC::SUCCESS, rc);
+
+  vector<RID> rids;
+  count = 0;
+  while ((rc = batch_scanner.next_entries(rids, 7)) == RC::SUCCESS) {
+    ASSERT_FALSE(rids.empty());
+    ASSERT_LE(rids.size(), 7);
+    for (const RID &batch_rid : rids) {
+      ASSERT_EQ(21 + count * 2, batch_rid.slot_num);
+      count++;
+    }
+  }
+  ASSERT_EQ(80, count);
+  ASSERT_EQ(RC::RECORD_EOF, rc);
+  ASSERT_EQ(RC::RECORD_EOF, batch_scanner.next_entries(rids, 7));
+  ASSERT_TRUE(rids.empty());
+
+  // 一次取出一个叶子节点中剩下的数据，同时返回键值
+  BplusTreeScanner leaf_scanner(handler);
+  begin = 20;
+  end   = 180;
+  rc    = leaf_scanner.open((const char *)&begin, 4, true, (const char *)&end, 4, true /*inclusive*/);
+  ASSERT_EQ(RC::SUCCESS, rc);
+
+  vector<char> keys;
+  count = 0;
+  while ((rc = leaf_scanner.next_entries(rids, &keys, 1000)) == RC::SUCCESS) {
+    ASSERT_LE(rids.size(), static_cast<size_t>(ORDER));
+    ASSERT_EQ(rids.size() * sizeof(int), keys.size());
+    for (size_t i = 0; i < rids.size(); i++) {
+      memcpy(&key, keys.data() + i * sizeof(int), sizeof(int));
+      ASSERT_EQ(21 + count * 2, key);
+      ASSERT_EQ(key, rids[i].slot_num);
+      count++;
+    }
+  }
+  ASSERT_EQ(80, count);
+  ASSERT_EQ(RC::RECORD_EOF, rc);
+  leaf_scanner.close();
+
+  handler.close();
+}
+
+TEST(test_bplus_tree, test_insert_entries)
+{
+  LoggerFactory::init_default("test.log");
+
+  filesystem::path test_directory("bplus_tree");
+  filesystem::path buffer_pool_file = test_directory / "insert_entries.btree";
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  VacuousLogHandler log_handler;
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(buffer_pool_file.c_str()));
+
+  DiskBufferPool *buffer_pool = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, buffer_pool_file.c_str(), buffer_pool));
+  ASSERT_NE(nullptr, buffer_pool);
+
+  BplusTreeHandler handler;
+  ASSERT_EQ(RC::SUCCESS, handler.create(log_handler, *buffer_pool, AttrType::INTS, sizeof(int), ORDER, ORDER));
+
+  // 先逐条插入 3 的倍数，再乱序批量插入其它的数据
+  const int   max_key = 1000;
+  vector<int> batch_keys;
+  RID         rid;
+  for (int key = 0; key < max_key; key++) {
+    if (key % 3 == 0) {
+      rid.page_num = key;
+      rid.slot_num = key;
+      ASSERT_EQ(RC::SUCCESS, handler.insert_entry((const char *)&key, &rid));
+    } else {
+      batch_keys.push_back(key);
+    }
+  }
+
+  for (size_t i = 0; i < batch_keys.size(); i++) {
+    swap(batch_keys[i], batch_keys[(i * 7919) % batch_keys.size()]);
+  }
+
+  vector<const char *> user_keys;
+  vector<RID>          rids;
+  for (const int &key : batch_keys) {
+    user_keys.push_back((const char *)&key);
+    rids.push_back(RID(key, key));
+  }
+  ASSERT_EQ(RC::SUCCESS, handler.insert_entries(user_keys, rids));
+  ASSERT_EQ(true, handler.validate_tree());
+
+  BplusTreeScanner scanner(handler);
+  ASSERT_EQ(RC::SUCCESS, scanner.open(nullptr, 0, true, nullptr, 0, true));
+  int count = 0;
+  RC  rc    = RC::SUCCESS;
+  while ((rc = scanner.next_entry(rid)) == RC::SUCCESS) {
+    ASSERT_EQ(count, rid.slot_num);
+    count++;
+  }
+  ASSERT_EQ(RC::RECORD_EOF, rc);
+  ASSERT_EQ(max_key, count);
+  scanner.close();
+
+  // 重复的键值会插入失败
+  user_keys.resize(1);
+  rids.resize(1);
+  ASSERT_EQ(RC::RECORD_DUPLICATE_KEY, handler.insert_entries(user_keys, rids));
+  ASSERT_EQ(true, handler.validate_tree());
+
   handler.close();
 }
 
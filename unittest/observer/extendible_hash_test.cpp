@@ -0,0 +1,304 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <filesystem>
+#include <algorithm>
+#include <random>
+
+#include "gtest/gtest.h"
+#include "storage/index/extendible_hash.h"
+#include "storage/buffer/disk_buffer_pool.h"
+#include "storage/buffer/double_write_buffer.h"
+#include "storage/clog/disk_log_handler.h"
+#include "storage/clog/integrated_log_replayer.h"
+#include "storage/clog/vacuous_log_handler.h"
+#include "storage/db/db.h"
+#include "storage/index/index.h"
+#include "storage/table/table.h"
+#include "storage/trx/trx.h"
+
+using namespace std;
+using namespace common;
+
+TEST(ExtendibleHash, insert_get_delete)
+{
+  filesystem::path test_directory = "extendible_hash_test_dir";
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  const filesystem::path filename = test_directory / "hash.index";
+
+  VacuousLogHandler log_handler;
+  auto              bpm = make_unique<BufferPoolManager>();
+  ASSERT_EQ(RC::SUCCESS, bpm->init(make_unique<VacuousDoubleWriteBuffer>()));
+
+  auto hash_handler = make_unique<ExtendibleHashHandler>();
+  // 桶设置得很小，让插入过程中不断地分裂
+  ASSERT_EQ(RC::SUCCESS, hash_handler->create(log_handler, *bpm, filename.c_str(), AttrType::INTS, 4, 8));
+  ASSERT_EQ(0, hash_handler->global_depth());
+
+  const int   insert_num = 5000;
+  vector<int> keys(insert_num);
+  for (int i = 0; i < insert_num; i++) {
+    keys[i] = i;
+  }
+  shuffle(keys.begin(), keys.end(), mt19937(random_device()()));
+
+  for (int key : keys) {
+    RID rid(key, key);
+    ASSERT_EQ(RC::SUCCESS, hash_handler->insert_entry(reinterpret_cast<const char *>(&key), &rid));
+  }
+  ASSERT_GT(hash_handler->global_depth(), 0);
+
+  for (int key : keys) {
+    RID rid(key, key);
+    ASSERT_EQ(RC::RECORD_DUPLICATE_KEY, hash_handler->insert_entry(reinterpret_cast<const char *>(&key), &rid));
+
+    RID other_rid(key, key + 1);
+    ASSERT_EQ(RC::RECORD_DUPLICATE_KEY,
+        hash_handler->insert_entry(reinterpret_cast<const char *>(&key), &other_rid, true /*unique*/));
+  }
+
+  for (int key = 0; key < insert_num; key++) {
+    list<RID> rids;
+    ASSERT_EQ(RC::SUCCESS, hash_handler->get_entry(reinterpret_cast<const char *>(&key), 4, rids));
+    ASSERT_EQ(1, rids.size());
+    ASSERT_EQ(RID(key, key), rids.front());
+  }
+
+  // 删除一半
+  for (int key = 0; key < insert_num; key += 2) {
+    RID rid(key, key);
+    ASSERT_EQ(RC::SUCCESS, hash_handler->delete_entry(reinterpret_cast<const char *>(&key), &rid));
+    ASSERT_EQ(RC::RECORD_NOT_EXIST, hash_handler->delete_entry(reinterpret_cast<const char *>(&key), &rid));
+  }
+
+  for (int key = 0; key < insert_num; key++) {
+    list<RID> rids;
+    ASSERT_EQ(RC::SUCCESS, hash_handler->get_entry(reinterpret_cast<const char *>(&key), 4, rids));
+    ASSERT_EQ(key % 2 == 0 ? 0 : 1, rids.size());
+  }
+
+  // 关闭后重新打开
+  ASSERT_EQ(RC::SUCCESS, hash_handler->sync());
+  hash_handler->close();
+  hash_handler = make_unique<ExtendibleHashHandler>();
+  ASSERT_EQ(RC::SUCCESS, hash_handler->open(log_handler, *bpm, filename.c_str()));
+
+  for (int key = 1; key < insert_num; key += 2) {
+    list<RID> rids;
+    ASSERT_EQ(RC::SUCCESS, hash_handler->get_entry(reinterpret_cast<const char *>(&key), 4, rids));
+    ASSERT_EQ(1, rids.size());
+  }
+
+  hash_handler.reset();
+  bpm.reset();
+}
+
+TEST(ExtendibleHash, duplicate_keys)
+{
+  filesystem::path test_directory = "extendible_hash_test_dir";
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  const filesystem::path filename = test_directory / "hash.index";
+
+  VacuousLogHandler log_handler;
+  auto              bpm = make_unique<BufferPoolManager>();
+  ASSERT_EQ(RC::SUCCESS, bpm->init(make_unique<VacuousDoubleWriteBuffer>()));
+
+  auto hash_handler = make_unique<ExtendibleHashHandler>();
+  ASSERT_EQ(RC::SUCCESS, hash_handler->create(log_handler, *bpm, filename.c_str(), AttrType::CHARS, 8, 4));
+
+  // 相同的键值无法通过分裂分开，会使用溢出页
+  const char key[8]  = "hello";
+  const int  rid_num = 100;
+  for (int i = 0; i < rid_num; i++) {
+    RID rid(1, i);
+    ASSERT_EQ(RC::SUCCESS, hash_handler->insert_entry(key, &rid));
+  }
+  ASSERT_EQ(0, hash_handler->global_depth());
+
+  // 其它的键值还可以正常分裂
+  for (int i = 0; i < rid_num; i++) {
+    char other_key[8] = {0};
+    snprintf(other_key, sizeof(other_key), "k%d", i);
+    RID rid(2, i);
+    ASSERT_EQ(RC::SUCCESS, hash_handler->insert_entry(other_key, &rid));
+  }
+  ASSERT_GT(hash_handler->global_depth(), 0);
+
+  // 查找时短的字符串后面补0
+  list<RID> rids;
+  ASSERT_EQ(RC::SUCCESS, hash_handler->get_entry("hello", 5, rids));
+  ASSERT_EQ(rid_num, rids.size());
+
+  for (int i = 0; i < rid_num; i++) {
+    RID rid(1, i);
+    ASSERT_EQ(RC::SUCCESS, hash_handler->delete_entry(key, &rid));
+  }
+
+  rids.clear();
+  ASSERT_EQ(RC::SUCCESS, hash_handler->get_entry("hello", 5, rids));
+  ASSERT_EQ(0, rids.size());
+
+  rids.clear();
+  ASSERT_EQ(RC::SUCCESS, hash_handler->get_entry("k10", 3, rids));
+  ASSERT_EQ(1, rids.size());
+  ASSERT_EQ(RID(2, 10), rids.front());
+
+  hash_handler.reset();
+  bpm.reset();
+}
+
+TEST(ExtendibleHash, recover)
+{
+  filesystem::path test_directory = "extendible_hash_log_test_dir";
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  const filesystem::path filename      = test_directory / "hash.index";
+  const filesystem::path filename2     = test_directory / "hash2.index";
+  const filesystem::path log_directory = test_directory / "clog";
+
+  // 1. 创建哈希表，保存一份刚创建时的文件
+  auto bpm = make_unique<BufferPoolManager>();
+  ASSERT_EQ(RC::SUCCESS, bpm->init(make_unique<VacuousDoubleWriteBuffer>()));
+  auto log_handler = make_unique<DiskLogHandler>();
+  ASSERT_EQ(RC::SUCCESS, log_handler->init(log_directory.c_str()));
+
+  IntegratedLogReplayer log_replayer(*bpm);
+  ASSERT_EQ(RC::SUCCESS, log_handler->replay(log_replayer, 0));
+  ASSERT_EQ(RC::SUCCESS, log_handler->start());
+
+  auto hash_handler = make_unique<ExtendibleHashHandler>();
+  ASSERT_EQ(RC::SUCCESS, hash_handler->create(*log_handler, *bpm, filename.c_str(), AttrType::INTS, 4, 16));
+  ASSERT_TRUE(filesystem::copy_file(filename, filename2));
+
+  // 2. 插入和删除一些数据，这些修改只有日志
+  const int insert_num = 2000;
+  for (int key = 0; key < insert_num; key++) {
+    RID rid(key, key);
+    ASSERT_EQ(RC::SUCCESS, hash_handler->insert_entry(reinterpret_cast<const char *>(&key), &rid));
+  }
+  for (int key = 0; key < insert_num; key += 3) {
+    RID rid(key, key);
+    ASSERT_EQ(RC::SUCCESS, hash_handler->delete_entry(reinterpret_cast<const char *>(&key), &rid));
+  }
+  const int global_depth = hash_handler->global_depth();
+
+  ASSERT_EQ(RC::SUCCESS, log_handler->stop());
+  ASSERT_EQ(RC::SUCCESS, log_handler->await_termination());
+
+  hash_handler.reset();
+  bpm.reset();
+  log_handler.reset();
+
+  // 3. 在刚创建时的文件上回放日志
+  auto bpm2 = make_unique<BufferPoolManager>();
+  ASSERT_EQ(RC::SUCCESS, bpm2->init(make_unique<VacuousDoubleWriteBuffer>()));
+  auto            log_handler2 = make_unique<DiskLogHandler>();
+  DiskBufferPool *buffer_pool2 = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm2->open_file(*log_handler2, filename2.c_str(), buffer_pool2));
+  ASSERT_EQ(RC::SUCCESS, log_handler2->init(log_directory.c_str()));
+
+  IntegratedLogReplayer log_replayer2(*bpm2);
+  ASSERT_EQ(RC::SUCCESS, log_handler2->replay(log_replayer2, 0));
+
+  auto hash_handler2 = make_unique<ExtendibleHashHandler>();
+  ASSERT_EQ(RC::SUCCESS, hash_handler2->open(*log_handler2, *buffer_pool2));
+  ASSERT_EQ(global_depth, hash_handler2->global_depth());
+
+  for (int key = 0; key < insert_num; key++) {
+    list<RID> rids;
+    ASSERT_EQ(RC::SUCCESS, hash_handler2->get_entry(reinterpret_cast<const char *>(&key), 4, rids));
+    if (key % 3 == 0) {
+      ASSERT_EQ(0, rids.size());
+    } else {
+      ASSERT_EQ(1, rids.size());
+      ASSERT_EQ(RID(key, key), rids.front());
+    }
+  }
+
+  hash_handler2.reset();
+  bpm2.reset();
+  log_handler2.reset();
+}
+
+TEST(ExtendibleHash, table_restart)
+{
+  filesystem::path db_path = "extendible_hash_db_test_dir";
+  filesystem::remove_all(db_path);
+  filesystem::create_directory(db_path);
+
+  const int record_num = 1000;
+
+  // 1. 建表并在 id 上创建哈希索引，插入一些数据后关闭数据库
+  {
+    auto db = make_unique<Db>();
+    ASSERT_EQ(RC::SUCCESS, db->init("test_db", db_path.c_str(), "vacuous", "disk"));
+
+    AttrInfoSqlNode attr_info;
+    attr_info.name   = "id";
+    attr_info.type   = AttrType::INTS;
+    attr_info.length = 4;
+    vector<AttrInfoSqlNode> attr_infos{attr_info};
+    ASSERT_EQ(RC::SUCCESS, db->create_table("t", attr_infos, {}));
+    Table *table = db->find_table("t");
+    ASSERT_NE(nullptr, table);
+
+    Trx *trx = db->trx_kit().create_trx(db->log_handler());
+    ASSERT_EQ(RC::SUCCESS, table->create_index(trx, table->table_meta().field("id"), "i_hash", false, IndexType::HASH));
+    db->trx_kit().destroy_trx(trx);
+
+    for (int i = 0; i < record_num; i++) {
+      Record record;
+      Value  value(i);
+      ASSERT_EQ(RC::SUCCESS, table->make_record(1, &value, record));
+      ASSERT_EQ(RC::SUCCESS, table->insert_record(record));
+    }
+    ASSERT_EQ(RC::SUCCESS, db->sync());
+  }
+
+  // 2. 重新打开数据库，索引类型和数据都要保留下来
+  {
+    auto db = make_unique<Db>();
+    ASSERT_EQ(RC::SUCCESS, db->init("test_db", db_path.c_str(), "vacuous", "disk"));
+    Table *table = db->find_table("t");
+    ASSERT_NE(nullptr, table);
+    Index *index = table->find_index("i_hash");
+    ASSERT_NE(nullptr, index);
+    ASSERT_EQ(IndexType::HASH, index->index_meta().type());
+
+    for (int i = 0; i < record_num; i++) {
+      IndexScanner *scanner = index->create_scanner(reinterpret_cast<const char *>(&i), 4, true,
+          reinterpret_cast<const char *>(&i), 4, true);
+      ASSERT_NE(nullptr, scanner);
+
+      RID rid;
+      ASSERT_EQ(RC::SUCCESS, scanner->next_entry(&rid));
+      Record record;
+      ASSERT_EQ(RC::SUCCESS, table->get_record(rid, record));
+      ASSERT_EQ(i, *reinterpret_cast<const int *>(record.data() + table->table_meta().field("id")->offset()));
+      ASSERT_EQ(RC::RECORD_EOF, scanner->next_entry(&rid));
+      scanner->destroy();
+    }
+  }
+
+  filesystem::remove_all(db_path);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  filesystem::path log_filename = filesystem::path(argv[0]).filename();
+  LoggerFactory::init_default(log_filename.string() + ".log", LOG_LEVEL_INFO);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,209 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sql/expr/composite_tuple.h"
+#include "sql/expr/expression.h"
+#include "sql/operator/gather_physical_operator.h"
+#include "sql/operator/table_scan_physical_operator.h"
+#include "sql/operator/table_scan_vec_physical_operator.h"
+#include "storage/db/db.h"
+#include "storage/table/table.h"
+#include "storage/trx/trx.h"
+
+using namespace std;
+
+class GatherPhysicalOperatorTest : public testing::Test
+{
+public:
+  static constexpr int ROW_NUM    = 20000;  ///< 页面数超过一个片段，每个工作线程都能领取到数据
+  static constexpr int WORKER_NUM = 4;
+
+  void SetUp() override
+  {
+    filesystem::remove_all(db_path_);
+    filesystem::create_directories(db_path_);
+
+    db_ = make_unique<Db>();
+    ASSERT_EQ(RC::SUCCESS, db_->init("test_db", db_path_.c_str(), "mvcc", "vacuous"));
+
+    AttrInfoSqlNode attr_info;
+    attr_info.name   = "id";
+    attr_info.type   = AttrType::INTS;
+    attr_info.length = 4;
+    vector<AttrInfoSqlNode> attr_infos{attr_info};
+    ASSERT_EQ(RC::SUCCESS, db_->create_table("t", attr_infos, {}));
+    table_ = db_->find_table("t");
+    ASSERT_NE(nullptr, table_);
+
+    Trx *trx = begin();
+    for (int i = 0; i < ROW_NUM; i++) {
+      insert(trx, i);
+    }
+    ASSERT_EQ(RC::SUCCESS, trx->commit());
+    db_->trx_kit().destroy_trx(trx);
+  }
+
+  void TearDown() override
+  {
+    db_.reset();
+    filesystem::remove_all(db_path_);
+  }
+
+  Trx *begin()
+  {
+    Trx *trx = db_->trx_kit().create_trx(db_->log_handler());
+    trx->start_if_need();
+    return trx;
+  }
+
+  void insert(Trx *trx, int id)
+  {
+    Record record;
+    Value  value(id);
+    ASSERT_EQ(RC::SUCCESS, table_->make_record(1, &value, record));
+    ASSERT_EQ(RC::SUCCESS, trx->insert_record(table_, record));
+  }
+
+  unique_ptr<Expression> id_not_less_than(int value)
+  {
+    return make_unique<ComparisonExpr>(CompOp::GREAT_EQUAL,
+        make_unique<FieldExpr>(table_, table_->table_meta().field("id")),
+        make_unique<ValueExpr>(Value(value)));
+  }
+
+  /// @brief 打开算子读取所有的行，返回行数和 id 之和
+  void scan_tuples(GatherPhysicalOperator &oper, Trx *trx, int &rows, int64_t &sum)
+  {
+    rows = 0;
+    sum  = 0;
+    ASSERT_EQ(RC::SUCCESS, oper.open(trx));
+    RC rc = RC::SUCCESS;
+    while (OB_SUCC(rc = oper.next())) {
+      Tuple *tuple = oper.current_tuple();
+      ASSERT_NE(nullptr, tuple);
+      Value value;
+      ASSERT_EQ(RC::SUCCESS, tuple->find_cell(TupleCellSpec("t", "id"), value));
+      rows++;
+      sum += value.get_int();
+    }
+    ASSERT_EQ(RC::RECORD_EOF, rc);
+    ASSERT_EQ(RC::SUCCESS, oper.close());
+  }
+
+  void scan_chunks(GatherPhysicalOperator &oper, Trx *trx, int &rows, int64_t &sum)
+  {
+    rows = 0;
+    sum  = 0;
+    ASSERT_EQ(RC::SUCCESS, oper.open(trx));
+    RC    rc = RC::SUCCESS;
+    Chunk chunk;
+    while (OB_SUCC(rc = oper.next(chunk))) {
+      ASSERT_EQ(1, chunk.column_num());
+      for (int i = 0; i < chunk.rows(); i++) {
+        rows++;
+        sum += chunk.get_value(0, i).get_int();
+      }
+    }
+    ASSERT_EQ(RC::RECORD_EOF, rc);
+    ASSERT_EQ(RC::SUCCESS, oper.close());
+  }
+
+protected:
+  filesystem::path db_path_ = "gather_physical_operator_test";
+  unique_ptr<Db>   db_;
+  Table           *table_ = nullptr;
+};
+
+static int64_t sum_range(int begin, int end) { return static_cast<int64_t>(begin + end - 1) * (end - begin) / 2; }
+
+TEST_F(GatherPhysicalOperatorTest, tuple)
+{
+  // 没有提交的数据对读事务不可见
+  Trx *writer = begin();
+  insert(writer, ROW_NUM);
+
+  GatherPhysicalOperator oper(table_, false /*vectorized*/);
+  for (int i = 0; i < WORKER_NUM; i++) {
+    auto scan = make_unique<TableScanPhysicalOperator>(table_, ReadWriteMode::READ_ONLY);
+    vector<unique_ptr<Expression>> predicates;
+    predicates.emplace_back(id_not_less_than(100));
+    scan->set_predicates(std::move(predicates));
+    oper.add_child(std::move(scan));
+  }
+
+  Trx    *reader = begin();
+  int     rows   = 0;
+  int64_t sum    = 0;
+  // 关闭以后可以再次打开，比如作为连接的右表
+  for (int round = 0; round < 2; round++) {
+    scan_tuples(oper, reader, rows, sum);
+    ASSERT_EQ(ROW_NUM - 100, rows);
+    ASSERT_EQ(sum_range(100, ROW_NUM), sum);
+  }
+
+  ASSERT_EQ(RC::SUCCESS, writer->commit());
+  ASSERT_EQ(RC::SUCCESS, reader->commit());
+  for (Trx *trx : {writer, reader}) {
+    db_->trx_kit().destroy_trx(trx);
+  }
+}
+
+TEST_F(GatherPhysicalOperatorTest, chunk)
+{
+  Trx *writer = begin();
+  insert(writer, ROW_NUM);
+
+  GatherPhysicalOperator oper(table_, true /*vectorized*/);
+  for (int i = 0; i < WORKER_NUM; i++) {
+    auto scan = make_unique<TableScanVecPhysicalOperator>(table_, ReadWriteMode::READ_ONLY);
+    scan->set_column_ids({table_->table_meta().field("id")->field_id()});
+    oper.add_child(std::move(scan));
+  }
+
+  Trx    *reader = begin();
+  int     rows   = 0;
+  int64_t sum    = 0;
+  scan_chunks(oper, reader, rows, sum);
+  ASSERT_EQ(ROW_NUM, rows);
+  ASSERT_EQ(sum_range(0, ROW_NUM), sum);
+
+  ASSERT_EQ(RC::SUCCESS, writer->commit());
+  ASSERT_EQ(RC::SUCCESS, reader->commit());
+  for (Trx *trx : {writer, reader}) {
+    db_->trx_kit().destroy_trx(trx);
+  }
+}
+
+TEST_F(GatherPhysicalOperatorTest, close_before_eof)
+{
+  // 上层算子没有读完就关闭时，等待中的工作线程要能退出
+  GatherPhysicalOperator oper(table_, false /*vectorized*/);
+  for (int i = 0; i < WORKER_NUM; i++) {
+    oper.add_child(make_unique<TableScanPhysicalOperator>(table_, ReadWriteMode::READ_ONLY));
+  }
+
+  Trx *reader = begin();
+  ASSERT_EQ(RC::SUCCESS, oper.open(reader));
+  ASSERT_EQ(RC::SUCCESS, oper.next());
+  ASSERT_EQ(RC::SUCCESS, oper.close());
+  ASSERT_EQ(RC::SUCCESS, reader->commit());
+  db_->trx_kit().destroy_trx(reader);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
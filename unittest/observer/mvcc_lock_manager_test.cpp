@@ -0,0 +1,129 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <chrono>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "storage/trx/mvcc_lock_manager.h"
+
+using namespace std;
+
+static const int32_t table_id = 1;
+
+// 等待另一个线程开始等锁
+static void wait_for_waiters(MvccLockManager &lock_manager, int count)
+{
+  while (lock_manager.waiting_count() < count) {
+    this_thread::sleep_for(chrono::milliseconds(1));
+  }
+}
+
+TEST(MvccLockManager, wait_and_hand_over)
+{
+  MvccLockManager lock_manager;
+  lock_manager.set_wait_timeout_ms(60 * 1000);
+
+  const RID rid(1, 1);
+  ASSERT_EQ(RC::SUCCESS, lock_manager.lock(1, table_id, rid));
+  ASSERT_EQ(RC::SUCCESS, lock_manager.lock(1, table_id, rid));
+  ASSERT_EQ(RC::SUCCESS, lock_manager.lock(1, table_id, RID(1, 2)));
+  ASSERT_EQ(2, lock_manager.lock_count());
+
+  // 按照等待的顺序拿到锁
+  vector<int32_t> order;
+  mutex           order_lock;
+  thread          waiter2([&] {
+    EXPECT_EQ(RC::SUCCESS, lock_manager.lock(2, table_id, rid));
+    {
+      lock_guard<mutex> guard(order_lock);
+      order.push_back(2);
+    }
+    lock_manager.unlock_all(2);
+  });
+  wait_for_waiters(lock_manager, 1);
+
+  thread waiter3([&] {
+    EXPECT_EQ(RC::SUCCESS, lock_manager.lock(3, table_id, rid));
+    {
+      lock_guard<mutex> guard(order_lock);
+      order.push_back(3);
+    }
+    lock_manager.unlock_all(3);
+  });
+  wait_for_waiters(lock_manager, 2);
+
+  lock_manager.unlock_all(1);
+  waiter2.join();
+  waiter3.join();
+
+  ASSERT_EQ((vector<int32_t>{2, 3}), order);
+  ASSERT_EQ(0, lock_manager.lock_count());
+  ASSERT_EQ(0, lock_manager.waiting_count());
+  ASSERT_EQ(2, lock_manager.stats().waits);
+}
+
+TEST(MvccLockManager, timeout)
+{
+  MvccLockManager lock_manager;
+  const RID       rid(1, 1);
+  ASSERT_EQ(RC::SUCCESS, lock_manager.lock(1, table_id, rid));
+
+  // 超时时间为0时不等待
+  lock_manager.set_wait_timeout_ms(0);
+  ASSERT_EQ(RC::LOCKED_CONCURRENCY_CONFLICT, lock_manager.lock(2, table_id, rid));
+
+  lock_manager.set_wait_timeout_ms(10);
+  ASSERT_EQ(RC::LOCKED_WAIT_TIMEOUT, lock_manager.lock(2, table_id, rid));
+  ASSERT_EQ(0, lock_manager.waiting_count());
+  ASSERT_EQ(1, lock_manager.stats().timeouts);
+
+  // 超时的事务已经离开等待队列，释放以后锁被删除
+  lock_manager.unlock_all(1);
+  ASSERT_EQ(0, lock_manager.lock_count());
+  ASSERT_EQ(RC::SUCCESS, lock_manager.lock(2, table_id, rid));
+  lock_manager.unlock_all(2);
+}
+
+TEST(MvccLockManager, deadlock)
+{
+  MvccLockManager lock_manager;
+  lock_manager.set_wait_timeout_ms(60 * 1000);
+
+  // 事务1等待事务2，事务2等待事务3，事务3再等待事务1就形成了环
+  const RID rid1(1, 1), rid2(1, 2), rid3(2, 1);
+  ASSERT_EQ(RC::SUCCESS, lock_manager.lock(1, table_id, rid1));
+  ASSERT_EQ(RC::SUCCESS, lock_manager.lock(2, table_id, rid2));
+  ASSERT_EQ(RC::SUCCESS, lock_manager.lock(3, table_id, rid3));
+
+  thread trx1([&] {
+    EXPECT_EQ(RC::SUCCESS, lock_manager.lock(1, table_id, rid2));
+    lock_manager.unlock_all(1);
+  });
+  wait_for_waiters(lock_manager, 1);
+
+  thread trx2([&] {
+    EXPECT_EQ(RC::SUCCESS, lock_manager.lock(2, table_id, rid3));
+    lock_manager.unlock_all(2);
+  });
+  wait_for_waiters(lock_manager, 2);
+
+  // 不同表上相同的 RID 是不同的锁
+  ASSERT_EQ(RC::SUCCESS, lock_manager.lock(3, table_id + 1, rid1));
+  ASSERT_EQ(RC::LOCKED_DEADLOCK, lock_manager.lock(3, table_id, rid1));
+  ASSERT_EQ(1, lock_manager.stats().deadlocks);
+
+  // 死锁的事务回滚以后，其它事务可以继续
+  lock_manager.unlock_all(3);
+  trx2.join();
+  trx1.join();
+  ASSERT_EQ(0, lock_manager.lock_count());
+  ASSERT_EQ(0, lock_manager.waiting_count());
+}
@@ -155,6 +155,80 @@ TEST(MvccTrxLog, wal)
   db.reset();
 }
 
+TEST(MvccTrxLog, async_commit)
+{
+  /*
+  关闭 synchronous_commit 以后，提交时不等待日志落地。
+  等日志线程把缓冲区中的日志刷到磁盘以后，这些事务仍然可以恢复出来。
+  */
+  filesystem::path test_directory("mvcc_trx_log_test");
+  filesystem::remove_all(test_directory);
+  filesystem::create_directory(test_directory);
+
+  const char      *dbname           = "test_db";
+  const char      *dbname2          = "test_db2";
+  filesystem::path db_path          = test_directory / dbname;
+  filesystem::path db_path2         = test_directory / dbname2;
+  const char      *trx_kit_name     = "mvcc";
+  const char      *log_handler_name = "disk";
+
+  filesystem::create_directories(db_path);
+  filesystem::create_directories(db_path2);
+
+  auto db = make_unique<Db>();
+  ASSERT_EQ(RC::SUCCESS, db->init(dbname, db_path.c_str(), trx_kit_name, log_handler_name));
+
+  AttrInfoSqlNode attr_info;
+  attr_info.name   = "id";
+  attr_info.type   = AttrType::INTS;
+  attr_info.length = 4;
+  vector<AttrInfoSqlNode> attr_infos{attr_info};
+  ASSERT_EQ(RC::SUCCESS, db->create_table("t", attr_infos, {}));
+  ASSERT_EQ(RC::SUCCESS, db->sync());
+  Table *table = db->find_table("t");
+  ASSERT_NE(table, nullptr);
+
+  TrxKit   &trx_kit    = db->trx_kit();
+  const int insert_num = 1000;
+  for (int i = 0; i < insert_num; i++) {
+    Trx *trx = trx_kit.create_trx(db->log_handler());
+    ASSERT_NE(trx, nullptr);
+    trx->set_synchronous_commit(false);
+    trx->start_if_need();
+
+    Record record;
+    Value  value(i);
+    ASSERT_EQ(RC::SUCCESS, table->make_record(1, &value, record));
+    ASSERT_EQ(RC::SUCCESS, trx->insert_record(table, record));
+    ASSERT_EQ(RC::SUCCESS, trx->commit());
+    trx_kit.destroy_trx(trx);
+  }
+
+  DiskLogHandler &log_handler = static_cast<DiskLogHandler &>(db->log_handler());
+  LSN             current_lsn = log_handler.current_lsn();
+  ASSERT_EQ(RC::SUCCESS, log_handler.wait_lsn(current_lsn));
+
+  filesystem::copy(db_path, db_path2, filesystem::copy_options::recursive);
+
+  auto db2 = make_unique<Db>();
+  ASSERT_EQ(RC::SUCCESS, db2->init(dbname2, db_path2.c_str(), trx_kit_name, log_handler_name));
+  Table *table2 = db2->find_table("t");
+  ASSERT_NE(table2, nullptr);
+
+  RecordScanner *scanner2 = nullptr;
+  ASSERT_EQ(RC::SUCCESS, table2->get_record_scanner(scanner2, nullptr, ReadWriteMode::READ_ONLY));
+  int    count2 = 0;
+  Record record;
+  while (OB_SUCC(scanner2->next(record))) {
+    count2++;
+  }
+  delete scanner2;
+  ASSERT_EQ(insert_num, count2);
+
+  db2.reset();
+  db.reset();
+}
+
 TEST(MvccTrxLog, wal2)
 {
   /*
@@ -0,0 +1,141 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/trx/mvcc_trx_registry.h"
+
+using namespace std;
+
+// 注册表只使用事务对象的地址，测试时使用假的地址
+static Trx *fake_trx(int i) { return reinterpret_cast<Trx *>(static_cast<uintptr_t>(i + 1) * 64); }
+
+TEST(MvccTrxRegistry, trxes)
+{
+  MvccTrxRegistry registry;
+  const int       trx_num = 100;
+  for (int i = 0; i < trx_num; i++) {
+    registry.add(fake_trx(i));
+  }
+
+  vector<Trx *> trxes;
+  registry.all_trxes(trxes);
+  ASSERT_EQ(trx_num, static_cast<int>(trxes.size()));
+
+  for (int i = 0; i < trx_num; i += 2) {
+    ASSERT_TRUE(registry.remove(fake_trx(i)));
+  }
+  ASSERT_FALSE(registry.remove(fake_trx(0)));
+
+  registry.take_all(trxes);
+  ASSERT_EQ(trx_num / 2, static_cast<int>(trxes.size()));
+  registry.all_trxes(trxes);
+  ASSERT_TRUE(trxes.empty());
+}
+
+TEST(MvccTrxRegistry, oldest_active)
+{
+  MvccTrxRegistry registry;
+  ASSERT_EQ(1, registry.oldest_active_trx_id());
+
+  // 同一个分片中的三个事务，以及另一个分片中的一个事务
+  Trx *trx1 = fake_trx(0);
+  Trx *trx2 = fake_trx(MvccTrxRegistry::SHARD_NUM);
+  Trx *trx3 = fake_trx(MvccTrxRegistry::SHARD_NUM * 2);
+  Trx *trx4 = fake_trx(1);
+
+  const int32_t id1 = registry.begin_snapshot(trx1);
+  const int32_t id2 = registry.begin_snapshot(trx2);
+  const int32_t id3 = registry.begin_snapshot(trx3);
+  const int32_t id4 = registry.begin_snapshot(trx4);
+  ASSERT_EQ(4, registry.active_count());
+  ASSERT_EQ(id1, registry.oldest_active_trx_id());
+
+  // 中间的事务先结束，不影响水位线
+  registry.end_snapshot(trx2, id2);
+  ASSERT_EQ(id1, registry.oldest_active_trx_id());
+  ASSERT_EQ(3, registry.active_count());
+
+  registry.end_snapshot(trx1, id1);
+  ASSERT_EQ(id3, registry.oldest_active_trx_id());
+
+  registry.end_snapshot(trx3, id3);
+  ASSERT_EQ(id4, registry.oldest_active_trx_id());
+
+  const int32_t commit_id = registry.next_trx_id();
+  registry.end_snapshot(trx4, id4);
+  ASSERT_EQ(0, registry.active_count());
+  ASSERT_EQ(commit_id + 1, registry.oldest_active_trx_id());
+
+  registry.advance_trx_id(100);
+  registry.advance_trx_id(50);
+  ASSERT_EQ(100, registry.current_trx_id());
+}
+
+TEST(MvccTrxRegistry, read_snapshot)
+{
+  MvccTrxRegistry registry;
+
+  // 只读事务使用当前的事务ID作为快照，同一个分片中可能有相同的ID
+  Trx *trx1 = fake_trx(0);
+  Trx *trx2 = fake_trx(MvccTrxRegistry::SHARD_NUM);
+  Trx *trx3 = fake_trx(MvccTrxRegistry::SHARD_NUM * 2);
+
+  const int32_t id1 = registry.begin_snapshot(trx1);
+  const int32_t id2 = registry.begin_read_snapshot(trx2);
+  const int32_t id3 = registry.begin_read_snapshot(trx3);
+  ASSERT_EQ(id1, id2);
+  ASSERT_EQ(id1, id3);
+  ASSERT_EQ(id1, registry.current_trx_id());
+  ASSERT_EQ(3, registry.active_count());
+
+  registry.end_snapshot(trx1, id1);
+  registry.end_snapshot(trx3, id3);
+  ASSERT_EQ(1, registry.active_count());
+  ASSERT_EQ(id2, registry.oldest_active_trx_id());
+
+  registry.end_snapshot(trx2, id2);
+  ASSERT_EQ(0, registry.active_count());
+  ASSERT_EQ(id1 + 1, registry.oldest_active_trx_id());
+}
+
+// 分片的锁只有在 CONCURRENCY 编译模式下才会真正生效
+#ifdef CONCURRENCY
+TEST(MvccTrxRegistry, concurrent)
+{
+  MvccTrxRegistry registry;
+  const int       thread_num = 8;
+  const int       trx_num    = 10000;
+
+  vector<thread> threads;
+  for (int t = 0; t < thread_num; t++) {
+    threads.emplace_back([&registry, t] {
+      for (int i = 0; i < trx_num; i++) {
+        Trx *trx = fake_trx(t * trx_num + i);
+        registry.add(trx);
+        const int32_t trx_id = registry.begin_snapshot(trx);
+        // 自己的快照还没有结束，水位线不会超过它
+        EXPECT_LE(registry.oldest_active_trx_id(), trx_id);
+        registry.end_snapshot(trx, trx_id);
+        EXPECT_TRUE(registry.remove(trx));
+      }
+    });
+  }
+  for (thread &th : threads) {
+    th.join();
+  }
+
+  ASSERT_EQ(0, registry.active_count());
+  ASSERT_EQ(thread_num * trx_num, registry.current_trx_id());
+  ASSERT_EQ(registry.current_trx_id() + 1, registry.oldest_active_trx_id());
+}
+#endif  // CONCURRENCY
@@ -0,0 +1,946 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "sql/expr/composite_tuple.h"
+#include "sql/expr/expression.h"
+#include "sql/operator/index_scan_physical_operator.h"
+#include "sql/operator/table_scan_physical_operator.h"
+#include "sql/operator/table_scan_vec_physical_operator.h"
+#include "sql/operator/update_physical_operator.h"
+#include "storage/db/db.h"
+#include "storage/index/index.h"
+#include "storage/record/record_manager.h"
+#include "storage/record/record_scanner.h"
+#include "storage/table/table.h"
+#include "storage/trx/mvcc_trx.h"
+#include "storage/trx/mvcc_undo.h"
+
+using namespace std;
+using namespace common;
+
+TEST(MvccUndoStore, version_chain)
+{
+  MvccUndoStore store;
+  const RID     rid(1, 2);
+
+  // 版本 [3, -10)：事务10正在更新
+  ASSERT_EQ(RC::SUCCESS, store.push(1, rid, 3, -10, "aaaa", 4));
+  string data;
+  ASSERT_EQ(RC::RECORD_INVISIBLE, store.find(1, rid, 2, data));
+  ASSERT_EQ(RC::SUCCESS, store.find(1, rid, 5, data));
+  ASSERT_EQ("aaaa", data);
+  ASSERT_EQ(RC::RECORD_INVISIBLE, store.find(1, rid, 10, data));
+  ASSERT_EQ(RC::RECORD_INVISIBLE, store.find(2, rid, 5, data));
+
+  // 事务10在12提交，事务20继续更新
+  store.commit(1, rid, 10, 12);
+  ASSERT_EQ(RC::SUCCESS, store.push(1, rid, 12, -20, "bbbb", 4));
+  ASSERT_EQ(2, store.version_count());
+
+  ASSERT_EQ(RC::SUCCESS, store.find(1, rid, 5, data));
+  ASSERT_EQ("aaaa", data);
+  ASSERT_EQ(RC::SUCCESS, store.find(1, rid, 15, data));
+  ASSERT_EQ("bbbb", data);
+
+  // 只能回滚自己的版本
+  ASSERT_EQ(RC::RECORD_NOT_EXIST, store.pop(1, rid, -10, data));
+  ASSERT_EQ(RC::SUCCESS, store.pop(1, rid, -20, data));
+  ASSERT_EQ("bbbb", data);
+  ASSERT_EQ(1, store.version_count());
+
+  // 最老的活跃事务早于提交时间时，旧版本还需要保留
+  ASSERT_EQ(0, store.purge(11));
+  ASSERT_EQ(1, store.purge(12));
+  ASSERT_EQ(0, store.version_count());
+  ASSERT_EQ(0, store.memory_bytes());
+}
+
+TEST(MvccUndoStore, spill)
+{
+  MvccUndoStore store;
+  store.set_memory_limit(64);
+
+  const int record_num = 20;
+  for (int i = 0; i < record_num; i++) {
+    string image(16, static_cast<char>('a' + i));
+    ASSERT_EQ(RC::SUCCESS, store.push(1, RID(1, i), 1, -(i + 2), image.data(), static_cast<int>(image.size())));
+  }
+  ASSERT_LE(store.memory_bytes(), 64);
+  ASSERT_EQ(record_num - 4, store.spilled_count());
+
+  for (int i = 0; i < record_num; i++) {
+    string data;
+    ASSERT_EQ(RC::SUCCESS, store.find(1, RID(1, i), 100, data));
+    ASSERT_EQ(string(16, static_cast<char>('a' + i)), data);
+    store.commit(1, RID(1, i), i + 2, 50);
+  }
+
+  ASSERT_EQ(record_num, store.purge(100));
+  ASSERT_EQ(0, store.version_count());
+}
+
+class MvccUndoTrxTest : public testing::Test
+{
+public:
+  void SetUp() override
+  {
+    filesystem::remove_all(db_path_);
+    filesystem::create_directories(db_path_);
+
+    db_ = make_unique<Db>();
+    ASSERT_EQ(RC::SUCCESS, db_->init("test_db", db_path_.c_str(), "mvcc", "vacuous"));
+
+    AttrInfoSqlNode attr_info;
+    attr_info.name   = "id";
+    attr_info.type   = AttrType::INTS;
+    attr_info.length = 4;
+    vector<AttrInfoSqlNode> attr_infos{attr_info};
+    ASSERT_EQ(RC::SUCCESS, db_->create_table("t", attr_infos, {}));
+    table_ = db_->find_table("t");
+    ASSERT_NE(nullptr, table_);
+
+    Trx *trx = begin();
+    Record record;
+    Value  value(1);
+    ASSERT_EQ(RC::SUCCESS, table_->make_record(1, &value, record));
+    ASSERT_EQ(RC::SUCCESS, trx->insert_record(table_, record));
+    rid_ = record.rid();
+    ASSERT_EQ(RC::SUCCESS, trx->commit());
+    db_->trx_kit().destroy_trx(trx);
+  }
+
+  void TearDown() override
+  {
+    db_.reset();
+    filesystem::remove_all(db_path_);
+  }
+
+  Trx *begin()
+  {
+    Trx *trx = db_->trx_kit().create_trx(db_->log_handler());
+    trx->start_if_need();
+    return trx;
+  }
+
+  /**
+   * @brief 在事务中读取唯一的一行，读不到时返回-1
+   */
+  int read(Trx *trx, ReadWriteMode mode, RC &rc, ConditionFilter *filter = nullptr)
+  {
+    RecordScanner *scanner = nullptr;
+    rc                     = table_->get_record_scanner(scanner, trx, mode);
+    if (OB_FAIL(rc)) {
+      return -1;
+    }
+    if (filter != nullptr) {
+      rc = scanner->set_condition_filter(filter);
+      if (OB_FAIL(rc)) {
+        delete scanner;
+        return -1;
+      }
+    }
+
+    int    value = -1;
+    Record record;
+    rc = scanner->next(record);
+    if (OB_SUCC(rc)) {
+      value = *reinterpret_cast<const int *>(record.data() + table_->table_meta().field("id")->offset());
+    }
+    delete scanner;
+    return value;
+  }
+
+  int read(Trx *trx)
+  {
+    RC rc = RC::SUCCESS;
+    return read(trx, ReadWriteMode::READ_ONLY, rc);
+  }
+
+  RC update(Trx *trx, int value)
+  {
+    Record old_record;
+    table_->visit_record(rid_, [&old_record](Record &record) {
+      old_record.copy_data(record.data(), record.len());
+      old_record.set_rid(record.rid());
+      return false;
+    });
+
+    Record new_record;
+    new_record.copy_data(old_record.data(), old_record.len());
+    new_record.set_rid(rid_);
+    memcpy(new_record.data() + table_->table_meta().field("id")->offset(), &value, sizeof(value));
+    return trx->update_record(table_, old_record, new_record);
+  }
+
+protected:
+  filesystem::path db_path_ = "mvcc_undo_test";
+  unique_ptr<Db>   db_;
+  Table           *table_ = nullptr;
+  RID              rid_;
+};
+
+TEST_F(MvccUndoTrxTest, snapshot_read)
+{
+  // 不等锁，直接返回冲突
+  auto &trx_kit = static_cast<MvccTrxKit &>(db_->trx_kit());
+  trx_kit.lock_manager().set_wait_timeout_ms(0);
+
+  Trx *reader = begin();
+  Trx *writer = begin();
+  Trx *other  = begin();
+
+  ASSERT_EQ(RC::SUCCESS, update(writer, 2));
+  ASSERT_EQ(2, read(writer));
+  ASSERT_EQ(1, read(reader));
+
+  // 写写冲突，扫描时不检查，修改之前加行锁时发现
+  ASSERT_EQ(RC::LOCKED_CONCURRENCY_CONFLICT, update(other, 3));
+  RC rc = RC::SUCCESS;
+  ASSERT_EQ(1, read(other, ReadWriteMode::READ_WRITE, rc));
+  ASSERT_EQ(RC::SUCCESS, rc);
+
+  ASSERT_EQ(RC::SUCCESS, writer->commit());
+
+  // 提交以后，之前开始的事务仍然读到自己快照中的版本，并且不能再修改
+  ASSERT_EQ(1, read(reader));
+  ASSERT_EQ(RC::LOCKED_CONCURRENCY_CONFLICT, update(other, 3));
+
+  Trx *new_reader = begin();
+  ASSERT_EQ(2, read(new_reader));
+
+  ASSERT_EQ(1, trx_kit.undo_store().version_count());
+  ASSERT_EQ(0, trx_kit.purge_undo());
+
+  for (Trx *trx : {reader, other, new_reader}) {
+    ASSERT_EQ(RC::SUCCESS, trx->rollback());
+    db_->trx_kit().destroy_trx(trx);
+  }
+  db_->trx_kit().destroy_trx(writer);
+
+  // 所有活跃事务都能看到新版本以后，旧版本可以清理
+  ASSERT_EQ(1, trx_kit.purge_undo());
+  ASSERT_EQ(0, trx_kit.undo_store().version_count());
+}
+
+TEST_F(MvccUndoTrxTest, filter_old_version)
+{
+  const FieldMeta        *field = table_->table_meta().field("id");
+  CompiledConditionFilter old_value_filter;
+  CompiledConditionFilter new_value_filter;
+  ASSERT_EQ(RC::SUCCESS, old_value_filter.add(*field, EQUAL_TO, Value(1)));
+  ASSERT_EQ(RC::SUCCESS, new_value_filter.add(*field, EQUAL_TO, Value(2)));
+
+  // 更新过滤条件中的字段，之前开始的事务仍然按照快照中的版本过滤
+  Trx *reader = begin();
+  Trx *writer = begin();
+  ASSERT_EQ(RC::SUCCESS, update(writer, 2));
+
+  RC rc = RC::SUCCESS;
+  ASSERT_EQ(1, read(reader, ReadWriteMode::READ_ONLY, rc, &old_value_filter));
+  ASSERT_EQ(-1, read(reader, ReadWriteMode::READ_ONLY, rc, &new_value_filter));
+  ASSERT_EQ(RC::RECORD_EOF, rc);
+  ASSERT_EQ(2, read(writer, ReadWriteMode::READ_ONLY, rc, &new_value_filter));
+  ASSERT_EQ(-1, read(writer, ReadWriteMode::READ_ONLY, rc, &old_value_filter));
+
+  ASSERT_EQ(RC::SUCCESS, writer->commit());
+  ASSERT_EQ(1, read(reader, ReadWriteMode::READ_ONLY, rc, &old_value_filter));
+  ASSERT_EQ(-1, read(reader, ReadWriteMode::READ_ONLY, rc, &new_value_filter));
+
+  Trx *new_reader = begin();
+  ASSERT_EQ(-1, read(new_reader, ReadWriteMode::READ_ONLY, rc, &old_value_filter));
+  ASSERT_EQ(2, read(new_reader, ReadWriteMode::READ_ONLY, rc, &new_value_filter));
+
+  for (Trx *trx : {reader, new_reader}) {
+    ASSERT_EQ(RC::SUCCESS, trx->rollback());
+    db_->trx_kit().destroy_trx(trx);
+  }
+  db_->trx_kit().destroy_trx(writer);
+}
+
+TEST_F(MvccUndoTrxTest, index_old_version)
+{
+  Trx *trx = begin();
+  ASSERT_EQ(RC::SUCCESS, table_->create_index(trx, table_->table_meta().field("id"), "id_index", false /*unique*/));
+  ASSERT_EQ(RC::SUCCESS, trx->commit());
+  db_->trx_kit().destroy_trx(trx);
+  Index *index = table_->find_index("id_index");
+  ASSERT_NE(nullptr, index);
+
+  // 通过索引扫描 [left, right]，返回事务能看到的记录条数
+  auto index_read = [this, index](Trx *trx, int left, int right) {
+    Value                     left_value(left);
+    Value                     right_value(right);
+    IndexScanPhysicalOperator scan(table_, index, ReadWriteMode::READ_ONLY, &left_value, true, &right_value, true);
+    EXPECT_EQ(RC::SUCCESS, scan.open(trx));
+    int num = 0;
+    while (OB_SUCC(scan.next())) {
+      num++;
+    }
+    scan.close();
+    return num;
+  };
+  // 索引中键值为 key 的索引项个数，不判断可见性
+  auto index_entries = [index](int key) {
+    IndexScanner *scanner = index->create_scanner(
+        reinterpret_cast<const char *>(&key), sizeof(key), true, reinterpret_cast<const char *>(&key), sizeof(key), true);
+    int num = 0;
+    RID rid;
+    while (OB_SUCC(scanner->next_entry(&rid))) {
+      num++;
+    }
+    scanner->destroy();
+    return num;
+  };
+
+  // 更新索引字段以后，之前开始的事务仍然可以通过旧的键值找到记录，并且不会重复返回
+  Trx *reader = begin();
+  Trx *writer = begin();
+  ASSERT_EQ(RC::SUCCESS, update(writer, 2));
+  ASSERT_EQ(1, index_read(reader, 1, 1));
+  ASSERT_EQ(0, index_read(reader, 2, 2));
+  ASSERT_EQ(1, index_read(reader, 1, 2));
+  ASSERT_EQ(0, index_read(writer, 1, 1));
+  ASSERT_EQ(1, index_read(writer, 2, 2));
+  ASSERT_EQ(1, index_read(writer, 1, 2));
+
+  ASSERT_EQ(RC::SUCCESS, writer->commit());
+  db_->trx_kit().destroy_trx(writer);
+  ASSERT_EQ(1, index_read(reader, 1, 1));
+  ASSERT_EQ(0, index_read(reader, 2, 2));
+
+  Trx *new_reader = begin();
+  ASSERT_EQ(0, index_read(new_reader, 1, 1));
+  ASSERT_EQ(1, index_read(new_reader, 2, 2));
+  ASSERT_EQ(1, index_read(new_reader, 1, 2));
+
+  // 回滚的版本和被自己再次更新的版本，索引项直接删除
+  writer = begin();
+  ASSERT_EQ(RC::SUCCESS, update(writer, 3));
+  ASSERT_EQ(RC::SUCCESS, update(writer, 4));
+  ASSERT_EQ(0, index_entries(3));
+  ASSERT_EQ(1, index_entries(4));
+  ASSERT_EQ(RC::SUCCESS, writer->rollback());
+  db_->trx_kit().destroy_trx(writer);
+  ASSERT_EQ(0, index_entries(4));
+  ASSERT_EQ(1, index_read(new_reader, 2, 2));
+
+  // 旧版本清理以后，它的索引项也删除了
+  auto &trx_kit = static_cast<MvccTrxKit &>(db_->trx_kit());
+  ASSERT_EQ(1, index_entries(1));
+  ASSERT_EQ(0, trx_kit.purge_undo());
+  for (Trx *trx : {reader, new_reader}) {
+    ASSERT_EQ(RC::SUCCESS, trx->rollback());
+    db_->trx_kit().destroy_trx(trx);
+  }
+  ASSERT_EQ(1, trx_kit.purge_undo());
+  ASSERT_EQ(0, index_entries(1));
+  ASSERT_EQ(1, index_entries(2));
+}
+
+TEST_F(MvccUndoTrxTest, unique_index_old_key)
+{
+  Trx *trx = begin();
+  ASSERT_EQ(RC::SUCCESS, table_->create_index(trx, table_->table_meta().field("id"), "id_index", true /*unique*/));
+  ASSERT_EQ(RC::SUCCESS, trx->commit());
+  db_->trx_kit().destroy_trx(trx);
+
+  auto insert = [this](Trx *trx, int value, RID &rid) {
+    Record record;
+    Value  id(value);
+    RC     rc = table_->make_record(1, &id, record);
+    if (OB_SUCC(rc)) {
+      rc = trx->insert_record(table_, record);
+      rid = record.rid();
+    }
+    return rc;
+  };
+
+  // 旧版本还在被快照使用，它的索引项不能清理
+  Trx *reader = begin();
+  Trx *writer = begin();
+  ASSERT_EQ(RC::SUCCESS, update(writer, 2));
+
+  // 修改还没有提交，回滚以后记录仍然使用旧的键值
+  RID  rid;
+  Trx *inserter = begin();
+  ASSERT_EQ(RC::RECORD_DUPLICATE_KEY, insert(inserter, 1, rid));
+  ASSERT_EQ(RC::SUCCESS, inserter->rollback());
+  db_->trx_kit().destroy_trx(inserter);
+
+  ASSERT_EQ(RC::SUCCESS, writer->commit());
+  db_->trx_kit().destroy_trx(writer);
+
+  // 提交以后，旧键值只剩下旧版本的索引项，不算重复
+  inserter = begin();
+  ASSERT_EQ(RC::SUCCESS, insert(inserter, 1, rid));
+  ASSERT_EQ(RC::RECORD_DUPLICATE_KEY, insert(inserter, 2, rid));
+  ASSERT_EQ(RC::SUCCESS, inserter->commit());
+  db_->trx_kit().destroy_trx(inserter);
+  ASSERT_EQ(1, read(reader));
+
+  // 改回旧的键值时，不能因为自己的旧索引项还在就忽略其它记录
+  writer = begin();
+  ASSERT_EQ(RC::RECORD_DUPLICATE_KEY, update(writer, 1));
+  ASSERT_EQ(RC::SUCCESS, writer->rollback());
+  db_->trx_kit().destroy_trx(writer);
+
+  ASSERT_EQ(RC::SUCCESS, reader->rollback());
+  db_->trx_kit().destroy_trx(reader);
+}
+
+TEST_F(MvccUndoTrxTest, rollback)
+{
+  Trx *reader = begin();
+  Trx *writer = begin();
+  ASSERT_EQ(RC::SUCCESS, update(writer, 2));
+  ASSERT_EQ(RC::SUCCESS, update(writer, 3));
+  ASSERT_EQ(3, read(writer));
+  ASSERT_EQ(RC::SUCCESS, writer->rollback());
+
+  ASSERT_EQ(1, read(reader));
+  auto &trx_kit = static_cast<MvccTrxKit &>(db_->trx_kit());
+  ASSERT_EQ(0, trx_kit.undo_store().version_count());
+
+  ASSERT_EQ(RC::SUCCESS, writer->start_if_need());
+  ASSERT_EQ(RC::SUCCESS, update(writer, 4));
+  ASSERT_EQ(RC::SUCCESS, writer->commit());
+  ASSERT_EQ(1, read(reader));
+
+  ASSERT_EQ(RC::SUCCESS, reader->rollback());
+  db_->trx_kit().destroy_trx(reader);
+  db_->trx_kit().destroy_trx(writer);
+}
+
+TEST_F(MvccUndoTrxTest, wait_for_row_lock)
+{
+  auto &trx_kit = static_cast<MvccTrxKit &>(db_->trx_kit());
+  trx_kit.lock_manager().set_wait_timeout_ms(60 * 1000);
+
+  // 修改的事务回滚以后，等锁的事务可以继续修改
+  Trx *writer = begin();
+  Trx *other  = begin();
+  ASSERT_EQ(RC::SUCCESS, update(writer, 2));
+
+  RC     other_rc = RC::INTERNAL;
+  thread waiter([this, other, &other_rc] { other_rc = update(other, 3); });
+  while (trx_kit.lock_manager().waiting_count() == 0) {
+    this_thread::sleep_for(chrono::milliseconds(1));
+  }
+  ASSERT_EQ(RC::SUCCESS, writer->rollback());
+  waiter.join();
+  ASSERT_EQ(RC::SUCCESS, other_rc);
+  ASSERT_EQ(RC::SUCCESS, other->commit());
+
+  Trx *reader = begin();
+  ASSERT_EQ(3, read(reader));
+
+  // 修改的事务提交了，说明记录在等锁的事务的快照之后被修改过，返回冲突
+  ASSERT_EQ(RC::SUCCESS, writer->start_if_need());
+  Trx *late = begin();
+  ASSERT_EQ(RC::SUCCESS, update(writer, 4));
+
+  RC late_rc = RC::INTERNAL;
+  waiter     = thread([this, late, &late_rc] { late_rc = update(late, 5); });
+  while (trx_kit.lock_manager().waiting_count() == 0) {
+    this_thread::sleep_for(chrono::milliseconds(1));
+  }
+  ASSERT_EQ(RC::SUCCESS, writer->commit());
+  waiter.join();
+  ASSERT_EQ(RC::LOCKED_CONCURRENCY_CONFLICT, late_rc);
+  ASSERT_EQ(RC::SUCCESS, late->rollback());
+  ASSERT_EQ(0, trx_kit.lock_manager().lock_count());
+  ASSERT_EQ(2, trx_kit.lock_manager().stats().waits);
+
+  for (Trx *trx : {writer, other, reader, late}) {
+    db_->trx_kit().destroy_trx(trx);
+  }
+}
+
+TEST_F(MvccUndoTrxTest, autocommit_write_latest_version)
+{
+  auto &trx_kit = static_cast<MvccTrxKit &>(db_->trx_kit());
+  trx_kit.lock_manager().set_wait_timeout_ms(60 * 1000);
+
+  // 自动提交的语句等到修改的事务提交以后，在最新提交的版本上修改
+  Trx *writer = begin();
+  Trx *late   = begin();
+  late->set_autocommit(true);
+  ASSERT_EQ(RC::SUCCESS, update(writer, 2));
+
+  RC     late_rc = RC::INTERNAL;
+  thread waiter([this, late, &late_rc] { late_rc = update(late, 3); });
+  while (trx_kit.lock_manager().waiting_count() == 0) {
+    this_thread::sleep_for(chrono::milliseconds(1));
+  }
+  ASSERT_EQ(RC::SUCCESS, writer->commit());
+  waiter.join();
+  ASSERT_EQ(RC::SUCCESS, late_rc);
+  ASSERT_EQ(RC::SUCCESS, late->commit());
+
+  Trx *reader = begin();
+  ASSERT_EQ(3, read(reader));
+  ASSERT_EQ(RC::SUCCESS, reader->commit());
+
+  // 等锁期间记录被删除了，自动提交的删除跳过这条记录
+  ASSERT_EQ(RC::SUCCESS, writer->start_if_need());
+  ASSERT_EQ(RC::SUCCESS, late->start_if_need());
+  Record record;
+  record.set_rid(rid_);
+  ASSERT_EQ(RC::SUCCESS, writer->delete_record(table_, record));
+
+  waiter = thread([late, &record, &late_rc, this] { late_rc = late->delete_record(table_, record); });
+  while (trx_kit.lock_manager().waiting_count() == 0) {
+    this_thread::sleep_for(chrono::milliseconds(1));
+  }
+  ASSERT_EQ(RC::SUCCESS, writer->commit());
+  waiter.join();
+  ASSERT_EQ(RC::SUCCESS, late_rc);
+  ASSERT_EQ(RC::SUCCESS, late->commit());
+
+  ASSERT_EQ(RC::SUCCESS, reader->start_if_need());
+  ASSERT_EQ(-1, read(reader));
+  ASSERT_EQ(RC::SUCCESS, reader->commit());
+
+  for (Trx *trx : {writer, late, reader}) {
+    db_->trx_kit().destroy_trx(trx);
+  }
+}
+
+TEST_F(MvccUndoTrxTest, autocommit_recheck_latest_version)
+{
+  auto &trx_kit = static_cast<MvccTrxKit &>(db_->trx_kit());
+  trx_kit.lock_manager().set_wait_timeout_ms(60 * 1000);
+
+  const FieldMeta *field = table_->table_meta().field("id");
+  auto id_equals = [this, field](int value) -> unique_ptr<Expression> {
+    return make_unique<ComparisonExpr>(
+        CompOp::EQUAL_TO, make_unique<FieldExpr>(table_, field), make_unique<ValueExpr>(Value(value)));
+  };
+  // 执行 UPDATE t SET id = value [WHERE id = where_value]，记录被其它事务改成 writer_value 后提交
+  auto run_update = [&](int value, int where_value, int writer_value) {
+    Trx *writer = begin();
+    Trx *late   = begin();
+    late->set_autocommit(true);
+    ASSERT_EQ(RC::SUCCESS, update(writer, writer_value));
+
+    auto scan = make_unique<TableScanPhysicalOperator>(table_, ReadWriteMode::READ_WRITE);
+    auto oper = make_unique<UpdatePhysicalOperator>(table_, field, Value(value));
+    if (where_value >= 0) {
+      vector<unique_ptr<Expression>> predicates;
+      predicates.emplace_back(id_equals(where_value));
+      scan->set_predicates(std::move(predicates));
+      oper->set_recheck_predicate(id_equals(where_value));
+    }
+    oper->add_child(std::move(scan));
+
+    RC     late_rc = RC::INTERNAL;
+    thread waiter([&oper, late, &late_rc] { late_rc = oper->open(late); });
+    while (trx_kit.lock_manager().waiting_count() == 0) {
+      this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    ASSERT_EQ(RC::SUCCESS, writer->commit());
+    waiter.join();
+    ASSERT_EQ(RC::SUCCESS, late_rc);
+    ASSERT_EQ(RC::SUCCESS, oper->close());
+    ASSERT_EQ(RC::SUCCESS, late->commit());
+
+    for (Trx *trx : {writer, late}) {
+      db_->trx_kit().destroy_trx(trx);
+    }
+  };
+
+  // 快照中的记录满足条件，最新版本不满足，跳过这条记录
+  run_update(5, 1, 2);
+  Trx *reader = begin();
+  ASSERT_EQ(2, read(reader));
+  ASSERT_EQ(RC::SUCCESS, reader->commit());
+
+  // 新值与快照中的值相同，仍然要覆盖其它事务提交的修改
+  run_update(2, -1, 3);
+  ASSERT_EQ(RC::SUCCESS, reader->start_if_need());
+  ASSERT_EQ(2, read(reader));
+  ASSERT_EQ(RC::SUCCESS, reader->commit());
+
+  // 最新版本仍然满足条件，在最新版本上修改
+  run_update(7, 2, 2);
+  ASSERT_EQ(RC::SUCCESS, reader->start_if_need());
+  ASSERT_EQ(7, read(reader));
+  ASSERT_EQ(RC::SUCCESS, reader->commit());
+  db_->trx_kit().destroy_trx(reader);
+}
+
+TEST_F(MvccUndoTrxTest, read_only_trx)
+{
+  auto &trx_kit = static_cast<MvccTrxKit &>(db_->trx_kit());
+  auto  begin_read_only = [this]() {
+    Trx *trx = db_->trx_kit().create_read_only_trx(db_->log_handler());
+    trx->start_if_need();
+    return trx;
+  };
+
+  Trx *writer = begin();
+  Trx *reader = begin_read_only();
+  ASSERT_TRUE(reader->read_only());
+
+  // 只读事务不分配事务ID
+  Trx *other = begin();
+  ASSERT_EQ(writer->id() + 1, other->id());
+  ASSERT_EQ(writer->id(), reader->id());
+
+  // 快照与正在修改记录的事务ID相同时，也不能看到它的修改
+  ASSERT_EQ(RC::SUCCESS, update(writer, 2));
+  ASSERT_EQ(1, read(reader));
+  ASSERT_EQ(RC::SUCCESS, writer->commit());
+  ASSERT_EQ(1, read(reader));
+
+  Record record;
+  Value  value(10);
+  ASSERT_EQ(RC::SUCCESS, table_->make_record(1, &value, record));
+  ASSERT_EQ(RC::UNSUPPORTED, reader->insert_record(table_, record));
+
+  // 只读事务的快照还在使用旧版本，不能清理
+  ASSERT_EQ(RC::SUCCESS, other->rollback());
+  ASSERT_EQ(0, trx_kit.purge_undo());
+
+  Trx *new_reader = begin_read_only();
+  ASSERT_EQ(2, read(new_reader));
+
+  ASSERT_EQ(RC::SUCCESS, reader->commit());
+  ASSERT_EQ(1, trx_kit.purge_undo());
+  ASSERT_EQ(2, read(new_reader));
+  ASSERT_EQ(RC::SUCCESS, new_reader->commit());
+
+  for (Trx *trx : {writer, reader, other, new_reader}) {
+    db_->trx_kit().destroy_trx(trx);
+  }
+}
+
+TEST(MvccReadOnlyTrx, read_after_restart)
+{
+  filesystem::path db_path = "mvcc_read_only_restart_test";
+  filesystem::remove_all(db_path);
+  filesystem::create_directories(db_path);
+
+  {
+    Db db;
+    ASSERT_EQ(RC::SUCCESS, db.init("test_db", db_path.c_str(), "mvcc", "disk"));
+
+    AttrInfoSqlNode attr_info;
+    attr_info.name   = "id";
+    attr_info.type   = AttrType::INTS;
+    attr_info.length = 4;
+    vector<AttrInfoSqlNode> attr_infos{attr_info};
+    ASSERT_EQ(RC::SUCCESS, db.create_table("t", attr_infos, {}));
+    Table *table = db.find_table("t");
+    ASSERT_NE(nullptr, table);
+
+    for (int i = 0; i < 2; i++) {
+      Trx *trx = db.trx_kit().create_trx(db.log_handler());
+      trx->start_if_need();
+      Record record;
+      Value  value(i);
+      ASSERT_EQ(RC::SUCCESS, table->make_record(1, &value, record));
+      ASSERT_EQ(RC::SUCCESS, trx->insert_record(table, record));
+      ASSERT_EQ(RC::SUCCESS, trx->commit());
+      db.trx_kit().destroy_trx(trx);
+    }
+  }
+
+  // 重启以后只读事务不分配事务ID，快照也要包含重启之前最后提交的事务
+  {
+    Db db;
+    ASSERT_EQ(RC::SUCCESS, db.init("test_db", db_path.c_str(), "mvcc", "disk"));
+    Table *table = db.find_table("t");
+    ASSERT_NE(nullptr, table);
+
+    Trx *reader = db.trx_kit().create_read_only_trx(db.log_handler());
+    reader->start_if_need();
+    RecordScanner *scanner = nullptr;
+    ASSERT_EQ(RC::SUCCESS, table->get_record_scanner(scanner, reader, ReadWriteMode::READ_ONLY));
+    int    num = 0;
+    Record record;
+    while (OB_SUCC(scanner->next(record))) {
+      num++;
+    }
+    delete scanner;
+    ASSERT_EQ(2, num);
+    ASSERT_EQ(RC::SUCCESS, reader->commit());
+    db.trx_kit().destroy_trx(reader);
+  }
+
+  filesystem::remove_all(db_path);
+}
+
+TEST_F(MvccUndoTrxTest, commit_many_pages)
+{
+  auto count = [this](Trx *trx) {
+    RecordScanner *scanner = nullptr;
+    EXPECT_EQ(RC::SUCCESS, table_->get_record_scanner(scanner, trx, ReadWriteMode::READ_ONLY));
+    int    num = 0;
+    Record record;
+    while (OB_SUCC(scanner->next(record))) {
+      num++;
+    }
+    delete scanner;
+    return num;
+  };
+
+  // 一个事务中插入、删除和更新跨越多个页面的记录，提交时按页面批量修改
+  Trx        *reader     = begin();
+  Trx        *writer     = begin();
+  const int   insert_num = 2000;
+  vector<RID> rids;
+  for (int i = 0; i < insert_num; i++) {
+    Record record;
+    Value  value(i + 100);
+    ASSERT_EQ(RC::SUCCESS, table_->make_record(1, &value, record));
+    ASSERT_EQ(RC::SUCCESS, writer->insert_record(table_, record));
+    rids.push_back(record.rid());
+  }
+  ASSERT_GT(rids.back().page_num, rids.front().page_num);
+
+  for (int i = 0; i < insert_num; i += 2) {
+    Record record;
+    ASSERT_EQ(RC::SUCCESS, table_->get_record(rids[i], record));
+    ASSERT_EQ(RC::SUCCESS, writer->delete_record(table_, record));
+  }
+  ASSERT_EQ(RC::SUCCESS, update(writer, 2));
+  ASSERT_EQ(RC::SUCCESS, writer->commit());
+
+  ASSERT_EQ(1, count(reader));
+  ASSERT_EQ(1, read(reader));
+
+  Trx *new_reader = begin();
+  ASSERT_EQ(1 + insert_num / 2, count(new_reader));
+
+  Record record;
+  ASSERT_EQ(RC::SUCCESS, table_->get_record(rid_, record));
+  ASSERT_EQ(2, *reinterpret_cast<const int *>(record.data() + table_->table_meta().field("id")->offset()));
+
+  for (Trx *trx : {reader, new_reader}) {
+    ASSERT_EQ(RC::SUCCESS, trx->rollback());
+    db_->trx_kit().destroy_trx(trx);
+  }
+  db_->trx_kit().destroy_trx(writer);
+}
+
+TEST_F(MvccUndoTrxTest, pax_chunk_scan)
+{
+  // | id int | grp int |，grp 是连续相同的值，可以根据 zone map 跳过页面
+  vector<AttrInfoSqlNode> attr_infos(2);
+  attr_infos[0].name   = "id";
+  attr_infos[0].type   = AttrType::INTS;
+  attr_infos[0].length = 4;
+  attr_infos[1].name   = "grp";
+  attr_infos[1].type   = AttrType::INTS;
+  attr_infos[1].length = 4;
+  ASSERT_EQ(RC::SUCCESS, db_->create_table("p", attr_infos, {}, StorageFormat::PAX_FORMAT));
+  Table *table = db_->find_table("p");
+  ASSERT_NE(nullptr, table);
+
+  const int   record_num = 2000;
+  vector<RID> rids;
+  Trx        *trx = begin();
+  for (int i = 0; i < record_num; i++) {
+    Value  values[] = {Value(i), Value(i / 100)};
+    Record record;
+    ASSERT_EQ(RC::SUCCESS, table->make_record(2, values, record));
+    ASSERT_EQ(RC::SUCCESS, trx->insert_record(table, record));
+    rids.push_back(record.rid());
+  }
+  ASSERT_EQ(RC::SUCCESS, trx->commit());
+  db_->trx_kit().destroy_trx(trx);
+
+  // 按列扫描，返回 grp 等于 grp_value 的可见记录条数。chunk 中使用 field_id，zone map 使用页面上列的下标
+  const FieldMeta *grp_field = table->table_meta().field("grp");
+  const int        grp_index = table->table_meta().field_index(grp_field->field_id());
+  auto             count     = [table, grp_field, grp_index](Trx *trx, int grp_value) {
+    ChunkFileScanner scanner;
+    EXPECT_EQ(RC::SUCCESS, table->get_chunk_scanner(scanner, trx, ReadWriteMode::READ_ONLY));
+    vector<ZonePredicate> predicates(1);
+    predicates[0].col_id = grp_index;
+    predicates[0].comp   = EQUAL_TO;
+    predicates[0].value  = Value(grp_value);
+    scanner.set_zone_predicates(std::move(predicates));
+
+    Chunk chunk;
+    chunk.add_column(make_unique<Column>(*grp_field), grp_field->field_id());
+    int num = 0;
+    RC  rc  = RC::SUCCESS;
+    while (OB_SUCC(rc = scanner.next_chunk(chunk))) {
+      for (int row = 0; row < chunk.rows(); row++) {
+        num += chunk.get_value(0, row).get_int() == grp_value ? 1 : 0;
+      }
+      chunk.reset_data();
+    }
+    EXPECT_EQ(RC::RECORD_EOF, rc);
+    return num;
+  };
+
+  // 更新和删除以后，之前开始的事务仍然按照快照中的版本过滤
+  Trx *reader = begin();
+  Trx *writer = begin();
+  for (int i = 0; i < 10; i++) {
+    Record record;
+    ASSERT_EQ(RC::SUCCESS, table->get_record(rids[i], record));
+    ASSERT_EQ(RC::SUCCESS, writer->delete_record(table, record));
+
+    Record old_record;
+    ASSERT_EQ(RC::SUCCESS, table->get_record(rids[300 + i], old_record));
+    Record new_record;
+    new_record.copy_data(old_record.data(), old_record.len());
+    new_record.set_rid(old_record.rid());
+    const int new_grp = 50;
+    memcpy(new_record.data() + grp_field->offset(), &new_grp, sizeof(new_grp));
+    ASSERT_EQ(RC::SUCCESS, writer->update_record(table, old_record, new_record));
+  }
+
+  ASSERT_EQ(90, count(writer, 0));
+  ASSERT_EQ(90, count(writer, 3));
+  ASSERT_EQ(10, count(writer, 50));
+  ASSERT_EQ(100, count(writer, 7));
+  ASSERT_EQ(100, count(reader, 0));
+  ASSERT_EQ(100, count(reader, 3));
+  ASSERT_EQ(0, count(reader, 50));
+
+  ASSERT_EQ(RC::SUCCESS, writer->commit());
+  db_->trx_kit().destroy_trx(writer);
+  ASSERT_EQ(100, count(reader, 0));
+  ASSERT_EQ(100, count(reader, 3));
+  ASSERT_EQ(0, count(reader, 50));
+  ASSERT_EQ(100, count(reader, 19));
+
+  Trx *new_reader = begin();
+  ASSERT_EQ(90, count(new_reader, 0));
+  ASSERT_EQ(90, count(new_reader, 3));
+  ASSERT_EQ(10, count(new_reader, 50));
+  ASSERT_EQ(100, count(new_reader, 19));
+
+  for (Trx *trx : {reader, new_reader}) {
+    ASSERT_EQ(RC::SUCCESS, trx->rollback());
+    db_->trx_kit().destroy_trx(trx);
+  }
+}
+
+TEST_F(MvccUndoTrxTest, vec_table_scan)
+{
+  vector<AttrInfoSqlNode> attr_infos(2);
+  attr_infos[0].name   = "id";
+  attr_infos[0].type   = AttrType::INTS;
+  attr_infos[0].length = 4;
+  attr_infos[1].name   = "grp";
+  attr_infos[1].type   = AttrType::INTS;
+  attr_infos[1].length = 4;
+
+  for (StorageFormat storage_format : {StorageFormat::ROW_FORMAT, StorageFormat::PAX_FORMAT}) {
+    const string table_name = storage_format == StorageFormat::PAX_FORMAT ? "vp" : "vr";
+    ASSERT_EQ(RC::SUCCESS, db_->create_table(table_name.c_str(), attr_infos, {}, storage_format));
+    Table *table = db_->find_table(table_name.c_str());
+    ASSERT_NE(nullptr, table);
+    const TableMeta &table_meta = table->table_meta();
+    ASSERT_GT(table_meta.sys_field_num(), 0);
+
+    const int   record_num = 2000;
+    vector<RID> rids;
+    Trx        *trx = begin();
+    for (int i = 0; i < record_num; i++) {
+      Value  values[] = {Value(i), Value(i / 100)};
+      Record record;
+      ASSERT_EQ(RC::SUCCESS, table->make_record(2, values, record));
+      ASSERT_EQ(RC::SUCCESS, trx->insert_record(table, record));
+      rids.push_back(record.rid());
+    }
+    ASSERT_EQ(RC::SUCCESS, trx->commit());
+    db_->trx_kit().destroy_trx(trx);
+
+    // 删除 grp = 0 中的一半记录，但是不提交
+    Trx *writer = begin();
+    for (int i = 0; i < 100; i += 2) {
+      Record record;
+      ASSERT_EQ(RC::SUCCESS, table->get_record(rids[i], record));
+      ASSERT_EQ(RC::SUCCESS, writer->delete_record(table, record));
+    }
+
+    const FieldMeta *id_field  = table_meta.field("id");
+    const FieldMeta *grp_field = table_meta.field("grp");
+
+    // 返回可见的行数，以及第一列的和
+    auto scan = [&](Trx *trx, vector<int> column_ids, int grp_value, int &column_num, int64_t &sum) {
+      TableScanVecPhysicalOperator oper(table, ReadWriteMode::READ_ONLY);
+      if (!column_ids.empty()) {
+        oper.set_column_ids(std::move(column_ids));
+      }
+      if (grp_value >= 0) {
+        vector<unique_ptr<Expression>> predicates;
+        predicates.emplace_back(make_unique<ComparisonExpr>(
+            EQUAL_TO, make_unique<FieldExpr>(table, grp_field), make_unique<ValueExpr>(Value(grp_value))));
+        oper.set_predicates(std::move(predicates));
+      }
+
+      EXPECT_EQ(RC::SUCCESS, oper.open(trx));
+      int   rows = 0;
+      Chunk chunk;
+      RC    rc = RC::SUCCESS;
+      sum      = 0;
+      while (OB_SUCC(rc = oper.next(chunk))) {
+        column_num = chunk.column_num();
+        rows += chunk.rows();
+        const int index = chunk.column_index(id_field->field_id());
+        for (int row = 0; index >= 0 && row < chunk.rows(); row++) {
+          sum += chunk.get_value(index, row).get_int();
+        }
+      }
+      EXPECT_EQ(RC::RECORD_EOF, rc);
+      EXPECT_EQ(RC::SUCCESS, oper.close());
+      return rows;
+    };
+
+    int     column_num = 0;
+    int64_t sum        = 0;
+
+    // 没有指定列时读取所有的字段，包括 field_id 是负数的事务字段
+    Trx *reader = begin();
+    ASSERT_EQ(record_num, scan(reader, {}, -1, column_num, sum));
+    ASSERT_EQ(table_meta.field_num(), column_num);
+    ASSERT_EQ(int64_t(record_num) * (record_num - 1) / 2, sum);
+
+    ASSERT_EQ(record_num - 50, scan(writer, {}, -1, column_num, sum));
+
+    // 只读取部分列，条件列使用 field_id 在 chunk 中查找，zone map 使用页面上的列
+    ASSERT_EQ(100, scan(reader, {id_field->field_id(), grp_field->field_id()}, 3, column_num, sum));
+    ASSERT_EQ(2, column_num);
+    ASSERT_EQ(int64_t(300 + 399) * 100 / 2, sum);
+    ASSERT_EQ(50, scan(writer, {id_field->field_id(), grp_field->field_id()}, 0, column_num, sum));
+
+    // 与 count(*) 的计划相同，只读取第一个用户字段
+    ASSERT_EQ(record_num - 50, scan(writer, {table_meta.field(table_meta.sys_field_num())->field_id()}, -1, column_num, sum));
+    ASSERT_EQ(1, column_num);
+
+    for (Trx *trx : {reader, writer}) {
+      ASSERT_EQ(RC::SUCCESS, trx->rollback());
+      db_->trx_kit().destroy_trx(trx);
+    }
+  }
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  filesystem::path log_filename = filesystem::path(argv[0]).filename();
+  LoggerFactory::init_default(log_filename.string() + ".log", LOG_LEVEL_INFO);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,195 @@
+/* Copyright (c) 2021 OceanBase and/or its affiliates. All rights reserved.
+miniob is licensed under Mulan PSL v2.
+You can use this software according to the terms and conditions of the Mulan PSL v2.
+You may obtain a copy of Mulan PSL v2 at:
+         http://license.coscl.org.cn/MulanPSL2
+THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+See the Mulan PSL v2 for more details. */
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/db/db.h"
+#include "storage/record/record_scanner.h"
+#include "storage/table/table.h"
+#include "storage/trx/mvcc_trx.h"
+#include "storage/trx/mvcc_vacuum.h"
+
+using namespace std;
+using namespace common;
+
+class MvccVacuumTest : public testing::Test
+{
+public:
+  void SetUp() override
+  {
+    filesystem::remove_all(db_path_);
+    filesystem::create_directories(db_path_);
+
+    // 不启动后台线程，测试中手动执行清理
+    MvccVacuum::set_default_interval_ms(0);
+
+    db_ = make_unique<Db>();
+    ASSERT_EQ(RC::SUCCESS, db_->init("test_db", db_path_.c_str(), "mvcc", "vacuous"));
+    ASSERT_NE(nullptr, db_->vacuum());
+
+    AttrInfoSqlNode attr_info;
+    attr_info.name   = "id";
+    attr_info.type   = AttrType::INTS;
+    attr_info.length = 4;
+    vector<AttrInfoSqlNode> attr_infos{attr_info};
+    ASSERT_EQ(RC::SUCCESS, db_->create_table("t", attr_infos, {}));
+    table_ = db_->find_table("t");
+    ASSERT_NE(nullptr, table_);
+
+    Trx *trx = begin();
+    for (int i = 0; i < record_num_; i++) {
+      Record record;
+      Value  value(i);
+      ASSERT_EQ(RC::SUCCESS, table_->make_record(1, &value, record));
+      ASSERT_EQ(RC::SUCCESS, trx->insert_record(table_, record));
+      rids_.push_back(record.rid());
+    }
+    ASSERT_EQ(RC::SUCCESS, trx->commit());
+    db_->trx_kit().destroy_trx(trx);
+  }
+
+  void TearDown() override
+  {
+    db_.reset();
+    filesystem::remove_all(db_path_);
+    MvccVacuum::set_default_interval_ms(MvccVacuum::DEFAULT_INTERVAL_MS);
+  }
+
+  Trx *begin()
+  {
+    Trx *trx = db_->trx_kit().create_trx(db_->log_handler());
+    trx->start_if_need();
+    return trx;
+  }
+
+  /**
+   * @brief 统计事务能看到的记录条数，trx 为空时统计页面上实际存在的记录
+   */
+  int count(Trx *trx)
+  {
+    RecordScanner *scanner = nullptr;
+    if (OB_FAIL(table_->get_record_scanner(scanner, trx, ReadWriteMode::READ_ONLY))) {
+      return -1;
+    }
+
+    int    num = 0;
+    Record record;
+    while (OB_SUCC(scanner->next(record))) {
+      num++;
+    }
+    delete scanner;
+    return num;
+  }
+
+  int vacuum()
+  {
+    const int64_t removed       = db_->vacuum()->stats().records_removed;
+    int           pages_scanned = 0;
+    EXPECT_EQ(RC::SUCCESS, db_->vacuum()->run_once(1024, pages_scanned));
+    return static_cast<int>(db_->vacuum()->stats().records_removed - removed);
+  }
+
+protected:
+  filesystem::path db_path_    = "mvcc_vacuum_test";
+  const int        record_num_ = 2000;
+  unique_ptr<Db>   db_;
+  Table           *table_ = nullptr;
+  vector<RID>      rids_;
+};
+
+TEST_F(MvccVacuumTest, remove_dead_records)
+{
+  Trx *reader = begin();
+
+  // 删除一半的记录
+  Trx *writer = begin();
+  for (int i = 0; i < record_num_; i += 2) {
+    Record record;
+    ASSERT_EQ(RC::SUCCESS, table_->get_record(rids_[i], record));
+    ASSERT_EQ(RC::SUCCESS, writer->delete_record(table_, record));
+  }
+
+  // 没有提交的删除不能清理
+  ASSERT_EQ(0, vacuum());
+  ASSERT_EQ(RC::SUCCESS, writer->commit());
+  db_->trx_kit().destroy_trx(writer);
+
+  // 还有事务可能看到删除的记录
+  ASSERT_EQ(0, vacuum());
+  ASSERT_EQ(record_num_, count(reader));
+  ASSERT_EQ(record_num_, count(nullptr));
+
+  ASSERT_EQ(RC::SUCCESS, reader->rollback());
+  db_->trx_kit().destroy_trx(reader);
+
+  ASSERT_EQ(record_num_ / 2, vacuum());
+  ASSERT_EQ(record_num_ / 2, count(nullptr));
+  int64_t pages = db_->vacuum()->stats().pages_scanned;
+  ASSERT_EQ(0, vacuum());
+  pages = db_->vacuum()->stats().pages_scanned - pages;
+
+  Trx *trx = begin();
+  ASSERT_EQ(record_num_ / 2, count(trx));
+
+  // 清理出来的空间可以重新使用，不会分配新的页面
+  for (int i = 0; i < record_num_ / 2; i++) {
+    Record record;
+    Value  value(i);
+    ASSERT_EQ(RC::SUCCESS, table_->make_record(1, &value, record));
+    ASSERT_EQ(RC::SUCCESS, trx->insert_record(table_, record));
+  }
+  ASSERT_EQ(RC::SUCCESS, trx->commit());
+  db_->trx_kit().destroy_trx(trx);
+  ASSERT_EQ(record_num_, count(nullptr));
+
+  const int64_t pages_before = db_->vacuum()->stats().pages_scanned;
+  ASSERT_EQ(0, vacuum());
+  ASSERT_EQ(pages, db_->vacuum()->stats().pages_scanned - pages_before);
+
+  MvccVacuumStats stats = db_->vacuum()->stats();
+  ASSERT_EQ(record_num_ / 2, stats.records_removed);
+  ASSERT_EQ(5, stats.passes);
+}
+
+TEST_F(MvccVacuumTest, page_budget)
+{
+  Trx *writer = begin();
+  for (const RID &rid : rids_) {
+    Record record;
+    ASSERT_EQ(RC::SUCCESS, table_->get_record(rid, record));
+    ASSERT_EQ(RC::SUCCESS, writer->delete_record(table_, record));
+  }
+  ASSERT_EQ(RC::SUCCESS, writer->commit());
+  db_->trx_kit().destroy_trx(writer);
+
+  // 每轮只扫描一个页面，多轮以后才能清理完
+  int passes = 0;
+  while (count(nullptr) > 0) {
+    int pages_scanned = 0;
+    ASSERT_EQ(RC::SUCCESS, db_->vacuum()->run_once(1, pages_scanned));
+    ASSERT_LE(pages_scanned, 1);
+    passes++;
+    ASSERT_LT(passes, 1000);
+  }
+  ASSERT_EQ(record_num_, db_->vacuum()->stats().records_removed);
+  ASSERT_GT(passes, 1);
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  filesystem::path log_filename = filesystem::path(argv[0]).filename();
+  LoggerFactory::init_default(log_filename.string() + ".log", LOG_LEVEL_INFO);
+  return RUN_ALL_TESTS();
+}
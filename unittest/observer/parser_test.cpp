@@ -64,6 +64,57 @@ TEST(ParserTest, DISABLED_group_by_test)
   }
 }
 
+TEST(ParserTest, create_index_using)
+{
+  {
+    ParsedSqlResult result;
+    ASSERT_EQ(parse("create index i_id on t(id) using hash", &result), RC::SUCCESS);
+    ASSERT_EQ(1, result.sql_nodes().size());
+    const ParsedSqlNode &node = *result.sql_nodes().front();
+    ASSERT_EQ(SCF_CREATE_INDEX, node.flag);
+    ASSERT_EQ("i_id", node.create_index.index_name);
+    ASSERT_EQ("id", node.create_index.attribute_name);
+    ASSERT_EQ("hash", node.create_index.index_method);
+    ASSERT_FALSE(node.create_index.Unique);
+  }
+  {
+    ParsedSqlResult result;
+    ASSERT_EQ(parse("CREATE UNIQUE INDEX i_id ON t(id) USING BTREE;", &result), RC::SUCCESS);
+    ASSERT_EQ(1, result.sql_nodes().size());
+    const ParsedSqlNode &node = *result.sql_nodes().front();
+    ASSERT_EQ(SCF_CREATE_INDEX, node.flag);
+    ASSERT_EQ("BTREE", node.create_index.index_method);
+    ASSERT_TRUE(node.create_index.Unique);
+  }
+  {
+    ParsedSqlResult result;
+    ASSERT_EQ(parse("create index i_id on t(id)", &result), RC::SUCCESS);
+    ASSERT_EQ(SCF_CREATE_INDEX, result.sql_nodes().front()->flag);
+    ASSERT_TRUE(result.sql_nodes().front()->create_index.index_method.empty());
+  }
+  {
+    ParsedSqlResult result;
+    ASSERT_EQ(parse("create index i_id on t(id) with hash", &result), RC::SUCCESS);
+    ASSERT_EQ(SCF_ERROR, result.sql_nodes().front()->flag);
+  }
+
+  // using 和 hash 不是关键字，可以用作表名和字段名
+  {
+    ParsedSqlResult result;
+    ASSERT_EQ(parse("create table hash(using int, hash char(4))", &result), RC::SUCCESS);
+    ASSERT_EQ(SCF_CREATE_TABLE, result.sql_nodes().front()->flag);
+  }
+  {
+    ParsedSqlResult result;
+    ASSERT_EQ(parse("create index using on hash(using) using hash", &result), RC::SUCCESS);
+    const ParsedSqlNode &node = *result.sql_nodes().front();
+    ASSERT_EQ(SCF_CREATE_INDEX, node.flag);
+    ASSERT_EQ("using", node.create_index.index_name);
+    ASSERT_EQ("hash", node.create_index.relation_name);
+    ASSERT_EQ("hash", node.create_index.index_method);
+  }
+}
+
 int main(int argc, char **argv)
 {
 
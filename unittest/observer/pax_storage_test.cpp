@@ -11,6 +11,7 @@ See the Mulan PSL v2 for more details. */
 #include <string.h>
 #include <sstream>
 #include <filesystem>
+#include <thread>
 #include <utility>
 
 #define protected public
@@ -37,7 +38,7 @@ using namespace common;
 class PaxRecordFileScannerWithParam : public testing::TestWithParam<int>
 {};
 
-TEST_P(PaxRecordFileScannerWithParam, DISABLED_test_file_iterator)
+TEST_P(PaxRecordFileScannerWithParam, test_file_iterator)
 {
   int               record_insert_num = GetParam();
   VacuousLogHandler log_handler;
@@ -183,7 +184,7 @@ TEST_P(PaxRecordFileScannerWithParam, DISABLED_test_file_iterator)
 class PaxPageHandlerTestWithParam : public testing::TestWithParam<int>
 {};
 
-TEST_P(PaxPageHandlerTestWithParam, DISABLED_PaxPageHandler)
+TEST_P(PaxPageHandlerTestWithParam, PaxPageHandler)
 {
   int               record_num = GetParam();
   VacuousLogHandler log_handler;
@@ -347,6 +348,218 @@ TEST_P(PaxPageHandlerTestWithParam, DISABLED_PaxPageHandler)
   delete bpm;
 }
 
+TEST(PaxZoneMap, skip_pages)
+{
+  VacuousLogHandler log_handler;
+
+  const char *record_manager_file = "record_manager_zone_map.bp";
+  filesystem::remove(record_manager_file);
+
+  BufferPoolManager *bpm = new BufferPoolManager();
+  ASSERT_EQ(RC::SUCCESS, bpm->init(make_unique<VacuousDoubleWriteBuffer>()));
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm->create_file(record_manager_file));
+  ASSERT_EQ(RC::SUCCESS, bpm->open_file(log_handler, record_manager_file, bp));
+
+  TableMeta table_meta;
+  table_meta.fields_.resize(2);
+  table_meta.fields_[0].attr_type_   = AttrType::INTS;
+  table_meta.fields_[0].attr_len_    = 4;
+  table_meta.fields_[0].attr_offset_ = 0;
+  table_meta.fields_[0].field_id_    = 0;
+  table_meta.fields_[1].attr_type_   = AttrType::INTS;
+  table_meta.fields_[1].attr_len_    = 4;
+  table_meta.fields_[1].attr_offset_ = 4;
+  table_meta.fields_[1].field_id_    = 1;
+
+  RecordFileHandler file_handler(StorageFormat::PAX_FORMAT);
+  ASSERT_EQ(RC::SUCCESS, file_handler.init(*bp, log_handler, &table_meta, nullptr));
+  ASSERT_NE(nullptr, file_handler.zone_map());
+
+  // 按照顺序插入，每个页面的范围都不重叠
+  const int   record_num = 5000;
+  vector<RID> rids;
+  for (int i = 0; i < record_num; i++) {
+    int record_data[2] = {i, record_num - i};
+    RID rid;
+    ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(reinterpret_cast<const char *>(record_data), sizeof(record_data), &rid));
+    rids.push_back(rid);
+  }
+  ASSERT_GT(rids.back().page_num, rids.front().page_num);
+
+  Table table;
+  table.table_meta_.storage_format_ = StorageFormat::PAX_FORMAT;
+
+  auto scan = [&](vector<ZonePredicate> &&predicates, int &total_rows, int &matched_rows) {
+    ChunkFileScanner chunk_scanner;
+    ASSERT_EQ(RC::SUCCESS, chunk_scanner.open_scan_chunk(&table, *bp, log_handler, ReadWriteMode::READ_ONLY));
+    chunk_scanner.set_zone_map(file_handler.zone_map());
+    chunk_scanner.set_zone_predicates(std::move(predicates));
+
+    Chunk     chunk;
+    FieldMeta fm;
+    fm.init("col1", AttrType::INTS, 0, 4, true, 0);
+    chunk.add_column(make_unique<Column>(fm, 2048), 0);
+
+    total_rows   = 0;
+    matched_rows = 0;
+    RC rc        = RC::SUCCESS;
+    while (OB_SUCC(rc = chunk_scanner.next_chunk(chunk))) {
+      total_rows += chunk.rows();
+      for (int i = 0; i < chunk.rows(); i++) {
+        if (chunk.get_value(0, i).get_int() >= 4500) {
+          matched_rows++;
+        }
+      }
+      chunk.reset_data();
+    }
+    ASSERT_EQ(RC::RECORD_EOF, rc);
+  };
+
+  int total_rows   = 0;
+  int matched_rows = 0;
+  scan({}, total_rows, matched_rows);
+  ASSERT_EQ(record_num, total_rows);
+
+  // col1 >= 4500，只需要读取最后的页面
+  scan({ZonePredicate{0, GREAT_EQUAL, Value(4500)}}, total_rows, matched_rows);
+  ASSERT_EQ(500, matched_rows);
+  ASSERT_LT(total_rows, record_num);
+
+  // 另一列上的条件：col2 <= 500 与上面的条件等价
+  scan({ZonePredicate{1, LESS_EQUAL, Value(500)}}, total_rows, matched_rows);
+  ASSERT_EQ(500, matched_rows);
+  ASSERT_LT(total_rows, record_num);
+
+  // 没有页面满足条件
+  scan({ZonePredicate{0, GREAT_THAN, Value(record_num)}}, total_rows, matched_rows);
+  ASSERT_EQ(0, total_rows);
+
+  // 删除以后 zone 失效，扫描时重新计算，结果仍然正确
+  for (int i = 4500; i < record_num; i += 2) {
+    ASSERT_EQ(RC::SUCCESS, file_handler.delete_record(&rids[i]));
+  }
+  PageZone zone;
+  ASSERT_FALSE(file_handler.zone_map()->get(rids.back().page_num, zone));
+  scan({ZonePredicate{0, GREAT_EQUAL, Value(4500)}}, total_rows, matched_rows);
+  ASSERT_EQ(250, matched_rows);
+  ASSERT_TRUE(file_handler.zone_map()->get(rids.back().page_num, zone));
+  ASSERT_EQ(record_num - 1, zone.max_value(0).get_int());
+
+  file_handler.close();
+  bpm->close_file(record_manager_file);
+  delete bpm;
+}
+
+TEST(PaxRecordFileScanner, parallel_scan)
+{
+  VacuousLogHandler log_handler;
+
+  const char *record_manager_file = "record_manager_parallel_chunk.bp";
+  filesystem::remove(record_manager_file);
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(record_manager_file));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, record_manager_file, bp));
+
+  Table table;
+  table.table_meta_.storage_format_ = StorageFormat::PAX_FORMAT;
+  TableMeta &table_meta             = table.table_meta_;
+  table_meta.fields_.resize(2);
+  for (int i = 0; i < 2; i++) {
+    table_meta.fields_[i].attr_type_   = AttrType::INTS;
+    table_meta.fields_[i].attr_len_    = 4;
+    table_meta.fields_[i].attr_offset_ = i * 4;
+    table_meta.fields_[i].field_id_    = i;
+  }
+
+  RecordFileHandler file_handler(StorageFormat::PAX_FORMAT);
+  ASSERT_EQ(RC::SUCCESS, file_handler.init(*bp, log_handler, &table_meta, nullptr));
+
+  const int record_num = 20000;
+  for (int i = 0; i < record_num; i++) {
+    int record_data[2] = {i, i * 2};
+    RID rid;
+    ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(reinterpret_cast<const char *>(record_data), sizeof(record_data), &rid));
+  }
+
+  auto morsels = make_shared<PageMorselQueue>(1, bp->page_count(), 2 /*morsel_pages*/);
+
+  const int       thread_num = 4;
+  vector<int64_t> thread_sums(thread_num, 0);
+  vector<int>     thread_rows(thread_num, 0);
+  vector<RC>      thread_rcs(thread_num, RC::SUCCESS);
+  vector<thread>  threads;
+  for (int t = 0; t < thread_num; t++) {
+    threads.emplace_back([&, t]() {
+      ChunkFileScanner scanner;
+      scanner.set_morsel_queue(morsels);
+      RC rc = scanner.open_scan_chunk(&table, *bp, log_handler, ReadWriteMode::READ_ONLY);
+      if (OB_FAIL(rc)) {
+        thread_rcs[t] = rc;
+        return;
+      }
+
+      Chunk     chunk;
+      FieldMeta fm;
+      fm.init("col2", AttrType::INTS, 4, 4, true, 1);
+      chunk.add_column(make_unique<Column>(fm, 2048), 1);
+      while (OB_SUCC(rc = scanner.next_chunk(chunk))) {
+        thread_rows[t] += chunk.rows();
+        for (int i = 0; i < chunk.rows(); i++) {
+          thread_sums[t] += chunk.get_value(0, i).get_int();
+        }
+        chunk.reset_data();
+      }
+      thread_rcs[t] = (rc == RC::RECORD_EOF) ? RC::SUCCESS : rc;
+      scanner.close_scan();
+    });
+  }
+  for (thread &t : threads) {
+    t.join();
+  }
+
+  int     rows = 0;
+  int64_t sum  = 0;
+  for (int t = 0; t < thread_num; t++) {
+    ASSERT_EQ(RC::SUCCESS, thread_rcs[t]);
+    rows += thread_rows[t];
+    sum += thread_sums[t];
+  }
+  ASSERT_EQ(record_num, rows);
+  ASSERT_EQ(static_cast<int64_t>(record_num) * (record_num - 1), sum);
+
+  file_handler.close();
+  bpm.close_file(record_manager_file);
+}
+
+TEST(PaxZoneMap, page_zone)
+{
+  PageZone zone(2);
+  ASSERT_FALSE(zone.may_match({}));
+
+  zone.set_not_empty();
+  zone.update(0, Value(10));
+  zone.update(0, Value(20));
+  ASSERT_TRUE(zone.may_match({}));
+
+  ASSERT_TRUE(zone.may_match({ZonePredicate{0, EQUAL_TO, Value(15)}}));
+  ASSERT_FALSE(zone.may_match({ZonePredicate{0, EQUAL_TO, Value(21)}}));
+  ASSERT_FALSE(zone.may_match({ZonePredicate{0, LESS_THAN, Value(10)}}));
+  ASSERT_TRUE(zone.may_match({ZonePredicate{0, LESS_EQUAL, Value(10)}}));
+  ASSERT_FALSE(zone.may_match({ZonePredicate{0, GREAT_THAN, Value(20)}}));
+  ASSERT_TRUE(zone.may_match({ZonePredicate{0, GREAT_EQUAL, Value(20)}}));
+  ASSERT_TRUE(zone.may_match({ZonePredicate{0, NOT_EQUAL, Value(10)}}));
+  ASSERT_TRUE(zone.may_match({ZonePredicate{0, GREAT_THAN, Value(19.5f)}}));
+  ASSERT_FALSE(zone.may_match({ZonePredicate{0, GREAT_THAN, Value(20.5f)}}));
+
+  // 没有统计的列和类型不同的常量都无法判断
+  ASSERT_TRUE(zone.may_match({ZonePredicate{1, EQUAL_TO, Value(100)}}));
+  ASSERT_TRUE(zone.may_match({ZonePredicate{0, EQUAL_TO, Value("abc")}}));
+}
+
 INSTANTIATE_TEST_SUITE_P(PaxFileScannerTests, PaxRecordFileScannerWithParam, testing::Values(1, 10, 100, 1000, 2000, 10000));
 
 INSTANTIATE_TEST_SUITE_P(PaxPageTests, PaxPageHandlerTestWithParam, testing::Values(1, 10, 100, 337));
@@ -13,6 +13,7 @@ See the Mulan PSL v2 for more details. */
 //
 
 #include "storage/persist/persist.h"
+#include "storage/record/lob_handler.h"
 #include "gtest/gtest.h"
 #include <string.h>
 
@@ -131,6 +132,67 @@ TEST(test_persist, test_persist_file_io)
   ASSERT_EQ(access(file_name_1.c_str(), F_OK), -1);
 }
 
+TEST(test_persist, test_lob_handler)
+{
+  std::string    file_name = "test_persist_lob_handler";
+  LobFileHandler lob_handler;
+  remove(file_name.c_str());
+  ASSERT_EQ(RC::SUCCESS, lob_handler.create_file(file_name.c_str()));
+
+  const int field_len = static_cast<int>(sizeof(LobRef)) + 16;
+  char      field[field_len];
+
+  // 短文本直接保存在字段中，不写 LOB 文件
+  std::string short_text = "hello lob";
+  ASSERT_EQ(RC::SUCCESS, lob_handler.write_field(short_text.data(), short_text.size(), field, field_len));
+  const LobRef *ref = reinterpret_cast<const LobRef *>(field);
+  ASSERT_TRUE(ref->is_inline());
+  ASSERT_EQ(short_text, std::string(ref->inline_data(), ref->length));
+
+  std::string text;
+  ASSERT_EQ(RC::SUCCESS, lob_handler.read_field(field, field_len, text));
+  ASSERT_EQ(short_text, text);
+  ASSERT_EQ(0, lob_handler.cache_miss_count());
+
+  // 空字符串也保存在字段中，与 NULL 区分开
+  ASSERT_EQ(RC::SUCCESS, lob_handler.write_field("", 0, field, field_len));
+  ASSERT_TRUE(ref->is_inline());
+  ASSERT_EQ(0, ref->length);
+
+  // 长文本写到 LOB 文件中，第二次读取命中缓存
+  std::string long_text(100, 'x');
+  ASSERT_EQ(RC::SUCCESS, lob_handler.write_field(long_text.data(), long_text.size(), field, field_len));
+  ASSERT_FALSE(ref->is_inline());
+  ASSERT_EQ(RC::SUCCESS, lob_handler.read_field(field, field_len, text));
+  ASSERT_EQ(long_text, text);
+  ASSERT_EQ(1, lob_handler.cache_miss_count());
+  ASSERT_EQ(RC::SUCCESS, lob_handler.read_field(field, field_len, text));
+  ASSERT_EQ(long_text, text);
+  ASSERT_EQ(1, lob_handler.cache_hit_count());
+
+  // 缓存的大小不超过容量，超过以后淘汰最久没有访问的对象
+  lob_handler.set_cache_capacity(100 * 16);
+  std::vector<std::string> fields;
+  for (int i = 0; i < 40; i++) {
+    std::string value(100, static_cast<char>('a' + i % 26));
+    ASSERT_EQ(RC::SUCCESS, lob_handler.write_field(value.data(), value.size(), field, field_len));
+    fields.emplace_back(field, field_len);
+    ASSERT_EQ(RC::SUCCESS, lob_handler.read_field(field, field_len, text));
+    ASSERT_EQ(value, text);
+    ASSERT_LE(lob_handler.cached_bytes(), lob_handler.cache_capacity());
+  }
+
+  const int64_t misses = lob_handler.cache_miss_count();
+  ASSERT_EQ(RC::SUCCESS, lob_handler.read_field(fields.back().data(), field_len, text));
+  ASSERT_EQ(misses, lob_handler.cache_miss_count());
+  ASSERT_EQ(RC::SUCCESS, lob_handler.read_field(fields.front().data(), field_len, text));
+  ASSERT_EQ(std::string(100, 'a'), text);
+  ASSERT_EQ(misses + 1, lob_handler.cache_miss_count());
+
+  ASSERT_EQ(RC::SUCCESS, lob_handler.close_file());
+  remove(file_name.c_str());
+}
+
 int main(int argc, char **argv)
 {
 
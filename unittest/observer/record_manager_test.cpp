@@ -15,8 +15,13 @@ See the Mulan PSL v2 for more details. */
 #include <string.h>
 #include <sstream>
 #include <filesystem>
+#include <thread>
 #include <utility>
 
+#define private public
+#include "storage/table/table.h"
+#undef private
+
 #include "storage/buffer/disk_buffer_pool.h"
 #include "storage/record/record_manager.h"
 #include "storage/trx/vacuous_trx.h"
@@ -27,6 +32,7 @@ See the Mulan PSL v2 for more details. */
 #include "common/thread/thread_pool_executor.h"
 #include "storage/clog/integrated_log_replayer.h"
 #include "storage/record/heap_record_scanner.h"
+#include "storage/table/table_meta.h"
 #include "gtest/gtest.h"
 
 using namespace std;
@@ -123,6 +129,100 @@ TEST(RecordPageHandler, test_record_page_handler)
   delete record_page_handle;
 }
 
+TEST(RecordPageHandler, test_slotted_record_page_handler)
+{
+  VacuousLogHandler log_handler;
+
+  const char *record_manager_file = "slotted_record_manager.bp";
+  ::remove(record_manager_file);
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(record_manager_file));
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, record_manager_file, bp));
+
+  Frame *frame = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bp->allocate_page(&frame));
+
+  // | id int | name char(200) |
+  const int     record_size = 204;
+  const int32_t columns[]   = {4, -200};
+  SlottedRecordPageHandler page_handler;
+  ASSERT_EQ(RC::SUCCESS,
+      page_handler.init_empty_page(*bp, log_handler, frame->page_num(), record_size, 2,
+          reinterpret_cast<const char *>(columns)));
+
+  // 短记录可以存放的条数远多于按照最大长度存放的定长格式
+  auto make_record = [](char *data, int id, const string &name) {
+    memset(data, 0, record_size);
+    memcpy(data, &id, sizeof(id));
+    memcpy(data + 4, name.data(), name.size());
+  };
+
+  char        data[record_size];
+  vector<RID> rids;
+  while (!page_handler.is_full()) {
+    RID rid;
+    make_record(data, static_cast<int>(rids.size()), "name" + to_string(rids.size()));
+    ASSERT_EQ(RC::SUCCESS, page_handler.insert_record(data, &rid));
+    rids.push_back(rid);
+  }
+  const int fixed_capacity = BP_PAGE_DATA_SIZE / record_size;
+  ASSERT_GT(static_cast<int>(rids.size()), fixed_capacity * 4);
+  ASSERT_EQ(page_handler.free_space(), 0);
+
+  for (size_t i = 0; i < rids.size(); i++) {
+    Record record;
+    ASSERT_EQ(RC::SUCCESS, page_handler.get_record(rids[i], record));
+    make_record(data, static_cast<int>(i), "name" + to_string(i));
+    ASSERT_EQ(record.len(), record_size);
+    ASSERT_EQ(0, memcmp(record.data(), data, record_size));
+  }
+
+  // 变长以后使用预留的空间，变短以后原地更新
+  make_record(data, 0, string(200, 'x'));
+  ASSERT_EQ(RC::SUCCESS, page_handler.update_record(rids[0], data));
+  make_record(data, 1, "y");
+  ASSERT_EQ(RC::SUCCESS, page_handler.update_record(rids[1], data));
+
+  Record record;
+  ASSERT_EQ(RC::SUCCESS, page_handler.get_record(rids[0], record));
+  make_record(data, 0, string(200, 'x'));
+  ASSERT_EQ(0, memcmp(record.data(), data, record_size));
+  ASSERT_EQ(RC::SUCCESS, page_handler.get_record(rids[1], record));
+  make_record(data, 1, "y");
+  ASSERT_EQ(0, memcmp(record.data(), data, record_size));
+
+  // 删除一半的记录以后，插入的长记录需要整理页面才能放下
+  for (size_t i = 2; i < rids.size(); i += 2) {
+    ASSERT_EQ(RC::SUCCESS, page_handler.delete_record(&rids[i]));
+  }
+  ASSERT_EQ(RC::RECORD_NOT_EXIST, page_handler.delete_record(&rids[2]));
+  ASSERT_FALSE(page_handler.is_full());
+  ASSERT_GT(page_handler.free_space(), 0);
+
+  int inserted = 0;
+  while (!page_handler.is_full()) {
+    RID rid;
+    make_record(data, -1, string(150, 'z'));
+    ASSERT_EQ(RC::SUCCESS, page_handler.insert_record(data, &rid));
+    ASSERT_EQ(RC::SUCCESS, page_handler.get_record(rid, record));
+    ASSERT_EQ(0, memcmp(record.data(), data, record_size));
+    inserted++;
+  }
+  ASSERT_GT(inserted, 0);
+
+  for (size_t i = 3; i < rids.size(); i += 2) {
+    ASSERT_EQ(RC::SUCCESS, page_handler.get_record(rids[i], record));
+    make_record(data, static_cast<int>(i), "name" + to_string(i));
+    ASSERT_EQ(0, memcmp(record.data(), data, record_size));
+  }
+
+  page_handler.cleanup();
+  bpm.close_file(record_manager_file);
+}
+
 TEST(RecordScanner, test_record_file_iterator)
 {
   VacuousLogHandler log_handler;
@@ -212,6 +312,514 @@ TEST(RecordScanner, test_record_file_iterator)
   delete bpm;
 }
 
+TEST(RecordScanner, parallel_scan)
+{
+  VacuousLogHandler log_handler;
+
+  const char *record_manager_file = "record_manager_parallel.bp";
+  filesystem::remove(record_manager_file);
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(record_manager_file));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, record_manager_file, bp));
+
+  RecordFileHandler file_handler(StorageFormat::ROW_FORMAT);
+  ASSERT_EQ(RC::SUCCESS, file_handler.init(*bp, log_handler, nullptr, nullptr));
+
+  const int record_num = 20000;
+  char      record_data[32] = {0};
+  for (int i = 0; i < record_num; i++) {
+    memcpy(record_data, &i, sizeof(i));
+    RID rid;
+    ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(record_data, sizeof(record_data), &rid));
+  }
+  ASSERT_GT(bp->page_count(), 20);
+
+  // 每个线程使用自己的扫描器，从同一个队列中领取页面，所有线程合起来访问到每条记录一次
+  auto morsels = make_shared<PageMorselQueue>(1, bp->page_count(), 3 /*morsel_pages*/);
+
+  const int           thread_num = 4;
+  vector<vector<int>> thread_ids(thread_num);
+  vector<RC>          thread_rcs(thread_num, RC::SUCCESS);
+  vector<thread>      threads;
+  for (int t = 0; t < thread_num; t++) {
+    threads.emplace_back([&, t]() {
+      VacuousTrx        trx;
+      HeapRecordScanner scanner(nullptr /*table*/, *bp, &trx, log_handler, ReadWriteMode::READ_ONLY, nullptr);
+      scanner.set_morsel_queue(morsels);
+      RC rc = scanner.open_scan();
+      if (OB_FAIL(rc)) {
+        thread_rcs[t] = rc;
+        return;
+      }
+
+      Record record;
+      while (OB_SUCC(rc = scanner.next(record))) {
+        int id = 0;
+        memcpy(&id, record.data(), sizeof(id));
+        thread_ids[t].push_back(id);
+      }
+      thread_rcs[t] = (rc == RC::RECORD_EOF) ? RC::SUCCESS : rc;
+      scanner.close_scan();
+    });
+  }
+  for (thread &t : threads) {
+    t.join();
+  }
+
+  vector<int> ids;
+  for (int t = 0; t < thread_num; t++) {
+    ASSERT_EQ(RC::SUCCESS, thread_rcs[t]);
+    ids.insert(ids.end(), thread_ids[t].begin(), thread_ids[t].end());
+  }
+  sort(ids.begin(), ids.end());
+  ASSERT_EQ(record_num, static_cast<int>(ids.size()));
+  for (int i = 0; i < record_num; i++) {
+    ASSERT_EQ(i, ids[i]);
+  }
+
+  // 队列中的片段已经领取完了，再创建的扫描器不会返回任何记录
+  HeapRecordScanner scanner(nullptr /*table*/, *bp, nullptr, log_handler, ReadWriteMode::READ_ONLY, nullptr);
+  scanner.set_morsel_queue(morsels);
+  ASSERT_EQ(RC::SUCCESS, scanner.open_scan());
+  Record record;
+  ASSERT_EQ(RC::RECORD_EOF, scanner.next(record));
+  scanner.close_scan();
+
+  file_handler.close();
+  bpm.close_file(record_manager_file);
+}
+
+// 页面锁和 RecordFileHandler 的锁只有在 CONCURRENCY 编译模式下才会真正生效
+#ifdef CONCURRENCY
+TEST(RecordManager, concurrent_insert)
+{
+  VacuousLogHandler log_handler;
+
+  const char *record_manager_file = "record_manager_concurrent_insert.bp";
+  filesystem::remove(record_manager_file);
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(record_manager_file));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, record_manager_file, bp));
+
+  RecordFileHandler file_handler(StorageFormat::ROW_FORMAT);
+  ASSERT_EQ(RC::SUCCESS, file_handler.init(*bp, log_handler, nullptr, nullptr));
+
+  // 每个线程插入记录的同时删除一部分，让其它线程从空闲空间映射中找到同一个页面，
+  // 插入以后更新空闲空间映射时不能持有页面锁，否则会与查找空闲页面的线程互相等待
+  const int      thread_num = 4;
+  const int      record_num = 5000;
+  vector<RC>     thread_rcs(thread_num, RC::SUCCESS);
+  vector<thread> threads;
+  for (int t = 0; t < thread_num; t++) {
+    threads.emplace_back([&, t]() {
+      char record_data[32] = {0};
+      for (int i = 0; i < record_num; i++) {
+        const int id = t * record_num + i;
+        memcpy(record_data, &id, sizeof(id));
+        RID rid;
+        RC  rc = file_handler.insert_record(record_data, sizeof(record_data), &rid);
+        if (OB_SUCC(rc) && i % 2 == 1) {
+          rc = file_handler.delete_record(&rid);
+        }
+        if (OB_FAIL(rc)) {
+          thread_rcs[t] = rc;
+          return;
+        }
+      }
+    });
+  }
+  for (thread &t : threads) {
+    t.join();
+  }
+
+  for (int t = 0; t < thread_num; t++) {
+    ASSERT_EQ(RC::SUCCESS, thread_rcs[t]);
+  }
+
+  VacuousTrx        trx;
+  HeapRecordScanner scanner(nullptr /*table*/, *bp, &trx, log_handler, ReadWriteMode::READ_ONLY, nullptr);
+  ASSERT_EQ(RC::SUCCESS, scanner.open_scan());
+  vector<int> ids;
+  Record      record;
+  RC          rc = RC::SUCCESS;
+  while (OB_SUCC(rc = scanner.next(record))) {
+    int id = 0;
+    memcpy(&id, record.data(), sizeof(id));
+    ids.push_back(id);
+  }
+  ASSERT_EQ(RC::RECORD_EOF, rc);
+  scanner.close_scan();
+
+  sort(ids.begin(), ids.end());
+  ASSERT_EQ(thread_num * record_num / 2, static_cast<int>(ids.size()));
+  for (size_t i = 0; i < ids.size(); i++) {
+    ASSERT_EQ(static_cast<int>(i * 2), ids[i]);
+  }
+
+  file_handler.close();
+  bpm.close_file(record_manager_file);
+}
+#endif  // CONCURRENCY
+
+TEST(RecordScanner, zero_copy)
+{
+  VacuousLogHandler log_handler;
+
+  const char *record_manager_file = "record_manager_zero_copy.bp";
+  filesystem::remove(record_manager_file);
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(record_manager_file));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, record_manager_file, bp));
+
+  RecordFileHandler file_handler(StorageFormat::ROW_FORMAT);
+  ASSERT_EQ(RC::SUCCESS, file_handler.init(*bp, log_handler, nullptr, nullptr));
+
+  const int record_num = 100;
+  char      record_data[16] = {0};
+  for (int i = 0; i < record_num; i++) {
+    memcpy(record_data, &i, sizeof(i));
+    RID rid;
+    ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(record_data, sizeof(record_data), &rid));
+  }
+
+  // 零拷贝时返回的记录直接指向页面，同一个页面上相邻的记录在内存中也是相邻的
+  HeapRecordScanner scanner(nullptr /*table*/, *bp, nullptr, log_handler, ReadWriteMode::READ_ONLY, nullptr);
+  scanner.set_zero_copy(true);
+  ASSERT_EQ(RC::SUCCESS, scanner.open_scan());
+
+  Record      record;
+  Record      kept;
+  const char *last_data = nullptr;
+  int         count     = 0;
+  RC          rc        = RC::SUCCESS;
+  while (OB_SUCC(rc = scanner.next(record))) {
+    int id = 0;
+    memcpy(&id, record.data(), sizeof(id));
+    ASSERT_EQ(count, id);
+    ASSERT_EQ(static_cast<int>(sizeof(record_data)), record.len());
+    if (last_data != nullptr) {
+      ASSERT_EQ(last_data + sizeof(record_data), record.data());
+    }
+    last_data = record.data();
+
+    // 需要保留的记录复制出来，复制以后复用同一块内存
+    const char *kept_data = kept.data();
+    ASSERT_EQ(RC::SUCCESS, kept.copy_data(record.data(), record.len()));
+    if (kept_data != nullptr) {
+      ASSERT_EQ(kept_data, kept.data());
+    }
+    count++;
+  }
+  ASSERT_EQ(RC::RECORD_EOF, rc);
+  ASSERT_EQ(record_num, count);
+  scanner.close_scan();
+
+  int id = 0;
+  memcpy(&id, kept.data(), sizeof(id));
+  ASSERT_EQ(record_num - 1, id);
+
+  file_handler.close();
+  bpm.close_file(record_manager_file);
+}
+
+TEST(RecordScanner, compiled_condition_filter)
+{
+  // | id int | score float | name char(8) |
+  FieldMeta fm_id, fm_score, fm_name;
+  ASSERT_EQ(RC::SUCCESS, fm_id.init("id", AttrType::INTS, 0, 4, true, 0, true /*nullable*/));
+  ASSERT_EQ(RC::SUCCESS, fm_score.init("score", AttrType::FLOATS, 4, 4, true, 1));
+  ASSERT_EQ(RC::SUCCESS, fm_name.init("name", AttrType::CHARS, 8, 8, true, 2));
+
+  auto make_record = [](char *data, int id, float score, const char *name) {
+    memset(data, 0, 16);
+    memcpy(data, &id, sizeof(id));
+    memcpy(data + 4, &score, sizeof(score));
+    strncpy(data + 8, name, 8);
+  };
+
+  char   data[16];
+  Record record;
+  make_record(data, 5, 1.5f, "abc");
+  record.set_data(data, sizeof(data));
+
+  {
+    CompiledConditionFilter filter;
+    ASSERT_TRUE(filter.empty());
+    ASSERT_TRUE(filter.filter(record));
+
+    ASSERT_EQ(RC::SUCCESS, filter.add(fm_id, GREAT_EQUAL, Value(5)));
+    ASSERT_EQ(RC::SUCCESS, filter.add(fm_score, LESS_THAN, Value(2)));
+    ASSERT_EQ(RC::SUCCESS, filter.add(fm_name, EQUAL_TO, Value("abc")));
+    ASSERT_EQ(3, filter.size());
+    ASSERT_TRUE(filter.filter(record));
+
+    ASSERT_EQ(RC::SUCCESS, filter.add(fm_id, NOT_EQUAL, Value(5.0f)));
+    ASSERT_FALSE(filter.filter(record));
+  }
+
+  {
+    CompiledConditionFilter filter;
+    ASSERT_EQ(RC::SUCCESS, filter.add(fm_name, LESS_THAN, Value("abcd")));
+    ASSERT_EQ(RC::SUCCESS, filter.add(fm_id, LESS_THAN, Value(5.5f)));
+    ASSERT_TRUE(filter.filter(record));
+
+    // 类型不匹配、NULL 和其它比较符都不编译
+    ASSERT_EQ(RC::UNSUPPORTED, filter.add(fm_name, EQUAL_TO, Value(1)));
+    ASSERT_EQ(RC::UNSUPPORTED, filter.add(fm_id, EQUAL_TO, Value("5")));
+    ASSERT_EQ(RC::UNSUPPORTED, filter.add(fm_id, EQUAL_TO, Value()));
+    ASSERT_EQ(RC::UNSUPPORTED, filter.add(fm_id, IS_NULL_OP, Value(0)));
+    ASSERT_EQ(2, filter.size());
+
+    // 可以为 NULL 的字段全部是0时当做 NULL，任何比较都不满足
+    CompiledConditionFilter null_filter;
+    ASSERT_EQ(RC::SUCCESS, null_filter.add(fm_id, NOT_EQUAL, Value(1)));
+    make_record(data, 0, 1.5f, "abc");
+    ASSERT_FALSE(null_filter.filter(record));
+    make_record(data, 2, 1.5f, "abc");
+    ASSERT_TRUE(null_filter.filter(record));
+  }
+
+  // 扫描器在原始记录上过滤，只返回满足条件的记录
+  VacuousLogHandler log_handler;
+
+  const char *record_manager_file = "record_manager_compiled_filter.bp";
+  filesystem::remove(record_manager_file);
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(record_manager_file));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, record_manager_file, bp));
+
+  RecordFileHandler file_handler(StorageFormat::ROW_FORMAT);
+  ASSERT_EQ(RC::SUCCESS, file_handler.init(*bp, log_handler, nullptr, nullptr));
+
+  const int record_num = 1000;
+  for (int i = 1; i <= record_num; i++) {
+    make_record(data, i, static_cast<float>(i % 10), i % 2 == 0 ? "even" : "odd");
+    RID rid;
+    ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(data, sizeof(data), &rid));
+  }
+
+  CompiledConditionFilter filter;
+  ASSERT_EQ(RC::SUCCESS, filter.add(fm_id, GREAT_THAN, Value(100)));
+  ASSERT_EQ(RC::SUCCESS, filter.add(fm_score, LESS_EQUAL, Value(3)));
+  ASSERT_EQ(RC::SUCCESS, filter.add(fm_name, EQUAL_TO, Value("even")));
+
+  HeapRecordScanner scanner(nullptr /*table*/, *bp, nullptr, log_handler, ReadWriteMode::READ_ONLY, nullptr);
+  ASSERT_EQ(RC::SUCCESS, scanner.set_condition_filter(&filter));
+  ASSERT_EQ(RC::SUCCESS, scanner.open_scan());
+
+  int count = 0;
+  RC  rc    = RC::SUCCESS;
+  while (OB_SUCC(rc = scanner.next(record))) {
+    int id = 0;
+    memcpy(&id, record.data(), sizeof(id));
+    ASSERT_GT(id, 100);
+    ASSERT_EQ(0, id % 2);
+    ASSERT_LE(id % 10, 3);
+    count++;
+  }
+  ASSERT_EQ(RC::RECORD_EOF, rc);
+  // 101~1000 中个位是 0 和 2 的数
+  ASSERT_EQ(180, count);
+  scanner.close_scan();
+
+  file_handler.close();
+  bpm.close_file(record_manager_file);
+}
+
+TEST(ChunkFileScanner, row_formats)
+{
+  for (StorageFormat format : {StorageFormat::ROW_FORMAT, StorageFormat::SLOTTED_FORMAT}) {
+    VacuousLogHandler log_handler;
+
+    const char *record_manager_file = "record_manager_row_chunk.bp";
+    filesystem::remove(record_manager_file);
+
+    BufferPoolManager bpm;
+    ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+    DiskBufferPool *bp = nullptr;
+    ASSERT_EQ(RC::SUCCESS, bpm.create_file(record_manager_file));
+    ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, record_manager_file, bp));
+
+    // | id int | name char(8) | score int |
+    vector<AttrInfoSqlNode> attributes = {
+        {AttrType::INTS, "id", 4, false}, {AttrType::CHARS, "name", 8, false}, {AttrType::INTS, "score", 4, false}};
+    Table      table;
+    TableMeta &table_meta = table.table_meta_;
+    ASSERT_EQ(RC::SUCCESS, table_meta.init(1, "t", nullptr, attributes, {}, format, StorageEngine::HEAP));
+    const int record_size = table_meta.record_size();
+
+    RecordFileHandler file_handler(format);
+    ASSERT_EQ(RC::SUCCESS, file_handler.init(*bp, log_handler, &table_meta, nullptr));
+
+    const int   record_num = 3000;
+    vector<RID> rids;
+    string      data(record_size, '\0');
+    for (int i = 0; i < record_num; i++) {
+      const int    id    = i;
+      const int    score = i * 10;
+      const string name  = "n" + to_string(i % 100);
+      data.assign(record_size, '\0');
+      memcpy(data.data() + table_meta.field(0)->offset(), &id, sizeof(id));
+      memcpy(data.data() + table_meta.field(1)->offset(), name.data(), name.size());
+      memcpy(data.data() + table_meta.field(2)->offset(), &score, sizeof(score));
+
+      RID rid;
+      ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(data.data(), record_size, &rid));
+      rids.push_back(rid);
+    }
+    for (int i = 0; i < record_num; i += 3) {
+      ASSERT_EQ(RC::SUCCESS, file_handler.delete_record(&rids[i]));
+    }
+
+    // 列的顺序与表中字段的顺序不同，也可以只读取部分列
+    ChunkFileScanner scanner;
+    ASSERT_EQ(RC::SUCCESS, scanner.open_scan_chunk(&table, *bp, log_handler, ReadWriteMode::READ_ONLY));
+    Chunk chunk;
+    chunk.add_column(make_unique<Column>(*table_meta.field(2)), 2);
+    chunk.add_column(make_unique<Column>(*table_meta.field(1)), 1);
+
+    int count = 0;
+    RC  rc    = RC::SUCCESS;
+    while (OB_SUCC(rc = scanner.next_chunk(chunk))) {
+      ASSERT_GT(chunk.rows(), 0);
+      for (int row = 0; row < chunk.rows(); row++) {
+        const int score = chunk.column(0).get_value(row).get_int();
+        ASSERT_EQ(0, score % 10);
+        ASSERT_NE(0, (score / 10) % 3);
+        ASSERT_EQ("n" + to_string((score / 10) % 100), chunk.column(1).get_value(row).get_string());
+      }
+      count += chunk.rows();
+      chunk.reset_data();
+    }
+    ASSERT_EQ(RC::RECORD_EOF, rc);
+    ASSERT_EQ(record_num - record_num / 3, count);
+    scanner.close_scan();
+
+    file_handler.close();
+    bpm.close_file(record_manager_file);
+  }
+}
+
+TEST(FreeSpaceMap, levels)
+{
+  ASSERT_EQ(FreeSpaceMap::FULL, FreeSpaceMap::level_of(0, 100));
+  ASSERT_EQ(FreeSpaceMap::MIN_FREE_LEVEL, FreeSpaceMap::level_of(1, 100));
+  ASSERT_EQ(FreeSpaceMap::MAX_LEVEL, FreeSpaceMap::level_of(100, 100));
+
+  FreeSpaceMap fsm;
+  ASSERT_EQ(RC::SUCCESS, fsm.init(nullptr));
+
+  // 没有记录过的页面也当做候选页面返回
+  PageNum page_num = 0;
+  ASSERT_EQ(RC::SUCCESS, fsm.find(10, FreeSpaceMap::MIN_FREE_LEVEL, page_num));
+  ASSERT_EQ(1, page_num);
+  ASSERT_EQ(RC::RECORD_EOF, fsm.find(1, FreeSpaceMap::MIN_FREE_LEVEL, page_num));
+
+  for (PageNum i = 1; i < 10; i++) {
+    ASSERT_EQ(RC::SUCCESS, fsm.update(i, FreeSpaceMap::FULL));
+  }
+  ASSERT_EQ(RC::RECORD_EOF, fsm.find(10, FreeSpaceMap::MIN_FREE_LEVEL, page_num));
+
+  ASSERT_EQ(RC::SUCCESS, fsm.update(7, 10, 100));
+  ASSERT_EQ(RC::SUCCESS, fsm.find(10, FreeSpaceMap::MIN_FREE_LEVEL, page_num));
+  ASSERT_EQ(7, page_num);
+  ASSERT_EQ(RC::RECORD_EOF, fsm.find(10, FreeSpaceMap::MAX_LEVEL, page_num));
+
+  // 跨越多个映射页面
+  const PageNum far_page = FreeSpaceMap::PAGES_PER_FSM_PAGE * 2 + 3;
+  ASSERT_EQ(RC::SUCCESS, fsm.update(7, FreeSpaceMap::FULL));
+  ASSERT_EQ(RC::SUCCESS, fsm.update(far_page, FreeSpaceMap::FULL));
+  uint8_t level = FreeSpaceMap::UNKNOWN;
+  ASSERT_EQ(RC::SUCCESS, fsm.get(far_page, level));
+  ASSERT_EQ(FreeSpaceMap::FULL, level);
+  ASSERT_EQ(RC::SUCCESS, fsm.find(far_page + 1, FreeSpaceMap::MIN_FREE_LEVEL, page_num));
+  ASSERT_EQ(10, page_num);
+
+  // 溢出页面的映射只返回记录过的页面
+  FreeSpaceMap overflow_map;
+  ASSERT_EQ(RC::SUCCESS, overflow_map.init(nullptr, FreeSpaceMap::Fork::OVERFLOW_PAGES));
+  ASSERT_EQ(RC::RECORD_EOF, overflow_map.find(10, FreeSpaceMap::MIN_FREE_LEVEL, page_num));
+  ASSERT_EQ(RC::SUCCESS, overflow_map.update(far_page, FreeSpaceMap::FULL));
+  ASSERT_EQ(RC::RECORD_EOF, overflow_map.find(far_page + 1, FreeSpaceMap::MIN_FREE_LEVEL, page_num));
+  ASSERT_EQ(RC::SUCCESS, overflow_map.update(5, 10, 100));
+  ASSERT_EQ(RC::SUCCESS, overflow_map.find(far_page + 1, FreeSpaceMap::MIN_FREE_LEVEL, page_num));
+  ASSERT_EQ(5, page_num);
+}
+
+TEST(FreeSpaceMap, persistence)
+{
+  VacuousLogHandler log_handler;
+
+  const char *data_file = "free_space_map_test.bp";
+  const char *fsm_file  = "free_space_map_test.fsm";
+  filesystem::remove(data_file);
+  filesystem::remove(fsm_file);
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(data_file));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(fsm_file));
+
+  DiskBufferPool *data_bp = nullptr;
+  DiskBufferPool *fsm_bp  = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, data_file, data_bp));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, fsm_file, fsm_bp));
+
+  const int         record_size = 100;
+  char              record_data[record_size];
+  vector<RID>       rids;
+  RecordFileHandler file_handler(StorageFormat::ROW_FORMAT);
+  ASSERT_EQ(RC::SUCCESS, file_handler.init(*data_bp, log_handler, nullptr, nullptr, fsm_bp));
+  for (int i = 0; i < 300; i++) {
+    RID rid;
+    ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(record_data, record_size, &rid));
+    rids.push_back(rid);
+  }
+  ASSERT_GE(data_bp->page_count(), 4);
+
+  // 删除以后空出来的位置会被重新使用
+  const RID deleted = rids[3];
+  ASSERT_EQ(RC::SUCCESS, file_handler.delete_record(&deleted));
+  RID rid;
+  ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(record_data, record_size, &rid));
+  ASSERT_EQ(deleted, rid);
+
+  ASSERT_EQ(RC::SUCCESS, file_handler.delete_record(&rids[5]));
+  file_handler.close();
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(fsm_file));
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(data_file));
+
+  // 重新打开以后空闲空间映射仍然有效，直接找到删除过记录的页面
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, data_file, data_bp));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, fsm_file, fsm_bp));
+  ASSERT_EQ(RC::SUCCESS, file_handler.init(*data_bp, log_handler, nullptr, nullptr, fsm_bp));
+
+  uint8_t level = FreeSpaceMap::UNKNOWN;
+  ASSERT_EQ(RC::SUCCESS, file_handler.free_space_map().get(rids[0].page_num, level));
+  ASSERT_GE(level, FreeSpaceMap::MIN_FREE_LEVEL);
+  ASSERT_EQ(RC::SUCCESS, file_handler.free_space_map().get(rids[200].page_num, level));
+  ASSERT_EQ(FreeSpaceMap::FULL, level);
+
+  ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(record_data, record_size, &rid));
+  ASSERT_EQ(rids[5], rid);
+
+  file_handler.close();
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(fsm_file));
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(data_file));
+}
+
 TEST(RecordManager, durability)
 {
   /*
@@ -363,6 +971,438 @@ TEST(RecordManager, durability)
   bpm2.close_file(record_manager_file.c_str());
 }
 
+TEST(RecordManager, slotted_durability)
+{
+  filesystem::path directory("slotted_record_manager_durability");
+  filesystem::remove_all(directory);
+  ASSERT_TRUE(filesystem::create_directories(directory));
+
+  filesystem::path record_manager_file = directory / "record_manager.bp";
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(bpm.init(make_unique<VacuousDoubleWriteBuffer>()), RC::SUCCESS);
+
+  DiskLogHandler        log_handler;
+  IntegratedLogReplayer log_replayer(bpm);
+  ASSERT_EQ(log_handler.init(directory.c_str()), RC::SUCCESS);
+  ASSERT_EQ(log_handler.replay(log_replayer, 0), RC::SUCCESS);
+  ASSERT_EQ(log_handler.start(), RC::SUCCESS);
+
+  DiskBufferPool *buffer_pool = nullptr;
+  ASSERT_EQ(bpm.create_file(record_manager_file.c_str()), RC::SUCCESS);
+  ASSERT_EQ(bpm.open_file(log_handler, record_manager_file.c_str(), buffer_pool), RC::SUCCESS);
+
+  // | id int | name char(100) |
+  vector<AttrInfoSqlNode> attributes = {{AttrType::INTS, "id", 4, false}, {AttrType::CHARS, "name", 100, false}};
+  TableMeta               table_meta;
+  ASSERT_EQ(RC::SUCCESS,
+      table_meta.init(1, "t", nullptr, attributes, {}, StorageFormat::SLOTTED_FORMAT, StorageEngine::HEAP));
+  const int record_size = table_meta.record_size();
+  ASSERT_EQ(record_size, 104);
+
+  RecordFileHandler record_file_handler(StorageFormat::SLOTTED_FORMAT);
+  ASSERT_EQ(record_file_handler.init(*buffer_pool, log_handler, &table_meta, nullptr), RC::SUCCESS);
+
+  IntegerGenerator                    random(0, 1000000000);
+  unordered_map<RID, string, RIDHash> record_map;
+  auto                                make_record = [&random, record_size](int id) {
+    string data(record_size, '\0');
+    memcpy(data.data(), &id, sizeof(id));
+    string name = "name" + string(random.next() % 90, 'x');
+    memcpy(data.data() + 4, name.data(), name.size());
+    return data;
+  };
+
+  for (int i = 0; i < 2000; i++) {
+    RID    rid;
+    string data = make_record(i);
+    ASSERT_EQ(record_file_handler.insert_record(data.data(), record_size, &rid), RC::SUCCESS);
+    record_map.emplace(rid, data);
+  }
+
+  // 随机更新和删除，更新后的长度可能变长也可能变短
+  IntegerGenerator operation_random(0, 2);
+  for (int i = 0; i < 2000; i++) {
+    IntegerGenerator record_random(0, record_map.size() - 1);
+    auto             iter = record_map.begin();
+    advance(iter, record_random.next());
+    const RID rid = iter->first;
+
+    switch (operation_random.next()) {
+      case 0: {
+        RID    new_rid;
+        string data = make_record(-i);
+        ASSERT_EQ(record_file_handler.insert_record(data.data(), record_size, &new_rid), RC::SUCCESS);
+        record_map.emplace(new_rid, data);
+      } break;
+      case 1: {
+        string data = make_record(i);
+        RC     rc   = record_file_handler.visit_record(rid, [&data](Record &record) {
+          memcpy(record.data(), data.data(), data.size());
+          return true;
+        });
+        // 页面上放不下变长的记录时迁移到溢出页面，RID 不变
+        ASSERT_EQ(rc, RC::SUCCESS);
+        record_map[rid] = data;
+      } break;
+      default: {
+        ASSERT_EQ(record_file_handler.delete_record(&rid), RC::SUCCESS);
+        record_map.erase(rid);
+      } break;
+    }
+  }
+
+  filesystem::path record_manager_file_copy = directory / "record_manager_copy.bp";
+  filesystem::copy_file(record_manager_file, record_manager_file_copy);
+  record_file_handler.close();
+  bpm.close_file(record_manager_file.c_str());
+  filesystem::remove(record_manager_file);
+  ASSERT_EQ(log_handler.stop(), RC::SUCCESS);
+  ASSERT_EQ(log_handler.await_termination(), RC::SUCCESS);
+
+  // 从日志中恢复，页面整理不记录日志，按照槽位重做以后记录仍然在原来的位置上
+  DiskLogHandler    log_handler2;
+  BufferPoolManager bpm2;
+  ASSERT_EQ(RC::SUCCESS, bpm2.init(make_unique<VacuousDoubleWriteBuffer>()));
+  DiskBufferPool *buffer_pool2 = nullptr;
+  filesystem::copy(record_manager_file_copy, record_manager_file);
+  ASSERT_EQ(bpm2.open_file(log_handler2, record_manager_file.c_str(), buffer_pool2), RC::SUCCESS);
+
+  IntegratedLogReplayer log_replayer2(bpm2);
+  ASSERT_EQ(log_handler2.init(directory.c_str()), RC::SUCCESS);
+  ASSERT_EQ(log_handler2.replay(log_replayer2, 0), RC::SUCCESS);
+  ASSERT_EQ(log_handler2.start(), RC::SUCCESS);
+
+  RecordFileHandler record_file_handler2(StorageFormat::SLOTTED_FORMAT);
+  ASSERT_EQ(record_file_handler2.init(*buffer_pool2, log_handler2, &table_meta, nullptr), RC::SUCCESS);
+  for (const auto &[rid, data] : record_map) {
+    Record record;
+    ASSERT_EQ(record_file_handler2.get_record(rid, record), RC::SUCCESS);
+    ASSERT_EQ(record.len(), record_size);
+    ASSERT_EQ(memcmp(record.data(), data.data(), record_size), 0);
+  }
+
+  record_file_handler2.close();
+  ASSERT_EQ(log_handler2.stop(), RC::SUCCESS);
+  ASSERT_EQ(log_handler2.await_termination(), RC::SUCCESS);
+  bpm2.close_file(record_manager_file.c_str());
+}
+
+TEST(RecordManager, slotted_move_record)
+{
+  VacuousLogHandler log_handler;
+
+  const char *record_manager_file = "record_manager_move.bp";
+  filesystem::remove(record_manager_file);
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  DiskBufferPool *bp = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(record_manager_file));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, record_manager_file, bp));
+
+  // | id int | name char(200) |
+  vector<AttrInfoSqlNode> attributes = {{AttrType::INTS, "id", 4, false}, {AttrType::CHARS, "name", 200, false}};
+  Table      table;
+  TableMeta &table_meta = table.table_meta_;
+  ASSERT_EQ(RC::SUCCESS, table_meta.init(1, "t", nullptr, attributes, {}, StorageFormat::SLOTTED_FORMAT, StorageEngine::HEAP));
+  const int record_size = table_meta.record_size();
+
+  RecordFileHandler file_handler(StorageFormat::SLOTTED_FORMAT);
+  ASSERT_EQ(RC::SUCCESS, file_handler.init(*bp, log_handler, &table_meta, nullptr));
+
+  auto make_record = [record_size](int id, int name_len) {
+    string data(record_size, '\0');
+    memcpy(data.data(), &id, sizeof(id));
+    memset(data.data() + 4, 'a' + id % 26, name_len);
+    return data;
+  };
+
+  // 短记录把第一个页面填满
+  const int   record_num = 1000;
+  vector<RID> rids;
+  for (int i = 0; i < record_num; i++) {
+    RID    rid;
+    string data = make_record(i, 1);
+    ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(data.data(), record_size, &rid));
+    rids.push_back(rid);
+  }
+  vector<int> first_page;
+  for (int i = 0; i < record_num && rids[i].page_num == rids[0].page_num; i++) {
+    first_page.push_back(i);
+  }
+  ASSERT_GT(first_page.size(), 100);
+
+  auto check_records = [&](const vector<string> &expected) {
+    for (int i = 0; i < record_num; i++) {
+      if (expected[i].empty()) {
+        continue;
+      }
+      Record record;
+      ASSERT_EQ(RC::SUCCESS, file_handler.get_record(rids[i], record));
+      ASSERT_EQ(rids[i], record.rid());
+      ASSERT_EQ(0, memcmp(record.data(), expected[i].data(), record_size));
+    }
+
+    // 溢出页面上的记录只通过原来的槽位返回一次
+    ChunkFileScanner scanner;
+    ASSERT_EQ(RC::SUCCESS, scanner.open_scan_chunk(&table, *bp, log_handler, ReadWriteMode::READ_ONLY));
+    Chunk chunk;
+    chunk.add_column(make_unique<Column>(*table_meta.field(0)), 0);
+    chunk.add_column(make_unique<Column>(*table_meta.field(1)), 1);
+    vector<int> ids;
+    RC          rc = RC::SUCCESS;
+    while (OB_SUCC(rc = scanner.next_chunk(chunk))) {
+      for (int row = 0; row < chunk.rows(); row++) {
+        const int id = chunk.column(0).get_value(row).get_int();
+        ASSERT_EQ(string(expected[id].data() + 4), chunk.column(1).get_value(row).get_string());
+        ids.push_back(id);
+      }
+      chunk.reset_data();
+    }
+    ASSERT_EQ(RC::RECORD_EOF, rc);
+    scanner.close_scan();
+
+    int expected_num = 0;
+    for (const string &data : expected) {
+      expected_num += data.empty() ? 0 : 1;
+    }
+    sort(ids.begin(), ids.end());
+    ASSERT_EQ(expected_num, static_cast<int>(ids.size()));
+    ASSERT_TRUE(adjacent_find(ids.begin(), ids.end()) == ids.end());
+  };
+
+  vector<string> expected;
+  for (int i = 0; i < record_num; i++) {
+    expected.push_back(make_record(i, 1));
+  }
+
+  // 第一个页面上的记录都变成最长，页面上放不下的迁移到溢出页面
+  for (int i : first_page) {
+    expected[i] = make_record(i, 200);
+    ASSERT_EQ(RC::SUCCESS, file_handler.visit_record(rids[i], [&](Record &record) {
+      memcpy(record.data(), expected[i].data(), record_size);
+      return true;
+    }));
+  }
+  check_records(expected);
+
+  // 批量更新时已经迁移的记录在溢出页面上更新，变长的记录再次迁移
+  vector<RID> batch_rids;
+  for (int i : first_page) {
+    batch_rids.push_back(rids[i]);
+  }
+  for (int round = 0; round < 2; round++) {
+    const int name_len = round == 0 ? 10 : 150;
+    ASSERT_EQ(RC::SUCCESS, file_handler.visit_records(batch_rids, [&](Record &record) {
+      const int id = *reinterpret_cast<const int *>(record.data());
+      expected[id] = make_record(id, name_len);
+      memcpy(record.data(), expected[id].data(), record_size);
+      return true;
+    }));
+    check_records(expected);
+  }
+
+  // 删除已经迁移的记录，溢出页面上的记录也一起删除
+  for (size_t i = 0; i < first_page.size(); i += 2) {
+    ASSERT_EQ(RC::SUCCESS, file_handler.delete_record(&rids[first_page[i]]));
+    expected[first_page[i]].clear();
+  }
+  check_records(expected);
+
+  file_handler.close();
+  bpm.close_file(record_manager_file);
+}
+
+TEST(RecordManager, slotted_overflow_reuse)
+{
+  VacuousLogHandler log_handler;
+
+  const char *data_file = "record_manager_overflow.bp";
+  const char *fsm_file  = "record_manager_overflow.fsm";
+  filesystem::remove(data_file);
+  filesystem::remove(fsm_file);
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(RC::SUCCESS, bpm.init(make_unique<VacuousDoubleWriteBuffer>()));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(data_file));
+  ASSERT_EQ(RC::SUCCESS, bpm.create_file(fsm_file));
+
+  DiskBufferPool *data_bp = nullptr;
+  DiskBufferPool *fsm_bp  = nullptr;
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, data_file, data_bp));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, fsm_file, fsm_bp));
+
+  // | id int | name char(200) |
+  vector<AttrInfoSqlNode> attributes = {{AttrType::INTS, "id", 4, false}, {AttrType::CHARS, "name", 200, false}};
+  TableMeta               table_meta;
+  ASSERT_EQ(RC::SUCCESS, table_meta.init(1, "t", nullptr, attributes, {}, StorageFormat::SLOTTED_FORMAT, StorageEngine::HEAP));
+  const int record_size = table_meta.record_size();
+
+  RecordFileHandler file_handler(StorageFormat::SLOTTED_FORMAT);
+  ASSERT_EQ(RC::SUCCESS, file_handler.init(*data_bp, log_handler, &table_meta, nullptr, fsm_bp));
+
+  auto make_record = [record_size](int id, int name_len) {
+    string data(record_size, '\0');
+    memcpy(data.data(), &id, sizeof(id));
+    memset(data.data() + 4, 'a' + id % 26, name_len);
+    return data;
+  };
+  auto grow = [&](const RID &rid, const string &data) {
+    return file_handler.visit_record(rid, [&](Record &record) {
+      memcpy(record.data(), data.data(), record_size);
+      return true;
+    });
+  };
+
+  const int   record_num = 1000;
+  vector<RID> rids;
+  for (int i = 0; i < record_num; i++) {
+    RID    rid;
+    string data = make_record(i, 1);
+    ASSERT_EQ(RC::SUCCESS, file_handler.insert_record(data.data(), record_size, &rid));
+    rids.push_back(rid);
+  }
+  vector<int> first_page;
+  for (int i = 0; i < record_num && rids[i].page_num == rids[0].page_num; i++) {
+    first_page.push_back(i);
+  }
+  ASSERT_GT(first_page.size(), 100);
+
+  // 一半的记录变长以后迁移到溢出页面，然后删除，溢出页面上空出来的空间在重启以后继续使用
+  for (size_t i = 0; i < first_page.size(); i += 2) {
+    ASSERT_EQ(RC::SUCCESS, grow(rids[first_page[i]], make_record(first_page[i], 200)));
+  }
+  const PageNum page_count = data_bp->page_count();
+  for (size_t i = 0; i < first_page.size(); i += 2) {
+    ASSERT_EQ(RC::SUCCESS, file_handler.delete_record(&rids[first_page[i]]));
+  }
+
+  file_handler.close();
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(fsm_file));
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(data_file));
+
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, data_file, data_bp));
+  ASSERT_EQ(RC::SUCCESS, bpm.open_file(log_handler, fsm_file, fsm_bp));
+  ASSERT_EQ(RC::SUCCESS, file_handler.init(*data_bp, log_handler, &table_meta, nullptr, fsm_bp));
+
+  for (size_t i = 1; i < first_page.size(); i += 2) {
+    ASSERT_EQ(RC::SUCCESS, grow(rids[first_page[i]], make_record(first_page[i], 200)));
+  }
+  ASSERT_EQ(page_count, data_bp->page_count());
+
+  for (size_t i = 1; i < first_page.size(); i += 2) {
+    const string expected = make_record(first_page[i], 200);
+    Record       record;
+    ASSERT_EQ(RC::SUCCESS, file_handler.get_record(rids[first_page[i]], record));
+    ASSERT_EQ(0, memcmp(record.data(), expected.data(), record_size));
+  }
+
+  file_handler.close();
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(fsm_file));
+  ASSERT_EQ(RC::SUCCESS, bpm.close_file(data_file));
+}
+
+TEST(RecordManager, batch_update_durability)
+{
+  filesystem::path directory("record_manager_batch_update");
+  filesystem::remove_all(directory);
+  ASSERT_TRUE(filesystem::create_directories(directory));
+
+  filesystem::path record_manager_file = directory / "record_manager.bp";
+
+  BufferPoolManager bpm;
+  ASSERT_EQ(bpm.init(make_unique<VacuousDoubleWriteBuffer>()), RC::SUCCESS);
+
+  DiskLogHandler        log_handler;
+  IntegratedLogReplayer log_replayer(bpm);
+  ASSERT_EQ(log_handler.init(directory.c_str()), RC::SUCCESS);
+  ASSERT_EQ(log_handler.replay(log_replayer, 0), RC::SUCCESS);
+  ASSERT_EQ(log_handler.start(), RC::SUCCESS);
+
+  DiskBufferPool *buffer_pool = nullptr;
+  ASSERT_EQ(bpm.create_file(record_manager_file.c_str()), RC::SUCCESS);
+  ASSERT_EQ(bpm.open_file(log_handler, record_manager_file.c_str(), buffer_pool), RC::SUCCESS);
+
+  RecordFileHandler record_file_handler(StorageFormat::ROW_FORMAT);
+  ASSERT_EQ(record_file_handler.init(*buffer_pool, log_handler, nullptr, nullptr), RC::SUCCESS);
+
+  const int   record_size = 100;
+  vector<RID> rids;
+  for (int i = 0; i < 1000; i++) {
+    string data(record_size, '\0');
+    memcpy(data.data(), &i, sizeof(i));
+    RID rid;
+    ASSERT_EQ(record_file_handler.insert_record(data.data(), record_size, &rid), RC::SUCCESS);
+    rids.push_back(rid);
+  }
+  sort(rids.begin(), rids.end(), [](const RID &a, const RID &b) { return RID::compare(&a, &b) < 0; });
+  ASSERT_GT(rids.back().page_num, rids.front().page_num);
+
+  // 跨越多个页面，只修改其中一半的记录，每个页面只记录一条日志
+  const LSN start_lsn = log_handler.current_lsn();
+  int       visited   = 0;
+  ASSERT_EQ(record_file_handler.visit_records(rids,
+                [&visited](Record &record) {
+                  visited++;
+                  int id = 0;
+                  memcpy(&id, record.data(), sizeof(id));
+                  if (id % 2 != 0) {
+                    return false;
+                  }
+                  id = -id;
+                  memcpy(record.data(), &id, sizeof(id));
+                  return true;
+                }),
+      RC::SUCCESS);
+  ASSERT_EQ(visited, static_cast<int>(rids.size()));
+  const int page_num = rids.back().page_num - rids.front().page_num + 1;
+  ASSERT_EQ(log_handler.current_lsn() - start_lsn, page_num);
+
+  filesystem::path record_manager_file_copy = directory / "record_manager_copy.bp";
+  filesystem::copy_file(record_manager_file, record_manager_file_copy);
+  record_file_handler.close();
+  bpm.close_file(record_manager_file.c_str());
+  filesystem::remove(record_manager_file);
+  ASSERT_EQ(log_handler.stop(), RC::SUCCESS);
+  ASSERT_EQ(log_handler.await_termination(), RC::SUCCESS);
+
+  // 从日志中恢复
+  DiskLogHandler    log_handler2;
+  BufferPoolManager bpm2;
+  ASSERT_EQ(RC::SUCCESS, bpm2.init(make_unique<VacuousDoubleWriteBuffer>()));
+  DiskBufferPool *buffer_pool2 = nullptr;
+  filesystem::copy(record_manager_file_copy, record_manager_file);
+  ASSERT_EQ(bpm2.open_file(log_handler2, record_manager_file.c_str(), buffer_pool2), RC::SUCCESS);
+
+  IntegratedLogReplayer log_replayer2(bpm2);
+  ASSERT_EQ(log_handler2.init(directory.c_str()), RC::SUCCESS);
+  ASSERT_EQ(log_handler2.replay(log_replayer2, 0), RC::SUCCESS);
+  ASSERT_EQ(log_handler2.start(), RC::SUCCESS);
+
+  RecordFileHandler record_file_handler2(StorageFormat::ROW_FORMAT);
+  ASSERT_EQ(record_file_handler2.init(*buffer_pool2, log_handler2, nullptr, nullptr), RC::SUCCESS);
+  int updated = 0;
+  for (const RID &rid : rids) {
+    Record record;
+    ASSERT_EQ(record_file_handler2.get_record(rid, record), RC::SUCCESS);
+    int id = 0;
+    memcpy(&id, record.data(), sizeof(id));
+    if (id < 0) {
+      ASSERT_EQ(0, (-id) % 2);
+      updated++;
+    } else if (id > 0) {
+      ASSERT_EQ(1, id % 2);
+    }
+  }
+  ASSERT_EQ(updated, static_cast<int>(rids.size()) / 2 - 1);  // 0 修改以后还是 0
+
+  record_file_handler2.close();
+  ASSERT_EQ(log_handler2.stop(), RC::SUCCESS);
+  ASSERT_EQ(log_handler2.await_termination(), RC::SUCCESS);
+  bpm2.close_file(record_manager_file.c_str());
+}
+
 int main(int argc, char **argv)
 {
   testing::InitGoogleTest(&argc, argv);